@@ -0,0 +1,189 @@
+#ifndef COMMON_PRICE
+#define COMMON_PRICE
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+namespace Common {
+
+/**
+ * @brief
+ * Fixed-point decimal price, an integer number of units of 10^-scale. The
+ * scale is a property of the symbol and is only needed to read or write the
+ * price as a decimal string, inside the engine a price compares and adds as
+ * a plain int64_t. An integer converts to the price with as many units, so
+ * the prices of a symbol of scale 0 read as integers. A floating point value
+ * does not convert, it would be truncated to units, see parse().
+ */
+class Price {
+public:
+  // enough for the sign, 19 digits and the decimal point
+  static constexpr size_t kMaxFormattedSize = 21;
+  static constexpr unsigned kMaxScale = 18;
+
+  constexpr Price() = default;
+  constexpr Price(std::int64_t units) : mUnits(units) {}
+  template <typename T,
+            typename = std::enable_if_t<std::is_floating_point_v<T>>>
+  Price(T) = delete;
+
+  static constexpr Price max() {
+    return Price(std::numeric_limits<std::int64_t>::max());
+  }
+
+  constexpr std::int64_t units() const { return mUnits; }
+
+  // whether the price is not 0
+  constexpr explicit operator bool() const { return mUnits != 0; }
+
+  constexpr Price operator-() const { return Price(-mUnits); }
+  constexpr Price &operator+=(Price other) {
+    mUnits += other.mUnits;
+    return *this;
+  }
+  constexpr Price &operator-=(Price other) {
+    mUnits -= other.mUnits;
+    return *this;
+  }
+
+  friend constexpr Price operator+(Price lhs, Price rhs) {
+    return Price(lhs.mUnits + rhs.mUnits);
+  }
+  friend constexpr Price operator-(Price lhs, Price rhs) {
+    return Price(lhs.mUnits - rhs.mUnits);
+  }
+  // the remainder of the division by a tick size
+  friend constexpr Price operator%(Price lhs, Price rhs) {
+    return Price(lhs.mUnits % rhs.mUnits);
+  }
+
+  friend constexpr bool operator==(Price lhs, Price rhs) {
+    return lhs.mUnits == rhs.mUnits;
+  }
+  friend constexpr bool operator!=(Price lhs, Price rhs) {
+    return lhs.mUnits != rhs.mUnits;
+  }
+  friend constexpr bool operator<(Price lhs, Price rhs) {
+    return lhs.mUnits < rhs.mUnits;
+  }
+  friend constexpr bool operator<=(Price lhs, Price rhs) {
+    return lhs.mUnits <= rhs.mUnits;
+  }
+  friend constexpr bool operator>(Price lhs, Price rhs) {
+    return lhs.mUnits > rhs.mUnits;
+  }
+  friend constexpr bool operator>=(Price lhs, Price rhs) {
+    return lhs.mUnits >= rhs.mUnits;
+  }
+
+  /**
+   * @brief
+   * The notional of the quantity at the price, in units of the price
+   */
+  constexpr std::int64_t notional(std::uint64_t quantity) const {
+    return mUnits * static_cast<std::int64_t>(quantity);
+  }
+
+  constexpr double toDouble() const { return static_cast<double>(mUnits); }
+
+  /**
+   * @brief
+   * Read a decimal string such as "-12.345" with the scale, the missing
+   * decimals are 0. Nothing is allocated and no floating point is involved.
+   * return false if the text is not a decimal number, has more decimals than
+   * the scale or overflows
+   */
+  static constexpr bool parse(std::string_view text, unsigned scale,
+                              Price &price) {
+    if (text.empty() || scale > kMaxScale) {
+      return false;
+    }
+
+    size_t pos = 0;
+    bool negative = text[0] == '-';
+    if (negative || text[0] == '+') {
+      pos++;
+    }
+
+    constexpr auto kMax = std::numeric_limits<std::int64_t>::max();
+    std::int64_t units = 0;
+    unsigned decimals = 0;
+    bool hasPoint = false;
+    bool hasDigit = false;
+    for (; pos < text.size(); pos++) {
+      auto c = text[pos];
+      if (c == '.' && !hasPoint) {
+        hasPoint = true;
+        continue;
+      }
+      if (c < '0' || c > '9' || (hasPoint && decimals == scale)) {
+        return false;
+      }
+      if (units > (kMax - (c - '0')) / 10) {
+        return false;
+      }
+      units = units * 10 + (c - '0');
+      decimals += hasPoint;
+      hasDigit = true;
+    }
+
+    if (!hasDigit) {
+      return false;
+    }
+
+    for (; decimals < scale; decimals++) {
+      if (units > kMax / 10) {
+        return false;
+      }
+      units *= 10;
+    }
+
+    price = Price(negative ? -units : units);
+    return true;
+  }
+
+  /**
+   * @brief
+   * Write the price as a decimal string with exactly scale decimals, the
+   * buffer holds at least kMaxFormattedSize characters. The string is not
+   * null terminated.
+   * return the number of characters written
+   */
+  constexpr size_t format(char *buffer, unsigned scale) const {
+    char digits[kMaxFormattedSize] = {};
+    size_t numOfDigits = 0;
+    // the magnitude of the minimum int64_t does not fit in an int64_t
+    auto magnitude = mUnits < 0 ? 0 - static_cast<std::uint64_t>(mUnits)
+                                : static_cast<std::uint64_t>(mUnits);
+    do {
+      digits[numOfDigits++] = static_cast<char>('0' + magnitude % 10);
+      magnitude /= 10;
+    } while (magnitude || numOfDigits <= scale);
+
+    size_t size = 0;
+    if (mUnits < 0) {
+      buffer[size++] = '-';
+    }
+    while (numOfDigits) {
+      if (numOfDigits == scale) {
+        buffer[size++] = '.';
+      }
+      buffer[size++] = digits[--numOfDigits];
+    }
+    return size;
+  }
+
+private:
+  std::int64_t mUnits = 0;
+};
+
+// the units of the price, the scale is not known here
+inline std::ostream &operator<<(std::ostream &os, Price price) {
+  return os << price.units();
+}
+
+} // namespace Common
+#endif
@@ -1,6 +1,7 @@
 #ifndef COMMON_TYPES
 #define COMMON_TYPES
 #include <cstdint>
+#include <price.h>
 #include <string>
 namespace Common {
 // enum class MatchingStatus {
@@ -9,18 +10,27 @@ namespace Common {
 //   REJECTED,
 // };
 
-/**
- * @brief
- * Assume the price will be int64_t for easy implementation.
- * In real world application, it will be floating point, probably we need to use
- * two int for storing the integer part and the decimal part of the number , in
- * order to preserve the precision
- */
-using Price = std::int64_t;
 using Quantity = std::uint64_t;
 using Symbol = std::string;
 using OrderId = std::uint64_t;
 using TraderId = std::string;
+/**
+ * @brief
+ * Dense index of a symbol added to the matching engine, in order of addition
+ */
+using SymbolId = std::uint32_t;
+/**
+ * @brief
+ * Dense integer handle of a TraderId interned by the matching engine, so that
+ * the hot path compares integers instead of strings. 0 is never assigned.
+ */
+using TraderKey = std::uint32_t;
+/**
+ * @brief
+ * A point in time in the unit chosen by the caller, e.g. milliseconds since
+ * the epoch
+ */
+using Timestamp = std::uint64_t;
 
 } // namespace Common
 #endif
@@ -2,18 +2,94 @@
 namespace Core {
 void ExecutionContext::addTraders(const std::vector<TraderId> &traderIds) {
   for (auto &id : traderIds) {
-    mTraderMap[id] = std::make_shared<Trader>(id);
+    auto trader = std::make_shared<Trader>(id);
+    trader->setLog(mTraderLog);
+    mTraderMap[id] = std::move(trader);
+  }
+}
+void ExecutionContext::setTraderLog(std::ostream *log) {
+  mTraderLog = log;
+  for (auto &[id, trader] : mTraderMap) {
+    trader->setLog(log);
   }
 }
 void ExecutionContext::notifyTraderAllFilled(TraderId traderId,
                                              OrderId orderId) {
+  if (mListener) {
+    mListener->onAllFilled(traderId, orderId);
+  }
   if (mTraderMap.find(traderId) != mTraderMap.end()) {
 
     mTraderMap[traderId]->notifyAllFilled(orderId);
   }
 }
+void ExecutionContext::notifyCancelled(
+    const std::vector<CancelledOrder> &cancelledOrders, OrderCancelReason rsn) {
+  if (mListener) {
+    mListener->onCancelled(cancelledOrders, rsn);
+  }
+
+  const TraderId *traderId = nullptr;
+  Trader *trader = nullptr;
+  for (const auto &order : cancelledOrders) {
+    onOrderClosed(order.mOrderId);
+    if (!traderId || *traderId != order.mTraderId) {
+      traderId = &order.mTraderId;
+      auto it = mTraderMap.find(order.mTraderId);
+      trader = it != mTraderMap.end() ? it->second.get() : nullptr;
+    }
+    if (!trader) {
+      continue;
+    }
+    if (order.mSide == Side::BUY) {
+      trader->notifyCancel<Side::BUY, OrderStyle::LIMIT_ORDER>(
+          order.mOrderId, order.mSymbol, order.mPrice, order.mQuantity, rsn);
+    } else {
+      trader->notifyCancel<Side::SELL, OrderStyle::LIMIT_ORDER>(
+          order.mOrderId, order.mSymbol, order.mPrice, order.mQuantity, rsn);
+    }
+  }
+}
+
 std::unordered_map<TraderId, std::shared_ptr<Trader>>
 ExecutionContext::getTraderMap() {
   return mTraderMap;
 }
+
+Position ExecutionContext::getPosition(const TraderId &traderId,
+                                       const Symbol &symbol) const {
+  auto account = findAccount(traderId);
+  auto position = account ? account->findPosition(symbol) : nullptr;
+  return position ? *position : Position();
+}
+
+const std::unordered_map<Symbol, Position> &
+ExecutionContext::getPositions(const TraderId &traderId) const {
+  static const std::unordered_map<Symbol, Position> empty;
+  auto account = findAccount(traderId);
+  return account ? account->getPositions() : empty;
+}
+
+const Account *ExecutionContext::findAccount(const TraderId &traderId) const {
+  auto it = mAccounts.find(traderId);
+  return it != mAccounts.end() ? &it->second : nullptr;
+}
+
+void ExecutionContext::onOrderClosed(OrderId orderId) {
+  auto it = mOpenOrders.find(orderId);
+  if (it == mOpenOrders.end()) {
+    return;
+  }
+
+  auto &openOrder = it->second;
+  if (openOrder.mSide == Side::BUY) {
+    openOrder.mPosition->onClose<Side::BUY>(openOrder.mPrice,
+                                            openOrder.mQuantity);
+  } else {
+    openOrder.mPosition->onClose<Side::SELL>(openOrder.mPrice,
+                                             openOrder.mQuantity);
+  }
+  openOrder.mAccount->onOrderClosed();
+  mOpenOrders.erase(it);
+}
 } // namespace Core
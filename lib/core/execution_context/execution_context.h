@@ -1,7 +1,10 @@
 #ifndef CORE_EXECUTION_CONTEXT
 #define CORE_EXECUTION_CONTEXT
+#include <iostream>
 #include <memory>
 #include <optional>
+#include <execution_context/execution_listener.h>
+#include <execution_context/position.h>
 #include <trader/trader.h>
 #include <types.h>
 #include <unordered_map>
@@ -10,6 +13,7 @@
 
 using namespace Common;
 namespace Core {
+
 class ExecutionContext {
 public:
   ExecutionContext() = default;
@@ -17,24 +21,48 @@ public:
     addTraders(traderIds);
   }
 
-  ExecutionContext(const ExecutionContext &other) = default;
-  ExecutionContext &operator=(const ExecutionContext &) = default;
+  // the open order index refers to the positions owned by this context
+  ExecutionContext(const ExecutionContext &other) = delete;
+  ExecutionContext &operator=(const ExecutionContext &) = delete;
   ExecutionContext(ExecutionContext &&other) = default;
   ExecutionContext &operator=(ExecutionContext &&other) = default;
 
   void addTraders(const std::vector<TraderId> &traderIds);
 
+  /**
+   * @brief
+   * Send every notification to the listener as well, nullptr removes it. The
+   * listener is not owned and outlives the context or is removed first.
+   */
+  void setListener(ExecutionListener *listener) { mListener = listener; }
+
+  /**
+   * @brief
+   * Set the log of the traders, added so far and from now on, see
+   * Trader::setLog()
+   */
+  void setTraderLog(std::ostream *log);
+
   template <OrderStatus status>
   void notifyTrader(TraderId traderId, OrderId orderId) {
     static_assert(status == OrderStatus::CANCEL ||
-                      status == OrderStatus::CANCEL_REJECT,
+                      status == OrderStatus::CANCEL_REJECT ||
+                      status == OrderStatus::AMEND_REJECT,
                   "This function template can only be instantiated by "
-                  "OrderStatus::CANCEL || OrderStatus::CANCEL_REJECT");
+                  "OrderStatus::CANCEL || OrderStatus::CANCEL_REJECT || "
+                  "OrderStatus::AMEND_REJECT");
+
+    if (mListener) {
+      notifyListener<status>(traderId, orderId);
+    }
 
     if constexpr (status == OrderStatus::CANCEL) {
+      onOrderClosed(orderId);
       mTraderMap[traderId]->notifyCancel(orderId);
     } else if constexpr (status == OrderStatus::CANCEL_REJECT) {
       mTraderMap[traderId]->notifyCancelReject(orderId);
+    } else if constexpr (status == OrderStatus::AMEND_REJECT) {
+      mTraderMap[traderId]->notifyAmendReject(orderId);
     }
   }
 
@@ -42,8 +70,23 @@ public:
   void notifyTrader(TraderId traderId, OrderId orderId, Symbol symbol,
                     Price price, Quantity quantity,
                     OrderCancelReason rsn = OrderCancelReason::NONE) {
+    if (mListener) {
+      notifyListener<side, style, status>(traderId, orderId, symbol, price,
+                                          quantity, rsn);
+    }
+
+    if constexpr (status == OrderStatus::FILLED) {
+      onOrderFilled<side>(traderId, orderId, symbol, price, quantity);
+    } else if constexpr (status == OrderStatus::CANCEL) {
+      onOrderClosed(orderId);
+    } else if constexpr (status == OrderStatus::OPEN && !isStopOrder(style)) {
+      // a pending stop order is not in the order book yet
+      onOrderOpen<side>(traderId, orderId, symbol, price, quantity);
+    } else if constexpr (status == OrderStatus::AMEND) {
+      onOrderAmended<side>(orderId, price, quantity);
+    }
 
-    if constexpr (style == OrderStyle::LIMIT_ORDER) {
+    if constexpr (style != OrderStyle::MKT_ORDER) {
       if (mTraderMap.find(traderId) != mTraderMap.end()) {
 
         if constexpr (status == OrderStatus::FILLED) {
@@ -54,6 +97,12 @@ public:
                                                           price, quantity, rsn);
         } else if constexpr (status == OrderStatus::CANCEL_REJECT) {
           mTraderMap[traderId]->notifyCancelReject(orderId);
+        } else if constexpr (status == OrderStatus::AMEND) {
+          mTraderMap[traderId]->notifyAmend<side, style>(orderId, symbol,
+                                                         price, quantity);
+        } else if constexpr (status == OrderStatus::TRIGGER) {
+          mTraderMap[traderId]->notifyTrigger<side, style>(orderId, symbol,
+                                                           price, quantity);
         } else {
           mTraderMap[traderId]->notifyOpen<side, style>(orderId, symbol, price,
                                                         quantity);
@@ -70,12 +119,161 @@ public:
     }
   }
 
+  template <Side side, OrderStyle style>
+  void notifyReject(TraderId traderId, OrderId orderId, Symbol symbol,
+                    Price price, Quantity quantity, OrderRejectReason rsn) {
+    if (mListener) {
+      mListener->onReject(traderId, orderId, symbol, side, style, price,
+                          quantity, rsn);
+    }
+    if (mTraderMap.find(traderId) != mTraderMap.end()) {
+      mTraderMap[traderId]->notifyReject<side, style>(orderId, symbol, price,
+                                                      quantity, rsn);
+    }
+  }
+
   void notifyTraderAllFilled(TraderId traderId, OrderId orderId);
 
+  /**
+   * @brief
+   * Notify the cancels of a batch of orders: the listener gets the batch in
+   * one onCancelled() call and the trader is looked up once per run of
+   * orders of the same trader
+   */
+  void notifyCancelled(const std::vector<CancelledOrder> &cancelledOrders,
+                       OrderCancelReason rsn);
+
   std::unordered_map<TraderId, std::shared_ptr<Trader>> getTraderMap();
 
+  /**
+   * @brief
+   * Position of the trader on the symbol, a flat position is returned if the
+   * trader never traded or quoted the symbol
+   */
+  Position getPosition(const TraderId &traderId, const Symbol &symbol) const;
+
+  const std::unordered_map<Symbol, Position> &
+  getPositions(const TraderId &traderId) const;
+
+  /**
+   * @brief
+   * The account of the trader, nullptr if the trader never traded or quoted
+   */
+  const Account *findAccount(const TraderId &traderId) const;
+
 private:
+  /**
+   * @brief
+   * The remaining part of an order resting in the order book, it refers to
+   * the account and position it contributes to, so that the fills and cancels
+   * of the order can update the open exposure in O(1)
+   */
+  struct OpenOrder {
+    Account *mAccount;
+    Position *mPosition;
+    Side mSide;
+    Price mPrice;
+    Quantity mQuantity;
+  };
+
+  template <OrderStatus status>
+  void notifyListener(const TraderId &traderId, OrderId orderId) {
+    if constexpr (status == OrderStatus::CANCEL) {
+      // the details of a resting order are known from its open order
+      static const Symbol unknownSymbol;
+      auto it = mOpenOrders.find(orderId);
+      if (it != mOpenOrders.end()) {
+        const auto &openOrder = it->second;
+        mListener->onCancel(traderId, orderId, unknownSymbol, openOrder.mSide,
+                            OrderStyle::LIMIT_ORDER, openOrder.mPrice,
+                            openOrder.mQuantity,
+                            OrderCancelReason::CANCEL_REQUEST);
+      } else {
+        mListener->onCancel(traderId, orderId, unknownSymbol, Side::BUY,
+                            OrderStyle::LIMIT_ORDER, 0, 0,
+                            OrderCancelReason::CANCEL_REQUEST);
+      }
+    } else if constexpr (status == OrderStatus::CANCEL_REJECT) {
+      mListener->onCancelReject(traderId, orderId);
+    } else {
+      mListener->onAmendReject(traderId, orderId);
+    }
+  }
+
+  template <Side side, OrderStyle style, OrderStatus status>
+  void notifyListener(const TraderId &traderId, OrderId orderId,
+                      const Symbol &symbol, Price price, Quantity quantity,
+                      OrderCancelReason rsn) {
+    if constexpr (status == OrderStatus::FILLED) {
+      mListener->onFill(traderId, orderId, symbol, side, style, price,
+                        quantity);
+    } else if constexpr (status == OrderStatus::CANCEL) {
+      mListener->onCancel(traderId, orderId, symbol, side, style, price,
+                          quantity, rsn);
+    } else if constexpr (status == OrderStatus::CANCEL_REJECT) {
+      mListener->onCancelReject(traderId, orderId);
+    } else if constexpr (status == OrderStatus::AMEND) {
+      mListener->onAmend(traderId, orderId, symbol, side, price, quantity);
+    } else if constexpr (status == OrderStatus::AMEND_REJECT) {
+      mListener->onAmendReject(traderId, orderId);
+    } else if constexpr (status == OrderStatus::TRIGGER) {
+      mListener->onTrigger(traderId, orderId, symbol, side, style, price,
+                           quantity);
+    } else {
+      mListener->onOpen(traderId, orderId, symbol, side, style, price,
+                        quantity);
+    }
+  }
+
+  template <Side side>
+  void onOrderOpen(const TraderId &traderId, OrderId orderId,
+                   const Symbol &symbol, Price price, Quantity quantity) {
+    auto &account = mAccounts[traderId];
+    auto &position = account.getPosition(symbol);
+    position.onOpen<side>(price, quantity);
+    account.onOrderOpen();
+    mOpenOrders[orderId] =
+        OpenOrder{&account, &position, side, price, quantity};
+  }
+
+  template <Side side>
+  void onOrderFilled(const TraderId &traderId, OrderId orderId,
+                     const Symbol &symbol, Price price, Quantity quantity) {
+    auto it = mOpenOrders.find(orderId);
+    if (it != mOpenOrders.end()) {
+      // the resting order is filled, its position is already known
+      auto &openOrder = it->second;
+      openOrder.mPosition->onFill<side>(price, quantity);
+      openOrder.mPosition->onClose<side>(openOrder.mPrice, quantity);
+      openOrder.mQuantity -= quantity;
+      if (openOrder.mQuantity == 0) {
+        openOrder.mAccount->onOrderClosed();
+        mOpenOrders.erase(it);
+      }
+    } else {
+      mAccounts[traderId].getPosition(symbol).onFill<side>(price, quantity);
+    }
+  }
+
+  template <Side side>
+  void onOrderAmended(OrderId orderId, Price price, Quantity quantity) {
+    auto it = mOpenOrders.find(orderId);
+    if (it != mOpenOrders.end()) {
+      auto &openOrder = it->second;
+      openOrder.mPosition->onClose<side>(openOrder.mPrice, openOrder.mQuantity);
+      openOrder.mPosition->onOpen<side>(price, quantity);
+      openOrder.mPrice = price;
+      openOrder.mQuantity = quantity;
+    }
+  }
+
+  void onOrderClosed(OrderId orderId);
+
   std::unordered_map<TraderId, std::shared_ptr<Trader>> mTraderMap;
+  std::unordered_map<TraderId, Account> mAccounts;
+  std::unordered_map<OrderId, OpenOrder> mOpenOrders;
+  ExecutionListener *mListener = nullptr;
+  std::ostream *mTraderLog = &std::cout;
 };
 } // namespace Core
 
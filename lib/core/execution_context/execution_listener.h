@@ -0,0 +1,93 @@
+#ifndef CORE_EXECUTION_LISTENER
+#define CORE_EXECUTION_LISTENER
+#include <order/order.h>
+#include <types.h>
+#include <vector>
+
+using namespace Common;
+
+namespace Core {
+
+/**
+ * @brief
+ * A resting order taken out of the order book by the engine, e.g. because it
+ * expired or its trader was mass cancelled
+ */
+struct CancelledOrder {
+  TraderId mTraderId;
+  OrderId mOrderId;
+  Symbol mSymbol;
+  Side mSide;
+  Price mPrice;
+  Quantity mQuantity;
+};
+
+/**
+ * @brief
+ * Receives every notification of the ExecutionContext, in the order they are
+ * sent to the traders, e.g. to encode them for a gateway. The references are
+ * only valid during the call. A listener overrides the notifications it
+ * needs, the others are ignored.
+ */
+class ExecutionListener {
+public:
+  virtual ~ExecutionListener() = default;
+
+  // the order rests in the order book, or waits for its trigger if it is a
+  // stop order
+  virtual void onOpen(const TraderId & /*traderId*/, OrderId /*orderId*/,
+                      const Symbol & /*symbol*/, Side /*side*/,
+                      OrderStyle /*style*/, Price /*price*/,
+                      Quantity /*quantity*/) {}
+
+  virtual void onFill(const TraderId & /*traderId*/, OrderId /*orderId*/,
+                      const Symbol & /*symbol*/, Side /*side*/,
+                      OrderStyle /*style*/, Price /*price*/,
+                      Quantity /*quantity*/) {}
+
+  virtual void onAllFilled(const TraderId & /*traderId*/,
+                           OrderId /*orderId*/) {}
+
+  // the symbol is empty for a cancel request
+  virtual void onCancel(const TraderId & /*traderId*/, OrderId /*orderId*/,
+                        const Symbol & /*symbol*/, Side /*side*/,
+                        OrderStyle /*style*/, Price /*price*/,
+                        Quantity /*quantity*/, OrderCancelReason /*rsn*/) {}
+
+  /**
+   * @brief
+   * The resting orders cancelled by the engine in one batch, by default each
+   * of them is passed to onCancel()
+   */
+  virtual void onCancelled(const std::vector<CancelledOrder> &cancelledOrders,
+                           OrderCancelReason rsn) {
+    for (const auto &order : cancelledOrders) {
+      onCancel(order.mTraderId, order.mOrderId, order.mSymbol, order.mSide,
+               OrderStyle::LIMIT_ORDER, order.mPrice, order.mQuantity, rsn);
+    }
+  }
+
+  virtual void onCancelReject(const TraderId & /*traderId*/,
+                              OrderId /*orderId*/) {}
+
+  virtual void onAmend(const TraderId & /*traderId*/, OrderId /*orderId*/,
+                       const Symbol & /*symbol*/, Side /*side*/,
+                       Price /*price*/, Quantity /*quantity*/) {}
+
+  virtual void onAmendReject(const TraderId & /*traderId*/,
+                             OrderId /*orderId*/) {}
+
+  // the stop order is released to the order book
+  virtual void onTrigger(const TraderId & /*traderId*/, OrderId /*orderId*/,
+                         const Symbol & /*symbol*/, Side /*side*/,
+                         OrderStyle /*style*/, Price /*price*/,
+                         Quantity /*quantity*/) {}
+
+  virtual void onReject(const TraderId & /*traderId*/, OrderId /*orderId*/,
+                        const Symbol & /*symbol*/, Side /*side*/,
+                        OrderStyle /*style*/, Price /*price*/,
+                        Quantity /*quantity*/, OrderRejectReason /*rsn*/) {}
+};
+
+} // namespace Core
+#endif
@@ -0,0 +1,165 @@
+#ifndef CORE_POSITION
+#define CORE_POSITION
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <order/order.h>
+#include <types.h>
+#include <unordered_map>
+
+using namespace Common;
+
+namespace Core {
+
+/**
+ * @brief
+ * The position of a trader on a single symbol. It is maintained incrementally
+ * by the ExecutionContext, every fill / open / cancel notification costs O(1),
+ * so it can be queried at any time without rescanning the filled orders.
+ *
+ * A positive net quantity is a long position, a negative one is a short
+ * position. The average cost is the average price of the currently open
+ * position, the realized P&L is booked whenever a fill reduces the absolute
+ * size of the position. The open exposure is the quantity / notional of the
+ * orders resting in the order book.
+ */
+class Position {
+public:
+  Position() = default;
+  Position(const Position &other) = default;
+  Position &operator=(const Position &) = default;
+  Position(Position &&other) = default;
+  Position &operator=(Position &&other) = default;
+
+  template <Side side> void onFill(Price price, Quantity quantity) {
+    const auto qty = static_cast<std::int64_t>(quantity);
+    const auto signedQty = (side == Side::BUY) ? qty : -qty;
+    const bool isIncreasing = mNetQuantity == 0 ||
+                              (mNetQuantity > 0 && side == Side::BUY) ||
+                              (mNetQuantity < 0 && side == Side::SELL);
+
+    const auto absNetQty = (mNetQuantity < 0) ? -mNetQuantity : mNetQuantity;
+
+    if (isIncreasing) {
+      mAvgCost = (mAvgCost * absNetQty + price.toDouble() * qty) /
+                 (absNetQty + qty);
+      mNetQuantity += signedQty;
+      return;
+    }
+
+    // the fill closes (part of) the position, the remaining quantity of the
+    // fill (if any) opens a position on the other side at the fill price
+    auto closedQty = std::min(absNetQty, qty);
+    auto direction = (mNetQuantity > 0) ? 1 : -1;
+    mRealizedPnl += (price.toDouble() - mAvgCost) *
+                    static_cast<double>(closedQty) * direction;
+    mNetQuantity += signedQty;
+
+    if (mNetQuantity == 0) {
+      mAvgCost = 0;
+    } else if (closedQty < qty) {
+      mAvgCost = price.toDouble();
+    }
+  }
+
+  template <Side side> void onOpen(Price price, Quantity quantity) {
+    if constexpr (side == Side::BUY) {
+      mOpenBuyQuantity += quantity;
+      mOpenBuyNotional += price.notional(quantity);
+    } else {
+      mOpenSellQuantity += quantity;
+      mOpenSellNotional += price.notional(quantity);
+    }
+  }
+
+  /**
+   * @brief
+   * The resting order at price leaves the book for the quantity, either
+   * because it was filled or cancelled
+   */
+  template <Side side> void onClose(Price price, Quantity quantity) {
+    if constexpr (side == Side::BUY) {
+      mOpenBuyQuantity -= quantity;
+      mOpenBuyNotional -= price.notional(quantity);
+    } else {
+      mOpenSellQuantity -= quantity;
+      mOpenSellNotional -= price.notional(quantity);
+    }
+  }
+
+  std::int64_t getNetQuantity() const { return mNetQuantity; }
+  double getAverageCost() const { return mAvgCost; }
+  double getRealizedPnl() const { return mRealizedPnl; }
+  double getUnrealizedPnl(Price markPrice) const {
+    return (markPrice.toDouble() - mAvgCost) *
+           static_cast<double>(mNetQuantity);
+  }
+
+  Quantity getOpenBuyQuantity() const { return mOpenBuyQuantity; }
+  Quantity getOpenSellQuantity() const { return mOpenSellQuantity; }
+  std::int64_t getOpenBuyNotional() const { return mOpenBuyNotional; }
+  std::int64_t getOpenSellNotional() const { return mOpenSellNotional; }
+
+  /**
+   * @brief
+   * The worst case net quantity if all the open orders on one side are filled
+   */
+  std::int64_t getMaxLongExposure() const {
+    return mNetQuantity + static_cast<std::int64_t>(mOpenBuyQuantity);
+  }
+  std::int64_t getMaxShortExposure() const {
+    return mNetQuantity - static_cast<std::int64_t>(mOpenSellQuantity);
+  }
+
+private:
+  std::int64_t mNetQuantity = 0;
+  double mAvgCost = 0;
+  double mRealizedPnl = 0;
+  Quantity mOpenBuyQuantity = 0;
+  Quantity mOpenSellQuantity = 0;
+  std::int64_t mOpenBuyNotional = 0;
+  std::int64_t mOpenSellNotional = 0;
+};
+
+/**
+ * @brief
+ * All the positions of a trader and the number of its orders resting in the
+ * order books. The counter is atomic so that it can be read by the risk
+ * checks and the monitoring without taking any lock.
+ */
+class Account {
+public:
+  Account() = default;
+  Account(const Account &other) = delete;
+  Account &operator=(const Account &) = delete;
+  Account(Account &&other) = delete;
+  Account &operator=(Account &&other) = delete;
+
+  Position &getPosition(const Symbol &symbol) { return mPositions[symbol]; }
+
+  const Position *findPosition(const Symbol &symbol) const {
+    auto it = mPositions.find(symbol);
+    return it != mPositions.end() ? &it->second : nullptr;
+  }
+
+  const std::unordered_map<Symbol, Position> &getPositions() const {
+    return mPositions;
+  }
+
+  std::uint32_t getOpenOrderCount() const {
+    return mOpenOrderCount.load(std::memory_order_relaxed);
+  }
+
+  void onOrderOpen() { mOpenOrderCount.fetch_add(1, std::memory_order_relaxed); }
+  void onOrderClosed() {
+    mOpenOrderCount.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+private:
+  std::unordered_map<Symbol, Position> mPositions;
+  std::atomic<std::uint32_t> mOpenOrderCount{0};
+};
+
+} // namespace Core
+
+#endif
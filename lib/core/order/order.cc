@@ -9,6 +9,41 @@ std::string orderCancelReason2Str(OrderCancelReason rsn) {
     return "SELF TRADE";
   case OrderCancelReason::NO_ORDER_TO_MATCH_MKT_ORDER:
     return "NO ORDER TO MATCH THE MKT ORDER";
+  case OrderCancelReason::UNFILLED_IOC_ORDER:
+    return "UNFILLED QUANTITY OF THE IOC ORDER";
+  case OrderCancelReason::UNFILLABLE_FOK_ORDER:
+    return "NOT ENOUGH QUANTITY TO FILL THE FOK ORDER";
+  case OrderCancelReason::EXPIRED:
+    return "EXPIRED";
+  case OrderCancelReason::MASS_CANCEL:
+    return "MASS CANCEL";
+  default:
+    return "NONE";
+  }
+}
+
+std::string orderRejectReason2Str(OrderRejectReason rsn) {
+  switch (rsn) {
+  case OrderRejectReason::INVALID_PRICE_OR_QUANTITY:
+    return "INVALID PRICE OR QUANTITY";
+  case OrderRejectReason::MAX_ORDER_QUANTITY:
+    return "MAX ORDER QUANTITY EXCEEDED";
+  case OrderRejectReason::MAX_NOTIONAL:
+    return "MAX NOTIONAL EXCEEDED";
+  case OrderRejectReason::PRICE_COLLAR:
+    return "PRICE OUTSIDE COLLAR";
+  case OrderRejectReason::MAX_OPEN_ORDERS:
+    return "MAX OPEN ORDERS EXCEEDED";
+  case OrderRejectReason::MAX_NET_POSITION:
+    return "MAX NET POSITION EXCEEDED";
+  case OrderRejectReason::CALL_PHASE:
+    return "NOT ALLOWED IN CALL PHASE";
+  case OrderRejectReason::TICK_OR_LOT_SIZE:
+    return "NOT A MULTIPLE OF TICK OR LOT SIZE";
+  case OrderRejectReason::PRICE_BAND:
+    return "PRICE OUTSIDE BAND";
+  case OrderRejectReason::UNKNOWN_SYMBOL:
+    return "UNKNOWN SYMBOL";
   default:
     return "NONE";
   }
@@ -18,6 +53,14 @@ std::string orderStyle2Str(OrderStyle style) {
   switch (style) {
   case OrderStyle::MKT_ORDER:
     return "MKT_ORDER";
+  case OrderStyle::IOC_ORDER:
+    return "IOC ORDER";
+  case OrderStyle::FOK_ORDER:
+    return "FOK ORDER";
+  case OrderStyle::STOP_ORDER:
+    return "STOP ORDER";
+  case OrderStyle::STOP_LIMIT_ORDER:
+    return "STOP LIMIT ORDER";
   default:
     return "LIMIT ORDER";
   }
@@ -1,28 +1,77 @@
 #ifndef COMMON_ORDER
 #define COMMON_ORDER
+#include <algorithm>
 #include <types.h>
 
 using namespace Common;
 
 namespace Core {
 
+/**
+ * @brief
+ * IOC_ORDER: immediate-or-cancel, a limit order whose unfilled quantity is
+ * cancelled instead of resting in the order book
+ * FOK_ORDER: fill-or-kill, a limit order which is either fully filled or
+ * cancelled without touching the order book
+ * STOP_ORDER: a market order released when the last trade price reaches the
+ * trigger price
+ * STOP_LIMIT_ORDER: a limit order released when the last trade price reaches
+ * the trigger price
+ */
 enum class OrderStyle {
   MKT_ORDER,
   LIMIT_ORDER,
+  IOC_ORDER,
+  FOK_ORDER,
+  STOP_ORDER,
+  STOP_LIMIT_ORDER,
 };
 
+constexpr bool isStopOrder(OrderStyle style) {
+  return style == OrderStyle::STOP_ORDER ||
+         style == OrderStyle::STOP_LIMIT_ORDER;
+}
+
 enum class OrderCancelReason {
   CANCEL_REQUEST,
   SELF_TRADE,
   NO_ORDER_TO_MATCH_MKT_ORDER,
+  UNFILLED_IOC_ORDER,
+  UNFILLABLE_FOK_ORDER,
+  EXPIRED,
+  MASS_CANCEL,
   NONE,
 };
 
 std::string orderCancelReason2Str(OrderCancelReason rsn);
 
+enum class OrderRejectReason {
+  INVALID_PRICE_OR_QUANTITY,
+  MAX_ORDER_QUANTITY,
+  MAX_NOTIONAL,
+  PRICE_COLLAR,
+  MAX_OPEN_ORDERS,
+  MAX_NET_POSITION,
+  CALL_PHASE,
+  TICK_OR_LOT_SIZE,
+  PRICE_BAND,
+  UNKNOWN_SYMBOL,
+  NONE,
+};
+
+std::string orderRejectReason2Str(OrderRejectReason rsn);
+
 std::string orderStyle2Str(OrderStyle style);
 
-enum class OrderStatus { OPEN, FILLED, CANCEL, CANCEL_REJECT };
+enum class OrderStatus {
+  OPEN,
+  FILLED,
+  CANCEL,
+  CANCEL_REJECT,
+  AMEND,
+  AMEND_REJECT,
+  TRIGGER
+};
 
 enum class Side { BUY, SELL };
 
@@ -32,6 +81,19 @@ struct OrderCancelRequest {
   TraderId mTraderId;
 };
 
+/**
+ * @brief
+ * Replace the price and the remaining quantity of a resting order, an iceberg
+ * order keeps its display quantity and is split again around it
+ */
+struct OrderAmendRequest {
+  OrderId mOrderId;
+  Symbol mSymbol;
+  TraderId mTraderId;
+  Price mPrice;
+  Quantity mQuantity;
+};
+
 template <Side side> class Order;
 
 template <Side side>
@@ -59,6 +121,8 @@ public:
   Order<side> &operator=(Order<side> &&other) = default;
 
   const TraderId &getTraderId() const { return mTraderId; }
+  TraderKey getTraderKey() const { return mTraderKey; }
+  void setTraderKey(TraderKey traderKey) { mTraderKey = traderKey; }
   Side getSide() const { return mSide; }
   OrderStyle getOrderStyle() const { return mStyle; }
 
@@ -67,6 +131,30 @@ public:
   Price getPrice() const { return mPrice; }
   Quantity getQuantity() const { return mQuantity; }
   void setQuantity(Quantity quantity) { mQuantity = quantity; }
+
+  /**
+   * @brief
+   * An iceberg order only shows its display quantity in the order book, the
+   * rest of it is the hidden quantity. The display quantity of a normal order
+   * is 0.
+   */
+  Quantity getDisplayQuantity() const { return mDisplayQuantity; }
+  void setDisplayQuantity(Quantity quantity) { mDisplayQuantity = quantity; }
+  Quantity getHiddenQuantity() const { return mHiddenQuantity; }
+  void setHiddenQuantity(Quantity quantity) { mHiddenQuantity = quantity; }
+  Quantity getTotalQuantity() const { return mQuantity + mHiddenQuantity; }
+
+  /**
+   * @brief
+   * Show at most the display quantity of an iceberg order and hide the rest
+   */
+  void splitDisplay() {
+    if (mDisplayQuantity) {
+      auto total = getTotalQuantity();
+      mQuantity = std::min(mDisplayQuantity, total);
+      mHiddenQuantity = total - mQuantity;
+    }
+  }
   void setPrice(Price price) { mPrice = price; }
 
   friend bool operator==<side>(const Order<side> &a, const Order<side> &b);
@@ -77,10 +165,13 @@ private:
   Side mSide;
   OrderStyle mStyle;
   TraderId mTraderId;
+  TraderKey mTraderKey = 0;
   OrderId mOrderId;
   Symbol mSymbol;
   Price mPrice;
   Quantity mQuantity;
+  Quantity mDisplayQuantity = 0;
+  Quantity mHiddenQuantity = 0;
 };
 
 } // namespace Core
@@ -0,0 +1,34 @@
+#ifndef CORE_ALLOCATION
+#define CORE_ALLOCATION
+#include <types.h>
+
+using namespace Common;
+
+namespace Core {
+
+/**
+ * @brief
+ * How an incoming order is shared among the resting orders of a price level
+ * it does not fully consume.
+ * FIFO: in time priority
+ * PRO_RATA: in proportion to the displayed quantity of each resting order,
+ * the allocations below the minimum allocation are dropped and the rounding
+ * residual goes in time priority
+ * LEAD_MARKET_MAKER: the lead market maker takes its share of the incoming
+ * quantity first, the rest goes in time priority
+ */
+enum class AllocationPolicy { FIFO, PRO_RATA, LEAD_MARKET_MAKER };
+
+struct AllocationConfig {
+  AllocationPolicy policy = AllocationPolicy::FIFO;
+  Quantity minAllocation = 1;
+  TraderId leadMarketMaker;
+  // the trader key of the lead market maker, set by the engine, the traders
+  // of its STP group share it
+  TraderKey leadMarketMakerKey = 0;
+  // the share of the lead market maker in percent of the incoming quantity
+  unsigned leadMarketMakerShare = 0;
+};
+
+} // namespace Core
+#endif
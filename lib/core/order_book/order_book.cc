@@ -1,13 +1,62 @@
 #include "order_book.h"
 #include <iostream>
+#include <utility>
 
 namespace Core {
+OrderBook::OrderBook(OrderBook &&other)
+    : mBidSide(std::move(other.mBidSide)), mAskSide(std::move(other.mAskSide)),
+      mBidIndex(std::move(other.mBidIndex)),
+      mAskIndex(std::move(other.mAskIndex)),
+      mBidTraderIndex(std::move(other.mBidTraderIndex)),
+      mAskTraderIndex(std::move(other.mAskTraderIndex)),
+      mBuyStops(std::move(other.mBuyStops)),
+      mSellStops(std::move(other.mSellStops)),
+      mLastTradePrice(other.mLastTradePrice),
+      mTradingPhase(other.mTradingPhase),
+      mAllocation(std::move(other.mAllocation)), mSymbolId(other.mSymbolId) {
+  rebindLevels();
+}
+
+OrderBook &OrderBook::operator=(OrderBook &&other) {
+  mBidSide = std::move(other.mBidSide);
+  mAskSide = std::move(other.mAskSide);
+  mBidIndex = std::move(other.mBidIndex);
+  mAskIndex = std::move(other.mAskIndex);
+  mBidTraderIndex = std::move(other.mBidTraderIndex);
+  mAskTraderIndex = std::move(other.mAskTraderIndex);
+  mBuyStops = std::move(other.mBuyStops);
+  mSellStops = std::move(other.mSellStops);
+  mLastTradePrice = other.mLastTradePrice;
+  mTradingPhase = other.mTradingPhase;
+  mAllocation = std::move(other.mAllocation);
+  mSymbolId = other.mSymbolId;
+  rebindLevels();
+  return *this;
+}
+
+void OrderBook::rebindLevels() {
+  for (auto &[price, orderQueue] : mBidSide) {
+    orderQueue.rebind(&mBidIndex, &mBidTraderIndex);
+  }
+  for (auto &[price, orderQueue] : mAskSide) {
+    orderQueue.rebind(&mAskIndex, &mAskTraderIndex);
+  }
+}
+
 OrderBook::BidSideIterator
 OrderBook::erase(const OrderBook::BidSideIterator &it) {
+  for (auto &order : it->second) {
+    mBidIndex.erase(order.getOrderId());
+    eraseTraderOrder(mBidTraderIndex, order.getTraderId(), order.getOrderId());
+  }
   return mBidSide.erase(it);
 }
 OrderBook::AskSideIterator
 OrderBook::erase(const OrderBook::AskSideIterator &it) {
+  for (auto &order : it->second) {
+    mAskIndex.erase(order.getOrderId());
+    eraseTraderOrder(mAskTraderIndex, order.getTraderId(), order.getOrderId());
+  }
   return mAskSide.erase(it);
 }
 } // namespace Core
@@ -1,127 +1,200 @@
 #ifndef CORE_ORDER_BOOK
 #define CORE_ORDER_BOOK
-#include <deque>
+#include <algorithm>
+#include <iterator>
+#include <list>
 #include <map>
+#include <optional>
 #include <order/order.h>
+#include <order_book/allocation.h>
+#include <order_book/stop_book.h>
 #include <types.h>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 using namespace Common;
 
 namespace Core {
+template <Side side> class OrderQueue;
+
+/**
+ * @brief
+ * Where a resting order lives: the price level and the position of the order
+ * in the level. Both stay valid until the order leaves the book, so the order
+ * can be reached in O(1) from its id.
+ */
+template <Side side> struct OrderLocator {
+  OrderQueue<side> *mQueue;
+  typename std::list<Order<side>>::iterator mIt;
+};
+
+template <Side side>
+using OrderIndex = std::unordered_map<OrderId, OrderLocator<side>>;
+
+/**
+ * @brief
+ * The ids of the resting orders of each trader on one side of the book
+ */
+using TraderOrderIndex =
+    std::unordered_map<TraderId, std::unordered_set<OrderId>>;
+
+inline void eraseTraderOrder(TraderOrderIndex &index, const TraderId &traderId,
+                             OrderId orderId) {
+  auto it = index.find(traderId);
+  if (it != index.end()) {
+    it->second.erase(orderId);
+    if (it->second.empty()) {
+      index.erase(it);
+    }
+  }
+}
+
 template <Side side> class OrderQueue {
 public:
+  using iterator = typename std::list<Order<side>>::iterator;
+
   OrderQueue() = default;
-  OrderQueue(const OrderQueue &other) = default;
-  OrderQueue<side> &operator=(const OrderQueue<side> &) = default;
-  OrderQueue(OrderQueue<side> &&other) = default;
-  OrderQueue<side> &operator=(OrderQueue<side> &&other) = default;
+  explicit OrderQueue(OrderIndex<side> *index,
+                      TraderOrderIndex *traderIndex = nullptr)
+      : mIndex(index), mTraderIndex(traderIndex) {}
+  // the index refers to the address of the queue
+  OrderQueue(const OrderQueue &other) = delete;
+  OrderQueue<side> &operator=(const OrderQueue<side> &) = delete;
+  OrderQueue(OrderQueue<side> &&other) = delete;
+  OrderQueue<side> &operator=(OrderQueue<side> &&other) = delete;
 
   auto &front() { return mQueue.front(); }
 
-  void push(Order<side> &&order) { mQueue.emplace(std::move(order)); }
+  auto begin() { return mQueue.begin(); }
+  auto end() { return mQueue.end(); }
+
+  void push(Order<side> &&order) { emplace(std::move(order)); }
 
   void push(const Order<side> &order) {
     mQueue.push_back(order);
-    mTotalQuantity += order.getQuantity();
-    mTraderIds.insert(order.getTraderId());
+    onPushed();
   }
 
   void emplace(Order<side> &&order) {
     mQueue.emplace_back(std::forward<Order<side>>(order));
-    mTotalQuantity += order.getQuantity();
-    mTraderIds.insert(order.getTraderId());
+    onPushed();
   }
 
-  void pop() {
-    auto &target = mQueue.front();
-    mTotalQuantity -= target.getQuantity();
-    mTraderIds.erase(target.getTraderId());
-
-    mQueue.pop_front();
-  };
-
-  void update(const Order<side> &order) {
-    // preconditon: there is a order with the target trader id in the queue
-    // the trader will lost its time priority when they update the order at the
-    // same price level
-    erase(order.getTraderId());
-    push(order);
-  }
-  bool erase(TraderId id) {
-    bool isFound = false;
-    auto it = mQueue.begin();
+  void pop() { erase(mQueue.begin()); };
 
-    for (; it != mQueue.end() && !isFound; it++) {
-      if (it->getTraderId() == id) {
-        isFound = true;
-      }
+  void erase(iterator it) {
+    mTotalQuantity -= it->getQuantity();
+    mHiddenQuantity -= it->getHiddenQuantity();
+    if (mIndex) {
+      mIndex->erase(it->getOrderId());
     }
-
-    if (isFound) {
-      mQueue.erase(it);
-      mTraderIds.erase(id);
-      mTotalQuantity -= it->getQuantity();
+    if (mTraderIndex) {
+      eraseTraderOrder(*mTraderIndex, it->getTraderId(), it->getOrderId());
     }
+    mQueue.erase(it);
+  }
 
-    return isFound;
+  /**
+   * @brief
+   * Change the quantity of the order in place, the order keeps its time
+   * priority
+   */
+  void setQuantity(iterator it, Quantity quantity) {
+    mTotalQuantity = mTotalQuantity - it->getQuantity() + quantity;
+    it->setQuantity(quantity);
   }
 
-  bool erase(OrderId orderId) {
-    bool isFound = false;
-    auto it = mQueue.begin();
+  /**
+   * @brief
+   * Reduce the displayed and hidden quantity of the order to the total
+   * quantity in place, the order keeps its time priority.
+   * precondition: quantity <= the total quantity of the order
+   */
+  void setTotalQuantity(iterator it, Quantity quantity) {
+    auto displayed = std::min(it->getQuantity(), quantity);
+    mHiddenQuantity =
+        mHiddenQuantity - it->getHiddenQuantity() + (quantity - displayed);
+    it->setHiddenQuantity(quantity - displayed);
+    setQuantity(it, displayed);
+  }
 
-    for (; it != mQueue.end() && !isFound; it++) {
-      if (it->getOrderId() == orderId) {
-        isFound = true;
-      }
-    }
+  /**
+   * @brief
+   * Show the next slice of the iceberg order whose displayed quantity is
+   * filled and move it to the back of the level. The list node is spliced,
+   * so the order keeps its locator and nothing is allocated.
+   */
+  void replenish(iterator it) {
+    mHiddenQuantity -= it->getHiddenQuantity();
+    mTotalQuantity -= it->getQuantity();
+    it->splitDisplay();
+    mHiddenQuantity += it->getHiddenQuantity();
+    mTotalQuantity += it->getQuantity();
+    mQueue.splice(mQueue.end(), mQueue, it);
+  }
 
-    if (isFound) {
-      mTraderIds.erase(it->getTraderId());
-      mQueue.erase(it);
-      mTotalQuantity -= it->getQuantity();
-    }
+  bool empty() const { return mQueue.empty(); }
 
-    return isFound;
+  /**
+   * @brief
+   * Point the queue to the indexes of the order book it has moved with
+   */
+  void rebind(OrderIndex<side> *index, TraderOrderIndex *traderIndex) {
+    mIndex = index;
+    mTraderIndex = traderIndex;
   }
 
-  bool erase(OrderId orderId, TraderId traderId) {
-    bool isFound = false;
-    auto it = mQueue.begin();
-    auto res = it;
+  size_t numOfOrders() const { return mQueue.size(); }
+  // the displayed quantity of the level
+  Quantity totalQuantity() const { return mTotalQuantity; }
+  // the reserve of the iceberg orders of the level
+  Quantity hiddenQuantity() const { return mHiddenQuantity; }
 
-    for (; it != mQueue.end() && !isFound; it++) {
-      if (it->getOrderId() == orderId && it->getTraderId() == traderId) {
-        isFound = true;
-        res = it;
-      }
+private:
+  void onPushed() {
+    auto &order = mQueue.back();
+    order.splitDisplay();
+    mTotalQuantity += order.getQuantity();
+    mHiddenQuantity += order.getHiddenQuantity();
+    if (mIndex) {
+      (*mIndex)[order.getOrderId()] =
+          OrderLocator<side>{this, std::prev(mQueue.end())};
     }
-
-    if (isFound) {
-      mTotalQuantity -= res->getQuantity();
-      mTraderIds.erase(res->getTraderId());
-      mQueue.erase(res);
+    if (mTraderIndex) {
+      (*mTraderIndex)[order.getTraderId()].insert(order.getOrderId());
     }
-
-    return isFound;
   }
 
-  bool contains(TraderId id) { return mTraderIds.find(id) != mTraderIds.end(); }
-  bool empty() const { return mQueue.empty(); }
+  std::list<Order<side>> mQueue;
+  Quantity mTotalQuantity = 0;
+  Quantity mHiddenQuantity = 0;
+  OrderIndex<side> *mIndex = nullptr;
+  TraderOrderIndex *mTraderIndex = nullptr;
+};
 
-  size_t numOfOrders() const { return mQueue.size(); }
-  std::int32_t totalQuantity() const { return mTotalQuantity; }
+/**
+ * @brief
+ * In the CALL phase of an auction the orders accumulate in the book without
+ * matching until the book is uncrossed
+ */
+enum class TradingPhase { CONTINUOUS, CALL };
 
-private:
-  std::deque<Order<side>> mQueue;
-  std::unordered_set<TraderId> mTraderIds;
-  std::int32_t mTotalQuantity;
-};
 class OrderBook {
 public:
-  using BidSideIterator = std::map<Price, OrderQueue<Side::BUY>>::iterator;
-  using AskSideIterator = std::map<Price, OrderQueue<Side::SELL>>::iterator;
+  using BidSide = std::map<Price, OrderQueue<Side::BUY>, std::greater<>>;
+  using AskSide = std::map<Price, OrderQueue<Side::SELL>>;
+  using BidSideIterator = BidSide::iterator;
+  using AskSideIterator = AskSide::iterator;
+
+  OrderBook() = default;
+  // the price levels refer to the order index of the book, they are rebound
+  // to the indexes of the new book when it is moved. The nodes of the maps
+  // move with them, so the locators of the orders stay valid.
+  OrderBook(const OrderBook &other) = delete;
+  OrderBook &operator=(const OrderBook &) = delete;
+  OrderBook(OrderBook &&other);
+  OrderBook &operator=(OrderBook &&other);
 
   template <Side side> Price getBest() {
     if constexpr (side == Side::BUY) {
@@ -133,8 +206,14 @@ public:
 
   template <Side side> void clear() {
     if constexpr (side == Side::BUY) {
+      mBidIndex.clear();
+      mBidTraderIndex.clear();
+      mBuyStops.clear();
       return mBidSide.clear();
     } else {
+      mAskIndex.clear();
+      mAskTraderIndex.clear();
+      mSellStops.clear();
       return mAskSide.clear();
     }
   }
@@ -144,20 +223,9 @@ public:
     if (order.getOrderStyle() == OrderStyle::MKT_ORDER)
       return;
 
-    if constexpr (side == Side::BUY) {
-      if (mBidSide[order.getPrice()].contains(order.getTraderId())) {
-        mBidSide[order.getPrice()].update(order);
-      } else {
-        mBidSide[order.getPrice()].push(order);
-      }
-
-    } else {
-      if (mAskSide[order.getPrice()].contains(order.getTraderId())) {
-        mAskSide[order.getPrice()].update(order);
-      } else {
-        mAskSide[order.getPrice()].push(order);
-      }
-    }
+    // a trader can have several independent orders at the same price, each
+    // of them is keyed by its order id
+    getLevel<side>(order.getPrice()).push(order);
   }
 
   template <Side side> auto begin() {
@@ -176,27 +244,88 @@ public:
     }
   }
 
+  /**
+   * @brief
+   * Remove a resting order or a pending stop order
+   */
   bool removeOrder(OrderId orderId, TraderId traderId) {
-    bool isFound = false;
-
-    // Definitely it can be optimized by manipulating the reference of the order
-    // in the queue and orderId and traderId, something like a multi-index
-    // (OrderId, TraderId) to the order, but I dont have time to do it yet
-    for (auto it = mBidSide.begin(); it != mBidSide.end() && !isFound; it++) {
-      isFound = it->second.erase(orderId, traderId);
-      if (it->second.empty()) {
-        mBidSide.erase(it);
-      }
+    return removeOrder<Side::BUY>(orderId, traderId) ||
+           removeOrder<Side::SELL>(orderId, traderId) ||
+           mBuyStops.remove(orderId, traderId) ||
+           mSellStops.remove(orderId, traderId);
+  }
+
+  template <Side side> bool removeOrder(OrderId orderId, TraderId traderId) {
+    auto &index = getIndex<side>();
+    auto it = index.find(orderId);
+    if (it == index.end() || it->second.mIt->getTraderId() != traderId) {
+      return false;
     }
 
-    for (auto it = mAskSide.begin(); it != mAskSide.end() && !isFound; it++) {
-      isFound = it->second.erase(orderId, traderId);
-      if (it->second.empty()) {
-        mAskSide.erase(it);
+    auto locator = it->second;
+    auto price = locator.mIt->getPrice();
+    locator.mQueue->erase(locator.mIt);
+    if (locator.mQueue->empty()) {
+      if constexpr (side == Side::BUY) {
+        mBidSide.erase(price);
+      } else {
+        mAskSide.erase(price);
       }
     }
+    return true;
+  }
+
+  template <Side side> bool contains(OrderId orderId) {
+    return getIndex<side>().count(orderId) != 0;
+  }
+
+  /**
+   * @brief
+   * The resting order with the id, nullptr if there is no such order
+   */
+  template <Side side> const Order<side> *find(OrderId orderId) {
+    auto &index = getIndex<side>();
+    auto it = index.find(orderId);
+    return it != index.end() ? &*it->second.mIt : nullptr;
+  }
+
+  /**
+   * @brief
+   * The displayed quantity ahead of the resting order in the FIFO of its
+   * price level, it costs time proportional to the orders ahead
+   * return nullopt if there is no such order
+   */
+  template <Side side>
+  std::optional<Quantity> getQueuePosition(OrderId orderId) {
+    auto &index = getIndex<side>();
+    auto it = index.find(orderId);
+    if (it == index.end()) {
+      return std::nullopt;
+    }
 
-    return isFound;
+    Quantity ahead = 0;
+    for (auto order = it->second.mQueue->begin(); order != it->second.mIt;
+         order++) {
+      ahead += order->getQuantity();
+    }
+    return ahead;
+  }
+
+  /**
+   * @brief
+   * Reduce the total quantity of the resting order in place, the order keeps
+   * its time priority.
+   * precondition: 0 < quantity <= the current total quantity of the order
+   */
+  template <Side side> bool reduce(OrderId orderId, Quantity quantity) {
+    auto &index = getIndex<side>();
+    auto it = index.find(orderId);
+    if (it == index.end()) {
+      return false;
+    }
+
+    it->second.mQueue->setTotalQuantity(it->second.mIt, quantity);
+    return true;
   }
 
   template <Side side> auto search(Price px) {
@@ -207,6 +336,76 @@ public:
     }
   }
 
+  /**
+   * @brief
+   * Whether the levels of the side priced at or better than the limit price
+   * hold at least the quantity, the hidden quantity of the iceberg orders
+   * included. Only the cached quantities of each level are read, so it costs
+   * O(levels) and never walks the orders.
+   */
+  template <Side side> bool canFill(Price limitPrice, Quantity quantity) {
+    Quantity available = 0;
+    auto it = begin<side>();
+    auto last = search<side>(limitPrice);
+    if (last != end<side>() && last->first == limitPrice) {
+      last++;
+    }
+
+    for (; it != last && available < quantity; it++) {
+      available += it->second.totalQuantity() + it->second.hiddenQuantity();
+    }
+
+    return available >= quantity;
+  }
+
+  /**
+   * @brief
+   * canFill() for an incoming order of the trader key when the self-trade
+   * prevention is on, the orders of the key never trade with it. They are
+   * skipped if the policy cancels them (ownOrdersCancelled), otherwise the
+   * incoming order is stopped at the first of them and only the quantity
+   * ahead of it counts. The orders of the levels are walked in time priority.
+   */
+  template <Side side>
+  bool canFill(Price limitPrice, Quantity quantity, TraderKey traderKey,
+               bool ownOrdersCancelled) {
+    Quantity available = 0;
+    auto it = begin<side>();
+    auto last = search<side>(limitPrice);
+    if (last != end<side>() && last->first == limitPrice) {
+      last++;
+    }
+
+    for (; it != last && available < quantity; it++) {
+      Quantity hidden = 0;
+      for (const auto &resting : it->second) {
+        if (resting.getTraderKey() != traderKey) {
+          available += resting.getQuantity();
+          hidden += resting.getHiddenQuantity();
+        } else if (!ownOrdersCancelled) {
+          // the hidden slices are shown behind the order of the key
+          return available >= quantity;
+        }
+      }
+      available += hidden;
+    }
+
+    return available >= quantity;
+  }
+
+  /**
+   * @brief
+   * The ids of the orders of the trader resting on the side, nullptr if there
+   * is none
+   */
+  template <Side side>
+  const std::unordered_set<OrderId> *
+  findTraderOrders(const TraderId &traderId) {
+    auto &index = getTraderIndex<side>();
+    auto it = index.find(traderId);
+    return it != index.end() ? &it->second : nullptr;
+  }
+
   template <Side side> size_t getNumOfLevels() const {
     if constexpr (side == Side::BUY) {
       return mBidSide.size();
@@ -214,12 +413,124 @@ public:
       return mAskSide.size();
     }
   }
+
+  template <Side side> size_t getNumOfOrders() const {
+    if constexpr (side == Side::BUY) {
+      return mBidIndex.size();
+    } else {
+      return mAskIndex.size();
+    }
+  }
+
+  /**
+   * @brief
+   * Park a stop order until the last trade price reaches the trigger price
+   */
+  template <Side side>
+  void insertStop(Price triggerPrice, const Order<side> &order) {
+    getStops<side>().insert(triggerPrice, order);
+  }
+
+  /**
+   * @brief
+   * Move the stop orders of the side triggered by the last trade price into
+   * the vector, in trigger price then arrival order
+   */
+  template <Side side>
+  void popTriggeredStops(std::vector<Order<side>> &triggered) {
+    if (mLastTradePrice) {
+      getStops<side>().popTriggered(mLastTradePrice, triggered);
+    }
+  }
+
+  template <Side side> bool containsStop(OrderId orderId) const {
+    if constexpr (side == Side::BUY) {
+      return mBuyStops.contains(orderId);
+    } else {
+      return mSellStops.contains(orderId);
+    }
+  }
+
+  template <Side side> size_t getNumOfStops() const {
+    if constexpr (side == Side::BUY) {
+      return mBuyStops.size();
+    } else {
+      return mSellStops.size();
+    }
+  }
+
+  bool hasStops() const { return !mBuyStops.empty() || !mSellStops.empty(); }
+
+  /**
+   * @brief
+   * The price of the last trade, 0 if nothing has been traded
+   */
+  Price getLastTradePrice() const { return mLastTradePrice; }
+  void setLastTradePrice(Price price) { mLastTradePrice = price; }
+
+  SymbolId getSymbolId() const { return mSymbolId; }
+  void setSymbolId(SymbolId symbolId) { mSymbolId = symbolId; }
+
+  const AllocationConfig &getAllocation() const { return mAllocation; }
+  void setAllocation(const AllocationConfig &allocation) {
+    mAllocation = allocation;
+  }
+
+  TradingPhase getTradingPhase() const { return mTradingPhase; }
+  void setTradingPhase(TradingPhase phase) { mTradingPhase = phase; }
+
   BidSideIterator erase(const BidSideIterator &it);
   AskSideIterator erase(const AskSideIterator &it);
 
 private:
-  std::map<Price, OrderQueue<Side::BUY>, std::greater<>> mBidSide;
-  std::map<Price, OrderQueue<Side::SELL>> mAskSide;
+  void rebindLevels();
+
+  template <Side side> auto &getIndex() {
+    if constexpr (side == Side::BUY) {
+      return mBidIndex;
+    } else {
+      return mAskIndex;
+    }
+  }
+
+  template <Side side> auto &getTraderIndex() {
+    if constexpr (side == Side::BUY) {
+      return mBidTraderIndex;
+    } else {
+      return mAskTraderIndex;
+    }
+  }
+
+  template <Side side> auto &getStops() {
+    if constexpr (side == Side::BUY) {
+      return mBuyStops;
+    } else {
+      return mSellStops;
+    }
+  }
+
+  template <Side side> OrderQueue<side> &getLevel(Price price) {
+    if constexpr (side == Side::BUY) {
+      return mBidSide.try_emplace(price, &mBidIndex, &mBidTraderIndex)
+          .first->second;
+    } else {
+      return mAskSide.try_emplace(price, &mAskIndex, &mAskTraderIndex)
+          .first->second;
+    }
+  }
+
+  BidSide mBidSide;
+  AskSide mAskSide;
+  OrderIndex<Side::BUY> mBidIndex;
+  OrderIndex<Side::SELL> mAskIndex;
+  TraderOrderIndex mBidTraderIndex;
+  TraderOrderIndex mAskTraderIndex;
+  StopBook<Side::BUY> mBuyStops;
+  StopBook<Side::SELL> mSellStops;
+  Price mLastTradePrice = 0;
+  TradingPhase mTradingPhase = TradingPhase::CONTINUOUS;
+  AllocationConfig mAllocation;
+  SymbolId mSymbolId = 0;
 };
 
 } // namespace Core
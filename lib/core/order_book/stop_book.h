@@ -0,0 +1,90 @@
+#ifndef CORE_STOP_BOOK
+#define CORE_STOP_BOOK
+#include <functional>
+#include <map>
+#include <order/order.h>
+#include <type_traits>
+#include <types.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace Common;
+
+namespace Core {
+
+/**
+ * @brief
+ * The stop and stop-limit orders of one side waiting for their trigger price,
+ * ordered by trigger price and then by arrival. A BUY stop is triggered when
+ * the last trade price rises to its trigger price, a SELL stop when it falls
+ * to it, so the stops closest to the market are always at the front and the
+ * k triggered stops are popped in O(k log n).
+ */
+template <Side side> class StopBook {
+public:
+  using Triggers =
+      std::conditional_t<side == Side::BUY, std::multimap<Price, Order<side>>,
+                         std::multimap<Price, Order<side>, std::greater<>>>;
+
+  StopBook() = default;
+  StopBook(const StopBook &other) = default;
+  StopBook<side> &operator=(const StopBook<side> &) = default;
+  StopBook(StopBook<side> &&other) = default;
+  StopBook<side> &operator=(StopBook<side> &&other) = default;
+
+  void insert(Price triggerPrice, const Order<side> &order) {
+    // the equal trigger prices keep their arrival order
+    auto it = mTriggers.emplace(triggerPrice, order);
+    mIndex[order.getOrderId()] = it;
+  }
+
+  bool remove(OrderId orderId, const TraderId &traderId) {
+    auto it = mIndex.find(orderId);
+    if (it == mIndex.end() || it->second->second.getTraderId() != traderId) {
+      return false;
+    }
+
+    mTriggers.erase(it->second);
+    mIndex.erase(it);
+    return true;
+  }
+
+  bool contains(OrderId orderId) const { return mIndex.count(orderId) != 0; }
+
+  /**
+   * @brief
+   * Move the stops triggered by the last trade price to the back of the
+   * vector, in trigger price then arrival order
+   */
+  void popTriggered(Price lastTradePrice, std::vector<Order<side>> &triggered) {
+    auto it = mTriggers.begin();
+    while (it != mTriggers.end() && isTriggered(it->first, lastTradePrice)) {
+      mIndex.erase(it->second.getOrderId());
+      triggered.emplace_back(std::move(it->second));
+      it = mTriggers.erase(it);
+    }
+  }
+
+  bool empty() const { return mTriggers.empty(); }
+  size_t size() const { return mTriggers.size(); }
+
+  void clear() {
+    mTriggers.clear();
+    mIndex.clear();
+  }
+
+private:
+  static bool isTriggered(Price triggerPrice, Price lastTradePrice) {
+    if constexpr (side == Side::BUY) {
+      return lastTradePrice >= triggerPrice;
+    } else {
+      return lastTradePrice <= triggerPrice;
+    }
+  }
+
+  Triggers mTriggers;
+  std::unordered_map<OrderId, typename Triggers::iterator> mIndex;
+};
+
+} // namespace Core
+#endif
@@ -0,0 +1,99 @@
+#include "timer_wheel.h"
+#include <algorithm>
+#include <utility>
+
+namespace Core {
+void TimerWheel::schedule(Timestamp expiry, std::uint64_t id) {
+  place(Timer{std::max(expiry, mNow), id});
+  mSize++;
+}
+
+void TimerWheel::advance(Timestamp now, std::vector<Timer> &expired) {
+  while (mNow <= now) {
+    if (!mOverflow.empty() && (mNow & lowBits(kNumOfLevels)) == 0) {
+      cascadeOverflow();
+    }
+
+    // the higher levels first, their timers may land in the lower slots due
+    for (unsigned level = kNumOfLevels - 1; level > 0; level--) {
+      if ((mNow & lowBits(level)) == 0) {
+        cascade(level);
+      }
+    }
+
+    auto slot = slotOf(mNow, 0);
+    auto &timers = mSlots[0][slot];
+    if (!timers.empty()) {
+      mSize -= timers.size();
+      expired.insert(expired.end(), timers.begin(), timers.end());
+      timers.clear();
+      mOccupied[0] &= ~(std::uint64_t(1) << slot);
+    }
+
+    if (mNow == kNever) {
+      return;
+    }
+    mNow = std::min(nextEvent(mNow + 1), now == kNever ? now : now + 1);
+  }
+}
+
+void TimerWheel::place(const Timer &timer) {
+  for (unsigned level = 0; level < kNumOfLevels; level++) {
+    auto span = shift(level + 1);
+    if ((timer.mExpiry >> span) == (mNow >> span)) {
+      auto slot = slotOf(timer.mExpiry, level);
+      mSlots[level][slot].push_back(timer);
+      mOccupied[level] |= std::uint64_t(1) << slot;
+      return;
+    }
+  }
+  mOverflow.push_back(timer);
+}
+
+void TimerWheel::cascade(unsigned level) {
+  auto slot = slotOf(mNow, level);
+  if (!(mOccupied[level] & (std::uint64_t(1) << slot))) {
+    return;
+  }
+
+  // the slot is swapped out first, the timers can not be placed back into it
+  mScratch.clear();
+  std::swap(mScratch, mSlots[level][slot]);
+  mOccupied[level] &= ~(std::uint64_t(1) << slot);
+  for (const auto &timer : mScratch) {
+    place(timer);
+  }
+}
+
+void TimerWheel::cascadeOverflow() {
+  mScratch.clear();
+  std::swap(mScratch, mOverflow);
+  for (const auto &timer : mScratch) {
+    place(timer);
+  }
+}
+
+Timestamp TimerWheel::nextEvent(Timestamp time) const {
+  Timestamp next = kNever;
+  for (unsigned level = 0; level < kNumOfLevels; level++) {
+    // only the slots from the current one on are used in the level
+    auto pending = mOccupied[level] &
+                   (~std::uint64_t(0) << slotOf(time, level));
+    if (pending) {
+      auto base = (time >> shift(level + 1)) << shift(level + 1);
+      auto slot = static_cast<Timestamp>(__builtin_ctzll(pending));
+      next = std::min(next, std::max(time, base + (slot << shift(level))));
+    }
+  }
+
+  if (!mOverflow.empty()) {
+    auto span = shift(kNumOfLevels);
+    auto boundary = (time & lowBits(kNumOfLevels))
+                        ? ((time >> span) + 1) << span
+                        : time;
+    next = std::min(next, boundary);
+  }
+
+  return next;
+}
+} // namespace Core
@@ -0,0 +1,97 @@
+#ifndef CORE_TIMER_WHEEL
+#define CORE_TIMER_WHEEL
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <types.h>
+#include <vector>
+
+using namespace Common;
+
+namespace Core {
+
+/**
+ * @brief
+ * Hierarchical timer wheel, every level has 64 slots and each slot of a level
+ * spans the whole lower level. A timer is kept in the lowest level whose span
+ * contains both its expiry and the current time, and moves down one level each
+ * time the current time enters its slot, so every timer is touched at most
+ * once per level: scheduling and expiring are amortized O(1).
+ *
+ * A 64-bit occupancy mask per level lets advance() jump straight to the next
+ * non-empty slot instead of ticking through the idle time. The timers further
+ * than 2^36 ticks away wait in an overflow list.
+ *
+ * A timer cannot be cancelled, the owner ignores the ids which are no longer
+ * relevant when they expire.
+ */
+class TimerWheel {
+public:
+  struct Timer {
+    Timestamp mExpiry;
+    std::uint64_t mId;
+  };
+
+  TimerWheel() = default;
+  explicit TimerWheel(Timestamp now) : mNow(now) {}
+  TimerWheel(const TimerWheel &other) = default;
+  TimerWheel &operator=(const TimerWheel &) = default;
+  TimerWheel(TimerWheel &&other) = default;
+  TimerWheel &operator=(TimerWheel &&other) = default;
+
+  /**
+   * @brief
+   * Schedule the id to expire at the expiry, a timer already due expires on
+   * the next call of advance()
+   */
+  void schedule(Timestamp expiry, std::uint64_t id);
+
+  /**
+   * @brief
+   * Move the current time to now and append the timers whose expiry is not
+   * later than now to the vector, in expiry order
+   */
+  void advance(Timestamp now, std::vector<Timer> &expired);
+
+  /**
+   * @brief
+   * The first tick which has not been processed yet
+   */
+  Timestamp getTime() const { return mNow; }
+
+  size_t size() const { return mSize; }
+  bool empty() const { return mSize == 0; }
+
+private:
+  static constexpr unsigned kSlotBits = 6;
+  static constexpr unsigned kNumOfSlots = 1u << kSlotBits;
+  static constexpr unsigned kNumOfLevels = 6;
+  static constexpr Timestamp kNever = std::numeric_limits<Timestamp>::max();
+
+  static constexpr unsigned shift(unsigned level) { return level * kSlotBits; }
+
+  // the ticks below the span of a slot of the level
+  static constexpr Timestamp lowBits(unsigned level) {
+    return (Timestamp(1) << shift(level)) - 1;
+  }
+
+  static unsigned slotOf(Timestamp time, unsigned level) {
+    return (time >> shift(level)) & (kNumOfSlots - 1);
+  }
+
+  void place(const Timer &timer);
+  void cascade(unsigned level);
+  void cascadeOverflow();
+  Timestamp nextEvent(Timestamp time) const;
+
+  std::array<std::array<std::vector<Timer>, kNumOfSlots>, kNumOfLevels>
+      mSlots;
+  std::array<std::uint64_t, kNumOfLevels> mOccupied{};
+  std::vector<Timer> mOverflow;
+  std::vector<Timer> mScratch;
+  Timestamp mNow = 0;
+  size_t mSize = 0;
+};
+
+} // namespace Core
+#endif
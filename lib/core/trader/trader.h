@@ -2,7 +2,6 @@
 #define COMMON_TRADER
 #include "types.h"
 #include <iostream>
-#include <list>
 #include <order/order.h>
 #include <string>
 #include <unordered_map>
@@ -21,9 +20,24 @@ public:
   Trader(Trader &&other) = default;
   Trader &operator=(Trader &&other) = default;
 
+  /**
+   * @brief
+   * Write the notifications to the stream, std::cout by default. nullptr
+   * turns the log off, e.g. in the backtests where the formatting and the
+   * writes to the shared stdout cost more than the matching. The stream is
+   * not owned.
+   */
+  void setLog(std::ostream *log) { mLog = log; }
+
   void notifyAllFilled(OrderId orderId) {
-    std::cout << mTraderId << " orderid:" << orderId << " "
-              << "is successfully filled\n";
+    // the order may have rested before it was filled
+    if (mOpenBuyOrders.erase(orderId) == 0) {
+      mOpenSellOrders.erase(orderId);
+    }
+    if (mLog) {
+      *mLog << mTraderId << " orderid:" << orderId << " "
+            << "is successfully filled\n";
+    }
   }
 
   template <Side side, OrderStyle style>
@@ -31,16 +45,20 @@ public:
                   Quantity fillQuantity) {
 
     if constexpr (side == Side::BUY) {
-      std::cout << "Fill! " << mTraderId << " "
-                << "ORDER_TYPE: " << orderStyle2Str(style) << " BUY "
-                << fillQuantity << " " << symbol << " at " << fillPrice << '\n';
+      if (mLog) {
+        *mLog << "Fill! " << mTraderId << " "
+              << "ORDER_TYPE: " << orderStyle2Str(style) << " BUY "
+              << fillQuantity << " " << symbol << " at " << fillPrice << '\n';
+      }
 
       mFilledBuyOrders.emplace_back(Order<side>(
           style, mTraderId, orderId, symbol, fillPrice, fillQuantity));
     } else {
-      std::cout << "Fill! " << mTraderId << " "
-                << "ORDER_TYPE: " << orderStyle2Str(style) << " SELL "
-                << fillQuantity << " " << symbol << " at " << fillPrice << '\n';
+      if (mLog) {
+        *mLog << "Fill! " << mTraderId << " "
+              << "ORDER_TYPE: " << orderStyle2Str(style) << " SELL "
+              << fillQuantity << " " << symbol << " at " << fillPrice << '\n';
+      }
 
       mFilledSellOrders.emplace_back(Order<side>(
           style, mTraderId, orderId, symbol, fillPrice, fillQuantity));
@@ -49,33 +67,27 @@ public:
 
   void notifyCancel(OrderId orderId,
                     OrderCancelReason rsn = OrderCancelReason::CANCEL_REQUEST) {
-    // precondition: the order must be in the open order lists
-    auto it = mOpenBuyOrders.begin();
-    auto end = mOpenBuyOrders.end();
-    while (it != end && it->getOrderId() != orderId) {
-      it++;
-    }
-
-    if (it != end) {
-      std::cout << "Order Cancel! " << mTraderId << " CANCEL "
-                << "ORDER_TYPE: " << orderStyle2Str(it->getOrderStyle())
-                << " BUY " << it->getQuantity() << " " << it->getSymbol()
-                << " at " << it->getPrice()
-                << " reason: " << orderCancelReason2Str(rsn) << '\n';
+    // precondition: the order must be in the open orders
+    if (auto it = mOpenBuyOrders.find(orderId); it != mOpenBuyOrders.end()) {
+      const auto &order = it->second;
+      if (mLog) {
+        *mLog << "Order Cancel! " << mTraderId << " CANCEL "
+              << "ORDER_TYPE: " << orderStyle2Str(order.getOrderStyle())
+              << " BUY " << order.getQuantity() << " " << order.getSymbol()
+              << " at " << order.getPrice()
+              << " reason: " << orderCancelReason2Str(rsn) << '\n';
+      }
       mOpenBuyOrders.erase(it);
-    } else {
-      auto it = mOpenSellOrders.begin();
-      auto end = mOpenSellOrders.end();
-      while (it != end && it->getOrderId() != orderId) {
-        it++;
+    } else if (auto it = mOpenSellOrders.find(orderId);
+               it != mOpenSellOrders.end()) {
+      const auto &order = it->second;
+      if (mLog) {
+        *mLog << "Order Cancel! " << mTraderId << " CANCEL "
+              << "ORDER_TYPE: " << orderStyle2Str(order.getOrderStyle())
+              << " SELL " << order.getQuantity() << " " << order.getSymbol()
+              << " at " << order.getPrice()
+              << " reason: " << orderCancelReason2Str(rsn) << '\n';
       }
-
-      std::cout << "Order Cancel! " << mTraderId << " CANCEL "
-                << "ORDER_TYPE: " << orderStyle2Str(it->getOrderStyle())
-                << " SELL " << it->getQuantity() << " " << it->getSymbol()
-                << " at " << it->getPrice()
-                << " reason: " << orderCancelReason2Str(rsn) << '\n';
-
       mOpenSellOrders.erase(it);
     }
   }
@@ -87,46 +99,88 @@ public:
 
     if constexpr (side == Side::BUY) {
 
-      std::cout << "Order Cancel! " << mTraderId << " CANCEL "
-                << "ORDER_TYPE: " << orderStyle2Str(style) << " BUY "
-                << quantity << " " << symbol << " at " << price
-                << " reason: " << orderCancelReason2Str(rsn) << '\n';
+      if (mLog) {
+        *mLog << "Order Cancel! " << mTraderId << " CANCEL "
+              << "ORDER_TYPE: " << orderStyle2Str(style) << " BUY "
+              << quantity << " " << symbol << " at " << price
+              << " reason: " << orderCancelReason2Str(rsn) << '\n';
+      }
 
       if constexpr (style == OrderStyle::LIMIT_ORDER) {
-        auto it = mOpenBuyOrders.begin();
-        auto end = mOpenBuyOrders.end();
-        while (it != end && it->getOrderId() != orderId) {
-          it++;
-        }
-
-        if (it != end) {
-
-          mOpenBuyOrders.erase(it);
-        }
+        mOpenBuyOrders.erase(orderId);
       }
 
     } else {
-      std::cout << "Order Cancel! " << mTraderId << " CANCEL "
-                << "SELL " << quantity << " " << symbol << " at " << price
-                << " reason: " << orderCancelReason2Str(rsn) << '\n';
+      if (mLog) {
+        *mLog << "Order Cancel! " << mTraderId << " CANCEL "
+              << "SELL " << quantity << " " << symbol << " at " << price
+              << " reason: " << orderCancelReason2Str(rsn) << '\n';
+      }
       if constexpr (style == OrderStyle::LIMIT_ORDER) {
-        auto it = mOpenSellOrders.begin();
-        auto end = mOpenSellOrders.end();
-        while (it != end && it->getOrderId() != orderId) {
-          it++;
-        }
-
-        if (it != end) {
-          mOpenSellOrders.erase(it);
-        }
+        mOpenSellOrders.erase(orderId);
       }
     }
   }
 
   void notifyCancelReject(OrderId orderId) {
 
-    std::cout << "Order Cancel Reject! " << mTraderId << " CANCEL "
-              << "order: " << orderId << " failed" << '\n';
+    if (mLog) {
+      *mLog << "Order Cancel Reject! " << mTraderId << " CANCEL "
+            << "order: " << orderId << " failed" << '\n';
+    }
+  }
+
+  void notifyAmendReject(OrderId orderId) {
+
+    if (mLog) {
+      *mLog << "Order Amend Reject! " << mTraderId << " AMEND "
+            << "order: " << orderId << " failed" << '\n';
+    }
+  }
+
+  template <Side side, OrderStyle style>
+  void notifyAmend(OrderId orderId, Symbol symbol, Price price,
+                   Quantity quantity) {
+    if (mLog) {
+      *mLog << "Order Amend! " << mTraderId << " "
+            << (side == Side::BUY ? "BUY " : "SELL ") << quantity << " "
+            << symbol << " at " << price << '\n';
+    }
+
+    auto &openOrders = getOpenOrders<side>();
+    if (auto it = openOrders.find(orderId); it != openOrders.end()) {
+      it->second.setPrice(price);
+      it->second.setQuantity(quantity);
+    }
+  }
+
+  /**
+   * @brief
+   * The stop order is released to the order book, it is no longer pending
+   */
+  template <Side side, OrderStyle style>
+  void notifyTrigger(OrderId orderId, Symbol symbol, Price price,
+                     Quantity quantity) {
+    if (mLog) {
+      *mLog << "Order Triggered! " << mTraderId << " "
+            << "ORDER_TYPE: " << orderStyle2Str(style)
+            << (side == Side::BUY ? " BUY " : " SELL ") << quantity << " "
+            << symbol << " at " << price << '\n';
+    }
+
+    getOpenOrders<side>().erase(orderId);
+  }
+
+  template <Side side, OrderStyle style>
+  void notifyReject(OrderId orderId, Symbol symbol, Price price,
+                    Quantity quantity, OrderRejectReason rsn) {
+    if (mLog) {
+      *mLog << "Order Reject! " << mTraderId << " "
+            << "ORDER_TYPE: " << orderStyle2Str(style)
+            << (side == Side::BUY ? " BUY " : " SELL ") << quantity << " "
+            << symbol << " at " << price << " order: " << orderId
+            << " reason: " << orderRejectReason2Str(rsn) << '\n';
+    }
   }
 
   template <Side side, OrderStyle style>
@@ -134,19 +188,25 @@ public:
                   Quantity fillQuantity) {
 
     if constexpr (side == Side::BUY) {
-      std::cout << "Order Open! " << mTraderId << " "
-                << "BUY " << fillQuantity << " " << symbol << " at "
-                << fillPrice << '\n';
+      if (mLog) {
+        *mLog << "Order Open! " << mTraderId << " "
+              << "BUY " << fillQuantity << " " << symbol << " at "
+              << fillPrice << '\n';
+      }
 
-      mOpenBuyOrders.emplace_back(Order<side>(style, mTraderId, orderId, symbol,
-                                              fillPrice, fillQuantity));
+      mOpenBuyOrders.emplace(
+          orderId, Order<side>(style, mTraderId, orderId, symbol, fillPrice,
+                               fillQuantity));
     } else {
-      std::cout << "Open! " << mTraderId << " "
-                << "SELL " << fillQuantity << " " << symbol << " at "
-                << fillPrice << '\n';
+      if (mLog) {
+        *mLog << "Open! " << mTraderId << " "
+              << "SELL " << fillQuantity << " " << symbol << " at "
+              << fillPrice << '\n';
+      }
 
-      mOpenSellOrders.emplace_back(Order<side>(
-          style, mTraderId, orderId, symbol, fillPrice, fillQuantity));
+      mOpenSellOrders.emplace(
+          orderId, Order<side>(style, mTraderId, orderId, symbol, fillPrice,
+                               fillQuantity));
     }
   }
 
@@ -159,9 +219,19 @@ public:
   }
 
 private:
+  template <Side side> auto &getOpenOrders() {
+    if constexpr (side == Side::BUY) {
+      return mOpenBuyOrders;
+    } else {
+      return mOpenSellOrders;
+    }
+  }
+
   std::string mTraderId;
-  std::list<Order<Side::BUY>> mOpenBuyOrders;
-  std::list<Order<Side::SELL>> mOpenSellOrders;
+  std::ostream *mLog = &std::cout;
+  // the resting orders by id, an order leaves when it is filled or closed
+  std::unordered_map<OrderId, Order<Side::BUY>> mOpenBuyOrders;
+  std::unordered_map<OrderId, Order<Side::SELL>> mOpenSellOrders;
   std::vector<Order<Side::BUY>> mFilledBuyOrders;
   std::vector<Order<Side::SELL>> mFilledSellOrders;
 };
@@ -0,0 +1,393 @@
+#ifndef BACKTESTER
+#define BACKTESTER
+#include "strategy.h"
+#include <algorithm>
+#include <core/execution_context/execution_context.h>
+#include <core/execution_context/execution_listener.h>
+#include <core/timer_wheel/timer_wheel.h>
+#include <cstdint>
+#include <memory>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <replay/replay_file.h>
+#include <replay/replayer.h>
+#include <string>
+#include <tuple>
+#include <types.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+namespace Backtest {
+
+/**
+ * @brief
+ * Replays a replay file through a matching engine on a simulated clock with
+ * a strategy trading against the historical flow. The clock moves to the
+ * timestamp of each record, the timers of the strategy due by then fire
+ * first. After each record the execution reports of the strategy are
+ * delivered, then the strategy is told that the book of the symbol changed.
+ *
+ * The orders of the strategy rest in the same FIFO price levels as the
+ * historical orders, so its queue position and its fills follow from the
+ * matching of the engine: it is filled once the quantity ahead of it has
+ * been traded or cancelled. The log of the traders is off, and the strategy
+ * is called statically so it can be inlined into the replay loop.
+ */
+template <typename Engine, typename StrategyType>
+class Backtester : public ExecutionListener {
+public:
+  Backtester(const Replay::ReplayFile &file, StrategyType &strategy,
+             const TraderId &traderId = "STRATEGY")
+      : mFile(file), mStrategy(strategy), mTraderId(traderId),
+        mTraderIds(Replay::makeTraderIds(file.getHeader().numOfTraders)) {
+    auto symbols = file.getSymbols();
+    mEngine.addStocks(symbols);
+    mSymbols.resize(mEngine.getNumOfSymbols());
+    for (const auto &config : symbols) {
+      auto symbolId = *mEngine.getSymbolId(config.symbol);
+      mSymbolIds.push_back(symbolId);
+      mSymbols[symbolId] = config.symbol;
+    }
+
+    auto traderIds = mTraderIds;
+    traderIds.push_back(mTraderId);
+    mContext.setTraderLog(nullptr);
+    mContext.addTraders(traderIds);
+    mContext.setListener(this);
+    mReplayer = std::make_unique<Replay::Replayer<Engine>>(
+        mEngine, mContext, mTraderIds, mSymbolIds);
+  }
+
+  Backtester(const Backtester &other) = delete;
+  Backtester &operator=(const Backtester &) = delete;
+  Backtester(Backtester &&other) = delete;
+  Backtester &operator=(Backtester &&other) = delete;
+
+  /**
+   * @brief
+   * Run the strategy over the whole file, from onStart() to onEnd()
+   */
+  void run() {
+    mStrategy.onStart(*this);
+    dispatch();
+
+    for (const auto &record : mFile) {
+      advanceTo(record.timestamp);
+      mReplayer->apply(record);
+      mNumOfRecords++;
+      dispatch();
+      mStrategy.onBook(*this, mSymbolIds[record.symbolIndex]);
+      dispatch();
+    }
+
+    mStrategy.onEnd(*this);
+    dispatch();
+  }
+
+  // the simulated time, the timestamp of the current record or timer
+  Timestamp now() const { return mNow; }
+
+  /**
+   * @brief
+   * Submit an order of the strategy, the price of a market order is ignored.
+   * Its reports are delivered once the current callback returns.
+   * return the id of the order
+   */
+  template <Side side, OrderStyle style>
+  OrderId insert(SymbolId symbolId, Price price, Quantity quantity) {
+    static_assert(!isStopOrder(style), "the stop orders are not supported");
+    mNumOfOrders++;
+    mCurrentSymbolId = symbolId;
+    if constexpr (style == OrderStyle::MKT_ORDER) {
+      return mEngine.template insert<side, style>(mContext, mTraderId,
+                                                  symbolId, quantity);
+    } else {
+      return mEngine.template insert<side, style>(mContext, mTraderId,
+                                                  symbolId, price, quantity);
+    }
+  }
+
+  /**
+   * @brief
+   * Cancel a resting order of the strategy
+   * return false if the order is not resting
+   */
+  bool cancel(OrderId orderId) {
+    auto it = mOrders.find(orderId);
+    if (it == mOrders.end()) {
+      return false;
+    }
+    mEngine.cancel(mContext, mTraderId, it->second.mSymbolId, orderId);
+    return true;
+  }
+
+  /**
+   * @brief
+   * Amend a resting order of the strategy, it keeps its queue position only
+   * if the quantity goes down at the same price
+   * return false if the order is not resting
+   */
+  bool amend(OrderId orderId, Price price, Quantity quantity) {
+    auto it = mOrders.find(orderId);
+    if (it == mOrders.end()) {
+      return false;
+    }
+    mCurrentSymbolId = it->second.mSymbolId;
+    mEngine.amend(mContext, mTraderId, it->second.mSymbolId, orderId, price,
+                  quantity);
+    return true;
+  }
+
+  // call onTimer() with the id once the clock reaches the expiry
+  void scheduleTimer(Timestamp expiry, std::uint64_t timerId) {
+    expiry = std::max(expiry, mNow);
+    if (expiry < mTimers.getTime()) {
+      // the wheel has passed it while the timers due by a record fire
+      mDueTimers.push(DueTimer{expiry, mNumOfDueTimers++, timerId});
+    } else {
+      mTimers.schedule(expiry, timerId);
+    }
+  }
+
+  TopOfBook getTopOfBook(SymbolId symbolId) {
+    TopOfBook top;
+    auto book = mEngine.getOrderBook(symbolId);
+    if (auto bid = book->template begin<Side::BUY>();
+        bid != book->template end<Side::BUY>()) {
+      top.mBidPrice = bid->first;
+      top.mBidQuantity = bid->second.totalQuantity();
+    }
+    if (auto ask = book->template begin<Side::SELL>();
+        ask != book->template end<Side::SELL>()) {
+      top.mAskPrice = ask->first;
+      top.mAskQuantity = ask->second.totalQuantity();
+    }
+    return top;
+  }
+
+  /**
+   * @brief
+   * The quantity ahead of a resting order of the strategy in its price level
+   * return nullopt if the order is not resting
+   */
+  std::optional<Quantity> getQueuePosition(OrderId orderId) {
+    auto it = mOrders.find(orderId);
+    if (it == mOrders.end()) {
+      return std::nullopt;
+    }
+    auto book = mEngine.getOrderBook(it->second.mSymbolId);
+    return it->second.mSide == Side::BUY
+               ? book->template getQueuePosition<Side::BUY>(orderId)
+               : book->template getQueuePosition<Side::SELL>(orderId);
+  }
+
+  // the position of the strategy on the symbol
+  Position getPosition(SymbolId symbolId) const {
+    return mContext.getPosition(mTraderId, mSymbols[symbolId]);
+  }
+
+  const Symbol &getSymbol(SymbolId symbolId) const {
+    return mSymbols[symbolId];
+  }
+
+  // the symbol ids of the symbol indexes of the file
+  const std::vector<SymbolId> &getSymbolIds() const { return mSymbolIds; }
+
+  Engine &getEngine() { return mEngine; }
+  ExecutionContext &getContext() { return mContext; }
+  std::uint64_t getNumOfRecords() const { return mNumOfRecords; }
+  std::uint64_t getNumOfOrders() const { return mNumOfOrders; }
+  std::uint64_t getNumOfFills() const { return mNumOfFills; }
+
+  void onOpen(const TraderId &traderId, OrderId orderId, const Symbol &,
+              Side side, OrderStyle, Price price,
+              Quantity quantity) override {
+    if (traderId == mTraderId) {
+      mOrders[orderId] = RestingOrder{mCurrentSymbolId, side};
+      report(ReportType::OPEN, orderId, mCurrentSymbolId, side, price,
+             quantity);
+    }
+  }
+
+  void onFill(const TraderId &traderId, OrderId orderId, const Symbol &symbol,
+              Side side, OrderStyle, Price price,
+              Quantity quantity) override {
+    if (traderId == mTraderId) {
+      mNumOfFills++;
+      report(ReportType::FILL, orderId, findSymbolId(orderId, symbol), side,
+             price, quantity);
+    }
+  }
+
+  void onAllFilled(const TraderId &traderId, OrderId orderId) override {
+    if (traderId == mTraderId) {
+      mOrders.erase(orderId);
+    }
+  }
+
+  void onCancel(const TraderId &traderId, OrderId orderId,
+                const Symbol &symbol, Side side, OrderStyle, Price price,
+                Quantity quantity, OrderCancelReason) override {
+    if (traderId == mTraderId) {
+      report(ReportType::CANCEL, orderId, findSymbolId(orderId, symbol), side,
+             price, quantity);
+      mOrders.erase(orderId);
+    }
+  }
+
+  void onAmend(const TraderId &traderId, OrderId orderId, const Symbol &symbol,
+               Side side, Price price, Quantity quantity) override {
+    if (traderId == mTraderId) {
+      report(ReportType::AMEND, orderId, findSymbolId(orderId, symbol), side,
+             price, quantity);
+    }
+  }
+
+  void onReject(const TraderId &traderId, OrderId orderId,
+                const Symbol &symbol, Side side, OrderStyle, Price price,
+                Quantity quantity, OrderRejectReason) override {
+    if (traderId == mTraderId) {
+      report(ReportType::REJECT, orderId, findSymbolId(orderId, symbol), side,
+             price, quantity);
+    }
+  }
+
+private:
+  enum class ReportType { OPEN, FILL, CANCEL, AMEND, REJECT };
+
+  struct Report {
+    ReportType mType;
+    OrderReport mReport;
+  };
+
+  struct RestingOrder {
+    SymbolId mSymbolId;
+    Side mSide;
+  };
+
+  // a timer due by the time being advanced to, fired in expiry order and in
+  // the order they became due for the same expiry
+  struct DueTimer {
+    Timestamp mExpiry;
+    std::uint64_t mSeqNum;
+    std::uint64_t mId;
+
+    bool operator>(const DueTimer &other) const {
+      return std::tie(mExpiry, mSeqNum) >
+             std::tie(other.mExpiry, other.mSeqNum);
+    }
+  };
+
+  /**
+   * @brief
+   * Fire the timers due by the time, then move the clock to it. A timer
+   * scheduled from onTimer() for a time the wheel has passed fires in turn
+   * before the clock reaches the time.
+   */
+  void advanceTo(Timestamp time) {
+    if (time <= mNow) {
+      return;
+    }
+
+    mExpiredTimers.clear();
+    mTimers.advance(time, mExpiredTimers);
+    for (const auto &timer : mExpiredTimers) {
+      mDueTimers.push(DueTimer{timer.mExpiry, mNumOfDueTimers++, timer.mId});
+    }
+    while (!mDueTimers.empty()) {
+      auto timer = mDueTimers.top();
+      mDueTimers.pop();
+      mNow = std::max(mNow, timer.mExpiry);
+      mStrategy.onTimer(*this, timer.mId);
+      dispatch();
+    }
+
+    mNow = time;
+    mEngine.advanceTime(mContext, mNow);
+    dispatch();
+  }
+
+  void report(ReportType type, OrderId orderId, SymbolId symbolId, Side side,
+              Price price, Quantity quantity) {
+    mReports.push_back(
+        Report{type, OrderReport{orderId, symbolId, side, price, quantity}});
+  }
+
+  /**
+   * @brief
+   * Deliver the reports queued, including the reports of the orders the
+   * strategy submits from the callbacks
+   */
+  void dispatch() {
+    for (size_t i = 0; i < mReports.size(); i++) {
+      auto report = mReports[i];
+      switch (report.mType) {
+      case ReportType::OPEN:
+        mStrategy.onOpen(*this, report.mReport);
+        break;
+      case ReportType::FILL:
+        mStrategy.onFill(*this, report.mReport);
+        break;
+      case ReportType::CANCEL:
+        mStrategy.onCancel(*this, report.mReport);
+        break;
+      case ReportType::AMEND:
+        mStrategy.onAmend(*this, report.mReport);
+        break;
+      case ReportType::REJECT:
+        mStrategy.onReject(*this, report.mReport);
+        break;
+      }
+    }
+    mReports.clear();
+  }
+
+  // the symbol of a report, the cancel of a request has no symbol
+  SymbolId findSymbolId(OrderId orderId, const Symbol &symbol) {
+    auto it = mOrders.find(orderId);
+    if (it != mOrders.end()) {
+      return it->second.mSymbolId;
+    }
+    if (!symbol.empty()) {
+      return mEngine.getSymbolId(symbol).value_or(mCurrentSymbolId);
+    }
+    return mCurrentSymbolId;
+  }
+
+  const Replay::ReplayFile &mFile;
+  StrategyType &mStrategy;
+  TraderId mTraderId;
+
+  Engine mEngine;
+  ExecutionContext mContext;
+  std::vector<TraderId> mTraderIds;
+  std::vector<SymbolId> mSymbolIds;
+  // the names of the symbols by id
+  std::vector<Symbol> mSymbols;
+  std::unique_ptr<Replay::Replayer<Engine>> mReplayer;
+
+  Timestamp mNow = 0;
+  TimerWheel mTimers;
+  std::vector<TimerWheel::Timer> mExpiredTimers;
+  std::priority_queue<DueTimer, std::vector<DueTimer>, std::greater<>>
+      mDueTimers;
+  std::uint64_t mNumOfDueTimers = 0;
+
+  // the resting orders of the strategy
+  std::unordered_map<OrderId, RestingOrder> mOrders;
+  // the symbol of the order being submitted, its open comes before its id
+  SymbolId mCurrentSymbolId = 0;
+  std::vector<Report> mReports;
+
+  std::uint64_t mNumOfRecords = 0;
+  std::uint64_t mNumOfOrders = 0;
+  std::uint64_t mNumOfFills = 0;
+};
+
+} // namespace Backtest
+
+#endif
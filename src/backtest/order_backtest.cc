@@ -0,0 +1,88 @@
+#include "backtester.h"
+#include "queue_maker.h"
+#include <chrono>
+#include <iostream>
+#include <matching_engine/matching_engine.h>
+#include <replay/replay_file.h>
+#include <string>
+#include <string_view>
+
+using namespace Backtest;
+
+namespace {
+
+void usage() {
+  std::cerr << "usage: order_backtest --file <replay file> [--symbol <name>] "
+               "[--quantity <n>] [--max-position <n>] [--requote <units>]\n"
+               "  runs the queue maker on the symbol, the first symbol of "
+               "the file by default\n";
+}
+
+} // namespace
+
+/**
+ * @brief
+ * Backtest the queue maker strategy over a replay file on the simulated
+ * clock of the records, and report the throughput of the replay and the
+ * orders, fills, position and P&L of the strategy.
+ */
+int main(int argc, char *argv[]) {
+  std::string path, symbol;
+  QueueMakerConfig config;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string_view option = argv[i];
+    if (option == "--file") {
+      path = argv[i + 1];
+    } else if (option == "--symbol") {
+      symbol = argv[i + 1];
+    } else if (option == "--quantity") {
+      config.quantity = std::stoull(argv[i + 1]);
+    } else if (option == "--max-position") {
+      config.maxPosition = std::stoll(argv[i + 1]);
+    } else if (option == "--requote") {
+      config.requoteDistance = std::stoll(argv[i + 1]);
+    }
+  }
+  if (path.empty() || config.quantity == 0) {
+    usage();
+    return 1;
+  }
+
+  Replay::ReplayFile file;
+  if (!file.open(path)) {
+    std::cerr << "cannot map the replay file " << path << '\n';
+    return 1;
+  }
+  auto symbols = file.getSymbols();
+  if (symbols.empty()) {
+    std::cerr << "no symbol in " << path << '\n';
+    return 1;
+  }
+
+  QueueMaker strategy(config);
+  Backtester<MatchingEngine, QueueMaker> backtest(file, strategy);
+  auto symbolId = backtest.getEngine().getSymbolId(
+      symbol.empty() ? symbols[0].symbol : symbol);
+  if (!symbolId) {
+    std::cerr << "unknown symbol " << symbol << '\n';
+    return 1;
+  }
+  config.symbolId = *symbolId;
+  strategy = QueueMaker(config);
+
+  auto start = std::chrono::steady_clock::now();
+  backtest.run();
+  auto seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  std::cout << "records: " << backtest.getNumOfRecords()
+            << "\nseconds: " << seconds
+            << "\nrecords/s: " << backtest.getNumOfRecords() / seconds
+            << "\norders: " << backtest.getNumOfOrders()
+            << "\nfills: " << backtest.getNumOfFills()
+            << "\nvolume: " << strategy.getVolume()
+            << "\nposition: " << strategy.getPosition()
+            << "\npnl: " << strategy.getPnl() << '\n';
+  return 0;
+}
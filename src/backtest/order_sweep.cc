@@ -0,0 +1,160 @@
+#include "parameter_sweep.h"
+#include "queue_maker.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <matching_engine/matching_engine.h>
+#include <optional>
+#include <replay/replay_file.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace Backtest;
+
+namespace {
+
+void usage() {
+  std::cerr
+      << "usage: order_sweep --file <replay file> [--symbol <name>] "
+         "[--workers <n>] [--pin] [--quantity <n,...>] "
+         "[--max-position <n,...>] [--requote <units,...>]\n"
+         "  backtests the queue maker on every combination of the listed "
+         "parameters, one worker process per core by default. The results "
+         "go to stdout as csv, the summary to stderr\n";
+}
+
+// parse a comma separated list of integers
+template <typename T> std::vector<T> parseList(const std::string &list) {
+  std::vector<T> values;
+  std::istringstream stream(list);
+  for (std::string value; std::getline(stream, value, ',');) {
+    values.push_back(static_cast<T>(std::stoll(value)));
+  }
+  return values;
+}
+
+} // namespace
+
+/**
+ * @brief
+ * Backtest the queue maker strategy with a grid of parameter sets over a
+ * replay file, the backtests run in parallel worker processes that share
+ * the memory mapped file. Report the result of each parameter set and the
+ * throughput and the best P&L of the sweep.
+ */
+int main(int argc, char *argv[]) {
+  std::string path, symbol;
+  unsigned numOfWorkers = std::max(std::thread::hardware_concurrency(), 1u);
+  bool isPinned = false;
+  std::vector<Quantity> quantities{100};
+  std::vector<std::int64_t> maxPositions{1000};
+  std::vector<std::int64_t> requoteDistances{0};
+  for (int i = 1; i < argc; i++) {
+    std::string_view option = argv[i];
+    if (option == "--pin") {
+      isPinned = true;
+    } else if (i + 1 == argc) {
+      break;
+    } else if (option == "--file") {
+      path = argv[++i];
+    } else if (option == "--symbol") {
+      symbol = argv[++i];
+    } else if (option == "--workers") {
+      numOfWorkers = std::stoul(argv[++i]);
+    } else if (option == "--quantity") {
+      quantities = parseList<Quantity>(argv[++i]);
+    } else if (option == "--max-position") {
+      maxPositions = parseList<std::int64_t>(argv[++i]);
+    } else if (option == "--requote") {
+      requoteDistances = parseList<std::int64_t>(argv[++i]);
+    }
+  }
+  if (path.empty() || numOfWorkers == 0 ||
+      std::count(quantities.begin(), quantities.end(), 0)) {
+    usage();
+    return 1;
+  }
+
+  Replay::ReplayFile file;
+  if (!file.open(path)) {
+    std::cerr << "cannot map the replay file " << path << '\n';
+    return 1;
+  }
+  auto symbols = file.getSymbols();
+  if (symbols.empty()) {
+    std::cerr << "no symbol in " << path << '\n';
+    return 1;
+  }
+
+  // the engines of the workers add the symbols of the file in the same order
+  std::optional<SymbolId> symbolId;
+  {
+    MatchingEngine engine;
+    engine.addStocks(symbols);
+    symbolId =
+        engine.getSymbolId(symbol.empty() ? symbols[0].symbol : symbol);
+  }
+  if (!symbolId) {
+    std::cerr << "unknown symbol " << symbol << '\n';
+    return 1;
+  }
+
+  std::vector<QueueMakerConfig> configs;
+  for (auto quantity : quantities) {
+    for (auto maxPosition : maxPositions) {
+      for (auto requoteDistance : requoteDistances) {
+        configs.push_back(QueueMakerConfig{*symbolId, quantity, maxPosition,
+                                           requoteDistance});
+      }
+    }
+  }
+
+  ParameterSweep<MatchingEngine, QueueMaker, QueueMakerConfig> sweep(
+      file, configs);
+  bool isCompleted = sweep.run(numOfWorkers, isPinned);
+
+  std::cout << "quantity,max_position,requote,orders,fills,volume,position,"
+               "pnl,seconds,worker\n";
+  const SweepResult *best = nullptr;
+  const QueueMakerConfig *bestConfig = nullptr;
+  std::uint64_t numOfRecords = 0;
+  for (size_t i = 0; i < configs.size(); i++) {
+    const auto &config = configs[i];
+    const auto &result = sweep.getResults()[i];
+    std::cout << config.quantity << ',' << config.maxPosition << ','
+              << config.requoteDistance << ',';
+    if (!result.mIsCompleted) {
+      std::cout << "failed\n";
+      continue;
+    }
+    std::cout << result.mNumOfOrders << ',' << result.mNumOfFills << ','
+              << result.mVolume << ',' << result.mPosition << ','
+              << result.mPnl << ',' << result.mSeconds << ','
+              << result.mWorker << '\n';
+    numOfRecords += result.mNumOfRecords;
+    if (!best || result.mPnl > best->mPnl) {
+      best = &result;
+      bestConfig = &config;
+    }
+  }
+
+  auto seconds = sweep.getSeconds();
+  std::cerr << "backtests: " << configs.size()
+            << "\nworkers: " << numOfWorkers << "\nseconds: " << seconds
+            << "\nbacktests/s: " << configs.size() / seconds
+            << "\nrecords/s: " << numOfRecords / seconds << '\n';
+  if (best) {
+    std::cerr << "best pnl: " << best->mPnl
+              << " quantity: " << bestConfig->quantity
+              << " max position: " << bestConfig->maxPosition
+              << " requote: " << bestConfig->requoteDistance << '\n';
+  }
+  if (!isCompleted) {
+    std::cerr << "some backtests did not complete\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,199 @@
+#ifndef PARAMETER_SWEEP
+#define PARAMETER_SWEEP
+#include "backtester.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <replay/replay_file.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <type_traits>
+#include <types.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+namespace Backtest {
+
+/**
+ * @brief
+ * The outcome of the backtest of one parameter set, mIsCompleted is false if
+ * its worker died before the backtest finished
+ */
+struct SweepResult {
+  bool mIsCompleted = false;
+  std::uint32_t mWorker = 0;
+  std::uint64_t mNumOfRecords = 0;
+  std::uint64_t mNumOfOrders = 0;
+  std::uint64_t mNumOfFills = 0;
+  Quantity mVolume = 0;
+  std::int64_t mPosition = 0;
+  double mPnl = 0;
+  double mSeconds = 0;
+};
+
+/**
+ * @brief
+ * Backtests a strategy over one replay file with many parameter sets, in
+ * parallel processes. Each worker is a fork with its own engine, execution
+ * context and strategy, so nothing is shared between the backtests but the
+ * pages of the memory mapped file. The workers take the parameter sets one
+ * at a time from a counter in shared memory, which balances the long and the
+ * short backtests, and write the results into a shared array the parent
+ * reads once they have all exited. The parent runs as the first worker.
+ *
+ * The strategy is constructed from a Config and reports getVolume(),
+ * getPosition() and getPnl() once it has run, see QueueMaker.
+ */
+template <typename Engine, typename StrategyType, typename Config>
+class ParameterSweep {
+public:
+  ParameterSweep(const Replay::ReplayFile &file, std::vector<Config> configs)
+      : mFile(file), mConfigs(std::move(configs)) {}
+
+  ParameterSweep(const ParameterSweep &other) = delete;
+  ParameterSweep &operator=(const ParameterSweep &) = delete;
+  ParameterSweep(ParameterSweep &&other) = delete;
+  ParameterSweep &operator=(ParameterSweep &&other) = delete;
+
+  /**
+   * @brief
+   * Run the backtests of all the parameter sets on numOfWorkers processes,
+   * the worker n is pinned to the core n modulo the number of cores if
+   * isPinned. The workers that cannot be forked are left out, the others
+   * take their share.
+   * return false if a backtest did not complete
+   */
+  bool run(unsigned numOfWorkers, bool isPinned = false) {
+    static_assert(std::is_trivially_copyable_v<SweepResult>);
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "the counter is shared between processes");
+    mResults.assign(mConfigs.size(), SweepResult{});
+    mSeconds = 0;
+    if (mConfigs.empty()) {
+      return true;
+    }
+
+    auto size = sizeof(Shared) + mConfigs.size() * sizeof(SweepResult);
+    void *memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+      return false;
+    }
+    auto shared = new (memory) Shared;
+    auto results = reinterpret_cast<SweepResult *>(shared + 1);
+    for (size_t i = 0; i < mConfigs.size(); i++) {
+      new (results + i) SweepResult;
+    }
+
+    // the children must not flush what the parent has buffered
+    std::cout.flush();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<pid_t> workers;
+    for (unsigned worker = 1; worker < numOfWorkers; worker++) {
+      auto pid = ::fork();
+      if (pid == 0) {
+        work(*shared, results, worker, isPinned);
+        ::_exit(0);
+      }
+      if (pid < 0) {
+        break;
+      }
+      workers.push_back(pid);
+    }
+    // the parent is pinned for its share only
+    cpu_set_t cores;
+    bool isRestored = isPinned && ::sched_getaffinity(0, sizeof(cores),
+                                                      &cores) == 0;
+    work(*shared, results, 0, isPinned);
+    if (isRestored) {
+      ::sched_setaffinity(0, sizeof(cores), &cores);
+    }
+
+    for (auto pid : workers) {
+      int status;
+      while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+      }
+    }
+    mSeconds = std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+
+    bool isCompleted = true;
+    for (size_t i = 0; i < mConfigs.size(); i++) {
+      mResults[i] = results[i];
+      isCompleted = isCompleted && mResults[i].mIsCompleted;
+    }
+    ::munmap(memory, size);
+    return isCompleted;
+  }
+
+  const std::vector<Config> &getConfigs() const { return mConfigs; }
+  // the results in the order of the configs
+  const std::vector<SweepResult> &getResults() const { return mResults; }
+  // the wall clock time of the last run
+  double getSeconds() const { return mSeconds; }
+
+private:
+  struct Shared {
+    std::atomic<std::uint64_t> mNextConfig{0};
+  };
+
+  void work(Shared &shared, SweepResult *results, unsigned worker,
+            bool isPinned) {
+    if (isPinned) {
+      pin(worker);
+    }
+    for (;;) {
+      auto index = shared.mNextConfig.fetch_add(1, std::memory_order_relaxed);
+      if (index >= mConfigs.size()) {
+        return;
+      }
+
+      StrategyType strategy(mConfigs[index]);
+      Backtester<Engine, StrategyType> backtest(mFile, strategy);
+      auto start = std::chrono::steady_clock::now();
+      backtest.run();
+
+      SweepResult result;
+      result.mWorker = worker;
+      result.mSeconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+      result.mNumOfRecords = backtest.getNumOfRecords();
+      result.mNumOfOrders = backtest.getNumOfOrders();
+      result.mNumOfFills = backtest.getNumOfFills();
+      result.mVolume = strategy.getVolume();
+      result.mPosition = strategy.getPosition();
+      result.mPnl = strategy.getPnl();
+      result.mIsCompleted = true;
+      results[index] = result;
+    }
+  }
+
+  static void pin(unsigned worker) {
+    auto numOfCores = ::sysconf(_SC_NPROCESSORS_ONLN);
+    if (numOfCores > 0) {
+      cpu_set_t cores;
+      CPU_ZERO(&cores);
+      CPU_SET(worker % numOfCores, &cores);
+      ::sched_setaffinity(0, sizeof(cores), &cores);
+    }
+  }
+
+  const Replay::ReplayFile &mFile;
+  std::vector<Config> mConfigs;
+  std::vector<SweepResult> mResults;
+  double mSeconds = 0;
+};
+
+} // namespace Backtest
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef QUEUE_MAKER
+#define QUEUE_MAKER
+#include "strategy.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <types.h>
+
+using namespace Common;
+using namespace Core;
+
+namespace Backtest {
+
+/**
+ * @brief
+ * symbolId: the symbol quoted
+ * quantity: the quantity of each quote
+ * maxPosition: the largest long or short position the quotes can reach
+ * requoteDistance: how far, in price units, the best price can move away
+ * from a quote before it is cancelled and placed again at the best price
+ */
+struct QueueMakerConfig {
+  SymbolId symbolId = 0;
+  Quantity quantity = 100;
+  std::int64_t maxPosition = 1000;
+  std::int64_t requoteDistance = 0;
+};
+
+/**
+ * @brief
+ * A passive market maker: it joins the back of the best bid and the best ask
+ * of a symbol, one quote per side, and waits for the flow to trade through
+ * the queue ahead of it. A side is not quoted while a fill there could take
+ * the position past its limit. The P&L is marked to the mid price at the end.
+ */
+class QueueMaker : public Strategy {
+public:
+  explicit QueueMaker(const QueueMakerConfig &config) : mConfig(config) {}
+
+  template <typename Driver>
+  void onBook(Driver &backtest, SymbolId symbolId) {
+    if (symbolId != mConfig.symbolId) {
+      return;
+    }
+    auto top = backtest.getTopOfBook(symbolId);
+    quote<Side::BUY>(backtest, top.mBidQuantity ? top.mBidPrice : Price());
+    quote<Side::SELL>(backtest, top.mAskQuantity ? top.mAskPrice : Price());
+  }
+
+  template <typename Driver>
+  void onFill(Driver &, const OrderReport &report) {
+    auto quantity = static_cast<std::int64_t>(report.mQuantity);
+    mPosition += report.mSide == Side::BUY ? quantity : -quantity;
+    mVolume += report.mQuantity;
+
+    auto &quote = getQuote(report.mSide);
+    if (quote.mOrderId == report.mOrderId) {
+      quote.mQuantity -= std::min(quote.mQuantity, report.mQuantity);
+      if (quote.mQuantity == 0) {
+        quote = Quote{};
+      }
+    }
+  }
+
+  template <typename Driver>
+  void onCancel(Driver &, const OrderReport &report) {
+    clear(report);
+  }
+
+  template <typename Driver>
+  void onReject(Driver &, const OrderReport &report) {
+    clear(report);
+  }
+
+  template <typename Driver> void onEnd(Driver &backtest) {
+    auto top = backtest.getTopOfBook(mConfig.symbolId);
+    auto position = backtest.getPosition(mConfig.symbolId);
+    mPnl = position.getRealizedPnl();
+    if (top.mBidQuantity && top.mAskQuantity) {
+      Price mid = (top.mBidPrice.units() + top.mAskPrice.units()) / 2;
+      mPnl += position.getUnrealizedPnl(mid);
+    }
+  }
+
+  std::int64_t getPosition() const { return mPosition; }
+  Quantity getVolume() const { return mVolume; }
+  // the P&L in price units times quantity, set by onEnd()
+  double getPnl() const { return mPnl; }
+
+private:
+  struct Quote {
+    OrderId mOrderId = 0;
+    Price mPrice;
+    Quantity mQuantity = 0;
+  };
+
+  Quote &getQuote(Side side) { return mQuotes[static_cast<size_t>(side)]; }
+
+  void clear(const OrderReport &report) {
+    auto &quote = getQuote(report.mSide);
+    if (quote.mOrderId == report.mOrderId) {
+      quote = Quote{};
+    }
+  }
+
+  // keep a quote of the side at the best price, none if the side is empty
+  template <Side side, typename Driver>
+  void quote(Driver &backtest, Price best) {
+    auto &quote = getQuote(side);
+    auto quantity = static_cast<std::int64_t>(mConfig.quantity);
+    auto exposure = side == Side::BUY ? mPosition : -mPosition;
+    bool canQuote = best && exposure + quantity <= mConfig.maxPosition;
+
+    if (quote.mQuantity) {
+      auto distance = (best - quote.mPrice).units();
+      if (canQuote && distance <= mConfig.requoteDistance &&
+          -distance <= mConfig.requoteDistance) {
+        return;
+      }
+      // the order may be gone already, its report is still queued
+      backtest.cancel(quote.mOrderId);
+      quote = Quote{};
+    }
+
+    if (canQuote) {
+      quote.mOrderId = backtest.template insert<side, OrderStyle::LIMIT_ORDER>(
+          mConfig.symbolId, best, mConfig.quantity);
+      quote.mPrice = best;
+      quote.mQuantity = mConfig.quantity;
+    }
+  }
+
+  QueueMakerConfig mConfig;
+  std::array<Quote, 2> mQuotes;
+  std::int64_t mPosition = 0;
+  Quantity mVolume = 0;
+  double mPnl = 0;
+};
+
+} // namespace Backtest
+
+#endif
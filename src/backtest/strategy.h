@@ -0,0 +1,66 @@
+#ifndef BACKTEST_STRATEGY
+#define BACKTEST_STRATEGY
+#include <core/order/order.h>
+#include <cstdint>
+#include <types.h>
+
+using namespace Common;
+using namespace Core;
+
+namespace Backtest {
+
+// the best price level of each side, the quantity is 0 on an empty side
+struct TopOfBook {
+  Price mBidPrice;
+  Quantity mBidQuantity = 0;
+  Price mAskPrice;
+  Quantity mAskQuantity = 0;
+};
+
+/**
+ * @brief
+ * An execution report of an order of the strategy. The quantity is the fill
+ * quantity of a fill, the quantity left of an open, amend or cancel.
+ */
+struct OrderReport {
+  OrderId mOrderId;
+  SymbolId mSymbolId;
+  Side mSide;
+  Price mPrice;
+  Quantity mQuantity;
+};
+
+/**
+ * @brief
+ * The callbacks of a strategy, all empty. A strategy derives from it and
+ * hides the callbacks it reacts to, the Backtester calls them statically so
+ * the callbacks left empty cost nothing. The Backtester is passed to each
+ * callback to read the books and the clock and to submit orders.
+ *
+ * The execution reports of the orders submitted in a callback are delivered
+ * after the callback returns, never from within it.
+ */
+class Strategy {
+public:
+  template <typename Driver> void onStart(Driver &) {}
+
+  // the book of the symbol has changed with the historical flow
+  template <typename Driver> void onBook(Driver &, SymbolId) {}
+
+  template <typename Driver> void onOpen(Driver &, const OrderReport &) {}
+  template <typename Driver> void onFill(Driver &, const OrderReport &) {}
+  template <typename Driver>
+  void onCancel(Driver &, const OrderReport &) {}
+  template <typename Driver> void onAmend(Driver &, const OrderReport &) {}
+  template <typename Driver>
+  void onReject(Driver &, const OrderReport &) {}
+
+  // a timer scheduled by the strategy is due, the clock is at its expiry
+  template <typename Driver> void onTimer(Driver &, std::uint64_t) {}
+
+  template <typename Driver> void onEnd(Driver &) {}
+};
+
+} // namespace Backtest
+
+#endif
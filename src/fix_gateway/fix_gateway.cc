@@ -0,0 +1,165 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <gateway/fix_session.h>
+#include <iostream>
+#include <matching_engine/matching_engine.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr size_t kReadSize = 64 * 1024;
+
+void usage() {
+  std::cerr << "usage: fix_gateway --symbols <file> --traders <id,id,...> "
+               "(--file <path> | --socket <path>)\n"
+               "  --file: execute the messages of the file and write the "
+               "reports to stdout\n"
+               "  --socket: serve the clients of a local socket one at a "
+               "time\n";
+}
+
+bool writeAll(int fd, std::string_view data) {
+  while (!data.empty()) {
+    auto written = ::write(fd, data.data(), data.size());
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+    data.remove_prefix(written);
+  }
+  return true;
+}
+
+/**
+ * @brief
+ * Execute the messages read from the input until the end of the stream, the
+ * reports of each read are written to the output in one go
+ * return false if the output cannot be written
+ */
+bool run(FixSession<MatchingEngine> &session, int in, int out) {
+  std::vector<char> buffer(kReadSize);
+  size_t size = 0;
+  while (true) {
+    if (buffer.size() - size < kReadSize) {
+      buffer.resize(size + kReadSize);
+    }
+
+    auto numOfBytes = ::read(in, buffer.data() + size, kReadSize);
+    if (numOfBytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (numOfBytes <= 0) {
+      return true;
+    }
+
+    size += numOfBytes;
+    auto consumed = session.onData(buffer.data(), size);
+    std::memmove(buffer.data(), buffer.data() + consumed, size - consumed);
+    size -= consumed;
+
+    if (!writeAll(out, session.getOutput())) {
+      return false;
+    }
+    session.clearOutput();
+  }
+}
+
+int serve(FixSession<MatchingEngine> &session, const std::string &path) {
+  sockaddr_un address{};
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "socket path too long: " << path << '\n';
+    return 1;
+  }
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size());
+
+  int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ::unlink(path.c_str());
+  if (listener < 0 ||
+      ::bind(listener, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)) < 0 ||
+      ::listen(listener, 1) < 0) {
+    std::cerr << "cannot listen on " << path << ": " << std::strerror(errno)
+              << '\n';
+    return 1;
+  }
+
+  while (true) {
+    int client = ::accept(listener, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "accept failed: " << std::strerror(errno) << '\n';
+      return 1;
+    }
+    run(session, client, client);
+    ::close(client);
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string symbolsPath, traders, filePath, socketPath;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string_view option = argv[i];
+    if (option == "--symbols") {
+      symbolsPath = argv[i + 1];
+    } else if (option == "--traders") {
+      traders = argv[i + 1];
+    } else if (option == "--file") {
+      filePath = argv[i + 1];
+    } else if (option == "--socket") {
+      socketPath = argv[i + 1];
+    }
+  }
+  if (symbolsPath.empty() || filePath.empty() == socketPath.empty()) {
+    usage();
+    return 1;
+  }
+
+  MatchingEngine engine;
+  if (!engine.loadStocks(symbolsPath)) {
+    std::cerr << "cannot load the symbols from " << symbolsPath << '\n';
+    return 1;
+  }
+
+  std::vector<TraderId> traderIds;
+  std::istringstream traderList(traders);
+  for (std::string traderId; std::getline(traderList, traderId, ',');) {
+    traderIds.push_back(traderId);
+  }
+
+  // the reports take stdout, the log of the traders goes to stderr
+  ExecutionContext context;
+  context.setTraderLog(&std::cerr);
+  context.addTraders(traderIds);
+  FixSession<MatchingEngine> session(engine, context, "ENGINE", "CLIENT");
+  for (const auto &traderId : traderIds) {
+    session.addTrader(traderId);
+  }
+
+  if (!socketPath.empty()) {
+    return serve(session, socketPath);
+  }
+
+  int file = ::open(filePath.c_str(), O_RDONLY);
+  if (file < 0) {
+    std::cerr << "cannot open " << filePath << ": " << std::strerror(errno)
+              << '\n';
+    return 1;
+  }
+  bool isWritten = run(session, file, STDOUT_FILENO);
+  ::close(file);
+  return isWritten ? 0 : 1;
+}
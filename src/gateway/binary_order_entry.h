@@ -0,0 +1,137 @@
+#ifndef BINARY_ORDER_ENTRY
+#define BINARY_ORDER_ENTRY
+#include "binary_protocol.h"
+#include <core/execution_context/execution_context.h>
+#include <cstdint>
+#include <types.h>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+/**
+ * @brief
+ * The handler of the binary protocol in front of a matching engine. The
+ * TraderId of each trader of the session is stored once when the trader logs
+ * on and a message refers to it by its index, the symbol is passed to the
+ * engine by id. A message of an unknown trader or with an invalid side or
+ * style is dropped.
+ */
+template <typename Engine> class BinaryOrderEntry {
+public:
+  BinaryOrderEntry(Engine &engine, ExecutionContext &context)
+      : mEngine(engine), mContext(context) {}
+
+  /**
+   * @brief
+   * Add the trader to the session
+   * return the index of the trader in the messages
+   */
+  std::uint32_t addTrader(const TraderId &traderId) {
+    mTraders.push_back(traderId);
+    return static_cast<std::uint32_t>(mTraders.size() - 1);
+  }
+
+  /**
+   * @brief
+   * Decode and execute the complete messages at the front of the buffer
+   * return the number of bytes consumed
+   */
+  size_t onData(const char *data, size_t size) {
+    return BinaryProtocol::decode(data, size, *this);
+  }
+
+  void onNewOrder(const BinaryProtocol::NewOrderView &message) {
+    if (message.traderIndex() >= mTraders.size()) {
+      return;
+    }
+
+    if (message.side() == static_cast<std::uint8_t>(Side::BUY)) {
+      insert<Side::BUY>(message);
+    } else if (message.side() == static_cast<std::uint8_t>(Side::SELL)) {
+      insert<Side::SELL>(message);
+    }
+  }
+
+  void onCancel(const BinaryProtocol::CancelView &message) {
+    if (message.traderIndex() >= mTraders.size()) {
+      return;
+    }
+    mEngine.cancel(mContext, mTraders[message.traderIndex()],
+                   message.symbolId(), message.orderId());
+  }
+
+  void onAmend(const BinaryProtocol::AmendView &message) {
+    if (message.traderIndex() >= mTraders.size()) {
+      return;
+    }
+    mEngine.amend(mContext, mTraders[message.traderIndex()],
+                  message.symbolId(), message.orderId(), message.price(),
+                  message.quantity());
+  }
+
+  void onMassCancel(const BinaryProtocol::MassCancelView &message) {
+    if (message.traderIndex() >= mTraders.size()) {
+      return;
+    }
+
+    const auto &traderId = mTraders[message.traderIndex()];
+    auto side = message.side();
+    if (message.symbolId() == BinaryProtocol::kAllSymbols) {
+      mEngine.massCancel(mContext, traderId);
+    } else if (side == BinaryProtocol::kBothSides) {
+      mEngine.massCancel(mContext, traderId, message.symbolId());
+    } else if (side <= static_cast<std::uint8_t>(Side::SELL)) {
+      mEngine.massCancel(mContext, traderId, message.symbolId(),
+                         static_cast<Side>(side));
+    }
+  }
+
+  // the reports are sent by the engine, not received
+  void onExecutionReport(const BinaryProtocol::ExecutionReportView &) {}
+
+private:
+  template <Side side>
+  void insert(const BinaryProtocol::NewOrderView &message) {
+    const auto &traderId = mTraders[message.traderIndex()];
+    auto symbolId = message.symbolId();
+    auto price = message.price();
+    auto quantity = message.quantity();
+
+    switch (static_cast<OrderStyle>(message.style())) {
+    case OrderStyle::MKT_ORDER:
+      mEngine.template insert<side, OrderStyle::MKT_ORDER>(
+          mContext, traderId, symbolId, quantity);
+      break;
+    case OrderStyle::LIMIT_ORDER:
+      mEngine.template insert<side, OrderStyle::LIMIT_ORDER>(
+          mContext, traderId, symbolId, price, quantity);
+      break;
+    case OrderStyle::IOC_ORDER:
+      mEngine.template insert<side, OrderStyle::IOC_ORDER>(
+          mContext, traderId, symbolId, price, quantity);
+      break;
+    case OrderStyle::FOK_ORDER:
+      mEngine.template insert<side, OrderStyle::FOK_ORDER>(
+          mContext, traderId, symbolId, price, quantity);
+      break;
+    case OrderStyle::STOP_ORDER:
+      mEngine.template insert<side, OrderStyle::STOP_ORDER>(
+          mContext, traderId, symbolId, message.triggerPrice(), quantity);
+      break;
+    case OrderStyle::STOP_LIMIT_ORDER:
+      mEngine.template insert<side, OrderStyle::STOP_LIMIT_ORDER>(
+          mContext, traderId, symbolId, message.triggerPrice(), price,
+          quantity);
+      break;
+    default:
+      break;
+    }
+  }
+
+  Engine &mEngine;
+  ExecutionContext &mContext;
+  std::vector<TraderId> mTraders;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "binary_protocol.h"
+
+namespace BinaryProtocol {
+
+namespace {
+
+char *encodeHeader(char *buffer, TemplateId templateId,
+                   std::uint16_t blockLength) {
+  std::memset(buffer, 0, MessageHeader::kSize + blockLength);
+  store<std::uint16_t>(buffer, blockLength);
+  store<std::uint16_t>(buffer + 2, static_cast<std::uint16_t>(templateId));
+  store<std::uint16_t>(buffer + 4, kSchemaId);
+  store<std::uint16_t>(buffer + 6, kSchemaVersion);
+  return buffer + MessageHeader::kSize;
+}
+
+} // namespace
+
+size_t encodeNewOrder(char *buffer, std::uint32_t traderIndex,
+                      SymbolId symbolId, Side side, OrderStyle style,
+                      Price price, Price triggerPrice, Quantity quantity) {
+  auto block = encodeHeader(buffer, NewOrderView::kTemplateId,
+                            NewOrderView::kBlockLength);
+  store<std::uint32_t>(block, traderIndex);
+  store<SymbolId>(block + 4, symbolId);
+  store<std::int64_t>(block + 8, price.units());
+  store<std::int64_t>(block + 16, triggerPrice.units());
+  store<std::uint64_t>(block + 24, quantity);
+  store<std::uint8_t>(block + 32, static_cast<std::uint8_t>(side));
+  store<std::uint8_t>(block + 33, static_cast<std::uint8_t>(style));
+  return MessageHeader::kSize + NewOrderView::kBlockLength;
+}
+
+size_t encodeCancel(char *buffer, std::uint32_t traderIndex,
+                    SymbolId symbolId, OrderId orderId) {
+  auto block =
+      encodeHeader(buffer, CancelView::kTemplateId, CancelView::kBlockLength);
+  store<std::uint32_t>(block, traderIndex);
+  store<SymbolId>(block + 4, symbolId);
+  store<std::uint64_t>(block + 8, orderId);
+  return MessageHeader::kSize + CancelView::kBlockLength;
+}
+
+size_t encodeAmend(char *buffer, std::uint32_t traderIndex, SymbolId symbolId,
+                   OrderId orderId, Price price, Quantity quantity) {
+  auto block =
+      encodeHeader(buffer, AmendView::kTemplateId, AmendView::kBlockLength);
+  store<std::uint32_t>(block, traderIndex);
+  store<SymbolId>(block + 4, symbolId);
+  store<std::uint64_t>(block + 8, orderId);
+  store<std::int64_t>(block + 16, price.units());
+  store<std::uint64_t>(block + 24, quantity);
+  return MessageHeader::kSize + AmendView::kBlockLength;
+}
+
+size_t encodeMassCancel(char *buffer, std::uint32_t traderIndex,
+                        SymbolId symbolId, std::uint8_t side) {
+  auto block = encodeHeader(buffer, MassCancelView::kTemplateId,
+                            MassCancelView::kBlockLength);
+  store<std::uint32_t>(block, traderIndex);
+  store<SymbolId>(block + 4, symbolId);
+  store<std::uint8_t>(block + 8, side);
+  return MessageHeader::kSize + MassCancelView::kBlockLength;
+}
+
+size_t encodeExecutionReport(char *buffer, OrderId orderId,
+                             std::uint64_t requestSeqNum,
+                             std::uint64_t seqNum, Price price,
+                             Quantity quantity, std::uint32_t traderIndex,
+                             SymbolId symbolId, ExecType execType, Side side,
+                             std::uint8_t reason) {
+  auto block = encodeHeader(buffer, ExecutionReportView::kTemplateId,
+                            ExecutionReportView::kBlockLength);
+  store<std::uint64_t>(block, orderId);
+  store<std::uint64_t>(block + 8, requestSeqNum);
+  store<std::uint64_t>(block + 16, seqNum);
+  store<std::int64_t>(block + 24, price.units());
+  store<std::uint64_t>(block + 32, quantity);
+  store<std::uint32_t>(block + 40, traderIndex);
+  store<SymbolId>(block + 44, symbolId);
+  store<std::uint8_t>(block + 48, static_cast<std::uint8_t>(execType));
+  store<std::uint8_t>(block + 49, static_cast<std::uint8_t>(side));
+  store<std::uint8_t>(block + 50, reason);
+  return MessageHeader::kSize + ExecutionReportView::kBlockLength;
+}
+
+size_t encodeFrame(char *buffer, size_t messageSize) {
+  auto frameSize = FrameHeader::kSize + messageSize;
+  store<std::uint32_t>(buffer, static_cast<std::uint32_t>(frameSize));
+  store<std::uint16_t>(buffer + 4, FrameHeader::kSbeEncoding);
+  return frameSize;
+}
+
+} // namespace BinaryProtocol
@@ -0,0 +1,398 @@
+#ifndef BINARY_PROTOCOL
+#define BINARY_PROTOCOL
+#include <core/order/order.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <types.h>
+
+using namespace Common;
+using namespace Core;
+
+/**
+ * @brief
+ * A fixed-layout binary order entry protocol in the style of SBE. Every
+ * message is an 8 bytes header followed by a root block of fixed size, all
+ * the fields are little-endian at fixed offsets. A field is read in place
+ * from the receive buffer when it is accessed, nothing is copied or
+ * allocated by the decoder. The host is assumed to be little-endian.
+ *
+ * The trader is an index into the traders of the session and the symbol is
+ * the dense symbol id of the engine, so no TraderId or Symbol string is built
+ * per message.
+ *
+ * On a stream the messages are framed by the Simple Open Framing Header: the
+ * size of the frame, header included, and the SBE encoding type.
+ */
+namespace BinaryProtocol {
+
+constexpr std::uint16_t kSchemaId = 1;
+constexpr std::uint16_t kSchemaVersion = 1;
+
+// the mass cancel of every symbol of the trader
+constexpr SymbolId kAllSymbols = 0xFFFFFFFF;
+// the mass cancel of both sides
+constexpr std::uint8_t kBothSides = 0xFF;
+
+enum class TemplateId : std::uint16_t {
+  NEW_ORDER = 1,
+  CANCEL = 2,
+  AMEND = 3,
+  MASS_CANCEL = 4,
+  EXECUTION_REPORT = 5,
+};
+
+// the notification of an ExecutionReport
+enum class ExecType : std::uint8_t {
+  NEW,
+  FILL,
+  CANCEL,
+  CANCEL_REJECT,
+  AMEND,
+  AMEND_REJECT,
+  TRIGGER,
+  REJECT,
+};
+
+template <typename T> T load(const char *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+template <typename T> void store(char *data, T value) {
+  std::memcpy(data, &value, sizeof(T));
+}
+
+/**
+ * @brief
+ * blockLength: the size of the root block following the header
+ * templateId: the type of the message
+ * schemaId, version: the schema of the message
+ */
+class MessageHeader {
+public:
+  static constexpr size_t kSize = 8;
+
+  explicit MessageHeader(const char *data) : mData(data) {}
+
+  std::uint16_t blockLength() const { return load<std::uint16_t>(mData); }
+  TemplateId templateId() const {
+    return static_cast<TemplateId>(load<std::uint16_t>(mData + 2));
+  }
+  std::uint16_t schemaId() const { return load<std::uint16_t>(mData + 4); }
+  std::uint16_t version() const { return load<std::uint16_t>(mData + 6); }
+
+private:
+  const char *mData;
+};
+
+/**
+ * @brief
+ * traderIndex: u32, the index of the trader in the session
+ * symbolId: u32
+ * price: i64, the limit price, 0 for a market or a stop order
+ * triggerPrice: i64, the trigger price of a stop or stop-limit order
+ * quantity: u64
+ * side: u8, the Side
+ * style: u8, the OrderStyle
+ */
+class NewOrderView {
+public:
+  static constexpr TemplateId kTemplateId = TemplateId::NEW_ORDER;
+  static constexpr std::uint16_t kBlockLength = 40;
+
+  explicit NewOrderView(const char *data) : mData(data) {}
+
+  std::uint32_t traderIndex() const { return load<std::uint32_t>(mData); }
+  SymbolId symbolId() const { return load<SymbolId>(mData + 4); }
+  Price price() const { return load<std::int64_t>(mData + 8); }
+  Price triggerPrice() const { return load<std::int64_t>(mData + 16); }
+  Quantity quantity() const { return load<std::uint64_t>(mData + 24); }
+  std::uint8_t side() const { return load<std::uint8_t>(mData + 32); }
+  std::uint8_t style() const { return load<std::uint8_t>(mData + 33); }
+
+private:
+  const char *mData;
+};
+
+/**
+ * @brief
+ * traderIndex: u32
+ * symbolId: u32
+ * orderId: u64
+ */
+class CancelView {
+public:
+  static constexpr TemplateId kTemplateId = TemplateId::CANCEL;
+  static constexpr std::uint16_t kBlockLength = 16;
+
+  explicit CancelView(const char *data) : mData(data) {}
+
+  std::uint32_t traderIndex() const { return load<std::uint32_t>(mData); }
+  SymbolId symbolId() const { return load<SymbolId>(mData + 4); }
+  OrderId orderId() const { return load<std::uint64_t>(mData + 8); }
+
+private:
+  const char *mData;
+};
+
+/**
+ * @brief
+ * traderIndex: u32
+ * symbolId: u32
+ * orderId: u64
+ * price: i64, the new price
+ * quantity: u64, the new quantity
+ */
+class AmendView {
+public:
+  static constexpr TemplateId kTemplateId = TemplateId::AMEND;
+  static constexpr std::uint16_t kBlockLength = 32;
+
+  explicit AmendView(const char *data) : mData(data) {}
+
+  std::uint32_t traderIndex() const { return load<std::uint32_t>(mData); }
+  SymbolId symbolId() const { return load<SymbolId>(mData + 4); }
+  OrderId orderId() const { return load<std::uint64_t>(mData + 8); }
+  Price price() const { return load<std::int64_t>(mData + 16); }
+  Quantity quantity() const { return load<std::uint64_t>(mData + 24); }
+
+private:
+  const char *mData;
+};
+
+/**
+ * @brief
+ * traderIndex: u32
+ * symbolId: u32, kAllSymbols for every symbol
+ * side: u8, the Side or kBothSides, only both sides are cancelled on every
+ * symbol
+ */
+class MassCancelView {
+public:
+  static constexpr TemplateId kTemplateId = TemplateId::MASS_CANCEL;
+  static constexpr std::uint16_t kBlockLength = 16;
+
+  explicit MassCancelView(const char *data) : mData(data) {}
+
+  std::uint32_t traderIndex() const { return load<std::uint32_t>(mData); }
+  SymbolId symbolId() const { return load<SymbolId>(mData + 4); }
+  std::uint8_t side() const { return load<std::uint8_t>(mData + 8); }
+
+private:
+  const char *mData;
+};
+
+/**
+ * @brief
+ * orderId: u64
+ * requestSeqNum: u64, the sequence number of the message of the session the
+ * report answers, 0 if it is not an answer, e.g. the fill of a resting order
+ * seqNum: u64, the sequence number of the report in the session
+ * price: i64, the fill price, or the price of the order
+ * quantity: u64, the fill quantity, or the quantity of the order
+ * traderIndex: u32
+ * symbolId: u32, kAllSymbols if the symbol is not known
+ * execType: u8, the ExecType
+ * side: u8, the Side
+ * reason: u8, the OrderCancelReason or the OrderRejectReason
+ */
+class ExecutionReportView {
+public:
+  static constexpr TemplateId kTemplateId = TemplateId::EXECUTION_REPORT;
+  static constexpr std::uint16_t kBlockLength = 56;
+
+  explicit ExecutionReportView(const char *data) : mData(data) {}
+
+  OrderId orderId() const { return load<std::uint64_t>(mData); }
+  std::uint64_t requestSeqNum() const {
+    return load<std::uint64_t>(mData + 8);
+  }
+  std::uint64_t seqNum() const { return load<std::uint64_t>(mData + 16); }
+  Price price() const { return load<std::int64_t>(mData + 24); }
+  Quantity quantity() const { return load<std::uint64_t>(mData + 32); }
+  std::uint32_t traderIndex() const { return load<std::uint32_t>(mData + 40); }
+  SymbolId symbolId() const { return load<SymbolId>(mData + 44); }
+  ExecType execType() const {
+    return static_cast<ExecType>(load<std::uint8_t>(mData + 48));
+  }
+  std::uint8_t side() const { return load<std::uint8_t>(mData + 49); }
+  std::uint8_t reason() const { return load<std::uint8_t>(mData + 50); }
+
+private:
+  const char *mData;
+};
+
+/**
+ * @brief
+ * messageLength: u32, the size of the frame, this header included
+ * encodingType: u16, kSbeEncoding
+ */
+class FrameHeader {
+public:
+  static constexpr size_t kSize = 6;
+  static constexpr std::uint16_t kSbeEncoding = 0x5BE0;
+  // a larger frame is a corrupted stream
+  static constexpr std::uint32_t kMaxMessageLength = 64 * 1024;
+
+  explicit FrameHeader(const char *data) : mData(data) {}
+
+  std::uint32_t messageLength() const { return load<std::uint32_t>(mData); }
+  std::uint16_t encodingType() const {
+    return load<std::uint16_t>(mData + 4);
+  }
+
+private:
+  const char *mData;
+};
+
+/**
+ * @brief
+ * Decode the complete messages at the front of the buffer and pass a view of
+ * each to the handler: onNewOrder, onCancel, onAmend, onMassCancel or
+ * onExecutionReport. The views point into the buffer and are only valid
+ * during the call. A message of another schema, of an unknown template or
+ * with a block shorter than its template is skipped, a longer block is
+ * accepted so that fields can be appended to a template.
+ * return the number of bytes consumed, the bytes of an incomplete message at
+ * the end are left for the next call
+ */
+template <typename Handler>
+size_t decode(const char *data, size_t size, Handler &handler) {
+  size_t offset = 0;
+  while (size - offset >= MessageHeader::kSize) {
+    MessageHeader header(data + offset);
+    size_t messageSize = MessageHeader::kSize + header.blockLength();
+    if (size - offset < messageSize) {
+      break;
+    }
+
+    const char *block = data + offset + MessageHeader::kSize;
+    auto blockLength = header.blockLength();
+    offset += messageSize;
+    if (header.schemaId() != kSchemaId) {
+      continue;
+    }
+
+    switch (header.templateId()) {
+    case TemplateId::NEW_ORDER:
+      if (blockLength >= NewOrderView::kBlockLength) {
+        handler.onNewOrder(NewOrderView(block));
+      }
+      break;
+    case TemplateId::CANCEL:
+      if (blockLength >= CancelView::kBlockLength) {
+        handler.onCancel(CancelView(block));
+      }
+      break;
+    case TemplateId::AMEND:
+      if (blockLength >= AmendView::kBlockLength) {
+        handler.onAmend(AmendView(block));
+      }
+      break;
+    case TemplateId::MASS_CANCEL:
+      if (blockLength >= MassCancelView::kBlockLength) {
+        handler.onMassCancel(MassCancelView(block));
+      }
+      break;
+    case TemplateId::EXECUTION_REPORT:
+      if (blockLength >= ExecutionReportView::kBlockLength) {
+        handler.onExecutionReport(ExecutionReportView(block));
+      }
+      break;
+    }
+  }
+  return offset;
+}
+
+/**
+ * @brief
+ * Decode the frame at the front of the buffer, if it is complete, the
+ * messages of the frame go to the handler as with decode().
+ * return the size of the frame, 0 if it is incomplete, or std::nullopt if it
+ * is not SBE or has an invalid length: the stream cannot be resynchronized
+ */
+template <typename Handler>
+std::optional<size_t> decodeFrame(const char *data, size_t size,
+                                  Handler &handler) {
+  if (size < FrameHeader::kSize) {
+    return 0;
+  }
+  FrameHeader header(data);
+  auto messageLength = header.messageLength();
+  if (header.encodingType() != FrameHeader::kSbeEncoding ||
+      messageLength < FrameHeader::kSize + MessageHeader::kSize ||
+      messageLength > FrameHeader::kMaxMessageLength) {
+    return std::nullopt;
+  }
+  if (size < messageLength) {
+    return 0;
+  }
+
+  decode(data + FrameHeader::kSize, messageLength - FrameHeader::kSize,
+         handler);
+  return messageLength;
+}
+
+/**
+ * @brief
+ * Decode the complete frames at the front of the buffer as with
+ * decodeFrame()
+ * return the number of bytes consumed, or std::nullopt if a frame is not
+ * SBE or has an invalid length: the stream cannot be resynchronized
+ */
+template <typename Handler>
+std::optional<size_t> decodeFrames(const char *data, size_t size,
+                                   Handler &handler) {
+  size_t offset = 0;
+  while (true) {
+    auto frameSize = decodeFrame(data + offset, size - offset, handler);
+    if (!frameSize) {
+      return std::nullopt;
+    }
+    if (*frameSize == 0) {
+      return offset;
+    }
+    offset += *frameSize;
+  }
+}
+
+/**
+ * @brief
+ * Write the messages, mainly for the clients and the tests. The buffer holds
+ * at least the size of the message.
+ * return the size of the message
+ */
+size_t encodeNewOrder(char *buffer, std::uint32_t traderIndex,
+                      SymbolId symbolId, Side side, OrderStyle style,
+                      Price price, Price triggerPrice, Quantity quantity);
+size_t encodeCancel(char *buffer, std::uint32_t traderIndex,
+                    SymbolId symbolId, OrderId orderId);
+size_t encodeAmend(char *buffer, std::uint32_t traderIndex, SymbolId symbolId,
+                   OrderId orderId, Price price, Quantity quantity);
+size_t encodeMassCancel(char *buffer, std::uint32_t traderIndex,
+                        SymbolId symbolId, std::uint8_t side);
+size_t encodeExecutionReport(char *buffer, OrderId orderId,
+                             std::uint64_t requestSeqNum,
+                             std::uint64_t seqNum, Price price,
+                             Quantity quantity, std::uint32_t traderIndex,
+                             SymbolId symbolId, ExecType execType, Side side,
+                             std::uint8_t reason);
+
+/**
+ * @brief
+ * Write the frame header in front of a message of the size, the message
+ * starts at buffer + FrameHeader::kSize
+ * return the size of the frame
+ */
+size_t encodeFrame(char *buffer, size_t messageSize);
+
+// the largest frame written by the encoders
+constexpr size_t kMaxFrameSize = FrameHeader::kSize + MessageHeader::kSize +
+                                 ExecutionReportView::kBlockLength;
+
+} // namespace BinaryProtocol
+
+#endif
@@ -0,0 +1,223 @@
+#include "fix_protocol.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace Fix {
+
+namespace {
+
+constexpr std::string_view kPrefix = "8=FIX.4.4\x01"
+                                     "9=";
+// "10=" 3 digits and the SOH
+constexpr size_t kTrailerSize = 7;
+constexpr std::uint64_t kMaxBodyLength = 8192;
+// the digits of the longest valid BodyLength
+constexpr size_t kMaxBodyLengthDigits = 4;
+
+unsigned checksum(const char *data, size_t size) {
+  unsigned sum = 0;
+  for (size_t i = 0; i < size; i++) {
+    sum += static_cast<unsigned char>(data[i]);
+  }
+  return sum;
+}
+
+// the start of the next message, or the end of the text if there is none
+size_t resync(std::string_view text, size_t from) {
+  auto pos = text.find("\x01" "8=", from);
+  return pos == std::string_view::npos ? text.size() : pos + 1;
+}
+
+} // namespace
+
+bool parseUnsigned(std::string_view text, std::uint64_t &value) {
+  if (text.empty()) {
+    return false;
+  }
+  auto end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, value);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+ParseStatus parse(const char *data, size_t size, FixMessage &message,
+                  size_t &consumed) {
+  message.clear();
+  consumed = 0;
+  std::string_view text(data, size);
+
+  auto prefixSize = std::min(size, kPrefix.size());
+  if (text.substr(0, prefixSize) != kPrefix.substr(0, prefixSize)) {
+    consumed = resync(text, 0);
+    return ParseStatus::MALFORMED;
+  }
+  if (size == prefixSize) {
+    return ParseStatus::INCOMPLETE;
+  }
+
+  auto lengthEnd = text.find(kSoh, kPrefix.size());
+  if (lengthEnd == std::string_view::npos) {
+    if (size - kPrefix.size() > kMaxBodyLengthDigits) {
+      consumed = resync(text, kPrefix.size());
+      return ParseStatus::MALFORMED;
+    }
+    return ParseStatus::INCOMPLETE;
+  }
+
+  std::uint64_t bodyLength = 0;
+  if (!parseUnsigned(text.substr(kPrefix.size(), lengthEnd - kPrefix.size()),
+                     bodyLength) ||
+      bodyLength > kMaxBodyLength) {
+    consumed = resync(text, lengthEnd);
+    return ParseStatus::MALFORMED;
+  }
+
+  size_t bodyStart = lengthEnd + 1;
+  size_t trailer = bodyStart + bodyLength;
+  if (size < trailer + kTrailerSize) {
+    return ParseStatus::INCOMPLETE;
+  }
+  consumed = trailer + kTrailerSize;
+
+  // split the body into fields and sum it in the same pass
+  unsigned sum = checksum(data, bodyStart);
+  size_t tagStart = bodyStart;
+  size_t valueStart = 0;
+  bool isValid = bodyLength > 0 && data[trailer - 1] == kSoh;
+  for (size_t i = bodyStart; i < trailer && isValid; i++) {
+    auto c = data[i];
+    sum += static_cast<unsigned char>(c);
+    if (c == '=' && !valueStart) {
+      valueStart = i + 1;
+    } else if (c == kSoh) {
+      std::uint64_t tag = 0;
+      isValid = valueStart &&
+                parseUnsigned(text.substr(tagStart, valueStart - 1 - tagStart),
+                              tag) &&
+                message.add(static_cast<int>(tag),
+                            text.substr(valueStart, i - valueStart));
+      tagStart = i + 1;
+      valueStart = 0;
+    }
+  }
+
+  std::uint64_t expected = 0;
+  if (!isValid || text.substr(trailer, 3) != "10=" ||
+      text[consumed - 1] != kSoh ||
+      !parseUnsigned(text.substr(trailer + 3, 3), expected) ||
+      expected != sum % 256) {
+    message.clear();
+    return ParseStatus::MALFORMED;
+  }
+
+  return ParseStatus::OK;
+}
+
+FixWriter::FixWriter(std::string_view senderCompId,
+                     std::string_view targetCompId) {
+  // written behind the MsgType, the MsgSeqNum value follows
+  std::string_view fields[] = {"49=", senderCompId, "\x01", "56=",
+                               targetCompId, "\x01", "34="};
+  for (auto field : fields) {
+    auto size = std::min(field.size(),
+                         mSessionFields.size() - mSessionFieldsSize);
+    std::memcpy(mSessionFields.data() + mSessionFieldsSize, field.data(),
+                size);
+    mSessionFieldsSize += size;
+  }
+}
+
+void FixWriter::begin(char msgType, std::uint64_t seqNum) {
+  mEnd = kHeaderSize;
+  mIsFieldCut = false;
+  mHasOverflowed = false;
+  const char msgTypeField[] = {'3', '5', '=', msgType, kSoh};
+  append(msgTypeField, sizeof(msgTypeField));
+  append(mSessionFields.data(), mSessionFieldsSize);
+
+  char digits[20];
+  auto result = std::to_chars(digits, digits + sizeof(digits), seqNum);
+  append(digits, result.ptr - digits);
+  append(&kSoh, 1);
+  endField(kHeaderSize);
+}
+
+void FixWriter::add(int tag, std::string_view value) {
+  auto start = mEnd;
+  appendTag(tag);
+  append(value.data(), value.size());
+  append(&kSoh, 1);
+  endField(start);
+}
+
+void FixWriter::add(int tag, char value) {
+  auto start = mEnd;
+  appendTag(tag);
+  append(&value, 1);
+  append(&kSoh, 1);
+  endField(start);
+}
+
+void FixWriter::add(int tag, std::uint64_t value) {
+  auto start = mEnd;
+  appendTag(tag);
+  char digits[20];
+  auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  append(digits, result.ptr - digits);
+  append(&kSoh, 1);
+  endField(start);
+}
+
+void FixWriter::add(int tag, Price price, unsigned scale) {
+  auto start = mEnd;
+  appendTag(tag);
+  char digits[Price::kMaxFormattedSize];
+  append(digits, price.format(digits, scale));
+  append(&kSoh, 1);
+  endField(start);
+}
+
+std::string_view FixWriter::finish() {
+  char header[kHeaderSize];
+  std::memcpy(header, kPrefix.data(), kPrefix.size());
+  auto result = std::to_chars(header + kPrefix.size(), header + kHeaderSize,
+                              mEnd - kHeaderSize);
+  *result.ptr = kSoh;
+  size_t headerSize = result.ptr + 1 - header;
+  mStart = kHeaderSize - headerSize;
+  std::memcpy(mBuffer.data() + mStart, header, headerSize);
+
+  auto sum = checksum(mBuffer.data() + mStart, mEnd - mStart) % 256;
+  const char trailer[] = {'1', '0', '=', static_cast<char>('0' + sum / 100),
+                          static_cast<char>('0' + sum / 10 % 10),
+                          static_cast<char>('0' + sum % 10), kSoh};
+  std::memcpy(mBuffer.data() + mEnd, trailer, sizeof(trailer));
+  return std::string_view(mBuffer.data() + mStart,
+                          mEnd + sizeof(trailer) - mStart);
+}
+
+void FixWriter::append(const char *data, size_t size) {
+  if (mIsFieldCut || size > mBuffer.size() - kTrailerSize - mEnd) {
+    mIsFieldCut = true;
+    return;
+  }
+  std::memcpy(mBuffer.data() + mEnd, data, size);
+  mEnd += size;
+}
+
+void FixWriter::endField(size_t start) {
+  if (mIsFieldCut) {
+    mEnd = start;
+    mIsFieldCut = false;
+    mHasOverflowed = true;
+  }
+}
+
+void FixWriter::appendTag(int tag) {
+  char digits[12];
+  auto result = std::to_chars(digits, digits + sizeof(digits), tag);
+  *result.ptr++ = '=';
+  append(digits, result.ptr - digits);
+}
+
+} // namespace Fix
@@ -0,0 +1,166 @@
+#ifndef FIX_PROTOCOL
+#define FIX_PROTOCOL
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <types.h>
+#include <utility>
+
+using namespace Common;
+
+/**
+ * @brief
+ * A FIX 4.4 tag=value codec. The parser splits a message into views of its
+ * fields in a single pass over the receive buffer, nothing is copied or
+ * allocated. The writer fills a fixed buffer whose constant fields are
+ * written once per session.
+ */
+namespace Fix {
+
+constexpr char kSoh = '\x01';
+constexpr std::string_view kBeginString = "FIX.4.4";
+
+namespace Tag {
+constexpr int kAccount = 1;
+constexpr int kAvgPx = 6;
+constexpr int kBeginString = 8;
+constexpr int kBodyLength = 9;
+constexpr int kCheckSum = 10;
+constexpr int kClOrdId = 11;
+constexpr int kCumQty = 14;
+constexpr int kExecId = 17;
+constexpr int kLastPx = 31;
+constexpr int kLastQty = 32;
+constexpr int kMsgSeqNum = 34;
+constexpr int kMsgType = 35;
+constexpr int kOrderId = 37;
+constexpr int kOrderQty = 38;
+constexpr int kOrdStatus = 39;
+constexpr int kOrdType = 40;
+constexpr int kOrigClOrdId = 41;
+constexpr int kPrice = 44;
+constexpr int kSenderCompId = 49;
+constexpr int kSide = 54;
+constexpr int kSymbol = 55;
+constexpr int kTargetCompId = 56;
+constexpr int kText = 58;
+constexpr int kTimeInForce = 59;
+constexpr int kStopPx = 99;
+constexpr int kExecType = 150;
+constexpr int kLeavesQty = 151;
+constexpr int kCxlRejResponseTo = 434;
+} // namespace Tag
+
+enum class ParseStatus { OK, INCOMPLETE, MALFORMED };
+
+/**
+ * @brief
+ * The fields of a parsed message, as views into the receive buffer. They are
+ * valid as long as the buffer is.
+ */
+class FixMessage {
+public:
+  static constexpr size_t kMaxFields = 64;
+
+  void clear() { mSize = 0; }
+
+  bool add(int tag, std::string_view value) {
+    if (mSize == kMaxFields) {
+      return false;
+    }
+    mFields[mSize++] = {tag, value};
+    return true;
+  }
+
+  // the value of the first field with the tag, empty if there is none
+  std::string_view get(int tag) const {
+    for (size_t i = 0; i < mSize; i++) {
+      if (mFields[i].first == tag) {
+        return mFields[i].second;
+      }
+    }
+    return {};
+  }
+
+  std::string_view getMsgType() const { return get(Tag::kMsgType); }
+
+  size_t size() const { return mSize; }
+
+private:
+  std::array<std::pair<int, std::string_view>, kMaxFields> mFields;
+  size_t mSize = 0;
+};
+
+/**
+ * @brief
+ * Parse the message at the front of the buffer. The BeginString, BodyLength
+ * and CheckSum fields are checked and not stored.
+ * return OK and the size of the message in consumed if it is valid,
+ * INCOMPLETE if the buffer ends before the message does, MALFORMED and the
+ * number of bytes to skip in consumed otherwise
+ */
+ParseStatus parse(const char *data, size_t size, FixMessage &message,
+                  size_t &consumed);
+
+/**
+ * @brief
+ * Read a non-negative integer
+ * return false if the text is not made of digits only or overflows
+ */
+bool parseUnsigned(std::string_view text, std::uint64_t &value);
+
+/**
+ * @brief
+ * Write the messages of a session. The SenderCompID and the TargetCompID are
+ * written once, a message is started with begin(), its fields are appended
+ * and finish() writes the BeginString, the BodyLength in front of the body
+ * and the CheckSum behind it. A field that does not fit in the buffer is left
+ * out whole, so the message stays well formed, and the message is marked as
+ * overflowed.
+ */
+class FixWriter {
+public:
+  static constexpr size_t kMaxMessageSize = 1024;
+
+  FixWriter(std::string_view senderCompId, std::string_view targetCompId);
+
+  void begin(char msgType, std::uint64_t seqNum);
+
+  void add(int tag, std::string_view value);
+  void add(int tag, char value);
+  void add(int tag, std::uint64_t value);
+  // the price as a decimal with the scale of the symbol
+  void add(int tag, Price price, unsigned scale);
+
+  /**
+   * @brief
+   * return a view of the complete message, valid until the next begin()
+   */
+  std::string_view finish();
+
+  // a field of the message since begin() was left out
+  bool hasOverflowed() const { return mHasOverflowed; }
+
+private:
+  // room for the BeginString and the BodyLength in front of the body
+  static constexpr size_t kHeaderSize = 32;
+
+  void append(const char *data, size_t size);
+  void appendTag(int tag);
+  // drop the field started at the offset if it did not fit
+  void endField(size_t start);
+
+  std::array<char, kMaxMessageSize> mBuffer;
+  // the constant fields following the MsgType
+  std::array<char, 256> mSessionFields;
+  size_t mSessionFieldsSize = 0;
+  size_t mStart = kHeaderSize;
+  size_t mEnd = kHeaderSize;
+  bool mIsFieldCut = false;
+  bool mHasOverflowed = false;
+};
+
+} // namespace Fix
+
+#endif
@@ -0,0 +1,551 @@
+#ifndef FIX_SESSION
+#define FIX_SESSION
+#include "fix_protocol.h"
+#include <algorithm>
+#include <core/execution_context/execution_context.h>
+#include <core/execution_context/execution_listener.h>
+#include <core/order/order.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <types.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+/**
+ * @brief
+ * A FIX 4.4 order entry session in front of a matching engine. It executes
+ * the NewOrderSingle (D), OrderCancelRequest (F) and OrderCancelReplaceRequest
+ * (G) messages and answers with ExecutionReport (8) and OrderCancelReject (9)
+ * messages built from the notifications of the ExecutionContext, it is the
+ * listener of the context while it lives. The other messages, including the
+ * session level ones, are ignored.
+ *
+ * The trader is the Account (1) of the message and is added to the session
+ * beforehand. The messages are parsed in place and the trader and the symbol
+ * are looked up by view, only the ClOrdID of a new order is stored to answer
+ * the later requests on it. The outgoing messages are appended to the output
+ * until the caller sends it.
+ */
+template <typename Engine> class FixSession : public ExecutionListener {
+public:
+  FixSession(Engine &engine, ExecutionContext &context,
+             std::string_view senderCompId, std::string_view targetCompId)
+      : mEngine(engine), mContext(context),
+        mWriter(senderCompId, targetCompId) {
+    mContext.setListener(this);
+  }
+
+  ~FixSession() override { mContext.setListener(nullptr); }
+
+  FixSession(const FixSession &other) = delete;
+  FixSession &operator=(const FixSession &) = delete;
+  FixSession(FixSession &&other) = delete;
+  FixSession &operator=(FixSession &&other) = delete;
+
+  void addTrader(const TraderId &traderId) {
+    auto it = std::lower_bound(mTraders.begin(), mTraders.end(), traderId);
+    if (it == mTraders.end() || *it != traderId) {
+      mTraders.insert(it, traderId);
+    }
+  }
+
+  /**
+   * @brief
+   * Execute the complete messages at the front of the buffer, a malformed
+   * message is skipped
+   * return the number of bytes consumed
+   */
+  size_t onData(const char *data, size_t size) {
+    size_t offset = 0;
+    while (offset < size) {
+      size_t consumed = 0;
+      auto status =
+          Fix::parse(data + offset, size - offset, mMessage, consumed);
+      if (status == Fix::ParseStatus::INCOMPLETE) {
+        break;
+      }
+
+      offset += consumed;
+      if (status == Fix::ParseStatus::OK) {
+        onMessage(mMessage);
+      }
+    }
+    return offset;
+  }
+
+  // the messages to send since the last clearOutput()
+  const std::string &getOutput() const { return mOutput; }
+  void clearOutput() { mOutput.clear(); }
+
+  void onOpen(const TraderId &traderId, OrderId orderId, const Symbol &, Side,
+              OrderStyle, Price, Quantity) override {
+    auto order = track(traderId, orderId);
+    if (order) {
+      beginExecutionReport(orderId, *order, order->mClOrdId, '0',
+                           getOrdStatus(*order));
+      send();
+    }
+  }
+
+  void onFill(const TraderId &traderId, OrderId orderId, const Symbol &, Side,
+              OrderStyle, Price price, Quantity quantity) override {
+    auto order = track(traderId, orderId);
+    if (!order) {
+      return;
+    }
+
+    order->mCumQty += quantity;
+    order->mNotional += price.notional(quantity);
+    beginExecutionReport(orderId, *order, order->mClOrdId, 'F',
+                         getOrdStatus(*order));
+    mWriter.add(Fix::Tag::kLastQty, quantity);
+    mWriter.add(Fix::Tag::kLastPx, price, getScale(*order));
+    send();
+
+    if (order->mCumQty >= order->mOrderQty) {
+      untrack(orderId);
+    }
+  }
+
+  void onCancel(const TraderId &traderId, OrderId orderId, const Symbol &,
+                Side, OrderStyle, Price, Quantity,
+                OrderCancelReason rsn) override {
+    auto order = track(traderId, orderId);
+    if (!order) {
+      return;
+    }
+
+    if (orderId == mRequestOrderId) {
+      beginExecutionReport(orderId, *order, mRequestClOrdId, '4', '4');
+      mWriter.add(Fix::Tag::kOrigClOrdId, order->mClOrdId);
+    } else {
+      beginExecutionReport(orderId, *order, order->mClOrdId, '4', '4');
+      mWriter.add(Fix::Tag::kText, orderCancelReason2Str(rsn));
+    }
+    send();
+    untrack(orderId);
+  }
+
+  void onCancelReject(const TraderId &, OrderId orderId) override {
+    sendCancelReject(orderId, '1');
+  }
+
+  void onAmend(const TraderId &, OrderId orderId, const Symbol &, Side,
+               Price price, Quantity quantity) override {
+    auto order = find(orderId);
+    if (!order) {
+      return;
+    }
+
+    std::string origClOrdId = order->mClOrdId;
+    order->mPrice = price;
+    order->mOrderQty = order->mCumQty + quantity;
+    if (orderId == mRequestOrderId) {
+      // the order is known by the ClOrdID of the replace request from now on
+      mClOrdIds.erase(std::string_view(order->mClOrdId));
+      order->mClOrdId = mRequestClOrdId;
+      mClOrdIds[std::string_view(order->mClOrdId)] = orderId;
+    }
+
+    beginExecutionReport(orderId, *order, order->mClOrdId, '5',
+                         getOrdStatus(*order));
+    mWriter.add(Fix::Tag::kOrigClOrdId, origClOrdId);
+    send();
+  }
+
+  void onAmendReject(const TraderId &, OrderId orderId) override {
+    sendCancelReject(orderId, '2');
+  }
+
+  void onTrigger(const TraderId &, OrderId orderId, const Symbol &, Side,
+                 OrderStyle, Price, Quantity) override {
+    auto order = find(orderId);
+    if (order) {
+      beginExecutionReport(orderId, *order, order->mClOrdId, 'L',
+                           getOrdStatus(*order));
+      send();
+    }
+  }
+
+  void onReject(const TraderId &traderId, OrderId orderId, const Symbol &,
+                Side, OrderStyle, Price, Quantity,
+                OrderRejectReason rsn) override {
+    auto order = track(traderId, orderId);
+    if (!order) {
+      return;
+    }
+
+    beginExecutionReport(orderId, *order, order->mClOrdId, '8', '8');
+    mWriter.add(Fix::Tag::kText, orderRejectReason2Str(rsn));
+    send();
+    untrack(orderId);
+  }
+
+private:
+  // a new order of the session, from the NewOrderSingle until it is closed
+  struct FixOrder {
+    std::string mClOrdId;
+    SymbolId mSymbolId = 0;
+    Side mSide = Side::BUY;
+    Price mPrice;
+    Quantity mOrderQty = 0;
+    Quantity mCumQty = 0;
+    // the sum of the price times the quantity of the fills
+    std::int64_t mNotional = 0;
+  };
+
+  static constexpr size_t kMaxClOrdIdSize = 64;
+  // the longest field of a request echoed in a reject
+  static constexpr size_t kMaxEchoedSize = kMaxClOrdIdSize;
+  static constexpr std::string_view kUnknownOrderId = "NONE";
+
+  void onMessage(const Fix::FixMessage &message) {
+    auto msgType = message.getMsgType();
+    if (msgType == "D") {
+      onNewOrderSingle(message);
+    } else if (msgType == "F" || msgType == "G") {
+      onCancelOrReplace(message, msgType == "G");
+    }
+  }
+
+  void onNewOrderSingle(const Fix::FixMessage &message) {
+    auto clOrdId = message.get(Fix::Tag::kClOrdId);
+    auto traderId = findTrader(message.get(Fix::Tag::kAccount));
+    auto symbolId = findSymbol(message.get(Fix::Tag::kSymbol));
+    auto side = message.get(Fix::Tag::kSide);
+    auto ordType = message.get(Fix::Tag::kOrdType);
+    if (clOrdId.empty() || clOrdId.size() > kMaxClOrdIdSize) {
+      sendReject(message, "INVALID CLORDID");
+      return;
+    } else if (mClOrdIds.find(clOrdId) != mClOrdIds.end()) {
+      sendReject(message, "DUPLICATE CLORDID");
+      return;
+    } else if (!traderId) {
+      sendReject(message, "UNKNOWN ACCOUNT");
+      return;
+    } else if (!symbolId) {
+      sendReject(message, "UNKNOWN SYMBOL");
+      return;
+    } else if (side != "1" && side != "2") {
+      sendReject(message, "UNSUPPORTED SIDE");
+      return;
+    }
+
+    FixOrder order;
+    order.mSymbolId = *symbolId;
+    order.mSide = side == "1" ? Side::BUY : Side::SELL;
+    auto insertOrder = getInsert(order.mSide, ordType,
+                                 message.get(Fix::Tag::kTimeInForce));
+    auto scale = getScale(order);
+    Price stopPx;
+    if (!insertOrder) {
+      sendReject(message, "UNSUPPORTED ORDER TYPE");
+      return;
+    } else if (!Fix::parseUnsigned(message.get(Fix::Tag::kOrderQty),
+                                   order.mOrderQty)) {
+      sendReject(message, "INVALID QUANTITY");
+      return;
+    } else if ((ordType == "2" || ordType == "4") &&
+               !Price::parse(message.get(Fix::Tag::kPrice), scale,
+                             order.mPrice)) {
+      sendReject(message, "INVALID PRICE");
+      return;
+    } else if ((ordType == "3" || ordType == "4") &&
+               !Price::parse(message.get(Fix::Tag::kStopPx), scale, stopPx)) {
+      sendReject(message, "INVALID STOP PRICE");
+      return;
+    }
+
+    order.mClOrdId = clOrdId;
+    mPendingTraderId = traderId;
+    mPendingOrder = std::move(order);
+    insertOrder(*this, *traderId, mPendingOrder.mSymbolId, stopPx,
+                mPendingOrder.mPrice, mPendingOrder.mOrderQty);
+    mPendingTraderId = nullptr;
+  }
+
+  void onCancelOrReplace(const Fix::FixMessage &message, bool isReplace) {
+    auto clOrdId = message.get(Fix::Tag::kClOrdId);
+    auto origClOrdId = message.get(Fix::Tag::kOrigClOrdId);
+    auto traderId = findTrader(message.get(Fix::Tag::kAccount));
+    auto it = mClOrdIds.find(origClOrdId);
+    char responseTo = isReplace ? '2' : '1';
+    if (clOrdId.empty() || clOrdId.size() > kMaxClOrdIdSize || !traderId ||
+        it == mClOrdIds.end()) {
+      sendCancelReject(std::nullopt, clOrdId, origClOrdId, '8', responseTo);
+      return;
+    }
+
+    auto orderId = it->second;
+    auto &order = mOrders[orderId];
+    mRequestOrderId = orderId;
+    mRequestClOrdId = clOrdId;
+    if (mClOrdIds.find(clOrdId) != mClOrdIds.end()) {
+      // the ClOrdID of a live order of the session
+      sendCancelReject(orderId, responseTo);
+    } else if (!isReplace) {
+      mEngine.cancel(mContext, *traderId, order.mSymbolId, orderId);
+    } else {
+      Quantity orderQty = 0;
+      Price price;
+      if (!Fix::parseUnsigned(message.get(Fix::Tag::kOrderQty), orderQty) ||
+          orderQty <= order.mCumQty ||
+          !Price::parse(message.get(Fix::Tag::kPrice), getScale(order),
+                        price)) {
+        sendCancelReject(orderId, responseTo);
+      } else {
+        mEngine.amend(mContext, *traderId, order.mSymbolId, orderId, price,
+                      orderQty - order.mCumQty);
+      }
+    }
+    mRequestOrderId.reset();
+    mRequestClOrdId = {};
+  }
+
+  using Insert = void (*)(FixSession &, const TraderId &, SymbolId, Price,
+                          Price, Quantity);
+
+  template <Side side, OrderStyle style>
+  static void insert(FixSession &session, const TraderId &traderId,
+                     SymbolId symbolId, Price stopPx, Price price,
+                     Quantity quantity) {
+    auto &engine = session.mEngine;
+    auto &context = session.mContext;
+    if constexpr (style == OrderStyle::MKT_ORDER) {
+      engine.template insert<side, style>(context, traderId, symbolId,
+                                          quantity);
+    } else if constexpr (style == OrderStyle::STOP_ORDER) {
+      engine.template insert<side, style>(context, traderId, symbolId, stopPx,
+                                          quantity);
+    } else if constexpr (style == OrderStyle::STOP_LIMIT_ORDER) {
+      engine.template insert<side, style>(context, traderId, symbolId, stopPx,
+                                          price, quantity);
+    } else {
+      engine.template insert<side, style>(context, traderId, symbolId, price,
+                                          quantity);
+    }
+  }
+
+  template <Side side>
+  static Insert getInsert(std::string_view ordType,
+                          std::string_view timeInForce) {
+    if (ordType == "1") {
+      return &insert<side, OrderStyle::MKT_ORDER>;
+    } else if (ordType == "3") {
+      return &insert<side, OrderStyle::STOP_ORDER>;
+    } else if (ordType == "4") {
+      return &insert<side, OrderStyle::STOP_LIMIT_ORDER>;
+    } else if (ordType != "2") {
+      return nullptr;
+    }
+
+    if (timeInForce == "3") {
+      return &insert<side, OrderStyle::IOC_ORDER>;
+    } else if (timeInForce == "4") {
+      return &insert<side, OrderStyle::FOK_ORDER>;
+    }
+    return &insert<side, OrderStyle::LIMIT_ORDER>;
+  }
+
+  static Insert getInsert(Side side, std::string_view ordType,
+                          std::string_view timeInForce) {
+    return side == Side::BUY ? getInsert<Side::BUY>(ordType, timeInForce)
+                             : getInsert<Side::SELL>(ordType, timeInForce);
+  }
+
+  const TraderId *findTrader(std::string_view traderId) const {
+    auto it = std::lower_bound(
+        mTraders.begin(), mTraders.end(), traderId,
+        [](const TraderId &lhs, std::string_view rhs) { return lhs < rhs; });
+    return it != mTraders.end() && *it == traderId ? &*it : nullptr;
+  }
+
+  std::optional<SymbolId> findSymbol(std::string_view symbol) {
+    // the symbols added to the engine since the last lookup
+    if (mSymbols.size() != mEngine.getNumOfSymbols()) {
+      mSymbols.clear();
+      for (SymbolId symbolId = 0; symbolId < mEngine.getNumOfSymbols();
+           symbolId++) {
+        mSymbols.emplace_back(mEngine.getSymbolConfig(symbolId).symbol,
+                              symbolId);
+      }
+      std::sort(mSymbols.begin(), mSymbols.end());
+    }
+
+    auto it = std::lower_bound(
+        mSymbols.begin(), mSymbols.end(), symbol,
+        [](const std::pair<Symbol, SymbolId> &lhs, std::string_view rhs) {
+          return lhs.first < rhs;
+        });
+    if (it == mSymbols.end() || it->first != symbol) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  /**
+   * @brief
+   * The order of the session, the pending new order is bound to the first
+   * unknown order id notified to its trader
+   */
+  FixOrder *track(const TraderId &traderId, OrderId orderId) {
+    auto order = find(orderId);
+    if (order || !mPendingTraderId || traderId != *mPendingTraderId) {
+      return order;
+    }
+
+    mPendingTraderId = nullptr;
+    auto &tracked = mOrders[orderId];
+    tracked = std::move(mPendingOrder);
+    mClOrdIds[std::string_view(tracked.mClOrdId)] = orderId;
+    return &tracked;
+  }
+
+  FixOrder *find(OrderId orderId) {
+    auto it = mOrders.find(orderId);
+    return it != mOrders.end() ? &it->second : nullptr;
+  }
+
+  void untrack(OrderId orderId) {
+    auto it = mOrders.find(orderId);
+    mClOrdIds.erase(std::string_view(it->second.mClOrdId));
+    mOrders.erase(it);
+  }
+
+  unsigned getScale(const FixOrder &order) const {
+    return mEngine.getSymbolConfig(order.mSymbolId).priceScale;
+  }
+
+  static char getOrdStatus(const FixOrder &order) {
+    if (order.mCumQty == 0) {
+      return '0';
+    }
+    return order.mCumQty >= order.mOrderQty ? '2' : '1';
+  }
+
+  /**
+   * @brief
+   * Start an ExecutionReport with the fields common to every report, the
+   * caller adds the specific ones and sends it
+   */
+  void beginExecutionReport(OrderId orderId, const FixOrder &order,
+                            std::string_view clOrdId, char execType,
+                            char ordStatus) {
+    auto scale = getScale(order);
+    bool isClosed = ordStatus == '4' || ordStatus == '8';
+    Price avgPx = order.mCumQty ? order.mNotional /
+                                      static_cast<std::int64_t>(order.mCumQty)
+                                : 0;
+
+    mWriter.begin('8', ++mSeqNum);
+    mWriter.add(Fix::Tag::kOrderId, orderId);
+    mWriter.add(Fix::Tag::kClOrdId, clOrdId);
+    mWriter.add(Fix::Tag::kExecId, ++mExecId);
+    mWriter.add(Fix::Tag::kExecType, execType);
+    mWriter.add(Fix::Tag::kOrdStatus, ordStatus);
+    mWriter.add(Fix::Tag::kSymbol,
+                std::string_view(mEngine.getSymbolConfig(order.mSymbolId)
+                                     .symbol));
+    mWriter.add(Fix::Tag::kSide, order.mSide == Side::BUY ? '1' : '2');
+    mWriter.add(Fix::Tag::kOrderQty, order.mOrderQty);
+    mWriter.add(Fix::Tag::kPrice, order.mPrice, scale);
+    mWriter.add(Fix::Tag::kLeavesQty,
+                isClosed ? 0 : order.mOrderQty - order.mCumQty);
+    mWriter.add(Fix::Tag::kCumQty, order.mCumQty);
+    mWriter.add(Fix::Tag::kAvgPx, avgPx, scale);
+  }
+
+  // reject a NewOrderSingle before it reaches the engine, echoing its fields
+  void sendReject(const Fix::FixMessage &message, std::string_view text) {
+    mWriter.begin('8', ++mSeqNum);
+    mWriter.add(Fix::Tag::kOrderId, kUnknownOrderId);
+    addEchoed(Fix::Tag::kClOrdId, message.get(Fix::Tag::kClOrdId));
+    mWriter.add(Fix::Tag::kExecId, ++mExecId);
+    mWriter.add(Fix::Tag::kExecType, '8');
+    mWriter.add(Fix::Tag::kOrdStatus, '8');
+    addEchoed(Fix::Tag::kSymbol, message.get(Fix::Tag::kSymbol));
+    addEchoed(Fix::Tag::kSide, message.get(Fix::Tag::kSide));
+    addEchoed(Fix::Tag::kOrderQty, message.get(Fix::Tag::kOrderQty));
+    mWriter.add(Fix::Tag::kLeavesQty, Quantity(0));
+    mWriter.add(Fix::Tag::kCumQty, Quantity(0));
+    mWriter.add(Fix::Tag::kAvgPx, std::string_view("0"));
+    mWriter.add(Fix::Tag::kText, text);
+    send();
+  }
+
+  void sendCancelReject(OrderId orderId, char responseTo) {
+    auto order = find(orderId);
+    if (!order) {
+      return;
+    }
+
+    auto clOrdId = orderId == mRequestOrderId ? mRequestClOrdId
+                                              : std::string_view();
+    sendCancelReject(orderId, clOrdId, order->mClOrdId,
+                     getOrdStatus(*order), responseTo);
+  }
+
+  // the OrderID is NONE if the order is unknown
+  void sendCancelReject(std::optional<OrderId> orderId,
+                        std::string_view clOrdId, std::string_view origClOrdId,
+                        char ordStatus, char responseTo) {
+    mWriter.begin('9', ++mSeqNum);
+    if (orderId) {
+      mWriter.add(Fix::Tag::kOrderId, *orderId);
+    } else {
+      mWriter.add(Fix::Tag::kOrderId, kUnknownOrderId);
+    }
+    addEchoed(Fix::Tag::kClOrdId, clOrdId);
+    addEchoed(Fix::Tag::kOrigClOrdId, origClOrdId);
+    mWriter.add(Fix::Tag::kOrdStatus, ordStatus);
+    mWriter.add(Fix::Tag::kCxlRejResponseTo, responseTo);
+    send();
+  }
+
+  // a field of a request longer than any valid one is left out
+  void addEchoed(int tag, std::string_view value) {
+    if (value.size() <= kMaxEchoedSize) {
+      mWriter.add(tag, value);
+    }
+  }
+
+  // a message missing a field is not sent and its MsgSeqNum is reused
+  void send() {
+    if (mWriter.hasOverflowed()) {
+      mSeqNum--;
+      return;
+    }
+    mOutput.append(mWriter.finish());
+  }
+
+  Engine &mEngine;
+  ExecutionContext &mContext;
+  Fix::FixWriter mWriter;
+  Fix::FixMessage mMessage;
+  std::string mOutput;
+
+  // sorted to be searched by view
+  std::vector<TraderId> mTraders;
+  std::vector<std::pair<Symbol, SymbolId>> mSymbols;
+
+  std::unordered_map<OrderId, FixOrder> mOrders;
+  // the views refer to the ClOrdID stored in the order
+  std::unordered_map<std::string_view, OrderId> mClOrdIds;
+
+  // the new order being inserted
+  const TraderId *mPendingTraderId = nullptr;
+  FixOrder mPendingOrder;
+  // the cancel or replace request being executed
+  std::optional<OrderId> mRequestOrderId;
+  std::string_view mRequestClOrdId;
+
+  std::uint64_t mSeqNum = 0;
+  std::uint64_t mExecId = 0;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef ALLOCATOR
+#define ALLOCATOR
+#include <algorithm>
+#include <cstddef>
+#include <types.h>
+
+using namespace Common;
+
+/**
+ * @brief
+ * The allocation of an incoming quantity among the orders of a price level.
+ * The quantities of the resting orders are copied in time priority into a
+ * contiguous array and the allocations are written to a parallel array, so
+ * every pass is a plain loop over integers the compiler can vectorize.
+ */
+class Allocator {
+public:
+  /**
+   * @brief
+   * Allocate in proportion to the quantities, rounded down, the allocations
+   * below the minimum allocation are dropped.
+   * precondition: quantity < total, the sum of the quantities
+   * return the allocated quantity
+   */
+  static Quantity proRata(const Quantity *quantities, Quantity *allocations,
+                          size_t size, Quantity quantity, Quantity total,
+                          Quantity minAllocation) {
+    const double ratio = static_cast<double>(quantity) / total;
+    Quantity allocated = 0;
+    for (size_t i = 0; i < size; i++) {
+      auto allocation = static_cast<Quantity>(quantities[i] * ratio);
+      allocation = allocation >= minAllocation ? allocation : 0;
+      allocations[i] = allocation;
+      allocated += allocation;
+    }
+
+    // the rounding of the ratio may overshoot by a unit
+    return std::min(allocated, quantity);
+  }
+
+  /**
+   * @brief
+   * Top up the allocations in time priority until the residual is allocated
+   * or every order is fully allocated
+   */
+  static void fifo(const Quantity *quantities, Quantity *allocations,
+                   size_t size, Quantity residual) {
+    for (size_t i = 0; i < size && residual; i++) {
+      auto allocation = std::min(quantities[i] - allocations[i], residual);
+      allocations[i] += allocation;
+      residual -= allocation;
+    }
+  }
+};
+
+#endif
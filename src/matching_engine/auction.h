@@ -0,0 +1,181 @@
+#ifndef AUCTION
+#define AUCTION
+#include <algorithm>
+#include <core/order/order.h>
+#include <core/order_book/order_book.h>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <types.h>
+
+using namespace Common;
+using namespace Core;
+
+/**
+ * @brief
+ * The outcome of an uncross: the single price every crossing order trades at,
+ * the executed volume and the surplus left at that price, positive when the
+ * buyers are in excess. The volume is 0 when the book does not cross.
+ */
+struct AuctionResult {
+  Price mPrice = 0;
+  Quantity mVolume = 0;
+  std::int64_t mImbalance = 0;
+};
+
+/**
+ * @brief
+ * The uncross of a book which has accumulated orders during the call phase.
+ * The equilibrium price is found in one pass over the price levels of both
+ * sides in ascending price order, only the cached quantities of each level
+ * are read. At each price the demand is the quantity bid at or above it and
+ * the supply is the quantity offered at or below it, the chosen price
+ * - maximizes the executable volume min(demand, supply),
+ * - then minimizes the surplus |demand - supply|,
+ * - then is the highest price if the buyers are in excess at every candidate
+ *   and the lowest if the sellers are,
+ * - then is the nearest to the reference price, the lowest if there is none.
+ *
+ * The crossing orders are then executed in price-time priority at that price,
+ * each of them with one aggregated fill. The hidden quantity of the iceberg
+ * orders takes part in full. Self-trade prevention does not apply.
+ */
+class Auction {
+public:
+  static AuctionResult equilibrium(OrderBook &book, Price referencePrice) {
+    Quantity demand = 0;
+    for (auto it = book.begin<Side::BUY>(); it != book.end<Side::BUY>();
+         it++) {
+      demand += levelQuantity(it->second);
+    }
+
+    auto bid = std::make_reverse_iterator(book.end<Side::BUY>());
+    const auto bidEnd = std::make_reverse_iterator(book.begin<Side::BUY>());
+    auto ask = book.begin<Side::SELL>();
+    const auto askEnd = book.end<Side::SELL>();
+    Quantity supply = 0;
+    AuctionResult best;
+
+    // nothing trades above the highest bid
+    while (demand && ask != askEnd) {
+      auto price = ask->first;
+      if (bid != bidEnd) {
+        price = std::min(price, bid->first);
+      }
+
+      Quantity bidQuantity = 0;
+      if (bid != bidEnd && bid->first == price) {
+        bidQuantity = levelQuantity(bid->second);
+        bid++;
+      }
+      if (ask->first == price) {
+        supply += levelQuantity(ask->second);
+        ask++;
+      }
+
+      consider(best, price, demand, supply, referencePrice);
+      demand -= bidQuantity;
+    }
+
+    // the asks are exhausted, the supply stays the same for the higher bids
+    while (demand && bid != bidEnd) {
+      consider(best, bid->first, demand, supply, referencePrice);
+      demand -= levelQuantity(bid->second);
+      bid++;
+    }
+
+    return best;
+  }
+
+  /**
+   * @brief
+   * Execute the volume of the result on both sides of the book, the emptied
+   * price levels are removed
+   */
+  template <typename Listener>
+  static void execute(Listener &listener, OrderBook &book,
+                      const AuctionResult &result) {
+    fill<Side::BUY>(listener, book, result.mPrice, result.mVolume);
+    fill<Side::SELL>(listener, book, result.mPrice, result.mVolume);
+  }
+
+private:
+  template <Side side>
+  static Quantity levelQuantity(const OrderQueue<side> &orderQueue) {
+    return orderQueue.totalQuantity() + orderQueue.hiddenQuantity();
+  }
+
+  static void consider(AuctionResult &best, Price price, Quantity demand,
+                       Quantity supply, Price referencePrice) {
+    auto volume = std::min(demand, supply);
+    if (volume == 0) {
+      return;
+    }
+
+    auto imbalance =
+        static_cast<std::int64_t>(demand) - static_cast<std::int64_t>(supply);
+    if (isBetter(best, price, volume, imbalance, referencePrice)) {
+      best = AuctionResult{price, volume, imbalance};
+    }
+  }
+
+  // the prices are considered in ascending order
+  static bool isBetter(const AuctionResult &best, Price price, Quantity volume,
+                       std::int64_t imbalance, Price referencePrice) {
+    if (volume != best.mVolume) {
+      return volume > best.mVolume;
+    }
+
+    auto surplus = std::abs(imbalance);
+    auto bestSurplus = std::abs(best.mImbalance);
+    if (surplus != bestSurplus) {
+      return surplus < bestSurplus;
+    }
+
+    if (imbalance > 0 && best.mImbalance > 0) {
+      return true;
+    }
+    if (imbalance < 0 && best.mImbalance < 0) {
+      return false;
+    }
+
+    return referencePrice &&
+           std::abs((price - referencePrice).units()) <
+               std::abs((best.mPrice - referencePrice).units());
+  }
+
+  template <Side side, typename Listener>
+  static void fill(Listener &listener, OrderBook &book, Price price,
+                   Quantity volume) {
+    auto it = book.template begin<side>();
+    while (volume && it != book.template end<side>()) {
+      auto &orderQueue = it->second;
+
+      while (volume && !orderQueue.empty()) {
+        auto orderIt = orderQueue.begin();
+        const auto totalQty = orderIt->getTotalQuantity();
+        const auto matchedQty = std::min(totalQty, volume);
+
+        listener.template notifyTrader<side, OrderStyle::LIMIT_ORDER,
+                                       OrderStatus::FILLED>(
+            orderIt->getTraderId(), orderIt->getOrderId(),
+            orderIt->getSymbol(), price, matchedQty);
+
+        if (matchedQty == totalQty) {
+          listener.notifyTraderAllFilled(orderIt->getTraderId(),
+                                         orderIt->getOrderId());
+          orderQueue.pop();
+        } else {
+          orderQueue.setTotalQuantity(orderIt, totalQty - matchedQty);
+        }
+        volume -= matchedQty;
+      }
+
+      if (orderQueue.empty()) {
+        it = book.erase(it);
+      }
+    }
+  }
+};
+
+#endif
@@ -2,183 +2,146 @@
 
 using namespace Core;
 
-void MatchingEngine::addStocks(const std::vector<Symbol> &symbols) {
+template <typename StpPolicy>
+void BasicMatchingEngine<StpPolicy>::addStocks(
+    const std::vector<Symbol> &symbols) {
   for (const auto &symbol : symbols) {
-    if (mBookMap.find(symbol) == mBookMap.end()) {
-      mBookMap[symbol] = std::make_shared<OrderBook>();
+    if (!mSymbolTable.find(symbol)) {
+      mBooks.emplace_back().setSymbolId(mSymbolTable.add(SymbolConfig{symbol}));
     }
   }
 }
 
-void MatchingEngine::addConfig(std::shared_ptr<MatchingEngineConfig> config) {
-  mConfig = config;
+template <typename StpPolicy>
+void BasicMatchingEngine<StpPolicy>::addStocks(
+    const std::vector<Symbol> &symbols, const AllocationConfig &allocation) {
+  addStocks(symbols);
+  auto config = allocation;
+  if (config.policy == AllocationPolicy::LEAD_MARKET_MAKER) {
+    config.leadMarketMakerKey = getTraderKey(config.leadMarketMaker);
+  }
+  for (const auto &symbol : symbols) {
+    getOrderBook(symbol)->setAllocation(config);
+  }
 }
 
-std::unordered_map<std::string, std::shared_ptr<OrderBook>>
-MatchingEngine::getOrderBookMap() const {
-  return mBookMap;
+template <typename StpPolicy>
+void BasicMatchingEngine<StpPolicy>::addStocks(
+    const std::vector<SymbolConfig> &configs) {
+  for (const auto &config : configs) {
+    auto symbolId = mSymbolTable.find(config.symbol);
+    if (symbolId) {
+      mSymbolTable.set(*symbolId, config);
+    } else {
+      mBooks.emplace_back().setSymbolId(mSymbolTable.add(config));
+    }
+  }
 }
 
-bool MatchingEngine::isSelfTradePreventionEnable() const {
-  return mConfig && mConfig->selfTradPreventionConfig &&
-         mConfig->selfTradPreventionConfig->enable;
+template <typename StpPolicy>
+bool BasicMatchingEngine<StpPolicy>::loadStocks(const std::string &path) {
+  std::vector<SymbolConfig> configs;
+  if (!SymbolTable::load(path, configs)) {
+    return false;
+  }
+
+  addStocks(configs);
+  return true;
 }
 
-std::uint64_t MatchingEngine::getNextOrderId() {
-  return mOrderId.fetch_add(1, std::memory_order_relaxed);
+template <typename StpPolicy>
+void BasicMatchingEngine<StpPolicy>::addConfig(
+    std::shared_ptr<MatchingEngineConfig> config) {
+  mConfig = config;
 }
 
-bool MatchingEngine::matchBuyOrder(ExecutionContext &context,
-                                   std::shared_ptr<OrderBook> &bookPtr,
-                                   Order<Side::BUY> &order) {
-  if (bookPtr->template getNumOfLevels<Side::SELL>() == 0) {
-    return false;
+template <typename StpPolicy>
+void BasicMatchingEngine<StpPolicy>::setTradingPhase(const Symbol &symbol,
+                                                     TradingPhase phase) {
+  auto book = getOrderBook(symbol);
+  if (book) {
+    book->setTradingPhase(phase);
   }
+}
 
-  auto it = bookPtr->template begin<Side::SELL>();
-  auto best_ask = it->first;
-  auto px = order.getPrice();
-  auto amt = order.getQuantity();
+template <typename StpPolicy>
+TradingPhase
+BasicMatchingEngine<StpPolicy>::getTradingPhase(const Symbol &symbol) {
+  auto book = getOrderBook(symbol);
+  return book ? book->getTradingPhase() : TradingPhase::CONTINUOUS;
+}
 
-  if (px < best_ask) {
-    return false;
+template <typename StpPolicy>
+AuctionResult
+BasicMatchingEngine<StpPolicy>::uncross(ExecutionContext &context,
+                                        const Symbol &symbol) {
+  auto bookPtr = getOrderBook(symbol);
+  if (!bookPtr) {
+    return AuctionResult{};
   }
 
-  bool isDone = false;
-
-  while (!isDone && px >= it->first &&
-         it != bookPtr->template end<Side::SELL>()) {
-
-    auto &orderQueue = it->second;
-    bool isOrderCompleted = false;
-
-    while (!orderQueue.empty() && !isOrderCompleted) {
-      if (isSelfTradePreventionEnable() &&
-          orderQueue.front().getTraderId() == order.getTraderId()) {
-        SelfTradeHandler::dispatch<OrderStyle::LIMIT_ORDER, Side::SELL,
-                                   Side::BUY>(
-            mConfig->selfTradPreventionConfig->policy, context, orderQueue,
-            order);
-        isOrderCompleted = !order.getQuantity();
-      } else {
-        auto &frontOrder = orderQueue.front();
-        auto frontOrderId = frontOrder.getOrderId();
-        auto frontOrderTraderId = frontOrder.getTraderId();
-        auto frontOrderPx = frontOrder.getPrice();
-        auto frontOrderQty = frontOrder.getQuantity();
-        auto matchedQty = std::min(frontOrderQty, amt);
-
-        auto fillpx = std::min(frontOrderPx, order.getPrice());
-        context.notifyTrader<Side::SELL, OrderStyle::LIMIT_ORDER,
-                             OrderStatus::FILLED>(
-            frontOrderTraderId, frontOrderId, order.getSymbol(), frontOrderPx,
-            matchedQty);
-
-        frontOrder.setQuantity(frontOrderQty - matchedQty);
-        if (frontOrder.getQuantity() == 0) {
-          context.notifyTraderAllFilled(frontOrderTraderId, frontOrderId);
-          orderQueue.pop();
-        }
-
-        context.notifyTrader<Side::BUY, OrderStyle::LIMIT_ORDER,
-                             OrderStatus::FILLED>(
-            order.getTraderId(), order.getOrderId(), order.getSymbol(), fillpx,
-            matchedQty);
-
-        amt = std::max(static_cast<Quantity>(0), amt - matchedQty);
-        order.setQuantity(amt);
-
-        isOrderCompleted = amt == 0;
-      }
-    }
-
-    isDone = order.getQuantity() == 0;
-    if (isDone) {
-      context.notifyTraderAllFilled(order.getTraderId(), order.getOrderId());
-    }
-    if (orderQueue.empty()) {
-      bookPtr->erase(it++);
-    }
+  auto &book = *bookPtr;
+  auto result = Auction::equilibrium(book, book.getLastTradePrice());
+  if (result.mVolume) {
+    Auction::execute(context, book, result);
+    book.setLastTradePrice(result.mPrice);
   }
 
-  return isDone;
+  book.setTradingPhase(TradingPhase::CONTINUOUS);
+  triggerStops(context, book);
+  return result;
 }
 
-bool MatchingEngine::matchSellOrder(ExecutionContext &context,
-                                    std::shared_ptr<OrderBook> &bookPtr,
-                                    Order<Side::SELL> &order) {
-
-  bool should_proceed = true;
+template <typename StpPolicy>
+bool BasicMatchingEngine<StpPolicy>::isSelfTradePreventionEnable() const {
+  return mConfig && mConfig->selfTradPreventionConfig &&
+         mConfig->selfTradPreventionConfig->enable;
+}
 
-  if (bookPtr->template getNumOfLevels<Side::BUY>() == 0) {
-    return false;
-  }
+template <typename StpPolicy>
+bool BasicMatchingEngine<StpPolicy>::isRiskCheckEnable() const {
+  return mConfig && mConfig->riskConfig && mConfig->riskConfig->enable;
+}
 
-  auto it = bookPtr->template begin<Side::BUY>();
-  auto best_bid = it->first;
-  auto px = order.getPrice();
-  auto amt = order.getQuantity();
+template <typename StpPolicy>
+std::uint64_t BasicMatchingEngine<StpPolicy>::getNextOrderId() {
+  return mOrderId.fetch_add(1, std::memory_order_relaxed);
+}
 
-  if (px > best_bid) {
-    return false;
+template <typename StpPolicy>
+TraderKey
+BasicMatchingEngine<StpPolicy>::getTraderKey(const TraderId &traderId) {
+  auto it = mTraderKeys.find(traderId);
+  if (it != mTraderKeys.end()) {
+    return it->second;
   }
 
-  bool isDone = false;
-
-  while (!isDone && px <= it->first &&
-         it != bookPtr->template end<Side::BUY>()) {
-    auto &orderQueue = it->second;
-    bool isOrderCompleted = false;
-
-    while (!orderQueue.empty() && !isOrderCompleted) {
-
-      if (isSelfTradePreventionEnable() &&
-          orderQueue.front().getTraderId() == order.getTraderId()) {
-        SelfTradeHandler::dispatch<OrderStyle::LIMIT_ORDER, Side::BUY,
-                                   Side::SELL>(
-            mConfig->selfTradPreventionConfig->policy, context, orderQueue,
-            order);
-        isOrderCompleted = !order.getQuantity();
-      } else {
-        auto &frontOrder = orderQueue.front();
-        auto frontOrderId = frontOrder.getOrderId();
-        auto frontOrderTraderId = frontOrder.getTraderId();
-        auto frontOrderPx = frontOrder.getPrice();
-        auto frontOrderQty = frontOrder.getQuantity();
-        auto matchedQty = std::min(frontOrderQty, amt);
-        auto fillpx = std::min(frontOrderPx, order.getPrice());
-
-        context.notifyTrader<Side::BUY, OrderStyle::LIMIT_ORDER,
-                             OrderStatus::FILLED>(
-            frontOrderTraderId, frontOrderId, order.getSymbol(), fillpx,
-            matchedQty);
-
-        frontOrder.setQuantity(frontOrderQty - matchedQty);
-        if (frontOrder.getQuantity() == 0) {
-          context.notifyTraderAllFilled(frontOrderTraderId, frontOrderId);
-          orderQueue.pop();
-        }
-        context.notifyTrader<Side::SELL, OrderStyle::LIMIT_ORDER,
-                             OrderStatus::FILLED>(
-            order.getTraderId(), order.getOrderId(), order.getSymbol(), fillpx,
-            matchedQty);
-
-        amt = std::max(static_cast<Quantity>(0), amt - matchedQty);
-
-        order.setQuantity(amt);
-        isOrderCompleted = amt == 0;
-      }
-    }
-
-    isDone = order.getQuantity() == 0;
-    if (isDone) {
-      context.notifyTraderAllFilled(order.getTraderId(), order.getOrderId());
+  TraderKey key = 0;
+  if (mConfig && mConfig->selfTradPreventionConfig) {
+    auto &groups = mConfig->selfTradPreventionConfig->groups;
+    auto groupIt = groups.find(traderId);
+    if (groupIt != groups.end()) {
+      key = mGroupKeys.try_emplace(groupIt->second, mNextTraderKey)
+                .first->second;
     }
+  }
 
-    if (orderQueue.empty()) {
-      bookPtr->erase(it++);
-    }
+  // a trader without group or the first trader of a group takes a new key
+  if (key == 0 || key == mNextTraderKey) {
+    key = mNextTraderKey++;
   }
 
-  return isDone;
+  mTraderKeys.emplace(traderId, key);
+  return key;
 }
+
+template class BasicMatchingEngine<RuntimeSelfTradePrevention>;
+template class BasicMatchingEngine<NoSelfTradePrevention>;
+template class BasicMatchingEngine<
+    SelfTradePrevention<SelfTradePreventionPolicy::CANCEL_PASSIVE>>;
+template class BasicMatchingEngine<
+    SelfTradePrevention<SelfTradePreventionPolicy::CANCEL_ACTIVE>>;
+template class BasicMatchingEngine<
+    SelfTradePrevention<SelfTradePreventionPolicy::CANCEL_BOTH>>;
+template class BasicMatchingEngine<
+    SelfTradePrevention<SelfTradePreventionPolicy::DECREMENT_AND_CANCEL>>;
@@ -1,11 +1,20 @@
 #ifndef MATCHING_ENGINE
 #define MATCHING_ENGINE
+#include "auction.h"
+#include "order_matcher.h"
+#include "risk_checker.h"
 #include "self_trade_handler.h"
+#include "symbol_table.h"
+#include <algorithm>
 #include <atomic>
 #include <core/execution_context/execution_context.h>
 #include <core/order/order.h>
 #include <core/order_book/order_book.h>
+#include <core/timer_wheel/timer_wheel.h>
 #include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
 #include <types.h>
 #include <unordered_map>
 #include <utility>
@@ -16,274 +25,821 @@ using namespace Core;
 
 struct MatchingEngineConfig {
   std::optional<SelfTradePreventionConfig> selfTradPreventionConfig;
+  std::optional<RiskConfig> riskConfig;
 };
 
-class MatchingEngine {
+/**
+ * @brief
+ * The self-trade prevention policy of the engine is a template parameter:
+ * RuntimeSelfTradePrevention reads it from the config for every incoming
+ * order, NoSelfTradePrevention and SelfTradePrevention<policy> fix it when the
+ * engine is built and ignore the SelfTradePreventionConfig. The engine without
+ * self-trade prevention only interns the trader ids on the books with a lead
+ * market maker.
+ */
+template <typename StpPolicy = RuntimeSelfTradePrevention>
+class BasicMatchingEngine {
 public:
-  MatchingEngine() = default;
-  MatchingEngine(std::shared_ptr<MatchingEngineConfig> config)
+  BasicMatchingEngine() = default;
+  BasicMatchingEngine(std::shared_ptr<MatchingEngineConfig> config)
       : mConfig(config) {}
 
-  MatchingEngine(std::shared_ptr<MatchingEngineConfig> config,
-                 const std::vector<Symbol> &stocks)
+  BasicMatchingEngine(std::shared_ptr<MatchingEngineConfig> config,
+                      const std::vector<Symbol> &stocks)
       : mConfig(config) {
     addStocks(stocks);
   }
 
-  MatchingEngine(const MatchingEngine &other) = delete;
-  MatchingEngine &operator=(const MatchingEngine &) = delete;
-  MatchingEngine(MatchingEngine &&other) = delete;
-  MatchingEngine &operator=(MatchingEngine &&other) = delete;
+  BasicMatchingEngine(const BasicMatchingEngine &other) = delete;
+  BasicMatchingEngine &operator=(const BasicMatchingEngine &) = delete;
+  BasicMatchingEngine(BasicMatchingEngine &&other) = delete;
+  BasicMatchingEngine &operator=(BasicMatchingEngine &&other) = delete;
   void addStocks(const std::vector<Symbol> &symbols);
+  /**
+   * @brief
+   * Add the symbols with the allocation policy of their price levels, the
+   * symbols added without one use FIFO
+   */
+  void addStocks(const std::vector<Symbol> &symbols,
+                 const AllocationConfig &allocation);
+  /**
+   * @brief
+   * Add the symbols with their static data, the static data of a symbol
+   * already added is replaced
+   */
+  void addStocks(const std::vector<SymbolConfig> &configs);
+  /**
+   * @brief
+   * Add the symbols listed in the file, see SymbolTable::load() for the
+   * format
+   * return false if the file cannot be read or is malformed, nothing is added
+   */
+  bool loadStocks(const std::string &path);
   void addConfig(std::shared_ptr<MatchingEngineConfig> config);
 
-  template <Side side, OrderStyle style>
+  /**
+   * @brief
+   * The insertions take the symbol either by name or by the id returned by
+   * getSymbolId(), the id saves the lookup by name. An order on an unknown
+   * symbol is rejected.
+   */
+  template <Side side, OrderStyle style, typename SymbolKey>
   OrderId insert(ExecutionContext &context, const TraderId &traderId,
-                 const Symbol &symbol, Quantity quantity) {
+                 const SymbolKey &symbol, Quantity quantity) {
     static_assert(
         style == OrderStyle::MKT_ORDER,
         " This function template can only be instantiated by MKT_ORDER");
 
-    auto &bookPtr = mBookMap[symbol];
-    // the execution of the market order is guaranteed
-
     auto orderId = getNextOrderId();
+    auto book = getOrderBook(symbol);
+    if (!book) {
+      rejectUnknownSymbol<side, style>(context, traderId, orderId, symbol, 0,
+                                       quantity);
+      return orderId;
+    }
 
-    auto price = (side == Side::BUY) ? bookPtr->template getBest<Side::SELL>()
-                                     : bookPtr->template getBest<Side::BUY>();
-    Order<side> order(OrderStyle::MKT_ORDER, traderId, orderId, symbol, price,
-                      quantity);
+    insert_market_order<side>(context, *book, traderId, quantity, orderId);
+    triggerStops(context, *book);
+    return orderId;
+  }
+
+  /**
+   * @brief
+   * Insert a LIMIT, IOC or FOK order at the price, or a STOP order triggered
+   * at the price
+   */
+  template <Side side, OrderStyle style, typename SymbolKey>
+  OrderId insert(ExecutionContext &context, const TraderId &traderId,
+                 const SymbolKey &symbol, const Price price,
+                 Quantity quantity) {
+    static_assert(style == OrderStyle::LIMIT_ORDER ||
+                      style == OrderStyle::IOC_ORDER ||
+                      style == OrderStyle::FOK_ORDER ||
+                      style == OrderStyle::STOP_ORDER,
+                  " This function template can only be instantiated by "
+                  "LIMIT_ORDER, IOC_ORDER, FOK_ORDER or STOP_ORDER");
+    auto orderId = getNextOrderId();
+    auto book = getOrderBook(symbol);
+    if (!book) {
+      rejectUnknownSymbol<side, style>(context, traderId, orderId, symbol,
+                                       price, quantity);
+      return orderId;
+    }
 
-    matchMarketOrder<side>(context, traderId, bookPtr, order);
-    return mOrderId.load(std::memory_order_relaxed);
+    if constexpr (style == OrderStyle::LIMIT_ORDER) {
+      insert_limit_order<side>(context, *book, traderId, price, quantity,
+                               orderId);
+    } else if constexpr (style == OrderStyle::STOP_ORDER) {
+      insert_stop_order<side, style>(context, *book, traderId, price, price,
+                                     quantity, orderId);
+    } else {
+      insert_immediate_order<side, style>(context, *book, traderId, price,
+                                          quantity, orderId);
+    }
+    triggerStops(context, *book);
+    return orderId;
   }
 
-  template <Side side, OrderStyle style>
+  /**
+   * @brief
+   * Insert a STOP_LIMIT order, it is released as a limit order at the price
+   * once the last trade price reaches the trigger price
+   */
+  template <Side side, OrderStyle style, typename SymbolKey>
   OrderId insert(ExecutionContext &context, const TraderId &traderId,
-                 const Symbol &symbol, const Price price, Quantity quantity) {
+                 const SymbolKey &symbol, const Price triggerPrice,
+                 const Price price, Quantity quantity) {
     static_assert(
-        style == OrderStyle::LIMIT_ORDER,
-        " This function template can only be instantiated by LIMIT_ORDER");
-    return insert_limit_order<side>(context, traderId, symbol, price, quantity);
+        style == OrderStyle::STOP_LIMIT_ORDER,
+        " This function template can only be instantiated by STOP_LIMIT_ORDER");
+
+    auto orderId = getNextOrderId();
+    auto book = getOrderBook(symbol);
+    if (!book) {
+      rejectUnknownSymbol<side, style>(context, traderId, orderId, symbol,
+                                       price, quantity);
+      return orderId;
+    }
+
+    insert_stop_order<side, style>(context, *book, traderId, triggerPrice,
+                                   price, quantity, orderId);
+    triggerStops(context, *book);
+    return orderId;
+  }
+
+  /**
+   * @brief
+   * Insert an iceberg limit order, only the display quantity of its remaining
+   * quantity is shown in the order book at a time
+   */
+  template <Side side, typename SymbolKey>
+  OrderId insertIceberg(ExecutionContext &context, const TraderId &traderId,
+                        const SymbolKey &symbol, const Price price,
+                        Quantity quantity, Quantity displayQuantity) {
+    auto orderId = getNextOrderId();
+    auto book = getOrderBook(symbol);
+    if (!book) {
+      rejectUnknownSymbol<side, OrderStyle::LIMIT_ORDER>(
+          context, traderId, orderId, symbol, price, quantity);
+      return orderId;
+    }
+
+    if (displayQuantity == 0 || displayQuantity > quantity) {
+      context.notifyReject<side, OrderStyle::LIMIT_ORDER>(
+          traderId, orderId, getSymbol(*book), price, quantity,
+          OrderRejectReason::INVALID_PRICE_OR_QUANTITY);
+      return orderId;
+    }
+
+    insert_limit_order<side>(context, *book, traderId, price, quantity,
+                             orderId, displayQuantity);
+    triggerStops(context, *book);
+    return orderId;
+  }
+
+  /**
+   * @brief
+   * Insert a good-till-time limit order, the remaining quantity resting in the
+   * order book is cancelled once the time reaches the expiry. A day order is a
+   * good-till-time order expiring at the end of the day.
+   */
+  template <Side side, typename SymbolKey>
+  OrderId insertGoodTillTime(ExecutionContext &context,
+                             const TraderId &traderId, const SymbolKey &symbol,
+                             const Price price, Quantity quantity,
+                             Timestamp expiry) {
+    auto orderId = getNextOrderId();
+    auto book = getOrderBook(symbol);
+    if (!book) {
+      rejectUnknownSymbol<side, OrderStyle::LIMIT_ORDER>(
+          context, traderId, orderId, symbol, price, quantity);
+      return orderId;
+    }
+
+    insert_limit_order<side>(context, *book, traderId, price, quantity,
+                             orderId);
+    if (book->template contains<side>(orderId)) {
+      mTimerWheel.schedule(expiry, orderId);
+      mGoodTillTimeOrders.emplace(orderId, book->getSymbolId());
+    }
+    triggerStops(context, *book);
+    return orderId;
+  }
+
+  /**
+   * @brief
+   * Move the time of the engine forward and cancel all the good-till-time
+   * orders expiring at or before now, the cancels are notified in one batch.
+   * The orders already filled or cancelled are skipped.
+   */
+  void advanceTime(ExecutionContext &context, Timestamp now) {
+    mExpiredTimers.clear();
+    mTimerWheel.advance(now, mExpiredTimers);
+    if (mExpiredTimers.empty()) {
+      return;
+    }
+
+    mCancelledOrders.clear();
+    for (const auto &timer : mExpiredTimers) {
+      auto it = mGoodTillTimeOrders.find(timer.mId);
+      if (it == mGoodTillTimeOrders.end()) {
+        continue;
+      }
+
+      auto &book = mBooks[it->second];
+      if (!takeOrder<Side::BUY>(book, timer.mId)) {
+        takeOrder<Side::SELL>(book, timer.mId);
+      }
+      mGoodTillTimeOrders.erase(it);
+    }
+
+    if (!mCancelledOrders.empty()) {
+      context.notifyCancelled(mCancelledOrders, OrderCancelReason::EXPIRED);
+    }
+  }
+
+  Timestamp getTime() const { return mTimerWheel.getTime(); }
+
+  /**
+   * @brief
+   * Cancel all the resting orders of the trader, optionally only on the symbol
+   * and the side, e.g. when the trader disconnects. The orders are found
+   * through the per-trader index of the order books, so it costs time
+   * proportional to the number of orders of the trader. The cancels are
+   * notified in one batch, in order id order per book side.
+   * return the number of cancelled orders
+   */
+  size_t massCancel(ExecutionContext &context, const TraderId &traderId) {
+    mCancelledOrders.clear();
+    for (auto &book : mBooks) {
+      takeTraderOrders<Side::BUY>(book, traderId);
+      takeTraderOrders<Side::SELL>(book, traderId);
+    }
+    return notifyMassCancel(context);
+  }
+
+  template <typename SymbolKey>
+  size_t massCancel(ExecutionContext &context, const TraderId &traderId,
+                    const SymbolKey &symbol) {
+    mCancelledOrders.clear();
+    auto book = getOrderBook(symbol);
+    if (book) {
+      takeTraderOrders<Side::BUY>(*book, traderId);
+      takeTraderOrders<Side::SELL>(*book, traderId);
+    }
+    return notifyMassCancel(context);
+  }
+
+  template <typename SymbolKey>
+  size_t massCancel(ExecutionContext &context, const TraderId &traderId,
+                    const SymbolKey &symbol, Side side) {
+    mCancelledOrders.clear();
+    auto book = getOrderBook(symbol);
+    if (book) {
+      if (side == Side::BUY) {
+        takeTraderOrders<Side::BUY>(*book, traderId);
+      } else {
+        takeTraderOrders<Side::SELL>(*book, traderId);
+      }
+    }
+    return notifyMassCancel(context);
   }
 
   void cancel(ExecutionContext &context,
               const OrderCancelRequest &cancelRequest) {
+    cancel(context, cancelRequest.mTraderId, cancelRequest.mSymbol,
+           cancelRequest.mOrderId);
+  }
 
-    bool isCancelled = mBookMap[cancelRequest.mSymbol]->removeOrder(
-        cancelRequest.mOrderId, cancelRequest.mTraderId);
+  /**
+   * @brief
+   * Cancel the order of the trader on the symbol, given by name or by id
+   */
+  template <typename SymbolKey>
+  void cancel(ExecutionContext &context, const TraderId &traderId,
+              const SymbolKey &symbol, OrderId orderId) {
+    auto book = getOrderBook(symbol);
+    bool isCancelled = book && book->removeOrder(orderId, traderId);
 
     if (isCancelled) {
-      context.notifyTrader<OrderStatus::CANCEL>(cancelRequest.mTraderId,
-                                                cancelRequest.mOrderId);
+      context.notifyTrader<OrderStatus::CANCEL>(traderId, orderId);
+    } else {
+      context.notifyTrader<OrderStatus::CANCEL_REJECT>(traderId, orderId);
+    }
+  }
+
+  /**
+   * @brief
+   * Amend the price and the remaining quantity of a resting order.
+   * Reducing the quantity at the same price is done in place and the order
+   * keeps its time priority, otherwise the order is taken out of the book and
+   * matched again as a new order at the new price.
+   */
+  void amend(ExecutionContext &context, const OrderAmendRequest &amendRequest) {
+    amend(context, amendRequest.mTraderId, amendRequest.mSymbol,
+          amendRequest.mOrderId, amendRequest.mPrice, amendRequest.mQuantity);
+  }
+
+  template <typename SymbolKey>
+  void amend(ExecutionContext &context, const TraderId &traderId,
+             const SymbolKey &symbol, OrderId orderId, Price price,
+             Quantity quantity) {
+    auto book = getOrderBook(symbol);
+    if (!book) {
+      context.notifyTrader<OrderStatus::AMEND_REJECT>(traderId, orderId);
+      return;
+    }
+
+    if (book->template contains<Side::BUY>(orderId)) {
+      amendOrder<Side::BUY>(context, *book, traderId, orderId, price,
+                            quantity);
+    } else if (book->template contains<Side::SELL>(orderId)) {
+      amendOrder<Side::SELL>(context, *book, traderId, orderId, price,
+                             quantity);
     } else {
-      context.notifyTrader<OrderStatus::CANCEL_REJECT>(cancelRequest.mTraderId,
-                                                       cancelRequest.mOrderId);
+      context.notifyTrader<OrderStatus::AMEND_REJECT>(traderId, orderId);
     }
+    triggerStops(context, *book);
+  }
+
+  /**
+   * @brief
+   * Start or end the call phase of an auction on the symbol. In the call
+   * phase the limit orders rest in the order book without matching, the
+   * market, IOC and FOK orders are rejected and the stop orders are not
+   * triggered.
+   */
+  void setTradingPhase(const Symbol &symbol, TradingPhase phase);
+  TradingPhase getTradingPhase(const Symbol &symbol);
+
+  /**
+   * @brief
+   * Execute the orders accumulated during the call phase in one batch at the
+   * equilibrium price and switch the symbol back to continuous trading. The
+   * previous last trade price is the reference price of the auction, the
+   * equilibrium price becomes the last trade price and the stop orders it
+   * reaches are released.
+   */
+  AuctionResult uncross(ExecutionContext &context, const Symbol &symbol);
+
+  /**
+   * @brief
+   * The dense id of the symbol, std::nullopt if the symbol is unknown
+   */
+  std::optional<SymbolId> getSymbolId(const Symbol &symbol) const {
+    return mSymbolTable.find(symbol);
   }
 
-  std::unordered_map<std::string, std::shared_ptr<OrderBook>>
-  getOrderBookMap() const;
+  // precondition: the symbol id is known
+  const SymbolConfig &getSymbolConfig(SymbolId symbolId) const {
+    return mSymbolTable[symbolId];
+  }
+
+  size_t getNumOfSymbols() const { return mSymbolTable.size(); }
+
+  /**
+   * @brief
+   * The order book of the symbol, nullptr if the symbol is unknown. The books
+   * are stored contiguously, adding symbols invalidates the pointer.
+   */
+  OrderBook *getOrderBook(const Symbol &symbol) {
+    auto symbolId = mSymbolTable.find(symbol);
+    return symbolId ? &mBooks[*symbolId] : nullptr;
+  }
+
+  OrderBook *getOrderBook(SymbolId symbolId) {
+    return symbolId < mBooks.size() ? &mBooks[symbolId] : nullptr;
+  }
 
 private:
   OrderId getNextOrderId();
 
+  /**
+   * @brief
+   * The key of the trader for the self-trade prevention, the traders of the
+   * same STP group share the key of the group
+   */
+  TraderKey getTraderKey(const TraderId &traderId);
+
+  const Symbol &getSymbol(const OrderBook &book) const {
+    return mSymbolTable[book.getSymbolId()].symbol;
+  }
+
+  template <Side side, OrderStyle style, typename SymbolKey>
+  void rejectUnknownSymbol(ExecutionContext &context, const TraderId &traderId,
+                           OrderId orderId, const SymbolKey &symbol,
+                           Price price, Quantity quantity) {
+    if constexpr (std::is_integral_v<SymbolKey>) {
+      context.notifyReject<side, style>(traderId, orderId,
+                                        std::to_string(symbol), price,
+                                        quantity,
+                                        OrderRejectReason::UNKNOWN_SYMBOL);
+    } else {
+      context.notifyReject<side, style>(traderId, orderId, symbol, price,
+                                        quantity,
+                                        OrderRejectReason::UNKNOWN_SYMBOL);
+    }
+  }
+
+  /**
+   * @brief
+   * Give the order the key of its trader for the self-trade prevention, and
+   * for the allocation to find the lead market maker of the book
+   */
   template <Side side>
-  OrderId insert_limit_order(ExecutionContext &context,
-                             const TraderId &traderId, const Symbol &symbol,
-                             const Price price, Quantity quantity) {
-    if (price == 0 || quantity == 0) {
-      return mOrderId.load(std::memory_order_relaxed);
+  void assignTraderKey(const OrderBook &book, Order<side> &order) {
+    if (StpPolicy::enable ||
+        book.getAllocation().policy == AllocationPolicy::LEAD_MARKET_MAKER) {
+      order.setTraderKey(getTraderKey(order.getTraderId()));
     }
+  }
 
-    auto orderId = getNextOrderId();
+  template <Side side>
+  void insert_market_order(ExecutionContext &context, OrderBook &book,
+                           const TraderId &traderId, Quantity quantity,
+                           OrderId orderId) {
+    const auto &symbol = getSymbol(book);
+    // the execution of the market order is guaranteed
+
+    constexpr auto otherSide = (side == Side::BUY) ? Side::SELL : Side::BUY;
+    auto price = book.template getNumOfLevels<otherSide>()
+                     ? book.template getBest<otherSide>()
+                     : 0;
+
+    auto rsn = validate<side, OrderStyle::MKT_ORDER>(context, book, traderId,
+                                                     symbol, price, quantity);
+    if (rsn != OrderRejectReason::NONE) {
+      context.notifyReject<side, OrderStyle::MKT_ORDER>(
+          traderId, orderId, symbol, price, quantity, rsn);
+      return;
+    }
+
+    Order<side> order(OrderStyle::MKT_ORDER, traderId, orderId, symbol, price,
+                      quantity);
+    assignTraderKey(book, order);
+
+    bool matched = match<side, OrderStyle::MKT_ORDER>(context, book, order);
+    if (!matched) {
+      context.notifyTrader<side, OrderStyle::MKT_ORDER, OrderStatus::CANCEL>(
+          order.getTraderId(), order.getOrderId(), order.getSymbol(), 0,
+          order.getQuantity(), OrderCancelReason::NO_ORDER_TO_MATCH_MKT_ORDER);
+    }
+  }
+
+  template <Side side>
+  void insert_limit_order(ExecutionContext &context, OrderBook &book,
+                          const TraderId &traderId, const Price price,
+                          Quantity quantity, OrderId orderId,
+                          Quantity displayQuantity = 0) {
+    const auto &symbol = getSymbol(book);
+    auto rsn = validate<side, OrderStyle::LIMIT_ORDER>(
+        context, book, traderId, symbol, price, quantity);
+    if (rsn != OrderRejectReason::NONE) {
+      context.notifyReject<side, OrderStyle::LIMIT_ORDER>(
+          traderId, orderId, symbol, price, quantity, rsn);
+      return;
+    }
 
     Order<side> order(OrderStyle::LIMIT_ORDER, traderId, orderId, symbol, price,
                       quantity);
+    order.setDisplayQuantity(displayQuantity);
+    assignTraderKey(book, order);
 
-    bool matched = tryMatchLimitOrder<side>(context, order);
+    bool matched = book.getTradingPhase() == TradingPhase::CONTINUOUS &&
+                   match<side, OrderStyle::LIMIT_ORDER>(context, book, order);
 
     if (!matched) {
-      mBookMap[symbol]->insert<side>(order);
+      book.insert<side>(order);
       context.notifyTrader<side, OrderStyle::LIMIT_ORDER, OrderStatus::OPEN>(
           order.getTraderId(), order.getOrderId(), order.getSymbol(),
           order.getPrice(), order.getQuantity());
     }
+  }
 
-    return orderId;
+  /**
+   * @brief
+   * Insert an IOC or FOK order, it is matched like a limit order but never
+   * rests in the order book. A FOK order is first checked against the
+   * quantity available up to its limit price, an unfillable FOK order is
+   * cancelled without touching any resting order.
+   */
+  template <Side side, OrderStyle style>
+  void insert_immediate_order(ExecutionContext &context, OrderBook &book,
+                              const TraderId &traderId, const Price price,
+                              Quantity quantity, OrderId orderId) {
+    const auto &symbol = getSymbol(book);
+    auto rsn =
+        validate<side, style>(context, book, traderId, symbol, price, quantity);
+    if (rsn != OrderRejectReason::NONE) {
+      context.notifyReject<side, style>(traderId, orderId, symbol, price,
+                                        quantity, rsn);
+      return;
+    }
+
+    Order<side> order(style, traderId, orderId, symbol, price, quantity);
+    assignTraderKey(book, order);
+    if constexpr (style == OrderStyle::FOK_ORDER) {
+      if (!canFill(book, order)) {
+        context.notifyTrader<side, style, OrderStatus::CANCEL>(
+            traderId, orderId, symbol, price, quantity,
+            OrderCancelReason::UNFILLABLE_FOK_ORDER);
+        return;
+      }
+    }
+
+    match<side, style>(context, book, order);
+
+    if (order.getQuantity()) {
+      context.notifyTrader<side, style, OrderStatus::CANCEL>(
+          traderId, orderId, symbol, price, order.getQuantity(),
+          style == OrderStyle::FOK_ORDER
+              ? OrderCancelReason::UNFILLABLE_FOK_ORDER
+              : OrderCancelReason::UNFILLED_IOC_ORDER);
+    }
   }
 
-  template <Side side>
-  void matchMarketOrder(ExecutionContext &context, const TraderId &traderId,
-                        std::shared_ptr<OrderBook> &bookPtr,
-                        Order<side> order) {
-
-    if constexpr (side == Side::BUY) {
-
-      auto it = bookPtr->template begin<Side::SELL>();
-      auto amt = order.getQuantity();
-      bool isDone = false;
-
-      while (!isDone && it != bookPtr->template end<Side::SELL>()) {
-
-        auto &orderQueue = it->second;
-        bool isOrderCompleted = false;
-        order.setPrice(it->first);
-
-        while (!orderQueue.empty() && !isOrderCompleted) {
-          if (isSelfTradePreventionEnable() &&
-              orderQueue.front().getTraderId() == order.getTraderId()) {
-            SelfTradeHandler::dispatch<OrderStyle::MKT_ORDER, Side::SELL,
-                                       Side::BUY>(
-                mConfig->selfTradPreventionConfig->policy, context, orderQueue,
-                order);
-            isOrderCompleted = !order.getQuantity();
-          } else {
-            auto &frontOrder = orderQueue.front();
-            auto frontOrderId = frontOrder.getOrderId();
-            auto frontOrderTraderId = frontOrder.getTraderId();
-            auto frontOrderPx = frontOrder.getPrice();
-            auto frontOrderQty = frontOrder.getQuantity();
-            auto matchedQty = std::min(frontOrderQty, amt);
-
-            auto fillpx = std::min(frontOrderPx, order.getPrice());
-            context.notifyTrader<Side::SELL, OrderStyle::LIMIT_ORDER,
-                                 OrderStatus::FILLED>(
-                frontOrderTraderId, frontOrderId, order.getSymbol(),
-                frontOrderPx, matchedQty);
-
-            frontOrder.setQuantity(frontOrderQty - matchedQty);
-            if (frontOrder.getQuantity() == 0) {
-              context.notifyTraderAllFilled(frontOrderTraderId, frontOrderId);
-              orderQueue.pop();
-            }
-
-            context.notifyTrader<Side::BUY, OrderStyle::MKT_ORDER,
-                                 OrderStatus::FILLED>(
-                order.getTraderId(), order.getOrderId(), order.getSymbol(),
-                fillpx, matchedQty);
-
-            amt = std::max(static_cast<Quantity>(0), amt - matchedQty);
-            order.setQuantity(amt);
-
-            isOrderCompleted = amt == 0;
-          }
-        }
-
-        isDone = order.getQuantity() == 0;
-        if (isDone) {
-          context.notifyTraderAllFilled(order.getTraderId(),
-                                        order.getOrderId());
-        }
-
-        if (orderQueue.empty()) {
-          bookPtr->erase(it++);
-        }
+  /**
+   * @brief
+   * Whether the FOK order can be filled in full, the resting orders it
+   * cannot trade with under the self-trade prevention left out
+   */
+  template <Side side> bool canFill(OrderBook &book, const Order<side> &order) {
+    constexpr auto otherSide = (side == Side::BUY) ? Side::SELL : Side::BUY;
+    constexpr auto cancelPassive = SelfTradePreventionPolicy::CANCEL_PASSIVE;
+    if constexpr (std::is_same_v<StpPolicy, RuntimeSelfTradePrevention>) {
+      if (isSelfTradePreventionEnable()) {
+        return book.template canFill<otherSide>(
+            order.getPrice(), order.getQuantity(), order.getTraderKey(),
+            mConfig->selfTradPreventionConfig->policy == cancelPassive);
       }
+    } else if constexpr (StpPolicy::enable) {
+      return book.template canFill<otherSide>(
+          order.getPrice(), order.getQuantity(), order.getTraderKey(),
+          StpPolicy::policy == cancelPassive);
+    }
+    return book.template canFill<otherSide>(order.getPrice(),
+                                            order.getQuantity());
+  }
+
+  /**
+   * @brief
+   * Park a STOP or STOP_LIMIT order in the stop book of the symbol. The risk
+   * checks run when the order is released, against the book at that time.
+   */
+  template <Side side, OrderStyle style>
+  void insert_stop_order(ExecutionContext &context, OrderBook &book,
+                         const TraderId &traderId, const Price triggerPrice,
+                         const Price price, Quantity quantity,
+                         OrderId orderId) {
+    const auto &symbol = getSymbol(book);
+    if (quantity == 0 || triggerPrice == 0 || price == 0) {
+      context.notifyReject<side, style>(
+          traderId, orderId, symbol, price, quantity,
+          OrderRejectReason::INVALID_PRICE_OR_QUANTITY);
+      return;
+    }
+
+    Order<side> order(style, traderId, orderId, symbol, price, quantity);
+    book.template insertStop<side>(triggerPrice, order);
+    context.notifyTrader<side, style, OrderStatus::OPEN>(
+        traderId, orderId, symbol, triggerPrice, quantity);
+  }
+
+  /**
+   * @brief
+   * Release the stop orders triggered by the last trade price of the symbol
+   * through the insertion path, BUY stops first then SELL stops, each in
+   * trigger price then arrival order. The released orders can trade and
+   * trigger more stops, so it repeats until nothing is triggered.
+   */
+  void triggerStops(ExecutionContext &context, OrderBook &book) {
+    if (!book.hasStops() || book.getTradingPhase() == TradingPhase::CALL) {
+      return;
+    }
 
-      if (!isDone) {
-        context.notifyTrader<side, OrderStyle::MKT_ORDER, OrderStatus::CANCEL>(
-            order.getTraderId(), order.getOrderId(), order.getSymbol(), 0,
-            order.getQuantity(),
-            OrderCancelReason::NO_ORDER_TO_MATCH_MKT_ORDER);
+    std::vector<Order<Side::BUY>> buyStops;
+    std::vector<Order<Side::SELL>> sellStops;
+    while (true) {
+      book.popTriggeredStops<Side::BUY>(buyStops);
+      book.popTriggeredStops<Side::SELL>(sellStops);
+      if (buyStops.empty() && sellStops.empty()) {
         return;
       }
 
-    } else {
-      auto it = bookPtr->template begin<Side::BUY>();
-      auto amt = order.getQuantity();
-      bool isDone = false;
-
-      while (!isDone && it != bookPtr->template end<Side::BUY>()) {
-        auto &orderQueue = it->second;
-        bool isOrderCompleted = false;
-
-        while (!orderQueue.empty() && !isOrderCompleted) {
-
-          if (isSelfTradePreventionEnable() &&
-              orderQueue.front().getTraderId() == order.getTraderId()) {
-            SelfTradeHandler::dispatch<OrderStyle::MKT_ORDER, Side::BUY,
-                                       Side::SELL>(
-                mConfig->selfTradPreventionConfig->policy, context, orderQueue,
-                order);
-            isOrderCompleted = !order.getQuantity();
-          } else {
-            auto &frontOrder = orderQueue.front();
-            auto frontOrderId = frontOrder.getOrderId();
-            auto frontOrderTraderId = frontOrder.getTraderId();
-            auto frontOrderPx = frontOrder.getPrice();
-            auto frontOrderQty = frontOrder.getQuantity();
-            auto matchedQty = std::min(frontOrderQty, amt);
-            auto fillpx = std::min(frontOrderPx, order.getPrice());
-
-            context.notifyTrader<Side::BUY, OrderStyle::LIMIT_ORDER,
-                                 OrderStatus::FILLED>(
-                frontOrderTraderId, frontOrderId, order.getSymbol(), fillpx,
-                matchedQty);
-
-            frontOrder.setQuantity(frontOrderQty - matchedQty);
-            if (frontOrder.getQuantity() == 0) {
-              context.notifyTraderAllFilled(frontOrderTraderId, frontOrderId);
-              orderQueue.pop();
-            }
-            context.notifyTrader<Side::SELL, OrderStyle::MKT_ORDER,
-                                 OrderStatus::FILLED>(
-                order.getTraderId(), order.getOrderId(), order.getSymbol(),
-                fillpx, matchedQty);
-
-            amt = std::max(static_cast<Quantity>(0), amt - matchedQty);
-
-            order.setQuantity(amt);
-            isOrderCompleted = amt == 0;
-          }
-        }
-
-        isDone = order.getQuantity() == 0;
-        if (isDone) {
-          context.notifyTraderAllFilled(order.getTraderId(),
-                                        order.getOrderId());
-        }
-
-        if (orderQueue.empty()) {
-          bookPtr->erase(it++);
-        }
+      for (auto &order : buyStops) {
+        releaseStop<Side::BUY>(context, book, order);
+      }
+      for (auto &order : sellStops) {
+        releaseStop<Side::SELL>(context, book, order);
       }
+      buyStops.clear();
+      sellStops.clear();
+    }
+  }
 
-      if (!isDone) {
-        context.notifyTrader<side, OrderStyle::MKT_ORDER, OrderStatus::CANCEL>(
-            order.getTraderId(), order.getOrderId(), order.getSymbol(), 0,
-            order.getQuantity(),
-            OrderCancelReason::NO_ORDER_TO_MATCH_MKT_ORDER);
-        return;
+  template <Side side>
+  void releaseStop(ExecutionContext &context, OrderBook &book,
+                   const Order<side> &order) {
+    if (order.getOrderStyle() == OrderStyle::STOP_ORDER) {
+      context.notifyTrader<side, OrderStyle::STOP_ORDER, OrderStatus::TRIGGER>(
+          order.getTraderId(), order.getOrderId(), order.getSymbol(),
+          order.getPrice(), order.getQuantity());
+      insert_market_order<side>(context, book, order.getTraderId(),
+                                order.getQuantity(), order.getOrderId());
+    } else {
+      context.notifyTrader<side, OrderStyle::STOP_LIMIT_ORDER,
+                           OrderStatus::TRIGGER>(
+          order.getTraderId(), order.getOrderId(), order.getSymbol(),
+          order.getPrice(), order.getQuantity());
+      insert_limit_order<side>(context, book, order.getTraderId(),
+                               order.getPrice(), order.getQuantity(),
+                               order.getOrderId());
+    }
+  }
+
+  /**
+   * @brief
+   * Take the resting order out of the order book and add it to the batch of
+   * cancelled orders
+   */
+  template <Side side> bool takeOrder(OrderBook &book, OrderId orderId) {
+    auto order = book.template find<side>(orderId);
+    if (!order) {
+      return false;
+    }
+
+    mCancelledOrders.push_back(CancelledOrder{
+        order->getTraderId(), orderId, order->getSymbol(), side,
+        order->getPrice(), order->getTotalQuantity()});
+    book.template removeOrder<side>(orderId, order->getTraderId());
+    return true;
+  }
+
+  template <Side side>
+  void takeTraderOrders(OrderBook &book, const TraderId &traderId) {
+    auto orders = book.template findTraderOrders<side>(traderId);
+    if (!orders) {
+      return;
+    }
+
+    // the set shrinks while the orders are taken out
+    mOrderIds.assign(orders->begin(), orders->end());
+    std::sort(mOrderIds.begin(), mOrderIds.end());
+    for (auto orderId : mOrderIds) {
+      takeOrder<side>(book, orderId);
+    }
+  }
+
+  size_t notifyMassCancel(ExecutionContext &context) {
+    if (!mCancelledOrders.empty()) {
+      context.notifyCancelled(mCancelledOrders, OrderCancelReason::MASS_CANCEL);
+    }
+    return mCancelledOrders.size();
+  }
+
+  template <Side side, OrderStyle style>
+  OrderRejectReason validate(const ExecutionContext &context, OrderBook &book,
+                             const TraderId &traderId, const Symbol &symbol,
+                             Price price, Quantity quantity) const {
+    if (quantity == 0 || (style != OrderStyle::MKT_ORDER && price == 0)) {
+      return OrderRejectReason::INVALID_PRICE_OR_QUANTITY;
+    }
+
+    auto rsn =
+        mSymbolTable.check<style>(book.getSymbolId(), price, quantity);
+    if (rsn != OrderRejectReason::NONE) {
+      return rsn;
+    }
+
+    if constexpr (style != OrderStyle::LIMIT_ORDER) {
+      if (book.getTradingPhase() == TradingPhase::CALL) {
+        return OrderRejectReason::CALL_PHASE;
       }
     }
+
+    if (!isRiskCheckEnable()) {
+      return OrderRejectReason::NONE;
+    }
+
+    return RiskChecker::check<side, style>(*mConfig->riskConfig, context, book,
+                                           traderId, symbol, price, quantity);
   }
 
   template <Side side>
-  bool tryMatchLimitOrder(ExecutionContext &context, Order<side> &order) {
-    auto &bookPtr = mBookMap[order.getSymbol()];
+  void amendOrder(ExecutionContext &context, OrderBook &book,
+                  const TraderId &traderId, OrderId orderId, Price price,
+                  Quantity quantity) {
+    auto restingOrder = book.template find<side>(orderId);
+
+    bool isValid = restingOrder->getTraderId() == traderId &&
+                   price != 0 && quantity != 0 &&
+                   mSymbolTable.check<OrderStyle::LIMIT_ORDER>(
+                       book.getSymbolId(), price, quantity) ==
+                       OrderRejectReason::NONE;
+    if (isValid && isRiskCheckEnable()) {
+      isValid = RiskChecker::checkOrder<side, OrderStyle::LIMIT_ORDER>(
+                    *mConfig->riskConfig, book, price, quantity) ==
+                OrderRejectReason::NONE;
+      // the open exposure already holds the resting quantity
+      auto restingQuantity = restingOrder->getTotalQuantity();
+      if (isValid && quantity > restingQuantity) {
+        isValid = RiskChecker::checkTrader<side, OrderStyle::LIMIT_ORDER>(
+                      *mConfig->riskConfig, context, traderId,
+                      getSymbol(book), quantity - restingQuantity,
+                      false) == OrderRejectReason::NONE;
+      }
+    }
 
-    if constexpr (side == Side::BUY) {
-      return matchBuyOrder(context, bookPtr, order);
-    } else {
-      return matchSellOrder(context, bookPtr, order);
+    if (!isValid) {
+      context.notifyTrader<OrderStatus::AMEND_REJECT>(traderId, orderId);
+      return;
+    }
+
+    if (price == restingOrder->getPrice() &&
+        quantity <= restingOrder->getTotalQuantity()) {
+      book.template reduce<side>(orderId, quantity);
+      context.notifyTrader<side, OrderStyle::LIMIT_ORDER, OrderStatus::AMEND>(
+          traderId, orderId, getSymbol(book), price, quantity);
+      return;
+    }
+
+    Order<side> order(*restingOrder);
+    book.template removeOrder<side>(orderId, traderId);
+    order.setPrice(price);
+    order.setQuantity(quantity);
+    order.setHiddenQuantity(0);
+    context.notifyTrader<side, OrderStyle::LIMIT_ORDER, OrderStatus::AMEND>(
+        traderId, orderId, getSymbol(book), price, quantity);
+
+    bool matched =
+        book.getTradingPhase() == TradingPhase::CONTINUOUS &&
+        match<side, OrderStyle::LIMIT_ORDER>(context, book, order);
+    if (!matched) {
+      book.template insert<side>(order);
     }
   }
 
-  bool matchBuyOrder(ExecutionContext &context,
-                     std::shared_ptr<OrderBook> &bookPtr,
-                     Order<Side::BUY> &order);
+  /**
+   * @brief
+   * Sweep the order against the order book, the self-trade prevention policy
+   * is resolved once here and the sweep is specialized on it.
+   * return true if nothing is left of the order
+   */
+  template <Side side, OrderStyle style>
+  bool match(ExecutionContext &context, OrderBook &book, Order<side> &order) {
+    if constexpr (!std::is_same_v<StpPolicy, RuntimeSelfTradePrevention>) {
+      return OrderMatcher::sweep<side, style, StpPolicy>(context, book, order);
+    } else {
+      if (!isSelfTradePreventionEnable()) {
+        return OrderMatcher::sweep<side, style, NoSelfTradePrevention>(
+            context, book, order);
+      }
 
-  bool matchSellOrder(ExecutionContext &context,
-                      std::shared_ptr<OrderBook> &bookPtr,
-                      Order<Side::SELL> &order);
+      switch (mConfig->selfTradPreventionConfig->policy) {
+      case SelfTradePreventionPolicy::CANCEL_ACTIVE:
+        return OrderMatcher::sweep<
+            side, style,
+            SelfTradePrevention<SelfTradePreventionPolicy::CANCEL_ACTIVE>>(
+            context, book, order);
+      case SelfTradePreventionPolicy::CANCEL_BOTH:
+        return OrderMatcher::sweep<
+            side, style,
+            SelfTradePrevention<SelfTradePreventionPolicy::CANCEL_BOTH>>(
+            context, book, order);
+      case SelfTradePreventionPolicy::DECREMENT_AND_CANCEL:
+        return OrderMatcher::sweep<
+            side, style,
+            SelfTradePrevention<
+                SelfTradePreventionPolicy::DECREMENT_AND_CANCEL>>(
+            context, book, order);
+      default:
+        return OrderMatcher::sweep<
+            side, style,
+            SelfTradePrevention<SelfTradePreventionPolicy::CANCEL_PASSIVE>>(
+            context, book, order);
+      }
+    }
+  }
 
   bool isSelfTradePreventionEnable() const;
 
+  bool isRiskCheckEnable() const;
+
 private:
   std::atomic<OrderId> mOrderId{0};
-  std::unordered_map<Symbol, std::shared_ptr<OrderBook>> mBookMap;
+  std::vector<OrderBook> mBooks;
+  SymbolTable mSymbolTable;
   std::shared_ptr<MatchingEngineConfig> mConfig;
+  std::unordered_map<TraderId, TraderKey> mTraderKeys;
+  std::unordered_map<StpGroupId, TraderKey> mGroupKeys;
+  TraderKey mNextTraderKey = 1;
+  TimerWheel mTimerWheel;
+  std::unordered_map<OrderId, SymbolId> mGoodTillTimeOrders;
+  std::vector<TimerWheel::Timer> mExpiredTimers;
+  std::vector<CancelledOrder> mCancelledOrders;
+  std::vector<OrderId> mOrderIds;
 };
 
+using MatchingEngine = BasicMatchingEngine<>;
+
 #endif
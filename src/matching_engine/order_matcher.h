@@ -0,0 +1,221 @@
+#ifndef ORDER_MATCHER
+#define ORDER_MATCHER
+#include "allocator.h"
+#include "self_trade_handler.h"
+#include <algorithm>
+#include <core/order/order.h>
+#include <core/order_book/order_book.h>
+#include <iterator>
+#include <types.h>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+/**
+ * @brief
+ * The sweep of an incoming order against the opposite side of the order book.
+ * Every combination of aggressor side, order style, self-trade prevention
+ * policy and listener is a separate instantiation, so the branches on them
+ * are resolved at compile time and the inner loop only compares prices,
+ * quantities and (when self-trade prevention is enabled) the interned trader
+ * keys.
+ *
+ * Every fill is at the price of the resting order, so the price improvement
+ * goes to the aggressor whatever its side, and a market order is filled at
+ * the price of each level it takes.
+ *
+ * The orders of a level are filled in time priority unless the book has
+ * another allocation policy.
+ */
+class OrderMatcher {
+public:
+  /**
+   * @brief
+   * Match the order until it is filled or no resting order crosses it, the
+   * emptied price levels are removed from the order book and the last trade
+   * price of the book is updated.
+   * return true if the order is fully filled or cancelled by self-trade
+   * prevention, false if there is a remaining quantity
+   */
+  template <Side side, OrderStyle style, typename StpPolicy, typename Listener>
+  static bool sweep(Listener &listener, OrderBook &book, Order<side> &order) {
+    constexpr auto bookSide = (side == Side::BUY) ? Side::SELL : Side::BUY;
+    constexpr auto stpStyle = (style == OrderStyle::MKT_ORDER)
+                                  ? OrderStyle::MKT_ORDER
+                                  : OrderStyle::LIMIT_ORDER;
+
+    auto it = book.template begin<bookSide>();
+    const auto last = book.template end<bookSide>();
+    Price lastTradePx = 0;
+
+    while (order.getQuantity() && it != last &&
+           crosses<side, style>(it->first, order.getPrice())) {
+      const auto levelPx = it->first;
+      if constexpr (style == OrderStyle::MKT_ORDER) {
+        order.setPrice(levelPx);
+      }
+      auto &orderQueue = it->second;
+
+      if (book.getAllocation().policy != AllocationPolicy::FIFO &&
+          allocate<side, style, StpPolicy>(listener, book.getAllocation(),
+                                           orderQueue, order, levelPx)) {
+        lastTradePx = levelPx;
+      }
+
+      while (!orderQueue.empty() && order.getQuantity()) {
+        auto &frontOrder = orderQueue.front();
+
+        if constexpr (StpPolicy::enable) {
+          if (frontOrder.getTraderKey() == order.getTraderKey()) {
+            SelfTradeHandler::handle<StpPolicy::policy, stpStyle>(
+                listener, orderQueue, order);
+            continue;
+          }
+        }
+
+        const auto matchedQty =
+            std::min(frontOrder.getQuantity(), order.getQuantity());
+        fill<side, style>(listener, orderQueue, orderQueue.begin(), order,
+                          levelPx, matchedQty);
+        lastTradePx = levelPx;
+      }
+
+      if (order.getQuantity() == 0) {
+        listener.notifyTraderAllFilled(order.getTraderId(), order.getOrderId());
+      }
+
+      if (orderQueue.empty()) {
+        it = book.erase(it);
+      }
+    }
+
+    if (lastTradePx) {
+      book.setLastTradePrice(lastTradePx);
+    }
+
+    return order.getQuantity() == 0;
+  }
+
+private:
+  /**
+   * @brief
+   * Fill the resting order and the incoming order with the matched quantity,
+   * a filled iceberg slice is replenished at the back of the level and any
+   * other filled resting order leaves the level
+   */
+  template <Side side, OrderStyle style, typename Listener, Side bookSide>
+  static void fill(Listener &listener, OrderQueue<bookSide> &orderQueue,
+                   typename OrderQueue<bookSide>::iterator restingIt,
+                   Order<side> &order, Price fillPx, Quantity matchedQty) {
+    const auto restingQty = restingIt->getQuantity();
+
+    listener.template notifyTrader<bookSide, OrderStyle::LIMIT_ORDER,
+                                   OrderStatus::FILLED>(
+        restingIt->getTraderId(), restingIt->getOrderId(), order.getSymbol(),
+        fillPx, matchedQty);
+
+    orderQueue.setQuantity(restingIt, restingQty - matchedQty);
+    if (restingQty == matchedQty) {
+      if (restingIt->getHiddenQuantity()) {
+        // the next slice of the iceberg order joins the back of the level
+        orderQueue.replenish(restingIt);
+      } else {
+        listener.notifyTraderAllFilled(restingIt->getTraderId(),
+                                       restingIt->getOrderId());
+        orderQueue.erase(restingIt);
+      }
+    }
+
+    listener.template notifyTrader<side, style, OrderStatus::FILLED>(
+        order.getTraderId(), order.getOrderId(), order.getSymbol(), fillPx,
+        matchedQty);
+
+    order.setQuantity(order.getQuantity() - matchedQty);
+  }
+
+  /**
+   * @brief
+   * Share the whole incoming quantity among the orders of the level with the
+   * allocation policy of the book. The displayed quantities of the level are
+   * gathered in one walk of the queue, the allocation runs over the
+   * contiguous arrays and the fills are applied in a second walk.
+   * A level the incoming order fully consumes is left to the time priority
+   * sweep, it fills every order either way. So is a level holding an order of
+   * the same trader key, for the self-trade prevention to apply as usual.
+   * return true if the incoming quantity is allocated
+   */
+  template <Side side, OrderStyle style, typename StpPolicy, typename Listener,
+            Side bookSide>
+  static bool allocate(Listener &listener, const AllocationConfig &config,
+                       OrderQueue<bookSide> &orderQueue, Order<side> &order,
+                       Price fillPx) {
+    const auto quantity = order.getQuantity();
+    const auto total = orderQueue.totalQuantity();
+    if (quantity >= total) {
+      return false;
+    }
+
+    thread_local std::vector<Quantity> quantities;
+    thread_local std::vector<Quantity> allocations;
+    const auto size = orderQueue.numOfOrders();
+    quantities.resize(size);
+    allocations.assign(size, 0);
+
+    const bool isLeadMarketMaker =
+        config.policy == AllocationPolicy::LEAD_MARKET_MAKER;
+    Quantity leadShare = quantity * config.leadMarketMakerShare / 100;
+    Quantity allocated = 0;
+    size_t i = 0;
+    for (auto &resting : orderQueue) {
+      if constexpr (StpPolicy::enable) {
+        if (resting.getTraderKey() == order.getTraderKey()) {
+          return false;
+        }
+      }
+
+      quantities[i] = resting.getQuantity();
+      if (isLeadMarketMaker && leadShare &&
+          resting.getTraderKey() == config.leadMarketMakerKey) {
+        allocations[i] = std::min(quantities[i], leadShare);
+        leadShare -= allocations[i];
+        allocated += allocations[i];
+      }
+      i++;
+    }
+
+    if (!isLeadMarketMaker) {
+      allocated =
+          Allocator::proRata(quantities.data(), allocations.data(), size,
+                             quantity, total, config.minAllocation);
+    }
+    Allocator::fifo(quantities.data(), allocations.data(), size,
+                    quantity - allocated);
+
+    // the iceberg slices replenished to the back are not visited again
+    auto restingIt = orderQueue.begin();
+    for (i = 0; i < size && order.getQuantity(); i++) {
+      auto next = std::next(restingIt);
+      const auto matchedQty = std::min(allocations[i], order.getQuantity());
+      if (matchedQty) {
+        fill<side, style>(listener, orderQueue, restingIt, order, fillPx,
+                          matchedQty);
+      }
+      restingIt = next;
+    }
+    return true;
+  }
+
+  template <Side side, OrderStyle style>
+  static constexpr bool crosses(Price levelPx, Price limitPx) {
+    if constexpr (style == OrderStyle::MKT_ORDER) {
+      return true;
+    } else if constexpr (side == Side::BUY) {
+      return levelPx <= limitPx;
+    } else {
+      return levelPx >= limitPx;
+    }
+  }
+};
+
+#endif
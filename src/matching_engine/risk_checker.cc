@@ -0,0 +1,3 @@
+#include "risk_checker.h"
+
+using namespace Core;
@@ -0,0 +1,140 @@
+#ifndef RISK_CHECKER
+#define RISK_CHECKER
+#include <core/execution_context/execution_context.h>
+#include <core/order/order.h>
+#include <core/order_book/order_book.h>
+#include <cstdint>
+#include <types.h>
+
+using namespace Common;
+using namespace Core;
+
+/**
+ * @brief
+ * Pre-trade risk limits, a limit of 0 disables the corresponding check
+ * maxOrderQuantity: the quantity of a single order
+ * maxNotional: the price * quantity of a single order
+ * priceCollar: how far a BUY (SELL) order can be priced above the best ask
+ * (below the best bid)
+ * maxOpenOrders: the number of orders of a trader resting in the order books
+ * maxNetPosition: the absolute net position of a trader on a symbol, assuming
+ * the order and all the open orders on the same side are filled
+ */
+struct RiskConfig {
+  bool enable = false;
+  Quantity maxOrderQuantity = 0;
+  std::int64_t maxNotional = 0;
+  Price priceCollar = 0;
+  std::uint32_t maxOpenOrders = 0;
+  std::int64_t maxNetPosition = 0;
+};
+
+class RiskChecker {
+public:
+  /**
+   * @brief
+   * Check the order against the limits, every check is a couple of integer
+   * comparisons against the best price of the book and the counters that the
+   * ExecutionContext maintains incrementally, nothing is scanned.
+   * The price of a market order is the best price on the other side, 0 if
+   * there is none.
+   */
+  template <Side side, OrderStyle style>
+  static OrderRejectReason check(const RiskConfig &config,
+                                 const ExecutionContext &context,
+                                 OrderBook &book, const TraderId &traderId,
+                                 const Symbol &symbol, Price price,
+                                 Quantity quantity) {
+    auto rsn = checkOrder<side, style>(config, book, price, quantity);
+    if (rsn != OrderRejectReason::NONE) {
+      return rsn;
+    }
+    return checkTrader<side, style>(config, context, traderId, symbol,
+                                    quantity);
+  }
+
+  /**
+   * @brief
+   * The checks that only depend on the order itself and the book, they also
+   * apply to the new price and quantity of an amended order
+   */
+  template <Side side, OrderStyle style>
+  static OrderRejectReason checkOrder(const RiskConfig &config,
+                                      OrderBook &book, Price price,
+                                      Quantity quantity) {
+    if (config.maxOrderQuantity && quantity > config.maxOrderQuantity) {
+      return OrderRejectReason::MAX_ORDER_QUANTITY;
+    }
+
+    if (config.maxNotional &&
+        price.notional(quantity) > config.maxNotional) {
+      return OrderRejectReason::MAX_NOTIONAL;
+    }
+
+    if constexpr (style != OrderStyle::MKT_ORDER) {
+      if (config.priceCollar && isOutsideCollar<side>(config, book, price)) {
+        return OrderRejectReason::PRICE_COLLAR;
+      }
+    }
+
+    return OrderRejectReason::NONE;
+  }
+
+  /**
+   * @brief
+   * The checks against the open orders and the position of the trader. The
+   * amend of a resting order passes the quantity it adds and isNewOrder
+   * false, it does not add an open order.
+   */
+  template <Side side, OrderStyle style>
+  static OrderRejectReason checkTrader(const RiskConfig &config,
+                                       const ExecutionContext &context,
+                                       const TraderId &traderId,
+                                       const Symbol &symbol,
+                                       Quantity quantity,
+                                       bool isNewOrder = true) {
+    if (!config.maxOpenOrders && !config.maxNetPosition) {
+      return OrderRejectReason::NONE;
+    }
+
+    auto account = context.findAccount(traderId);
+    // only the limit orders can rest in the order book
+    if constexpr (style == OrderStyle::LIMIT_ORDER) {
+      if (config.maxOpenOrders && isNewOrder && account &&
+          account->getOpenOrderCount() >= config.maxOpenOrders) {
+        return OrderRejectReason::MAX_OPEN_ORDERS;
+      }
+    }
+
+    if (config.maxNetPosition) {
+      auto position = account ? account->findPosition(symbol) : nullptr;
+      auto qty = static_cast<std::int64_t>(quantity);
+      std::int64_t exposure = qty;
+      if (position) {
+        exposure = (side == Side::BUY)
+                       ? position->getMaxLongExposure() + qty
+                       : qty - position->getMaxShortExposure();
+      }
+
+      if (exposure > config.maxNetPosition) {
+        return OrderRejectReason::MAX_NET_POSITION;
+      }
+    }
+
+    return OrderRejectReason::NONE;
+  }
+
+private:
+  template <Side side>
+  static bool isOutsideCollar(const RiskConfig &config, OrderBook &book,
+                              Price price) {
+    if constexpr (side == Side::BUY) {
+      return book.getNumOfLevels<Side::SELL>() &&
+             price > book.getBest<Side::SELL>() + config.priceCollar;
+    } else {
+      return book.getNumOfLevels<Side::BUY>() &&
+             price < book.getBest<Side::BUY>() - config.priceCollar;
+    }
+  }
+};
+#endif
@@ -6,6 +6,7 @@
 #include <deque>
 #include <map>
 #include <types.h>
+#include <unordered_map>
 #include <unordered_set>
 
 using namespace Common;
@@ -16,136 +17,232 @@ using namespace Core;
  * CANCEL_PASSIVE: cancel the existing order
  * CANCEL_ACTIVE: cancel the incoming order
  * CANCEL_BOTH: cancel both existing order and incoming order
+ * DECREMENT_AND_CANCEL: reduce the larger order by the quantity of the smaller
+ * one and cancel the smaller one, both are cancelled if they are equal
  */
 enum class SelfTradePreventionPolicy {
   CANCEL_PASSIVE,
   CANCEL_ACTIVE,
-  CANCEL_BOTH
+  CANCEL_BOTH,
+  DECREMENT_AND_CANCEL
 };
 
+using StpGroupId = std::uint32_t;
+
+/**
+ * @brief
+ * The traders mapped to the same group are treated as a single trader by the
+ * self-trade prevention, the others are only matched against themselves. The
+ * group of a trader is read when the trader sends its first order.
+ */
 struct SelfTradePreventionConfig {
   bool enable;
   SelfTradePreventionPolicy policy;
+  std::unordered_map<TraderId, StpGroupId> groups;
+};
+
+/**
+ * @brief
+ * Compile-time self-trade prevention policies of the matching kernel, the
+ * policy is resolved once per incoming order instead of once per resting
+ * order.
+ */
+struct NoSelfTradePrevention {
+  static constexpr bool enable = false;
+};
+
+template <SelfTradePreventionPolicy stpPolicy> struct SelfTradePrevention {
+  static constexpr bool enable = true;
+  static constexpr SelfTradePreventionPolicy policy = stpPolicy;
+};
+
+/**
+ * @brief
+ * The policy is read from the SelfTradePreventionConfig of the engine
+ */
+struct RuntimeSelfTradePrevention {
+  static constexpr bool enable = true;
 };
 
 class SelfTradeHandler {
 public:
-  template <OrderStyle style, Side bookSide, Side orderSide>
-  static void dispatch(SelfTradePreventionPolicy policy,
-                       ExecutionContext &context, OrderQueue<bookSide> &queue,
-                       Order<orderSide> &order) {
+  template <OrderStyle style, Side bookSide, Side orderSide,
+            typename Listener = ExecutionContext>
+  static void dispatch(SelfTradePreventionPolicy policy, Listener &context,
+                       OrderQueue<bookSide> &queue, Order<orderSide> &order) {
+    switch (policy) {
+    case SelfTradePreventionPolicy::CANCEL_ACTIVE:
+      handle<SelfTradePreventionPolicy::CANCEL_ACTIVE, style>(context, queue,
+                                                              order);
+      break;
+    case SelfTradePreventionPolicy::CANCEL_BOTH:
+      handle<SelfTradePreventionPolicy::CANCEL_BOTH, style>(context, queue,
+                                                            order);
+      break;
+    case SelfTradePreventionPolicy::DECREMENT_AND_CANCEL:
+      handle<SelfTradePreventionPolicy::DECREMENT_AND_CANCEL, style>(
+          context, queue, order);
+      break;
+    default:
+      handle<SelfTradePreventionPolicy::CANCEL_PASSIVE, style>(context, queue,
+                                                               order);
+    }
+  }
+
+  /**
+   * @brief
+   * Resolve the self-match between the incoming order and the order at the
+   * front of the queue, the policy is a template parameter so that the
+   * handler is selected at compile time
+   */
+  template <SelfTradePreventionPolicy policy, OrderStyle style, Side bookSide,
+            Side orderSide, typename Listener>
+  static void handle(Listener &context, OrderQueue<bookSide> &queue,
+                     Order<orderSide> &order) {
     static_assert(bookSide != orderSide,
                   "The BookSide should not be same as the OrderSide");
-    if (style == OrderStyle::LIMIT_ORDER) {
-      switch (policy) {
-      case SelfTradePreventionPolicy::CANCEL_ACTIVE:
-        cancelActiveLimitOrder<bookSide, orderSide>(context, queue, order);
-        break;
-      case SelfTradePreventionPolicy::CANCEL_BOTH:
-        cancelBothLimitOrder<bookSide, orderSide>(context, queue, order);
-        break;
-      default:
-        cancelPassiveLimitOrder<bookSide, orderSide>(context, queue, order);
+    if constexpr (policy == SelfTradePreventionPolicy::DECREMENT_AND_CANCEL) {
+      decrementAndCancel<style>(context, queue, order);
+    } else if constexpr (style != OrderStyle::MKT_ORDER) {
+      if constexpr (policy == SelfTradePreventionPolicy::CANCEL_ACTIVE) {
+        cancelActiveLimitOrder(context, queue, order);
+      } else if constexpr (policy == SelfTradePreventionPolicy::CANCEL_BOTH) {
+        cancelBothLimitOrder(context, queue, order);
+      } else {
+        cancelPassiveLimitOrder(context, queue, order);
       }
     } else {
-      switch (policy) {
-      case SelfTradePreventionPolicy::CANCEL_ACTIVE:
-        cancelActiveMarketOrder<bookSide, orderSide>(context, queue, order);
-        break;
-      case SelfTradePreventionPolicy::CANCEL_BOTH:
-        cancelBothMarketOrder<bookSide, orderSide>(context, queue, order);
-        break;
-      default:
-        cancelPassiveMarketOrder<bookSide, orderSide>(context, queue, order);
+      if constexpr (policy == SelfTradePreventionPolicy::CANCEL_ACTIVE) {
+        cancelActiveMarketOrder(context, queue, order);
+      } else if constexpr (policy == SelfTradePreventionPolicy::CANCEL_BOTH) {
+        cancelBothMarketOrder(context, queue, order);
+      } else {
+        cancelPassiveMarketOrder(context, queue, order);
       }
     }
   }
 
 private:
-  template <Side bookSide, Side orderSide>
-  static void cancelActiveMarketOrder(ExecutionContext &context,
+  template <OrderStyle style, Side bookSide, Side orderSide, typename Listener>
+  static void decrementAndCancel(Listener &context, OrderQueue<bookSide> &queue,
+                                 Order<orderSide> &order) {
+    auto &frontOrder = queue.front();
+    const auto frontOrderQty = frontOrder.getTotalQuantity();
+    const auto orderQty = order.getQuantity();
+
+    if (orderQty >= frontOrderQty) {
+      context.template notifyTrader<bookSide, OrderStyle::LIMIT_ORDER,
+                                    OrderStatus::CANCEL>(
+          frontOrder.getTraderId(), frontOrder.getOrderId(),
+          frontOrder.getSymbol(), frontOrder.getPrice(), frontOrderQty,
+          OrderCancelReason::SELF_TRADE);
+      queue.pop();
+    } else {
+      queue.setTotalQuantity(queue.begin(), frontOrderQty - orderQty);
+      context.template notifyTrader<bookSide, OrderStyle::LIMIT_ORDER,
+                                    OrderStatus::AMEND>(
+          frontOrder.getTraderId(), frontOrder.getOrderId(),
+          frontOrder.getSymbol(), frontOrder.getPrice(),
+          frontOrder.getTotalQuantity());
+    }
+
+    if (orderQty <= frontOrderQty) {
+      context.template notifyTrader<orderSide, style, OrderStatus::CANCEL>(
+          order.getTraderId(), order.getOrderId(), order.getSymbol(),
+          order.getPrice(), orderQty, OrderCancelReason::SELF_TRADE);
+      order.setQuantity(0);
+    } else {
+      order.setQuantity(orderQty - frontOrderQty);
+    }
+  }
+
+  template <Side bookSide, Side orderSide, typename Listener>
+  static void cancelActiveMarketOrder(Listener &context,
                                       OrderQueue<bookSide> &queue,
                                       Order<orderSide> &order) {
-    context.notifyTrader<orderSide, OrderStyle::MKT_ORDER, OrderStatus::CANCEL>(
+    context.template notifyTrader<orderSide, OrderStyle::MKT_ORDER,
+                                  OrderStatus::CANCEL>(
         order.getTraderId(), order.getOrderId(), order.getSymbol(),
         order.getPrice(), order.getQuantity(), OrderCancelReason::SELF_TRADE);
 
     order.setQuantity(0);
   }
 
-  template <Side bookSide, Side orderSide>
-  static void cancelBothMarketOrder(ExecutionContext &context,
+  template <Side bookSide, Side orderSide, typename Listener>
+  static void cancelBothMarketOrder(Listener &context,
                                     OrderQueue<bookSide> &queue,
                                     Order<orderSide> &order) {
     auto &frontOrder = queue.front();
-    context.notifyTrader<orderSide, OrderStyle::MKT_ORDER, OrderStatus::CANCEL>(
+    context.template notifyTrader<orderSide, OrderStyle::MKT_ORDER,
+                                  OrderStatus::CANCEL>(
         order.getTraderId(), order.getOrderId(), order.getSymbol(),
         order.getPrice(), order.getQuantity(), OrderCancelReason::SELF_TRADE);
 
-    context
-        .notifyTrader<bookSide, OrderStyle::LIMIT_ORDER, OrderStatus::CANCEL>(
-            frontOrder.getTraderId(), frontOrder.getOrderId(),
-            frontOrder.getSymbol(), frontOrder.getPrice(),
-            frontOrder.getQuantity(), OrderCancelReason::SELF_TRADE);
+    context.template notifyTrader<bookSide, OrderStyle::LIMIT_ORDER,
+                                  OrderStatus::CANCEL>(
+        frontOrder.getTraderId(), frontOrder.getOrderId(),
+        frontOrder.getSymbol(), frontOrder.getPrice(),
+        frontOrder.getTotalQuantity(), OrderCancelReason::SELF_TRADE);
 
     queue.pop();
     order.setQuantity(0);
   }
 
-  template <Side bookSide, Side orderSide>
-  static void cancelPassiveMarketOrder(ExecutionContext &context,
+  template <Side bookSide, Side orderSide, typename Listener>
+  static void cancelPassiveMarketOrder(Listener &context,
                                        OrderQueue<bookSide> &queue,
                                        Order<orderSide> &order) {
     auto &frontOrder = queue.front();
-    context.notifyTrader<bookSide, OrderStyle::MKT_ORDER, OrderStatus::CANCEL>(
+    context.template notifyTrader<bookSide, OrderStyle::MKT_ORDER,
+                                  OrderStatus::CANCEL>(
         frontOrder.getTraderId(), frontOrder.getOrderId(),
-        frontOrder.getSymbol(), frontOrder.getPrice(), frontOrder.getQuantity(),
-        OrderCancelReason::SELF_TRADE);
+        frontOrder.getSymbol(), frontOrder.getPrice(),
+        frontOrder.getTotalQuantity(), OrderCancelReason::SELF_TRADE);
 
     queue.pop();
   }
 
-  template <Side bookSide, Side orderSide>
-  static void cancelActiveLimitOrder(ExecutionContext &context,
+  template <Side bookSide, Side orderSide, typename Listener>
+  static void cancelActiveLimitOrder(Listener &context,
                                      OrderQueue<bookSide> &queue,
                                      Order<orderSide> &order) {
-    context
-        .notifyTrader<orderSide, OrderStyle::LIMIT_ORDER, OrderStatus::CANCEL>(
-            order.getTraderId(), order.getOrderId(), order.getSymbol(),
-            order.getPrice(), order.getQuantity(),
-            OrderCancelReason::SELF_TRADE);
+    context.template notifyTrader<orderSide, OrderStyle::LIMIT_ORDER,
+                                  OrderStatus::CANCEL>(
+        order.getTraderId(), order.getOrderId(), order.getSymbol(),
+        order.getPrice(), order.getQuantity(),
+        OrderCancelReason::SELF_TRADE);
     order.setQuantity(0);
   }
-  template <Side bookSide, Side orderSide>
-  static void cancelBothLimitOrder(ExecutionContext &context,
+  template <Side bookSide, Side orderSide, typename Listener>
+  static void cancelBothLimitOrder(Listener &context,
                                    OrderQueue<bookSide> &queue,
                                    Order<orderSide> &order) {
     auto &frontOrder = queue.front();
-    context
-        .notifyTrader<orderSide, OrderStyle::LIMIT_ORDER, OrderStatus::CANCEL>(
-            order.getTraderId(), order.getOrderId(), order.getSymbol(),
-            order.getPrice(), order.getQuantity(),
-            OrderCancelReason::SELF_TRADE);
-
-    context
-        .notifyTrader<bookSide, OrderStyle::LIMIT_ORDER, OrderStatus::CANCEL>(
-            frontOrder.getTraderId(), frontOrder.getOrderId(),
-            frontOrder.getSymbol(), frontOrder.getPrice(),
-            frontOrder.getQuantity(), OrderCancelReason::SELF_TRADE);
+    context.template notifyTrader<orderSide, OrderStyle::LIMIT_ORDER,
+                                  OrderStatus::CANCEL>(
+        order.getTraderId(), order.getOrderId(), order.getSymbol(),
+        order.getPrice(), order.getQuantity(),
+        OrderCancelReason::SELF_TRADE);
+
+    context.template notifyTrader<bookSide, OrderStyle::LIMIT_ORDER,
+                                  OrderStatus::CANCEL>(
+        frontOrder.getTraderId(), frontOrder.getOrderId(),
+        frontOrder.getSymbol(), frontOrder.getPrice(),
+        frontOrder.getTotalQuantity(), OrderCancelReason::SELF_TRADE);
 
     queue.pop();
     order.setQuantity(0);
   }
-  template <Side bookSide, Side orderSide>
-  static void cancelPassiveLimitOrder(ExecutionContext &context,
+  template <Side bookSide, Side orderSide, typename Listener>
+  static void cancelPassiveLimitOrder(Listener &context,
                                       OrderQueue<bookSide> &queue,
                                       Order<orderSide> &order) {
     auto &frontOrder = queue.front();
-    context
-        .notifyTrader<bookSide, OrderStyle::LIMIT_ORDER, OrderStatus::CANCEL>(
-            frontOrder.getTraderId(), frontOrder.getOrderId(),
-            frontOrder.getSymbol(), frontOrder.getPrice(),
-            frontOrder.getQuantity(), OrderCancelReason::SELF_TRADE);
+    context.template notifyTrader<bookSide, OrderStyle::LIMIT_ORDER,
+                                  OrderStatus::CANCEL>(
+        frontOrder.getTraderId(), frontOrder.getOrderId(),
+        frontOrder.getSymbol(), frontOrder.getPrice(),
+        frontOrder.getTotalQuantity(), OrderCancelReason::SELF_TRADE);
 
     queue.pop();
   }
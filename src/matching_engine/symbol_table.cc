@@ -0,0 +1,47 @@
+#include "symbol_table.h"
+#include <fstream>
+#include <sstream>
+
+bool SymbolTable::load(const std::string &path,
+                       std::vector<SymbolConfig> &configs) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    SymbolConfig config;
+    if (!(fields >> config.symbol) || config.symbol[0] == '#') {
+      continue;
+    }
+
+    std::string tickSize, minPrice, maxPrice;
+    std::string backend = "MAP";
+    if (!(fields >> config.priceScale >> tickSize >> config.lotSize >>
+          minPrice >> maxPrice)) {
+      return false;
+    }
+    fields >> backend;
+
+    if (!Price::parse(tickSize, config.priceScale, config.tickSize) ||
+        !Price::parse(minPrice, config.priceScale, config.minPrice) ||
+        !Price::parse(maxPrice, config.priceScale, config.maxPrice)) {
+      return false;
+    }
+
+    if (config.tickSize <= 0 || config.lotSize == 0 || config.minPrice <= 0 ||
+        config.maxPrice < config.minPrice) {
+      return false;
+    }
+
+    if (backend != "MAP") {
+      return false;
+    }
+
+    configs.push_back(config);
+  }
+
+  return true;
+}
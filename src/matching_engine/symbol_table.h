@@ -0,0 +1,122 @@
+#ifndef SYMBOL_TABLE
+#define SYMBOL_TABLE
+#include <core/order/order.h>
+#include <optional>
+#include <string>
+#include <types.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+/**
+ * @brief
+ * The order book implementation of a symbol, the MAP book is the only one so
+ * far and the symbol file names it for the books to come
+ */
+enum class BookBackend { MAP };
+
+/**
+ * @brief
+ * The static data of a symbol, the defaults accept any positive price and
+ * quantity
+ * priceScale: the number of decimals of the prices, a price of the symbol is
+ * a number of units of 10^-priceScale
+ * tickSize: the prices are multiples of it
+ * lotSize: the quantities are multiples of it
+ * minPrice, maxPrice: the price band, both included
+ */
+struct SymbolConfig {
+  Symbol symbol;
+  unsigned priceScale = 0;
+  Price tickSize = 1;
+  Quantity lotSize = 1;
+  Price minPrice = 1;
+  Price maxPrice = Price::max();
+  BookBackend backend = BookBackend::MAP;
+};
+
+/**
+ * @brief
+ * The registry of the symbols: every symbol added gets the next dense id and
+ * its static data is stored in a table indexed by the id. The order book of
+ * a symbol keeps its id so an incoming order is checked without another
+ * lookup by name.
+ */
+class SymbolTable {
+public:
+  /**
+   * @brief
+   * Add a row for the symbol
+   * return the id of the symbol, the index of its row
+   */
+  SymbolId add(const SymbolConfig &config) {
+    auto symbolId = static_cast<SymbolId>(mConfigs.size());
+    mConfigs.push_back(config);
+    mIds.emplace(config.symbol, symbolId);
+    return symbolId;
+  }
+
+  std::optional<SymbolId> find(const Symbol &symbol) const {
+    auto it = mIds.find(symbol);
+    if (it == mIds.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  // the symbol of the config is the one of the row
+  void set(SymbolId symbolId, const SymbolConfig &config) {
+    mConfigs[symbolId] = config;
+  }
+
+  const SymbolConfig &operator[](SymbolId symbolId) const {
+    return mConfigs[symbolId];
+  }
+
+  size_t size() const { return mConfigs.size(); }
+
+  /**
+   * @brief
+   * Check the order against the tick size, the lot size and the price band
+   * of the symbol, a market order has no price to check
+   */
+  template <OrderStyle style>
+  OrderRejectReason check(SymbolId symbolId, Price price,
+                          Quantity quantity) const {
+    const auto &config = mConfigs[symbolId];
+    if (quantity % config.lotSize) {
+      return OrderRejectReason::TICK_OR_LOT_SIZE;
+    }
+
+    if constexpr (style != OrderStyle::MKT_ORDER) {
+      if (price % config.tickSize) {
+        return OrderRejectReason::TICK_OR_LOT_SIZE;
+      }
+      if (price < config.minPrice || price > config.maxPrice) {
+        return OrderRejectReason::PRICE_BAND;
+      }
+    }
+
+    return OrderRejectReason::NONE;
+  }
+
+  /**
+   * @brief
+   * Read the static data of the symbols from a file, one symbol per line:
+   *   symbol priceScale tickSize lotSize minPrice maxPrice [MAP]
+   * The prices are decimals with at most priceScale decimals, e.g. 0.05 for
+   * a tick of 5 units of a symbol of scale 2. The empty lines and the lines
+   * starting with '#' are skipped.
+   * return false if the file cannot be read or a line is malformed, the
+   * configs of the lines before it are kept
+   */
+  static bool load(const std::string &path, std::vector<SymbolConfig> &configs);
+
+private:
+  std::vector<SymbolConfig> mConfigs;
+  std::unordered_map<Symbol, SymbolId> mIds;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "io_backend.h"
+#include "uring_backend.h"
+#include <cerrno>
+#include <unistd.h>
+
+namespace {
+
+// the fallback: every write is a system call made when it is queued
+class WriteBackend : public IoBackend {
+public:
+  int registerBuffer(char *, size_t) override { return -1; }
+
+  void queueWrite(int fd, const char *data, size_t size, off_t offset,
+                  int) override {
+    while (size) {
+      auto written = ::pwrite(fd, data, size, offset);
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written <= 0) {
+        mHasFailed = true;
+        return;
+      }
+      data += written;
+      size -= written;
+      offset += written;
+    }
+  }
+
+  void queueSend(int fd, OutputQueue &queue) override {
+    if (!queue.flush(fd)) {
+      queue.setFailed();
+    }
+  }
+
+  bool submit() override {
+    bool hasFailed = mHasFailed;
+    mHasFailed = false;
+    return !hasFailed;
+  }
+
+  bool waitForWrites(int) override { return submit(); }
+
+private:
+  bool mHasFailed = false;
+};
+
+} // namespace
+
+std::optional<IoBackendType> str2IoBackendType(std::string_view name) {
+  if (name == "write") {
+    return IoBackendType::WRITE;
+  } else if (name == "io_uring") {
+    return IoBackendType::IO_URING;
+  }
+  return std::nullopt;
+}
+
+std::unique_ptr<IoBackend> makeIoBackend(IoBackendType type) {
+  switch (type) {
+  case IoBackendType::WRITE:
+    return std::make_unique<WriteBackend>();
+  case IoBackendType::IO_URING: {
+    auto backend = std::make_unique<UringBackend>();
+    if (!backend->setUp()) {
+      return nullptr;
+    }
+    return backend;
+  }
+  }
+  return nullptr;
+}
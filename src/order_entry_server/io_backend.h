@@ -0,0 +1,73 @@
+#ifndef IO_BACKEND
+#define IO_BACKEND
+#include "output_queue.h"
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <sys/types.h>
+
+/**
+ * @brief
+ * The system calls the order entry server makes to send its reports and
+ * append its journal. WRITE makes a sendmsg or pwrite as each one is queued,
+ * IO_URING gathers the queued ones of a batch and submits them to an
+ * io_uring in one system call.
+ */
+enum class IoBackendType { WRITE, IO_URING };
+
+std::optional<IoBackendType> str2IoBackendType(std::string_view name);
+
+/**
+ * @brief
+ * The writes and sends of a batch are queued and handed over by submit().
+ * The sends and the writes from unregistered buffers are done when submit()
+ * returns. The writes from a registered buffer may still be in flight, the
+ * buffer is reused once waitForWrites() of it returns. The result of a send
+ * goes to its queue: the bytes sent are consumed and a failure is marked on
+ * the queue. A socket that would block keeps the rest of its queue for the
+ * next send.
+ */
+class IoBackend {
+public:
+  virtual ~IoBackend() = default;
+
+  /**
+   * @brief
+   * Register a buffer that the writes of a file are made from, so that the
+   * kernel does not map it on every write
+   * return the index of the buffer for queueWrite(), or -1 if the backend
+   * does not register buffers
+   */
+  virtual int registerBuffer(char *data, size_t size) = 0;
+
+  // queue the write of the bytes at the offset of the file
+  virtual void queueWrite(int fd, const char *data, size_t size, off_t offset,
+                          int bufferIndex) = 0;
+
+  // queue the send of the queue to the non-blocking socket
+  virtual void queueSend(int fd, OutputQueue &queue) = 0;
+
+  /**
+   * @brief
+   * Hand over the queued writes and sends, and complete the sends
+   * return false if a write of a file failed
+   */
+  virtual bool submit() = 0;
+
+  /**
+   * @brief
+   * Submit and wait until the writes from the registered buffer are done
+   * return false if a write of a file failed
+   */
+  virtual bool waitForWrites(int bufferIndex) = 0;
+};
+
+/**
+ * @brief
+ * Make a backend of the type
+ * return nullptr if the kernel does not support it
+ */
+std::unique_ptr<IoBackend> makeIoBackend(IoBackendType type);
+
+#endif
@@ -0,0 +1,65 @@
+#include "journal.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+Journal::Journal(IoBackend &backend) : mBackend(backend) {
+  for (auto &buffer : mBuffers) {
+    buffer.mData = std::make_unique<char[]>(kBufferSize);
+    buffer.mIndex = mBackend.registerBuffer(buffer.mData.get(), kBufferSize);
+  }
+}
+
+Journal::~Journal() {
+  if (mFd >= 0) {
+    flush();
+    for (auto &buffer : mBuffers) {
+      mBackend.waitForWrites(buffer.mIndex);
+    }
+    ::close(mFd);
+  }
+}
+
+bool Journal::open(const std::string &path) {
+  mFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  return mFd >= 0;
+}
+
+bool Journal::append(const char *data, size_t size) {
+  if (mFd < 0) {
+    return false;
+  }
+
+  bool isWritten = true;
+  while (size) {
+    auto &buffer = mBuffers[mCurrent];
+    if (buffer.mIsWriting) {
+      isWritten = mBackend.waitForWrites(buffer.mIndex) && isWritten;
+      buffer.mIsWriting = false;
+    }
+
+    auto copied = std::min(size, kBufferSize - mSize);
+    std::memcpy(buffer.mData.get() + mSize, data, copied);
+    mSize += copied;
+    data += copied;
+    size -= copied;
+    if (mSize == kBufferSize) {
+      flush();
+    }
+  }
+  return isWritten;
+}
+
+void Journal::flush() {
+  if (mFd < 0 || !mSize) {
+    return;
+  }
+
+  auto &buffer = mBuffers[mCurrent];
+  mBackend.queueWrite(mFd, buffer.mData.get(), mSize, mOffset, buffer.mIndex);
+  buffer.mIsWriting = true;
+  mOffset += static_cast<off_t>(mSize);
+  mSize = 0;
+  mCurrent = 1 - mCurrent;
+}
@@ -0,0 +1,70 @@
+#ifndef JOURNAL
+#define JOURNAL
+#include "io_backend.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+
+/**
+ * @brief
+ * The record of the frames executed by the order entry server, in the order
+ * of execution and as they were received, so the file is a stream of frames
+ * that decodeFrames() reads back. The frames are appended to one of two
+ * buffers registered with the IoBackend and written as one append per batch,
+ * the other buffer is filled while the write may still be in flight. The
+ * journal is written to the page cache, it is not synced.
+ */
+class Journal {
+public:
+  static constexpr size_t kBufferSize = 1024 * 1024;
+
+  explicit Journal(IoBackend &backend);
+  ~Journal();
+
+  Journal(const Journal &other) = delete;
+  Journal &operator=(const Journal &) = delete;
+  Journal(Journal &&other) = delete;
+  Journal &operator=(Journal &&other) = delete;
+
+  /**
+   * @brief
+   * Create or truncate the file of the journal
+   * return false if the file cannot be opened
+   */
+  bool open(const std::string &path);
+
+  /**
+   * @brief
+   * Append the bytes, a buffer filled up is written at once
+   * return false if the journal is not open or a write failed
+   */
+  bool append(const char *data, size_t size);
+
+  /**
+   * @brief
+   * Queue the write of the buffered bytes, the next submit() of the backend
+   * hands it over
+   */
+  void flush();
+
+  // the size of the journal, the buffered bytes included
+  off_t size() const { return mOffset + static_cast<off_t>(mSize); }
+
+private:
+  struct Buffer {
+    std::unique_ptr<char[]> mData;
+    int mIndex = -1;
+    bool mIsWriting = false;
+  };
+
+  IoBackend &mBackend;
+  Buffer mBuffers[2];
+  // the buffer appended to and the size of its bytes
+  size_t mCurrent = 0;
+  size_t mSize = 0;
+  off_t mOffset = 0;
+  int mFd = -1;
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "order_entry_server.h"
+#include <csignal>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+OrderEntryServer *gServer = nullptr;
+
+void usage() {
+  std::cerr << "usage: order_entry_server --symbols <file> "
+               "--traders <id,id,...> [--address <ipv4>] [--port <port>]\n"
+               "    [--io write|io_uring] [--journal <path>]\n"
+               "  the index of a trader in the messages is its position in "
+               "--traders\n";
+}
+
+void onSignal(int) {
+  if (gServer) {
+    gServer->stop();
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string symbolsPath, traders, address = "127.0.0.1", journalPath;
+  std::string io = "write";
+  std::uint16_t port = 9000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string_view option = argv[i];
+    if (option == "--symbols") {
+      symbolsPath = argv[i + 1];
+    } else if (option == "--traders") {
+      traders = argv[i + 1];
+    } else if (option == "--address") {
+      address = argv[i + 1];
+    } else if (option == "--io") {
+      io = argv[i + 1];
+    } else if (option == "--journal") {
+      journalPath = argv[i + 1];
+    } else if (option == "--port") {
+      port = static_cast<std::uint16_t>(std::stoul(argv[i + 1]));
+    }
+  }
+  auto ioType = str2IoBackendType(io);
+  if (symbolsPath.empty() || traders.empty() || !ioType) {
+    usage();
+    return 1;
+  }
+
+  MatchingEngine engine;
+  if (!engine.loadStocks(symbolsPath)) {
+    std::cerr << "cannot load the symbols from " << symbolsPath << '\n';
+    return 1;
+  }
+
+  std::vector<TraderId> traderIds;
+  std::istringstream traderList(traders);
+  for (std::string traderId; std::getline(traderList, traderId, ',');) {
+    traderIds.push_back(traderId);
+  }
+
+  auto backend = makeIoBackend(*ioType);
+  if (!backend) {
+    std::cerr << io << " is not supported, falling back to write\n";
+    backend = makeIoBackend(IoBackendType::WRITE);
+  }
+  Journal journal(*backend);
+  if (!journalPath.empty() && !journal.open(journalPath)) {
+    std::cerr << "cannot open the journal " << journalPath << '\n';
+    return 1;
+  }
+
+  // the reports go to the connections, the log of the traders is dropped
+  ExecutionContext context;
+  context.setTraderLog(nullptr);
+  context.addTraders(traderIds);
+  OrderEntryServer server(engine, context, traderIds, *backend,
+                          journalPath.empty() ? nullptr : &journal);
+  if (!server.listen(address, port)) {
+    std::cerr << "cannot listen on " << address << ":" << port << '\n';
+    return 1;
+  }
+  std::cerr << "listening on " << address << ":" << server.getPort() << '\n';
+
+  gServer = &server;
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+  std::signal(SIGPIPE, SIG_IGN);
+  return server.run() ? 0 : 1;
+}
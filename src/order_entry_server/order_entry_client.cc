@@ -0,0 +1,178 @@
+#include <arpa/inet.h>
+#include <cerrno>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <gateway/binary_protocol.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Common;
+
+namespace {
+
+constexpr size_t kReadSize = 1024 * 1024;
+
+void usage() {
+  std::cerr << "usage: order_entry_client [--address <ipv4>] [--port <port>] "
+               "[--count <messages>] [--window <messages>]\n"
+               "  sends crossing limit orders of traders 0 and 1 on symbol 0 "
+               "and reports the throughput\n";
+}
+
+/**
+ * @brief
+ * Reads the reports of the server and keeps the sequence number of the last
+ * message answered
+ */
+struct ReportCounter {
+  void onNewOrder(const BinaryProtocol::NewOrderView &) {}
+  void onCancel(const BinaryProtocol::CancelView &) {}
+  void onAmend(const BinaryProtocol::AmendView &) {}
+  void onMassCancel(const BinaryProtocol::MassCancelView &) {}
+  void onExecutionReport(const BinaryProtocol::ExecutionReportView &message) {
+    numOfReports++;
+    if (message.requestSeqNum() > lastAnswered) {
+      lastAnswered = message.requestSeqNum();
+    }
+  }
+
+  std::uint64_t numOfReports = 0;
+  std::uint64_t lastAnswered = 0;
+};
+
+} // namespace
+
+/**
+ * @brief
+ * A load generator of the order entry server. It keeps up to --window
+ * messages in flight, every message is a limit order of 1 on symbol 0 that
+ * crosses the previous one, so each pair of messages is a new order and a
+ * trade.
+ */
+int main(int argc, char *argv[]) {
+  std::string address = "127.0.0.1";
+  std::uint16_t port = 9000;
+  std::uint64_t count = 10'000'000;
+  std::uint64_t window = 100'000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string_view option = argv[i];
+    if (option == "--address") {
+      address = argv[i + 1];
+    } else if (option == "--port") {
+      port = static_cast<std::uint16_t>(std::stoul(argv[i + 1]));
+    } else if (option == "--count") {
+      count = std::stoull(argv[i + 1]);
+    } else if (option == "--window") {
+      window = std::stoull(argv[i + 1]);
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  sockaddr_in socketAddress{};
+  socketAddress.sin_family = AF_INET;
+  socketAddress.sin_port = htons(port);
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (::inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1 ||
+      fd < 0 ||
+      ::connect(fd, reinterpret_cast<sockaddr *>(&socketAddress),
+                sizeof(socketAddress)) < 0) {
+    std::cerr << "cannot connect to " << address << ":" << port << '\n';
+    return 1;
+  }
+  int enable = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+  // the messages are the same two frames over and over
+  constexpr size_t kFrameSize = BinaryProtocol::FrameHeader::kSize +
+                                BinaryProtocol::MessageHeader::kSize +
+                                BinaryProtocol::NewOrderView::kBlockLength;
+  char frames[2][kFrameSize];
+  for (std::uint32_t trader = 0; trader < 2; trader++) {
+    auto side = trader == 0 ? Side::BUY : Side::SELL;
+    auto size = BinaryProtocol::encodeNewOrder(
+        frames[trader] + BinaryProtocol::FrameHeader::kSize, trader, 0, side,
+        OrderStyle::LIMIT_ORDER, 100, 0, 1);
+    BinaryProtocol::encodeFrame(frames[trader], size);
+  }
+  std::vector<char> output(kFrameSize * 4096);
+  for (size_t i = 0; i < output.size() / kFrameSize; i++) {
+    std::memcpy(output.data() + i * kFrameSize, frames[i % 2], kFrameSize);
+  }
+
+  std::vector<char> input(kReadSize);
+  size_t inputSize = 0;
+  ReportCounter counter;
+  std::uint64_t numOfSent = 0;
+  size_t partialSize = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  while (counter.lastAnswered < count) {
+    auto inFlight = numOfSent - counter.lastAnswered;
+    bool isSending = numOfSent < count && inFlight < window;
+    pollfd event{fd, static_cast<short>(POLLIN | (isSending ? POLLOUT : 0)),
+                 0};
+    if (::poll(&event, 1, -1) < 0 && errno != EINTR) {
+      break;
+    }
+
+    if (isSending && (event.revents & POLLOUT)) {
+      // the frames of the buffer alternate between the two traders, the
+      // first one unsent is at the start of the buffer or the one after it
+      auto offset = (numOfSent % 2) * kFrameSize + partialSize;
+      auto numOfFrames = std::min(count - numOfSent, window - inFlight);
+      auto size = std::min<std::uint64_t>(numOfFrames * kFrameSize -
+                                              partialSize,
+                                          output.size() - offset);
+      auto written =
+          ::send(fd, output.data() + offset, size, MSG_DONTWAIT);
+      if (written < 0 && errno != EAGAIN && errno != EINTR) {
+        break;
+      }
+      // a partially sent frame is finished by the next send
+      if (written > 0) {
+        auto total = partialSize + written;
+        numOfSent += total / kFrameSize;
+        partialSize = total % kFrameSize;
+      }
+    }
+
+    if (event.revents & (POLLIN | POLLHUP | POLLERR)) {
+      auto numOfBytes = ::recv(fd, input.data() + inputSize,
+                               input.size() - inputSize, MSG_DONTWAIT);
+      if (numOfBytes == 0 || (numOfBytes < 0 && errno != EAGAIN)) {
+        break;
+      }
+      if (numOfBytes > 0) {
+        inputSize += numOfBytes;
+        auto consumed =
+            BinaryProtocol::decodeFrames(input.data(), inputSize, counter);
+        if (!consumed) {
+          break;
+        }
+        std::memmove(input.data(), input.data() + *consumed,
+                     inputSize - *consumed);
+        inputSize -= *consumed;
+      }
+    }
+  }
+  auto elapsed = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  ::close(fd);
+
+  std::cout << "messages: " << counter.lastAnswered << " of " << count
+            << "\nreports: " << counter.numOfReports
+            << "\nseconds: " << elapsed
+            << "\nmessages/s: " << counter.lastAnswered / elapsed << '\n';
+  return counter.lastAnswered == count ? 0 : 1;
+}
@@ -0,0 +1,353 @@
+#include "order_entry_server.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kMaxEvents = 256;
+constexpr int kEpollTimeoutMs = 100;
+constexpr size_t kReadSize = 64 * 1024;
+
+} // namespace
+
+OrderEntryServer::OrderEntryServer(MatchingEngine &engine,
+                                   ExecutionContext &context,
+                                   const std::vector<TraderId> &traderIds,
+                                   IoBackend &backend, Journal *journal)
+    : mEngine(engine), mContext(context), mOrderEntry(engine, context),
+      mBackend(backend), mJournal(journal) {
+  for (const auto &traderId : traderIds) {
+    mTraderIndexes.emplace(traderId, mOrderEntry.addTrader(traderId));
+  }
+  mTraderSessions.resize(traderIds.size(), nullptr);
+  mContext.setListener(this);
+}
+
+OrderEntryServer::~OrderEntryServer() {
+  mContext.setListener(nullptr);
+  for (auto &[fd, session] : mSessions) {
+    ::close(fd);
+  }
+  if (mListenFd >= 0) {
+    ::close(mListenFd);
+  }
+  if (mEpollFd >= 0) {
+    ::close(mEpollFd);
+  }
+}
+
+bool OrderEntryServer::listen(const std::string &address, std::uint16_t port) {
+  sockaddr_in socketAddress{};
+  socketAddress.sin_family = AF_INET;
+  socketAddress.sin_port = htons(port);
+  if (::inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1) {
+    return false;
+  }
+
+  mListenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  int enable = 1;
+  if (mListenFd < 0 ||
+      ::setsockopt(mListenFd, SOL_SOCKET, SO_REUSEADDR, &enable,
+                   sizeof(enable)) < 0 ||
+      ::bind(mListenFd, reinterpret_cast<sockaddr *>(&socketAddress),
+             sizeof(socketAddress)) < 0 ||
+      ::listen(mListenFd, SOMAXCONN) < 0) {
+    return false;
+  }
+
+  socklen_t size = sizeof(socketAddress);
+  ::getsockname(mListenFd, reinterpret_cast<sockaddr *>(&socketAddress),
+                &size);
+  mPort = ntohs(socketAddress.sin_port);
+
+  mEpollFd = ::epoll_create1(0);
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLET;
+  event.data.ptr = nullptr;
+  return mEpollFd >= 0 &&
+         ::epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mListenFd, &event) == 0;
+}
+
+bool OrderEntryServer::run() {
+  epoll_event events[kMaxEvents];
+  mIsRunning = true;
+  while (mIsRunning) {
+    int numOfEvents = ::epoll_wait(mEpollFd, events, kMaxEvents,
+                                   kEpollTimeoutMs);
+    if (numOfEvents < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+
+    // execute the messages of every ready connection
+    for (int i = 0; i < numOfEvents; i++) {
+      auto session = static_cast<Session *>(events[i].data.ptr);
+      if (!session) {
+        accept();
+        continue;
+      }
+
+      if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+        session->mIsClosing = true;
+      }
+      if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+        read(*session);
+      }
+      markDirty(*session);
+    }
+
+    // then write the journal and send the reports of the batch
+    if (mJournal) {
+      mJournal->flush();
+    }
+    for (auto session : mDirtySessions) {
+      mBackend.queueSend(session->mFd, session->mOutput);
+    }
+    bool isWritten = mBackend.submit() && !mHasJournalFailed;
+
+    for (auto session : mDirtySessions) {
+      session->mIsDirty = false;
+      if (session->mIsClosing || session->mOutput.hasFailed() ||
+          session->mOutput.size() > mMaxPendingOutput) {
+        close(*session);
+      }
+    }
+    mDirtySessions.clear();
+    if (!isWritten) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void OrderEntryServer::accept() {
+  while (true) {
+    int fd = ::accept4(mListenFd, nullptr, nullptr, SOCK_NONBLOCK);
+    if (fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+
+    int enable = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    auto session = std::make_unique<Session>();
+    session->mFd = fd;
+    session->mInput.resize(kReadSize);
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = session.get();
+    if (::epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+      ::close(fd);
+      continue;
+    }
+    mSessions.emplace(fd, std::move(session));
+  }
+}
+
+void OrderEntryServer::read(Session &session) {
+  auto &input = session.mInput;
+  while (!session.mIsClosing) {
+    if (input.size() - session.mInputSize < kReadSize / 2) {
+      input.resize(input.size() * 2);
+    }
+
+    auto numOfBytes = ::read(session.mFd, input.data() + session.mInputSize,
+                             input.size() - session.mInputSize);
+    if (numOfBytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      session.mIsClosing = errno != EAGAIN && errno != EWOULDBLOCK;
+      return;
+    }
+    if (numOfBytes == 0) {
+      session.mIsClosing = true;
+      return;
+    }
+
+    session.mInputSize += numOfBytes;
+    // a frame at a time, so that only the executed frames are journaled,
+    // those in front of a corrupted frame included
+    size_t consumed = 0;
+    mCurrentSession = &session;
+    while (true) {
+      mIsFrameExecuted = false;
+      auto frameSize = BinaryProtocol::decodeFrame(
+          input.data() + consumed, session.mInputSize - consumed, *this);
+      if (!frameSize) {
+        session.mIsClosing = true;
+        break;
+      }
+      if (*frameSize == 0) {
+        break;
+      }
+      if (mIsFrameExecuted && mJournal &&
+          !mJournal->append(input.data() + consumed, *frameSize)) {
+        mHasJournalFailed = true;
+      }
+      consumed += *frameSize;
+    }
+    mCurrentSession = nullptr;
+    if (session.mIsClosing) {
+      return;
+    }
+
+    std::memmove(input.data(), input.data() + consumed,
+                 session.mInputSize - consumed);
+    session.mInputSize -= consumed;
+  }
+}
+
+void OrderEntryServer::markDirty(Session &session) {
+  if (!session.mIsDirty) {
+    session.mIsDirty = true;
+    mDirtySessions.push_back(&session);
+  }
+}
+
+void OrderEntryServer::close(Session &session) {
+  for (auto &traderSession : mTraderSessions) {
+    if (traderSession == &session) {
+      traderSession = nullptr;
+    }
+  }
+  ::close(session.mFd);
+  mSessions.erase(session.mFd);
+}
+
+bool OrderEntryServer::bind(std::uint32_t traderIndex) {
+  if (traderIndex >= mTraderSessions.size()) {
+    return false;
+  }
+  auto &traderSession = mTraderSessions[traderIndex];
+  if (traderSession && traderSession != mCurrentSession) {
+    return false;
+  }
+  traderSession = mCurrentSession;
+  mCurrentSession->mInSeqNum++;
+  mCurrentTrader = traderIndex;
+  mIsFrameExecuted = true;
+  return true;
+}
+
+void OrderEntryServer::onNewOrder(
+    const BinaryProtocol::NewOrderView &message) {
+  if (bind(message.traderIndex())) {
+    mOrderEntry.onNewOrder(message);
+  }
+}
+
+void OrderEntryServer::onCancel(const BinaryProtocol::CancelView &message) {
+  if (bind(message.traderIndex())) {
+    mOrderEntry.onCancel(message);
+  }
+}
+
+void OrderEntryServer::onAmend(const BinaryProtocol::AmendView &message) {
+  if (bind(message.traderIndex())) {
+    mOrderEntry.onAmend(message);
+  }
+}
+
+void OrderEntryServer::onMassCancel(
+    const BinaryProtocol::MassCancelView &message) {
+  if (bind(message.traderIndex())) {
+    mOrderEntry.onMassCancel(message);
+  }
+}
+
+void OrderEntryServer::report(const TraderId &traderId, OrderId orderId,
+                              const Symbol *symbol,
+                              BinaryProtocol::ExecType execType, Side side,
+                              Price price, Quantity quantity,
+                              std::uint8_t reason) {
+  auto it = mTraderIndexes.find(traderId);
+  if (it == mTraderIndexes.end() || !mTraderSessions[it->second]) {
+    return;
+  }
+
+  auto traderIndex = it->second;
+  auto &session = *mTraderSessions[traderIndex];
+  bool isAnswer =
+      mCurrentSession == &session && mCurrentTrader == traderIndex;
+  auto symbolId = BinaryProtocol::kAllSymbols;
+  if (symbol && !symbol->empty()) {
+    symbolId = mEngine.getSymbolId(*symbol).value_or(symbolId);
+  }
+
+  auto buffer = session.mOutput.reserve(BinaryProtocol::kMaxFrameSize);
+  auto size = BinaryProtocol::encodeExecutionReport(
+      buffer + BinaryProtocol::FrameHeader::kSize, orderId,
+      isAnswer ? session.mInSeqNum : 0, ++session.mOutSeqNum, price, quantity,
+      traderIndex, symbolId, execType, side, reason);
+  session.mOutput.commit(BinaryProtocol::encodeFrame(buffer, size));
+  markDirty(session);
+}
+
+void OrderEntryServer::onOpen(const TraderId &traderId, OrderId orderId,
+                              const Symbol &symbol, Side side, OrderStyle,
+                              Price price, Quantity quantity) {
+  report(traderId, orderId, &symbol, BinaryProtocol::ExecType::NEW, side,
+         price, quantity, 0);
+}
+
+void OrderEntryServer::onFill(const TraderId &traderId, OrderId orderId,
+                              const Symbol &symbol, Side side, OrderStyle,
+                              Price price, Quantity quantity) {
+  report(traderId, orderId, &symbol, BinaryProtocol::ExecType::FILL, side,
+         price, quantity, 0);
+}
+
+void OrderEntryServer::onCancel(const TraderId &traderId, OrderId orderId,
+                                const Symbol &symbol, Side side, OrderStyle,
+                                Price price, Quantity quantity,
+                                OrderCancelReason rsn) {
+  report(traderId, orderId, &symbol, BinaryProtocol::ExecType::CANCEL, side,
+         price, quantity, static_cast<std::uint8_t>(rsn));
+}
+
+void OrderEntryServer::onCancelReject(const TraderId &traderId,
+                                      OrderId orderId) {
+  report(traderId, orderId, nullptr, BinaryProtocol::ExecType::CANCEL_REJECT,
+         Side::BUY, 0, 0, 0);
+}
+
+void OrderEntryServer::onAmend(const TraderId &traderId, OrderId orderId,
+                               const Symbol &symbol, Side side, Price price,
+                               Quantity quantity) {
+  report(traderId, orderId, &symbol, BinaryProtocol::ExecType::AMEND, side,
+         price, quantity, 0);
+}
+
+void OrderEntryServer::onAmendReject(const TraderId &traderId,
+                                     OrderId orderId) {
+  report(traderId, orderId, nullptr, BinaryProtocol::ExecType::AMEND_REJECT,
+         Side::BUY, 0, 0, 0);
+}
+
+void OrderEntryServer::onTrigger(const TraderId &traderId, OrderId orderId,
+                                 const Symbol &symbol, Side side, OrderStyle,
+                                 Price price, Quantity quantity) {
+  report(traderId, orderId, &symbol, BinaryProtocol::ExecType::TRIGGER, side,
+         price, quantity, 0);
+}
+
+void OrderEntryServer::onReject(const TraderId &traderId, OrderId orderId,
+                                const Symbol &symbol, Side side, OrderStyle,
+                                Price price, Quantity quantity,
+                                OrderRejectReason rsn) {
+  report(traderId, orderId, &symbol, BinaryProtocol::ExecType::REJECT, side,
+         price, quantity, static_cast<std::uint8_t>(rsn));
+}
@@ -0,0 +1,162 @@
+#ifndef ORDER_ENTRY_SERVER
+#define ORDER_ENTRY_SERVER
+#include "io_backend.h"
+#include "journal.h"
+#include "output_queue.h"
+#include <atomic>
+#include <core/execution_context/execution_context.h>
+#include <core/execution_context/execution_listener.h>
+#include <cstdint>
+#include <gateway/binary_order_entry.h>
+#include <gateway/binary_protocol.h>
+#include <matching_engine/matching_engine.h>
+#include <memory>
+#include <string>
+#include <types.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+/**
+ * @brief
+ * A TCP order entry server around a matching engine, serving the framed
+ * binary protocol on an edge-triggered epoll loop in a single thread.
+ *
+ * Every wakeup is a batch: each ready connection is read until it would
+ * block and all its complete frames are executed on the engine back to back.
+ * The execution reports of the batch are queued per connection and sent
+ * with one gathering send per connection once the batch is executed, through
+ * the IoBackend. The frames with an executed message are appended to the
+ * journal, if any, which is written along with the reports.
+ *
+ * A trader is bound to the first connection that sends a message for it,
+ * until that connection closes. Its reports go to that connection, and the
+ * messages for it from any other connection are dropped. The messages of a
+ * connection that are executed are numbered from 1, a report carries its
+ * own sequence number on the connection and the number of the message it
+ * answers.
+ */
+class OrderEntryServer : public ExecutionListener {
+public:
+  // a connection sending faster than it reads its reports is dropped once
+  // this much output is pending by default
+  static constexpr size_t kMaxPendingOutput = 64 * 1024 * 1024;
+
+  OrderEntryServer(MatchingEngine &engine, ExecutionContext &context,
+                   const std::vector<TraderId> &traderIds, IoBackend &backend,
+                   Journal *journal = nullptr);
+  ~OrderEntryServer() override;
+
+  OrderEntryServer(const OrderEntryServer &other) = delete;
+  OrderEntryServer &operator=(const OrderEntryServer &) = delete;
+  OrderEntryServer(OrderEntryServer &&other) = delete;
+  OrderEntryServer &operator=(OrderEntryServer &&other) = delete;
+
+  /**
+   * @brief
+   * Listen on the IPv4 address and port, port 0 picks a free port
+   * return false if the socket cannot be set up
+   */
+  bool listen(const std::string &address, std::uint16_t port);
+
+  // the port listened on
+  std::uint16_t getPort() const { return mPort; }
+
+  /**
+   * @brief
+   * Serve the connections until stop() is called, it is safe to call from a
+   * signal handler or another thread
+   * return false if the event loop or the journal fails
+   */
+  bool run();
+  void stop() { mIsRunning = false; }
+
+  // the pending output at which a connection is dropped
+  void setMaxPendingOutput(size_t size) { mMaxPendingOutput = size; }
+
+  // the handler of the decoded messages, they go on to the engine
+  void onNewOrder(const BinaryProtocol::NewOrderView &message);
+  void onCancel(const BinaryProtocol::CancelView &message);
+  void onAmend(const BinaryProtocol::AmendView &message);
+  void onMassCancel(const BinaryProtocol::MassCancelView &message);
+  void onExecutionReport(const BinaryProtocol::ExecutionReportView &) {}
+
+  void onOpen(const TraderId &traderId, OrderId orderId, const Symbol &symbol,
+              Side side, OrderStyle style, Price price,
+              Quantity quantity) override;
+  void onFill(const TraderId &traderId, OrderId orderId, const Symbol &symbol,
+              Side side, OrderStyle style, Price price,
+              Quantity quantity) override;
+  void onCancel(const TraderId &traderId, OrderId orderId,
+                const Symbol &symbol, Side side, OrderStyle style, Price price,
+                Quantity quantity, OrderCancelReason rsn) override;
+  void onCancelReject(const TraderId &traderId, OrderId orderId) override;
+  void onAmend(const TraderId &traderId, OrderId orderId, const Symbol &symbol,
+               Side side, Price price, Quantity quantity) override;
+  void onAmendReject(const TraderId &traderId, OrderId orderId) override;
+  void onTrigger(const TraderId &traderId, OrderId orderId,
+                 const Symbol &symbol, Side side, OrderStyle style,
+                 Price price, Quantity quantity) override;
+  void onReject(const TraderId &traderId, OrderId orderId,
+                const Symbol &symbol, Side side, OrderStyle style, Price price,
+                Quantity quantity, OrderRejectReason rsn) override;
+
+private:
+  struct Session {
+    int mFd = -1;
+    std::vector<char> mInput;
+    size_t mInputSize = 0;
+    OutputQueue mOutput;
+    std::uint64_t mInSeqNum = 0;
+    std::uint64_t mOutSeqNum = 0;
+    bool mIsDirty = false;
+    bool mIsClosing = false;
+  };
+
+  void accept();
+  void read(Session &session);
+  void markDirty(Session &session);
+  void close(Session &session);
+
+  /**
+   * @brief
+   * Bind the trader of the message to the current session, unless another
+   * session is bound to it
+   * return false if the message must be dropped
+   */
+  bool bind(std::uint32_t traderIndex);
+
+  void report(const TraderId &traderId, OrderId orderId, const Symbol *symbol,
+              BinaryProtocol::ExecType execType, Side side, Price price,
+              Quantity quantity, std::uint8_t reason);
+
+  MatchingEngine &mEngine;
+  ExecutionContext &mContext;
+  BinaryOrderEntry<MatchingEngine> mOrderEntry;
+  IoBackend &mBackend;
+  Journal *mJournal;
+  bool mHasJournalFailed = false;
+  size_t mMaxPendingOutput = kMaxPendingOutput;
+
+  std::unordered_map<TraderId, std::uint32_t> mTraderIndexes;
+  // the session bound to each trader, nullptr until the trader sends a
+  // message or once its session is closed
+  std::vector<Session *> mTraderSessions;
+
+  std::unordered_map<int, std::unique_ptr<Session>> mSessions;
+  std::vector<Session *> mDirtySessions;
+  // the session and the trader of the message being executed
+  Session *mCurrentSession = nullptr;
+  std::uint32_t mCurrentTrader = 0;
+  // a message of the frame being decoded was executed
+  bool mIsFrameExecuted = false;
+
+  int mListenFd = -1;
+  int mEpollFd = -1;
+  std::uint16_t mPort = 0;
+  std::atomic<bool> mIsRunning{false};
+};
+
+#endif
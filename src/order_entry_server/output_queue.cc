@@ -0,0 +1,76 @@
+#include "output_queue.h"
+#include <algorithm>
+#include <cerrno>
+#include <sys/socket.h>
+
+namespace {
+// the empty blocks kept for reuse
+constexpr size_t kMaxFreeBlocks = 4;
+} // namespace
+
+char *OutputQueue::reserve(size_t size) {
+  if (mBlocks.empty() || kBlockSize - mBlocks.back().mEnd < size) {
+    if (mFreeBlocks.empty()) {
+      mBlocks.push_back(Block{std::make_unique<char[]>(kBlockSize)});
+    } else {
+      mBlocks.push_back(std::move(mFreeBlocks.back()));
+      mFreeBlocks.pop_back();
+    }
+  }
+
+  auto &block = mBlocks.back();
+  return block.mData.get() + block.mEnd;
+}
+
+bool OutputQueue::flush(int fd) {
+  iovec iovecs[kMaxIovecs];
+  while (mSize) {
+    auto numOfIovecs = gather(iovecs, kMaxIovecs);
+    msghdr message{};
+    message.msg_iov = iovecs;
+    message.msg_iovlen = numOfIovecs;
+    // a closed peer is an error of the send, not a SIGPIPE
+    auto written = ::sendmsg(fd, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    consume(written);
+  }
+  return true;
+}
+
+size_t OutputQueue::gather(iovec *iovecs, size_t maxIovecs) const {
+  size_t numOfIovecs = mSize ? std::min(mBlocks.size(), maxIovecs) : 0;
+  for (size_t i = 0; i < numOfIovecs; i++) {
+    auto &block = mBlocks[i];
+    iovecs[i].iov_base = block.mData.get() + block.mBegin;
+    iovecs[i].iov_len = block.mEnd - block.mBegin;
+  }
+  return numOfIovecs;
+}
+
+void OutputQueue::consume(size_t size) {
+  mSize -= size;
+  while (size) {
+    auto &block = mBlocks.front();
+    auto sent = std::min(size, block.mEnd - block.mBegin);
+    block.mBegin += sent;
+    size -= sent;
+    // the last block stays at the back to be written to
+    if (block.mBegin == block.mEnd && mBlocks.size() > 1) {
+      block.mBegin = block.mEnd = 0;
+      if (mFreeBlocks.size() < kMaxFreeBlocks) {
+        mFreeBlocks.push_back(std::move(block));
+      }
+      mBlocks.pop_front();
+    }
+  }
+
+  // the queue is empty, the last block restarts from its beginning
+  if (!mSize && !mBlocks.empty()) {
+    mBlocks.back().mBegin = mBlocks.back().mEnd = 0;
+  }
+}
@@ -0,0 +1,76 @@
+#ifndef OUTPUT_QUEUE
+#define OUTPUT_QUEUE
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <sys/uio.h>
+#include <vector>
+
+/**
+ * @brief
+ * The bytes waiting to be sent on a connection, in a queue of fixed blocks.
+ * The messages are written in place at the back and flush() sends as many
+ * blocks as the socket takes in one gathering send, so the reports of a batch
+ * leave in one system call whatever their number. The sent blocks are
+ * recycled.
+ * An IoBackend that sends asynchronously gathers the blocks and consumes
+ * what was sent once the send completes.
+ */
+class OutputQueue {
+public:
+  static constexpr size_t kBlockSize = 64 * 1024;
+  // the blocks gathered for one send
+  static constexpr size_t kMaxIovecs = 64;
+
+  /**
+   * @brief
+   * Room for size bytes at the back, valid until the next call
+   * precondition: size <= kBlockSize
+   */
+  char *reserve(size_t size);
+
+  // the size bytes written at the reserved room are to be sent
+  void commit(size_t size) {
+    mBlocks.back().mEnd += size;
+    mSize += size;
+  }
+
+  bool empty() const { return mSize == 0; }
+  size_t size() const { return mSize; }
+
+  /**
+   * @brief
+   * Send the queue to the socket until it is empty or the socket would block
+   * return false if the socket fails
+   */
+  bool flush(int fd);
+
+  /**
+   * @brief
+   * Point the iovecs at up to maxIovecs blocks from the front, they are valid
+   * until the queue is changed
+   * return the number of iovecs
+   */
+  size_t gather(iovec *iovecs, size_t maxIovecs) const;
+
+  // the size bytes at the front were sent
+  void consume(size_t size);
+
+  // a send failed, the connection is to be closed
+  void setFailed() { mHasFailed = true; }
+  bool hasFailed() const { return mHasFailed; }
+
+private:
+  struct Block {
+    std::unique_ptr<char[]> mData;
+    size_t mBegin = 0;
+    size_t mEnd = 0;
+  };
+
+  std::deque<Block> mBlocks;
+  std::vector<Block> mFreeBlocks;
+  size_t mSize = 0;
+  bool mHasFailed = false;
+};
+
+#endif
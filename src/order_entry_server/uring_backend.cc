@@ -0,0 +1,279 @@
+#include "uring_backend.h"
+#include <algorithm>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+int setUpRing(unsigned numOfEntries, io_uring_params &params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, numOfEntries,
+                                    &params));
+}
+
+int enterRing(int ringFd, unsigned toSubmit, unsigned minComplete) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit,
+                                    minComplete,
+                                    minComplete ? IORING_ENTER_GETEVENTS : 0,
+                                    nullptr, 0));
+}
+
+int registerRing(int ringFd, unsigned opcode, const void *arg,
+                 unsigned numOfArgs) {
+  return static_cast<int>(::syscall(__NR_io_uring_register, ringFd, opcode,
+                                    arg, numOfArgs));
+}
+
+// the ring indexes are shared with the kernel
+unsigned loadAcquire(const unsigned *index) {
+  return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+void storeRelease(unsigned *index, unsigned value) {
+  __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+template <typename T> T *at(void *base, size_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+} // namespace
+
+UringBackend::~UringBackend() {
+  if (mEntries) {
+    ::munmap(mEntries, mEntriesSize);
+  }
+  if (mRing) {
+    ::munmap(mRing, mRingSize);
+  }
+  if (mRingFd >= 0) {
+    ::close(mRingFd);
+  }
+}
+
+bool UringBackend::setUp(unsigned numOfEntries) {
+  io_uring_params params{};
+  mRingFd = setUpRing(numOfEntries, params);
+  // the rings in one mapping need kernel 5.4
+  if (mRingFd < 0 || !(params.features & IORING_FEAT_SINGLE_MMAP)) {
+    return false;
+  }
+
+  mRingSize = std::max<size_t>(
+      params.sq_off.array + params.sq_entries * sizeof(unsigned),
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  mRing = ::mmap(nullptr, mRingSize, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, mRingFd, IORING_OFF_SQ_RING);
+  mEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+  auto entries = ::mmap(nullptr, mEntriesSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, mRingFd, IORING_OFF_SQES);
+  if (mRing == MAP_FAILED || entries == MAP_FAILED) {
+    mRing = mRing == MAP_FAILED ? nullptr : mRing;
+    return false;
+  }
+  mEntries = static_cast<io_uring_sqe *>(entries);
+
+  mSqTail = at<unsigned>(mRing, params.sq_off.tail);
+  mSqMask = *at<unsigned>(mRing, params.sq_off.ring_mask);
+  mSqArray = at<unsigned>(mRing, params.sq_off.array);
+  mNumOfEntries = params.sq_entries;
+  mCqHead = at<unsigned>(mRing, params.cq_off.head);
+  mCqTail = at<unsigned>(mRing, params.cq_off.tail);
+  mCqMask = *at<unsigned>(mRing, params.cq_off.ring_mask);
+  mCqes = at<io_uring_cqe>(mRing, params.cq_off.cqes);
+
+  mRequests.resize(params.cq_entries);
+  mMessages.resize(params.cq_entries);
+  for (auto i = params.cq_entries; i > 0; i--) {
+    mFreeRequests.push_back(i - 1);
+  }
+  return true;
+}
+
+int UringBackend::registerBuffer(char *data, size_t size) {
+  // the buffers are registered as a whole, the previous ones again
+  if (!mBuffers.empty()) {
+    registerRing(mRingFd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+  }
+  mBuffers.push_back(iovec{data, size});
+  if (registerRing(mRingFd, IORING_REGISTER_BUFFERS, mBuffers.data(),
+                   static_cast<unsigned>(mBuffers.size())) < 0) {
+    mBuffers.pop_back();
+    if (!mBuffers.empty()) {
+      registerRing(mRingFd, IORING_REGISTER_BUFFERS, mBuffers.data(),
+                   static_cast<unsigned>(mBuffers.size()));
+    }
+    return -1;
+  }
+  mNumOfWrites.push_back(0);
+  return static_cast<int>(mBuffers.size() - 1);
+}
+
+io_uring_sqe *UringBackend::getEntry(std::uint32_t &requestIndex) {
+  // a full ring is entered, the completions free the requests
+  while (mNumOfUnsubmitted + mNumOfQueued == mNumOfEntries ||
+         mFreeRequests.empty()) {
+    if (!enter(mFreeRequests.empty())) {
+      return nullptr;
+    }
+  }
+
+  requestIndex = mFreeRequests.back();
+  mFreeRequests.pop_back();
+  auto index = (*mSqTail + mNumOfQueued++) & mSqMask;
+  mSqArray[index] = index;
+  auto &entry = mEntries[index];
+  entry = io_uring_sqe{};
+  entry.user_data = requestIndex;
+  return &entry;
+}
+
+void UringBackend::queueWrite(int fd, const char *data, size_t size,
+                              off_t offset, int bufferIndex) {
+  std::uint32_t requestIndex = 0;
+  auto entry = getEntry(requestIndex);
+  if (!entry) {
+    mHasFailed = true;
+    return;
+  }
+  mRequests[requestIndex] =
+      Request{fd, nullptr, data, size, offset, bufferIndex};
+  if (bufferIndex >= 0) {
+    mNumOfWrites[bufferIndex]++;
+  } else {
+    mNumOfWaited++;
+  }
+
+  entry->opcode = bufferIndex >= 0 ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+  entry->fd = fd;
+  entry->addr = reinterpret_cast<std::uint64_t>(data);
+  entry->len = static_cast<std::uint32_t>(size);
+  entry->off = static_cast<std::uint64_t>(offset);
+  entry->buf_index = static_cast<std::uint16_t>(std::max(bufferIndex, 0));
+}
+
+void UringBackend::queueSend(int fd, OutputQueue &queue) {
+  if (queue.empty()) {
+    return;
+  }
+
+  std::uint32_t requestIndex = 0;
+  auto entry = getEntry(requestIndex);
+  if (!entry) {
+    queue.setFailed();
+    return;
+  }
+  mRequests[requestIndex] = Request{fd, &queue};
+  auto &message = mMessages[requestIndex];
+  message.mHeader = msghdr{};
+  message.mHeader.msg_iov = message.mIovecs;
+  message.mHeader.msg_iovlen =
+      queue.gather(message.mIovecs, OutputQueue::kMaxIovecs);
+  for (size_t i = 0; i < message.mHeader.msg_iovlen; i++) {
+    mRequests[requestIndex].mSize += message.mIovecs[i].iov_len;
+  }
+  mNumOfWaited++;
+
+  entry->opcode = IORING_OP_SENDMSG;
+  entry->fd = fd;
+  entry->addr = reinterpret_cast<std::uint64_t>(&message.mHeader);
+  entry->len = 1;
+  entry->msg_flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+}
+
+bool UringBackend::submit() {
+  while (mNumOfQueued || mNumOfUnsubmitted || mNumOfWaited) {
+    if (!enter(mNumOfWaited)) {
+      break;
+    }
+  }
+
+  bool hasFailed = mHasFailed;
+  mHasFailed = false;
+  return !hasFailed;
+}
+
+bool UringBackend::waitForWrites(int bufferIndex) {
+  while (bufferIndex >= 0 && mNumOfWrites[bufferIndex] > 0) {
+    if (!enter(true)) {
+      break;
+    }
+  }
+  return submit();
+}
+
+bool UringBackend::enter(bool wait) {
+  if (mIsBroken) {
+    mHasFailed = true;
+    return false;
+  }
+
+  storeRelease(mSqTail, *mSqTail + mNumOfQueued);
+  mNumOfUnsubmitted += mNumOfQueued;
+  mNumOfQueued = 0;
+
+  // the ring has no polling thread, the kernel takes the entries in the call
+  // unless it is interrupted
+  auto result = enterRing(mRingFd, mNumOfUnsubmitted, wait ? 1 : 0);
+  if (result >= 0) {
+    mNumOfUnsubmitted -= result;
+  } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+    // the requests left are lost, nothing is written through the ring again
+    mIsBroken = mHasFailed = true;
+    return false;
+  }
+
+  // a completion is consumed before it is handled, the handling may enter
+  // the ring again to queue the rest of its request
+  while (true) {
+    auto head = *mCqHead;
+    if (head == loadAcquire(mCqTail)) {
+      break;
+    }
+    auto &cqe = mCqes[head & mCqMask];
+    auto requestIndex = static_cast<std::uint32_t>(cqe.user_data);
+    auto completion = cqe.res;
+    storeRelease(mCqHead, head + 1);
+
+    auto request = mRequests[requestIndex];
+    mFreeRequests.push_back(requestIndex);
+    if (isWaited(request)) {
+      mNumOfWaited--;
+    } else {
+      mNumOfWrites[request.mBufferIndex]--;
+    }
+    complete(request, completion);
+  }
+  return true;
+}
+
+void UringBackend::complete(const Request &request, int result) {
+  if (request.mQueue) {
+    auto &queue = *request.mQueue;
+    if (result == -EINTR) {
+      queueSend(request.mFd, queue);
+    } else if (result < 0 && result != -EAGAIN && result != -EWOULDBLOCK) {
+      queue.setFailed();
+    } else if (result > 0) {
+      queue.consume(result);
+      // all was taken, the socket may take the blocks left out
+      if (static_cast<size_t>(result) == request.mSize) {
+        queueSend(request.mFd, queue);
+      }
+    }
+    return;
+  }
+
+  if (result == -EINTR || result == -EAGAIN) {
+    result = 0;
+  } else if (result <= 0) {
+    mHasFailed = true;
+    return;
+  }
+  // a short write of a file is completed with the rest
+  if (static_cast<size_t>(result) < request.mSize) {
+    queueWrite(request.mFd, request.mData + result, request.mSize - result,
+               request.mOffset + result, request.mBufferIndex);
+  }
+}
@@ -0,0 +1,107 @@
+#ifndef URING_BACKEND
+#define URING_BACKEND
+#include "io_backend.h"
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+#include <vector>
+
+/**
+ * @brief
+ * An IoBackend on an io_uring, set up with the raw system calls. The queued
+ * writes and sends are entries of the submission ring that submit() hands to
+ * the kernel in one io_uring_enter, which also reaps the completions.
+ * The sends are SENDMSG of the gathered blocks of the queue with
+ * MSG_DONTWAIT, so a full socket completes with EAGAIN instead of holding
+ * the batch. The writes of a file are WRITE_FIXED from the registered
+ * buffers and are not waited for, the file is written while the next batch
+ * is executed.
+ */
+class UringBackend : public IoBackend {
+public:
+  UringBackend() = default;
+  ~UringBackend() override;
+
+  UringBackend(const UringBackend &other) = delete;
+  UringBackend &operator=(const UringBackend &) = delete;
+  UringBackend(UringBackend &&other) = delete;
+  UringBackend &operator=(UringBackend &&other) = delete;
+
+  /**
+   * @brief
+   * Create the ring and map its queues
+   * return false if the kernel does not support io_uring
+   */
+  bool setUp(unsigned numOfEntries = 256);
+
+  int registerBuffer(char *data, size_t size) override;
+  void queueWrite(int fd, const char *data, size_t size, off_t offset,
+                  int bufferIndex) override;
+  void queueSend(int fd, OutputQueue &queue) override;
+  bool submit() override;
+  bool waitForWrites(int bufferIndex) override;
+
+private:
+  // the request of a submitted entry, until its completion
+  struct Request {
+    int mFd = -1;
+    // the queue of a send, nullptr for a write
+    OutputQueue *mQueue = nullptr;
+    const char *mData = nullptr;
+    size_t mSize = 0;
+    off_t mOffset = 0;
+    int mBufferIndex = -1;
+  };
+
+  // the message of a send, at the index of its request
+  struct Message {
+    msghdr mHeader{};
+    iovec mIovecs[OutputQueue::kMaxIovecs];
+  };
+
+  // a free entry of the submission ring and a free request for it, nullptr
+  // if the ring is broken
+  io_uring_sqe *getEntry(std::uint32_t &requestIndex);
+  // enter the ring, waiting for a completion if wait
+  // return false if the ring is broken
+  bool enter(bool wait);
+  void complete(const Request &request, int result);
+
+  // the requests that submit() waits for
+  bool isWaited(const Request &request) const {
+    return request.mQueue || request.mBufferIndex < 0;
+  }
+
+  int mRingFd = -1;
+  void *mRing = nullptr;
+  size_t mRingSize = 0;
+  io_uring_sqe *mEntries = nullptr;
+  size_t mEntriesSize = 0;
+
+  unsigned *mSqTail = nullptr;
+  unsigned mSqMask = 0;
+  unsigned *mSqArray = nullptr;
+  unsigned mNumOfEntries = 0;
+  unsigned *mCqHead = nullptr;
+  unsigned *mCqTail = nullptr;
+  unsigned mCqMask = 0;
+  io_uring_cqe *mCqes = nullptr;
+
+  // the entries queued since the last enter, and the ones behind them that
+  // the kernel has not taken yet
+  unsigned mNumOfQueued = 0;
+  unsigned mNumOfUnsubmitted = 0;
+  // as many requests as completions fit in the completion ring
+  std::vector<Request> mRequests;
+  std::vector<Message> mMessages;
+  std::vector<std::uint32_t> mFreeRequests;
+  unsigned mNumOfWaited = 0;
+
+  std::vector<iovec> mBuffers;
+  // the writes in flight from each registered buffer
+  std::vector<unsigned> mNumOfWrites;
+  bool mHasFailed = false;
+  bool mIsBroken = false;
+};
+
+#endif
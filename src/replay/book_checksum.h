@@ -0,0 +1,49 @@
+#ifndef BOOK_CHECKSUM
+#define BOOK_CHECKSUM
+#include <core/order_book/order_book.h>
+#include <cstdint>
+#include <type_traits>
+
+using namespace Common;
+using namespace Core;
+
+namespace Replay {
+
+/**
+ * @brief
+ * The FNV-1a hash of the resting orders of the book in priority order: the
+ * price, the order id and the quantities of each order, side by side. Two
+ * replays of the same records end with the same checksums.
+ */
+inline std::uint64_t checksum(OrderBook &book) {
+  constexpr std::uint64_t kFnvOffset = 14695981039346656037ull;
+  constexpr std::uint64_t kFnvPrime = 1099511628211ull;
+
+  auto checksum = kFnvOffset;
+  auto hash = [&checksum](std::uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+      checksum = (checksum ^ ((value >> (8 * i)) & 0xFF)) * kFnvPrime;
+    }
+  };
+  auto hashSide = [&book, &hash](auto sideTag) {
+    constexpr Side side = decltype(sideTag)::value;
+    hash(static_cast<std::uint64_t>(side));
+    for (auto level = book.begin<side>(); level != book.end<side>();
+         ++level) {
+      for (auto &order : level->second) {
+        hash(static_cast<std::uint64_t>(order.getPrice().units()));
+        hash(order.getOrderId());
+        hash(order.getQuantity());
+        hash(order.getHiddenQuantity());
+      }
+    }
+  };
+
+  hashSide(std::integral_constant<Side, Side::BUY>{});
+  hashSide(std::integral_constant<Side, Side::SELL>{});
+  return checksum;
+}
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,266 @@
+#include "csv_converter.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <core/order/order.h>
+#include <cstring>
+#include <fcntl.h>
+#include <price.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace Core;
+
+namespace Replay {
+
+namespace {
+
+constexpr size_t kNumOfFields = 9;
+constexpr std::uint32_t kMaxNumOfTraders = 65536;
+
+template <typename T> bool parseInteger(std::string_view text, T &value) {
+  auto end = text.data() + text.size();
+  auto [last, error] = std::from_chars(text.data(), end, value);
+  return error == std::errc() && last == end;
+}
+
+bool parseEvent(std::string_view text, EventType &type) {
+  if (text == "NEW") {
+    type = EventType::NEW_ORDER;
+  } else if (text == "CANCEL") {
+    type = EventType::CANCEL;
+  } else if (text == "REDUCE") {
+    type = EventType::REDUCE;
+  } else if (text == "AMEND") {
+    type = EventType::AMEND;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool parseStyle(std::string_view text, OrderStyle &style) {
+  if (text.empty() || text == "LIMIT") {
+    style = OrderStyle::LIMIT_ORDER;
+  } else if (text == "MKT") {
+    style = OrderStyle::MKT_ORDER;
+  } else if (text == "IOC") {
+    style = OrderStyle::IOC_ORDER;
+  } else if (text == "FOK") {
+    style = OrderStyle::FOK_ORDER;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+CsvConverter::CsvConverter(ReplayWriter &writer, unsigned numOfThreads,
+                           unsigned defaultScale, size_t blockSize)
+    : mWriter(writer), mNumOfThreads(numOfThreads),
+      mDefaultScale(defaultScale), mBlockSize(blockSize),
+      mLines(numOfThreads) {}
+
+bool CsvConverter::convert(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  std::vector<char> block(mBlockSize);
+  size_t size = 0;
+  bool isFirstBlock = true;
+  bool isEnd = false;
+  bool isOk = true;
+  while (!isEnd && isOk) {
+    while (size < block.size()) {
+      auto numOfBytes = ::read(fd, block.data() + size, block.size() - size);
+      if (numOfBytes < 0 && errno == EINTR) {
+        continue;
+      }
+      if (numOfBytes <= 0) {
+        isOk = numOfBytes == 0;
+        isEnd = true;
+        break;
+      }
+      size += numOfBytes;
+    }
+
+    // the last line of a block is completed by the next one
+    std::string_view text(block.data(), size);
+    auto complete = size;
+    if (!isEnd) {
+      auto lastNewline = text.rfind('\n');
+      if (lastNewline == std::string_view::npos) {
+        isOk = false;
+        break;
+      }
+      complete = lastNewline + 1;
+    }
+    text = text.substr(0, complete);
+
+    if (isFirstBlock && !text.empty() && (text[0] < '0' || text[0] > '9')) {
+      auto header = text.find('\n');
+      text.remove_prefix(header == std::string_view::npos ? text.size()
+                                                          : header + 1);
+    }
+    isFirstBlock = false;
+
+    // one chunk per thread, cut at the first line end past its share
+    std::vector<std::string_view> chunks;
+    auto chunkSize = text.size() / mNumOfThreads + 1;
+    for (size_t begin = 0; begin < text.size();) {
+      auto end = text.find('\n', std::min(begin + chunkSize, text.size()) - 1);
+      end = end == std::string_view::npos ? text.size() : end + 1;
+      chunks.push_back(text.substr(begin, end - begin));
+      begin = end;
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < chunks.size(); i++) {
+      threads.emplace_back(
+          [this, &chunks, i] { parse(chunks[i], mLines[i]); });
+    }
+    if (!chunks.empty()) {
+      parse(chunks[0], mLines[0]);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (size_t i = 0; i < chunks.size(); i++) {
+      append(mLines[i]);
+    }
+
+    std::memmove(block.data(), block.data() + complete, size - complete);
+    size -= complete;
+  }
+
+  ::close(fd);
+  mWriter.setNumOfTraders(
+      std::max(mWriter.getNumOfTraders(), mNumOfTraders));
+  return isOk;
+}
+
+void CsvConverter::parse(std::string_view chunk,
+                         std::vector<Line> &lines) const {
+  lines.clear();
+  while (!chunk.empty()) {
+    auto end = chunk.find('\n');
+    auto text = chunk.substr(0, end);
+    chunk.remove_prefix(end == std::string_view::npos ? chunk.size()
+                                                      : end + 1);
+
+    if (!text.empty() && text.back() == '\r') {
+      text.remove_suffix(1);
+    }
+    if (text.empty() || text[0] == '#') {
+      continue;
+    }
+
+    Line line{};
+    line.mIsValid = parseLine(text, line);
+    lines.push_back(line);
+  }
+}
+
+bool CsvConverter::parseLine(std::string_view text, Line &line) const {
+  std::array<std::string_view, kNumOfFields> fields;
+  size_t numOfFields = 0;
+  while (numOfFields < kNumOfFields) {
+    auto comma = text.find(',');
+    fields[numOfFields++] = text.substr(0, comma);
+    if (comma == std::string_view::npos) {
+      text = {};
+      break;
+    }
+    text.remove_prefix(comma + 1);
+  }
+  if (numOfFields != kNumOfFields || !text.empty()) {
+    return false;
+  }
+
+  const auto &[timestamp, event, orderRef, trader, symbol, side, style,
+               price, quantity] = fields;
+  auto &record = line.mRecord;
+  if (!parseInteger(timestamp, record.timestamp) ||
+      !parseEvent(event, record.type) ||
+      !parseInteger(orderRef, record.orderRef) ||
+      !parseInteger(trader, record.traderIndex) ||
+      record.traderIndex >= kMaxNumOfTraders ||
+      symbol.size() >= sizeof(SymbolEntry::name)) {
+    return false;
+  }
+  if (!quantity.empty() && !parseInteger(quantity, record.quantity)) {
+    return false;
+  }
+
+  line.mSymbol = symbol;
+  line.mPriceScale = mDefaultScale;
+  if (!mPriceScales.empty()) {
+    auto it = mPriceScales.find(Symbol(symbol));
+    if (it != mPriceScales.end()) {
+      line.mPriceScale = it->second;
+    }
+  }
+  Price units;
+  if (!price.empty() && !Price::parse(price, line.mPriceScale, units)) {
+    return false;
+  }
+  record.price = units.units();
+
+  switch (record.type) {
+  case EventType::NEW_ORDER: {
+    OrderStyle orderStyle;
+    if (symbol.empty() || record.quantity == 0 ||
+        !parseStyle(style, orderStyle) ||
+        (price.empty() && orderStyle != OrderStyle::MKT_ORDER)) {
+      return false;
+    }
+    record.style = static_cast<std::uint8_t>(orderStyle);
+    if (side == "B") {
+      record.side = static_cast<std::uint8_t>(Side::BUY);
+    } else if (side == "S") {
+      record.side = static_cast<std::uint8_t>(Side::SELL);
+    } else {
+      return false;
+    }
+    return true;
+  }
+  case EventType::REDUCE:
+    return record.quantity != 0;
+  case EventType::AMEND:
+    return !price.empty() && record.quantity != 0;
+  default:
+    return true;
+  }
+}
+
+void CsvConverter::append(const std::vector<Line> &lines) {
+  for (const auto &line : lines) {
+    if (!line.mIsValid) {
+      mNumOfSkippedLines++;
+      continue;
+    }
+
+    auto record = line.mRecord;
+    if (line.mSymbol.empty()) {
+      // only read by a new order, which has a symbol
+      record.symbolIndex = 0;
+    } else if (mHasLastSymbol && line.mSymbol == mLastSymbol) {
+      record.symbolIndex = mLastSymbolIndex;
+    } else {
+      mLastSymbolIndex = mWriter.internSymbol(line.mSymbol, line.mPriceScale);
+      mLastSymbol = line.mSymbol;
+      mHasLastSymbol = true;
+      record.symbolIndex = mLastSymbolIndex;
+    }
+
+    mNumOfTraders = std::max(mNumOfTraders, record.traderIndex + 1);
+    mWriter.append(record);
+    mNumOfRecords++;
+  }
+}
+
+} // namespace Replay
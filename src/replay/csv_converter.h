@@ -0,0 +1,94 @@
+#ifndef CSV_CONVERTER
+#define CSV_CONVERTER
+#include "replay_format.h"
+#include "replay_writer.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Replay {
+
+/**
+ * @brief
+ * Converts order flow in CSV into a replay file, one event per line:
+ *   timestamp,event,orderRef,trader,symbol,side,style,price,quantity
+ * event: NEW, CANCEL, REDUCE or AMEND
+ * trader: the index of the trader, below 65536, the file has the traders up
+ * to the largest
+ * side: B or S, style: LIMIT, MKT, IOC or FOK, both only read by NEW
+ * price: a decimal with at most the decimals of the price scale of the symbol
+ * The side, style, price and quantity of the events that do not use them may
+ * be empty. A first line not starting with a digit is a header, the empty
+ * lines and the lines starting with '#' are skipped, the malformed lines are
+ * counted and skipped.
+ *
+ * The input is read in blocks of a fixed size. The complete lines of a block
+ * are split into one chunk per thread at line boundaries, the chunks are
+ * parsed in parallel and the records are appended in the order of the input,
+ * interning the symbols as they come. The memory used is bounded by the
+ * block size whatever the size of the input.
+ */
+class CsvConverter {
+public:
+  static constexpr size_t kDefaultBlockSize = 16 * 1024 * 1024;
+
+  /**
+   * @brief
+   * precondition: numOfThreads > 0, blockSize > 0
+   * defaultScale: the price scale of the symbols not given a scale
+   */
+  CsvConverter(ReplayWriter &writer, unsigned numOfThreads,
+               unsigned defaultScale, size_t blockSize = kDefaultBlockSize);
+
+  // the price scale of the symbol, instead of the default scale
+  void setPriceScale(const Symbol &symbol, unsigned priceScale) {
+    mPriceScales[symbol] = priceScale;
+  }
+
+  /**
+   * @brief
+   * Convert the lines of the file and append them to the writer, the number
+   * of traders of the writer is raised to cover the trader indexes
+   * return false if the file cannot be read or a line is longer than a block
+   */
+  bool convert(const std::string &path);
+
+  std::uint64_t getNumOfRecords() const { return mNumOfRecords; }
+  std::uint64_t getNumOfSkippedLines() const { return mNumOfSkippedLines; }
+
+private:
+  // a parsed line, the symbol refers to the block
+  struct Line {
+    Record mRecord;
+    std::string_view mSymbol;
+    unsigned mPriceScale;
+    bool mIsValid;
+  };
+
+  void parse(std::string_view chunk, std::vector<Line> &lines) const;
+  bool parseLine(std::string_view text, Line &line) const;
+  void append(const std::vector<Line> &lines);
+
+  ReplayWriter &mWriter;
+  unsigned mNumOfThreads;
+  unsigned mDefaultScale;
+  size_t mBlockSize;
+  std::unordered_map<Symbol, unsigned> mPriceScales;
+  // the lines parsed by each thread, kept from block to block
+  std::vector<std::vector<Line>> mLines;
+
+  // the last symbol interned, the events of a symbol often come in runs
+  std::string mLastSymbol;
+  std::uint32_t mLastSymbolIndex = 0;
+  bool mHasLastSymbol = false;
+
+  std::uint32_t mNumOfTraders = 0;
+  std::uint64_t mNumOfRecords = 0;
+  std::uint64_t mNumOfSkippedLines = 0;
+};
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,260 @@
+#include "itch_converter.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <string_view>
+#include <unistd.h>
+
+using namespace Core;
+
+namespace Replay {
+
+namespace {
+
+// the offsets of the fields common to the messages
+constexpr size_t kLocateOffset = 1;
+constexpr size_t kTimestampOffset = 5;
+constexpr size_t kOrderRefOffset = 11;
+constexpr size_t kStockSize = 8;
+
+std::uint64_t loadBigEndian(const char *data, size_t size) {
+  std::uint64_t value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value = value << 8 | static_cast<unsigned char>(data[i]);
+  }
+  return value;
+}
+
+// the length of the message of the type, 0 if it is not converted
+size_t getLength(char type) {
+  switch (type) {
+  case 'A':
+    return 36;
+  case 'F':
+    return 40;
+  case 'E':
+    return 31;
+  case 'C':
+    return 36;
+  case 'X':
+    return 23;
+  case 'D':
+    return 19;
+  case 'U':
+    return 35;
+  default:
+    return 0;
+  }
+}
+
+} // namespace
+
+ItchConverter::ItchConverter(ReplayWriter &writer)
+    : mWriter(writer), mSymbolIndexes(UINT16_MAX + 1, kNoSymbol) {
+  mWriter.setNumOfTraders(
+      std::max(mWriter.getNumOfTraders(), kAggressorIndex + 1));
+}
+
+bool ItchConverter::convert(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  std::vector<char> block(kBlockSize);
+  size_t size = 0;
+  bool isOk = true;
+  while (true) {
+    auto numOfBytes = ::read(fd, block.data() + size, block.size() - size);
+    if (numOfBytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (numOfBytes <= 0) {
+      // a message cut by the end of the file
+      isOk = numOfBytes == 0 && size == 0;
+      break;
+    }
+
+    size += numOfBytes;
+    auto consumed = onData(block.data(), size);
+    std::copy(block.begin() + consumed, block.begin() + size, block.begin());
+    size -= consumed;
+  }
+
+  ::close(fd);
+  return isOk;
+}
+
+size_t ItchConverter::onData(const char *data, size_t size) {
+  size_t consumed = 0;
+  while (size - consumed >= 2) {
+    auto length = loadBigEndian(data + consumed, 2);
+    if (size - consumed - 2 < length) {
+      break;
+    }
+    onMessage(data + consumed + 2, length);
+    consumed += 2 + length;
+  }
+  return consumed;
+}
+
+void ItchConverter::onMessage(const char *message, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  auto type = message[0];
+  auto expected = getLength(type);
+  if (expected == 0) {
+    return;
+  }
+  if (length < expected) {
+    mNumOfSkippedMessages++;
+    return;
+  }
+
+  auto timestamp = loadBigEndian(message + kTimestampOffset, 6);
+  switch (type) {
+  case 'A':
+  case 'F':
+    onAdd(message, timestamp);
+    break;
+  case 'E':
+  case 'C':
+    onExecute(message, timestamp);
+    break;
+  case 'X':
+    onReduce(message, timestamp);
+    break;
+  case 'D':
+    onDelete(message, timestamp);
+    break;
+  default:
+    onReplace(message, timestamp);
+    break;
+  }
+}
+
+void ItchConverter::onAdd(const char *message, Timestamp timestamp) {
+  auto orderRef = loadBigEndian(message + kOrderRefOffset, 8);
+  RestingOrder order;
+  order.mSide = static_cast<std::uint8_t>(message[19] == 'B' ? Side::BUY
+                                                             : Side::SELL);
+  order.mShares = loadBigEndian(message + 20, 4);
+  order.mSymbolIndex =
+      internSymbol(loadBigEndian(message + kLocateOffset, 2), message + 24);
+  order.mPrice = loadBigEndian(message + 32, 4);
+
+  mOrders[orderRef] = order;
+  append(EventType::NEW_ORDER, timestamp, orderRef, order, order.mPrice);
+}
+
+void ItchConverter::onExecute(const char *message, Timestamp timestamp) {
+  auto orderRef = loadBigEndian(message + kOrderRefOffset, 8);
+  auto it = mOrders.find(orderRef);
+  if (it == mOrders.end()) {
+    mNumOfSkippedMessages++;
+    return;
+  }
+
+  // the order of the other side that took the shares, at the price of the
+  // executed order so that it matches in the book
+  auto &order = it->second;
+  auto shares = static_cast<std::uint32_t>(
+      std::min<std::uint64_t>(loadBigEndian(message + 19, 4), order.mShares));
+  RestingOrder aggressor = order;
+  aggressor.mShares = shares;
+  aggressor.mSide = static_cast<std::uint8_t>(
+      order.mSide == static_cast<std::uint8_t>(Side::BUY) ? Side::SELL
+                                                          : Side::BUY);
+  append(EventType::NEW_ORDER, timestamp, 0, aggressor, order.mPrice,
+         kAggressorIndex, OrderStyle::IOC_ORDER);
+
+  order.mShares -= shares;
+  if (order.mShares == 0) {
+    mOrders.erase(it);
+  }
+}
+
+void ItchConverter::onReduce(const char *message, Timestamp timestamp) {
+  auto orderRef = loadBigEndian(message + kOrderRefOffset, 8);
+  auto it = mOrders.find(orderRef);
+  if (it == mOrders.end()) {
+    mNumOfSkippedMessages++;
+    return;
+  }
+
+  auto &order = it->second;
+  auto shares = static_cast<std::uint32_t>(
+      std::min<std::uint64_t>(loadBigEndian(message + 19, 4), order.mShares));
+  RestingOrder reduced = order;
+  reduced.mShares = shares;
+  append(EventType::REDUCE, timestamp, orderRef, reduced, 0);
+
+  order.mShares -= shares;
+  if (order.mShares == 0) {
+    mOrders.erase(it);
+  }
+}
+
+void ItchConverter::onDelete(const char *message, Timestamp timestamp) {
+  auto orderRef = loadBigEndian(message + kOrderRefOffset, 8);
+  auto it = mOrders.find(orderRef);
+  if (it == mOrders.end()) {
+    mNumOfSkippedMessages++;
+    return;
+  }
+
+  append(EventType::CANCEL, timestamp, orderRef, it->second, 0);
+  mOrders.erase(it);
+}
+
+void ItchConverter::onReplace(const char *message, Timestamp timestamp) {
+  auto orderRef = loadBigEndian(message + kOrderRefOffset, 8);
+  auto it = mOrders.find(orderRef);
+  if (it == mOrders.end()) {
+    mNumOfSkippedMessages++;
+    return;
+  }
+
+  // the new order loses the time priority, as on the exchange
+  auto order = it->second;
+  append(EventType::CANCEL, timestamp, orderRef, order, 0);
+  mOrders.erase(it);
+
+  auto newOrderRef = loadBigEndian(message + 19, 8);
+  order.mShares = loadBigEndian(message + 27, 4);
+  order.mPrice = loadBigEndian(message + 31, 4);
+  mOrders[newOrderRef] = order;
+  append(EventType::NEW_ORDER, timestamp, newOrderRef, order, order.mPrice);
+}
+
+std::uint32_t ItchConverter::internSymbol(std::uint16_t locate,
+                                          const char *stock) {
+  auto &symbolIndex = mSymbolIndexes[locate];
+  if (symbolIndex == kNoSymbol) {
+    std::string_view name(stock, kStockSize);
+    name = name.substr(0, name.find_last_not_of(' ') + 1);
+    symbolIndex = mWriter.internSymbol(name, kPriceScale);
+  }
+  return symbolIndex;
+}
+
+void ItchConverter::append(EventType type, Timestamp timestamp,
+                           std::uint64_t orderRef, const RestingOrder &order,
+                           std::int64_t price, std::uint32_t traderIndex,
+                           OrderStyle style) {
+  Record record{};
+  record.timestamp = timestamp;
+  record.orderRef = orderRef;
+  record.price = price;
+  record.quantity = order.mShares;
+  record.traderIndex = traderIndex;
+  record.symbolIndex = order.mSymbolIndex;
+  record.type = type;
+  record.side = order.mSide;
+  record.style = static_cast<std::uint8_t>(style);
+  mWriter.append(record);
+  mNumOfRecords++;
+}
+
+} // namespace Replay
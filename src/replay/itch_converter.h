@@ -0,0 +1,99 @@
+#ifndef ITCH_CONVERTER
+#define ITCH_CONVERTER
+#include "replay_format.h"
+#include "replay_writer.h"
+#include <core/order/order.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Replay {
+
+/**
+ * @brief
+ * Converts a NASDAQ TotalView-ITCH 5.0 capture into a replay file. The
+ * capture is a stream of messages each preceded by its length in 2 bytes,
+ * the integers are big-endian. The order book messages become records of the
+ * trader 0, the executions records of the aggressor trader 1:
+ *   A, F (add order): NEW_ORDER, a limit order
+ *   E, C (executed): NEW_ORDER of the aggressor, an IOC order of the other
+ *   side for the executed shares at the price of the executed order
+ *   X (cancel): REDUCE by the cancelled shares
+ *   D (delete): CANCEL
+ *   U (replace): CANCEL of the order, NEW_ORDER of the new reference
+ * The executions of ITCH are against orders that never rest and so are not in
+ * the capture, they are replayed as orders that trade with the book so that
+ * the fills, the trades and the queues ahead of a simulated order follow the
+ * capture. The symbols are interned by stock locate on their first add order,
+ * the prices have the 4 decimals of ITCH. The other messages are skipped.
+ *
+ * The capture is read in blocks of a fixed size, the memory used is bounded
+ * by the orders resting at a time: the side, symbol, price and shares of each
+ * order are kept to convert its executions and replace and to forget it once
+ * it is gone.
+ */
+class ItchConverter {
+public:
+  static constexpr unsigned kPriceScale = 4;
+  // the trader of the executions
+  static constexpr std::uint32_t kAggressorIndex = 1;
+  static constexpr size_t kBlockSize = 1024 * 1024;
+
+  explicit ItchConverter(ReplayWriter &writer);
+
+  /**
+   * @brief
+   * Convert the messages of the file and append them to the writer
+   * return false if the file cannot be read or ends within a message
+   */
+  bool convert(const std::string &path);
+
+  /**
+   * @brief
+   * Convert the complete messages at the front of the buffer
+   * return the number of bytes consumed
+   */
+  size_t onData(const char *data, size_t size);
+
+  std::uint64_t getNumOfRecords() const { return mNumOfRecords; }
+  // the order messages of orders added before the capture, or too short
+  std::uint64_t getNumOfSkippedMessages() const {
+    return mNumOfSkippedMessages;
+  }
+  size_t getNumOfRestingOrders() const { return mOrders.size(); }
+
+private:
+  struct RestingOrder {
+    std::uint32_t mSymbolIndex;
+    std::uint32_t mShares;
+    std::uint32_t mPrice;
+    std::uint8_t mSide;
+  };
+
+  void onMessage(const char *message, size_t length);
+  void onAdd(const char *message, Timestamp timestamp);
+  void onExecute(const char *message, Timestamp timestamp);
+  void onReduce(const char *message, Timestamp timestamp);
+  void onDelete(const char *message, Timestamp timestamp);
+  void onReplace(const char *message, Timestamp timestamp);
+  std::uint32_t internSymbol(std::uint16_t locate, const char *stock);
+  void append(EventType type, Timestamp timestamp, std::uint64_t orderRef,
+              const RestingOrder &order, std::int64_t price,
+              std::uint32_t traderIndex = 0,
+              Core::OrderStyle style = Core::OrderStyle::LIMIT_ORDER);
+
+  static constexpr std::uint32_t kNoSymbol = UINT32_MAX;
+
+  ReplayWriter &mWriter;
+  // the symbol index of each stock locate
+  std::vector<std::uint32_t> mSymbolIndexes;
+  std::unordered_map<std::uint64_t, RestingOrder> mOrders;
+  std::uint64_t mNumOfRecords = 0;
+  std::uint64_t mNumOfSkippedMessages = 0;
+};
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef LATENCY_HISTOGRAM
+#define LATENCY_HISTOGRAM
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace Replay {
+
+/**
+ * @brief
+ * A histogram of latencies in nanoseconds with a fixed memory and a
+ * constant time record(). A value below 16 has its own bucket, a larger one
+ * falls in one of 16 buckets between its powers of two, so a percentile is
+ * within 1/16 of the true value. A replay records every event.
+ */
+class LatencyHistogram {
+public:
+  void record(std::uint64_t latency) {
+    mBuckets[bucketOf(latency)]++;
+    mCount++;
+    mMax = std::max(mMax, latency);
+  }
+
+  /**
+   * @brief
+   * The lower bound of the bucket of the latency at the quantile
+   * precondition: 0 <= quantile <= 1
+   */
+  std::uint64_t percentile(double quantile) const {
+    auto rank = static_cast<std::uint64_t>(quantile * mCount);
+    std::uint64_t count = 0;
+    for (size_t i = 0; i < kNumOfBuckets; i++) {
+      count += mBuckets[i];
+      if (count > rank) {
+        return std::min(lowerBound(i), mMax);
+      }
+    }
+    return mMax;
+  }
+
+  std::uint64_t getCount() const { return mCount; }
+  std::uint64_t getMax() const { return mMax; }
+
+private:
+  static constexpr unsigned kSubBits = 4;
+  static constexpr size_t kNumOfBuckets = (64 - kSubBits + 1) << kSubBits;
+
+  static size_t bucketOf(std::uint64_t value) {
+    if (value < (1u << kSubBits)) {
+      return value;
+    }
+    unsigned exponent = 63 - __builtin_clzll(value);
+    auto mantissa = (value >> (exponent - kSubBits)) & ((1u << kSubBits) - 1);
+    return ((exponent - kSubBits + 1) << kSubBits) + mantissa;
+  }
+
+  static std::uint64_t lowerBound(size_t bucket) {
+    if (bucket < (1u << kSubBits)) {
+      return bucket;
+    }
+    unsigned exponent = (bucket >> kSubBits) + kSubBits - 1;
+    std::uint64_t mantissa = bucket & ((1u << kSubBits) - 1);
+    return ((std::uint64_t(1) << kSubBits) | mantissa)
+           << (exponent - kSubBits);
+  }
+
+  std::array<std::uint64_t, kNumOfBuckets> mBuckets{};
+  std::uint64_t mCount = 0;
+  std::uint64_t mMax = 0;
+};
+
+} // namespace Replay
+
+#endif
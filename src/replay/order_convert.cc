@@ -0,0 +1,103 @@
+#include "csv_converter.h"
+#include "itch_converter.h"
+#include "replay_writer.h"
+#include <algorithm>
+#include <iostream>
+#include <matching_engine/symbol_table.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace Replay;
+
+namespace {
+
+void usage() {
+  std::cerr << "usage: order_convert (--csv <file> | --itch <file>) "
+               "--output <replay file> [--threads <n>] [--scale <digits>] "
+               "[--symbols <file>]\n"
+               "  --threads: the threads parsing the CSV, one per core by "
+               "default\n"
+               "  --scale: the price scale of the CSV symbols, 2 by default\n"
+               "  --symbols: a symbols file giving the price scale of each "
+               "CSV symbol\n";
+}
+
+} // namespace
+
+/**
+ * @brief
+ * Convert historical order flow, CSV or an ITCH 5.0 capture, into a replay
+ * file for order_replay and report the number of records written and of the
+ * lines or messages skipped.
+ */
+int main(int argc, char *argv[]) {
+  std::string csvPath, itchPath, outputPath, symbolsPath;
+  unsigned numOfThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  unsigned priceScale = 2;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string_view option = argv[i];
+    if (option == "--csv") {
+      csvPath = argv[i + 1];
+    } else if (option == "--itch") {
+      itchPath = argv[i + 1];
+    } else if (option == "--output") {
+      outputPath = argv[i + 1];
+    } else if (option == "--threads") {
+      numOfThreads = std::stoul(argv[i + 1]);
+    } else if (option == "--scale") {
+      priceScale = std::stoul(argv[i + 1]);
+    } else if (option == "--symbols") {
+      symbolsPath = argv[i + 1];
+    }
+  }
+  if (outputPath.empty() || csvPath.empty() == itchPath.empty() ||
+      numOfThreads == 0) {
+    usage();
+    return 1;
+  }
+
+  ReplayWriter writer;
+  if (!writer.open(outputPath)) {
+    std::cerr << "cannot open " << outputPath << '\n';
+    return 1;
+  }
+
+  bool isConverted = false;
+  std::uint64_t numOfSkipped = 0;
+  if (!csvPath.empty()) {
+    CsvConverter converter(writer, numOfThreads, priceScale);
+    if (!symbolsPath.empty()) {
+      std::vector<SymbolConfig> configs;
+      if (!SymbolTable::load(symbolsPath, configs)) {
+        std::cerr << "cannot load the symbols from " << symbolsPath << '\n';
+        return 1;
+      }
+      for (const auto &config : configs) {
+        converter.setPriceScale(config.symbol, config.priceScale);
+      }
+    }
+    isConverted = converter.convert(csvPath);
+    numOfSkipped = converter.getNumOfSkippedLines();
+  } else {
+    ItchConverter converter(writer);
+    isConverted = converter.convert(itchPath);
+    numOfSkipped = converter.getNumOfSkippedMessages();
+  }
+
+  auto numOfRecords = writer.getNumOfRecords();
+  if (!writer.close()) {
+    std::cerr << "cannot write " << outputPath << '\n';
+    return 1;
+  }
+  if (!isConverted) {
+    std::cerr << "cannot read " << (csvPath.empty() ? itchPath : csvPath)
+              << " to the end\n";
+    return 1;
+  }
+
+  std::cout << "records: " << numOfRecords << '\n'
+            << "skipped: " << numOfSkipped << '\n';
+  return 0;
+}
@@ -0,0 +1,127 @@
+#include "book_checksum.h"
+#include "latency_histogram.h"
+#include "replay_file.h"
+#include "replayer.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <matching_engine/matching_engine.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace Replay;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void usage() {
+  std::cerr << "usage: order_replay --file <replay file> [--speed <factor>] "
+               "[--time-unit <ns>]\n"
+               "  --speed: replay the records at the pace of their "
+               "timestamps times the factor, 0 is as fast as possible "
+               "(default)\n"
+               "  --time-unit: the nanoseconds of a unit of the timestamps, "
+               "1 by default\n";
+}
+
+std::uint64_t nanoseconds(Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+      .count();
+}
+
+} // namespace
+
+/**
+ * @brief
+ * Replay a replay file through a matching engine, as fast as possible or
+ * paced on the timestamps of the records, and report the throughput, the
+ * latency percentiles of the records and the checksums of the books at the
+ * end. As fast as possible the latency of a record is the time the engine
+ * takes for it. Paced it is from the time the record is due, so a replay
+ * falling behind shows in the latencies.
+ */
+int main(int argc, char *argv[]) {
+  std::string path;
+  double speed = 0;
+  double timeUnit = 1;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string_view option = argv[i];
+    if (option == "--file") {
+      path = argv[i + 1];
+    } else if (option == "--speed") {
+      speed = std::stod(argv[i + 1]);
+    } else if (option == "--time-unit") {
+      timeUnit = std::stod(argv[i + 1]);
+    }
+  }
+  if (path.empty() || speed < 0 || timeUnit <= 0) {
+    usage();
+    return 1;
+  }
+
+  ReplayFile file;
+  if (!file.open(path)) {
+    std::cerr << "cannot map the replay file " << path << '\n';
+    return 1;
+  }
+
+  auto symbols = file.getSymbols();
+  MatchingEngine engine;
+  engine.addStocks(symbols);
+  std::vector<SymbolId> symbolIds;
+  for (const auto &config : symbols) {
+    symbolIds.push_back(*engine.getSymbolId(config.symbol));
+  }
+  auto traderIds = makeTraderIds(file.getHeader().numOfTraders);
+  ExecutionContext context;
+  context.setTraderLog(nullptr);
+  context.addTraders(traderIds);
+  Replayer<MatchingEngine> replayer(engine, context, traderIds, symbolIds);
+
+  LatencyHistogram latencies;
+  auto start = Clock::now();
+  auto firstTimestamp = file.size() ? file.begin()->timestamp : 0;
+  auto nanosPerUnit = speed > 0 ? timeUnit / speed : 0;
+  for (const auto &record : file) {
+    auto begin = Clock::now();
+    if (nanosPerUnit > 0) {
+      auto due = start + std::chrono::nanoseconds(static_cast<std::int64_t>(
+                             (record.timestamp - firstTimestamp) *
+                             nanosPerUnit));
+      // sleep through the long gaps and spin through the short ones
+      if (due - begin > std::chrono::milliseconds(1)) {
+        std::this_thread::sleep_until(due - std::chrono::microseconds(100));
+      }
+      while ((begin = Clock::now()) < due) {
+      }
+      begin = due;
+    }
+
+    replayer.apply(record);
+    latencies.record(nanoseconds(Clock::now() - begin));
+  }
+  auto seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::cout << "records: " << file.size() << "\nseconds: " << seconds
+            << "\nrecords/s: " << file.size() / seconds
+            << "\nlatency ns p50: " << latencies.percentile(0.5)
+            << " p90: " << latencies.percentile(0.9)
+            << " p99: " << latencies.percentile(0.99)
+            << " p99.9: " << latencies.percentile(0.999)
+            << " p99.99: " << latencies.percentile(0.9999)
+            << " max: " << latencies.getMax()
+            << "\nresting order refs: " << replayer.getNumOfRefs() << '\n';
+
+  char checksum[17];
+  for (size_t i = 0; i < symbols.size(); i++) {
+    std::snprintf(checksum, sizeof(checksum), "%016llx",
+                  static_cast<unsigned long long>(
+                      Replay::checksum(*engine.getOrderBook(symbolIds[i]))));
+    std::cout << "checksum " << symbols[i].symbol << ": " << checksum << '\n';
+  }
+  return 0;
+}
@@ -0,0 +1,79 @@
+#include "replay_file.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Replay {
+
+ReplayFile::~ReplayFile() {
+  if (mData) {
+    ::munmap(mData, mSize);
+  }
+}
+
+bool ReplayFile::open(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat status {};
+  if (::fstat(fd, &status) < 0 ||
+      static_cast<size_t>(status.st_size) < kRecordsOffset) {
+    ::close(fd);
+    return false;
+  }
+
+  mSize = status.st_size;
+  auto data = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  mData = data;
+  // read ahead of the replay and drop the pages behind it
+  ::madvise(mData, mSize, MADV_SEQUENTIAL);
+
+  auto bytes = static_cast<const char *>(mData);
+  mHeader = reinterpret_cast<const FileHeader *>(bytes);
+  mRecords = reinterpret_cast<const Record *>(bytes + kRecordsOffset);
+  mSymbols =
+      reinterpret_cast<const SymbolEntry *>(bytes + mHeader->symbolsOffset);
+
+  // the sizes are checked against the file before they are multiplied
+  auto maxRecords = (mSize - kRecordsOffset) / sizeof(Record);
+  if (std::memcmp(mHeader->magic, kMagic, sizeof(kMagic)) != 0 ||
+      mHeader->version != kVersion ||
+      mHeader->recordSize != sizeof(Record) ||
+      mHeader->numOfRecords > maxRecords ||
+      mHeader->symbolsOffset > mSize ||
+      mHeader->symbolsOffset % alignof(SymbolEntry) != 0) {
+    return false;
+  }
+  auto recordsEnd = kRecordsOffset + mHeader->numOfRecords * sizeof(Record);
+  auto maxSymbols = (mSize - mHeader->symbolsOffset) / sizeof(SymbolEntry);
+  return mHeader->symbolsOffset >= recordsEnd &&
+         mHeader->numOfSymbols <= maxSymbols;
+}
+
+std::vector<SymbolConfig> ReplayFile::getSymbols() const {
+  std::vector<SymbolConfig> configs(mHeader->numOfSymbols);
+  for (size_t i = 0; i < configs.size(); i++) {
+    const auto &entry = mSymbols[i];
+    configs[i].symbol.assign(entry.name,
+                             strnlen(entry.name, sizeof(entry.name)));
+    configs[i].priceScale = entry.priceScale;
+  }
+  return configs;
+}
+
+std::vector<TraderId> makeTraderIds(std::uint32_t numOfTraders) {
+  std::vector<TraderId> traderIds;
+  for (std::uint32_t i = 0; i < numOfTraders; i++) {
+    traderIds.push_back("T" + std::to_string(i));
+  }
+  return traderIds;
+}
+
+} // namespace Replay
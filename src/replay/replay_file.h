@@ -0,0 +1,60 @@
+#ifndef REPLAY_FILE
+#define REPLAY_FILE
+#include "replay_format.h"
+#include <cstddef>
+#include <matching_engine/symbol_table.h>
+#include <string>
+#include <vector>
+
+namespace Replay {
+
+/**
+ * @brief
+ * A replay file mapped read-only, the records are read in place from the
+ * mapping and paged in by the kernel as they are reached, so a file larger
+ * than the memory replays with a bounded resident set.
+ */
+class ReplayFile {
+public:
+  ReplayFile() = default;
+  ~ReplayFile();
+
+  ReplayFile(const ReplayFile &other) = delete;
+  ReplayFile &operator=(const ReplayFile &) = delete;
+  ReplayFile(ReplayFile &&other) = delete;
+  ReplayFile &operator=(ReplayFile &&other) = delete;
+
+  /**
+   * @brief
+   * Map the file and check its header and its size
+   * return false if the file cannot be mapped or is not a replay file
+   */
+  bool open(const std::string &path);
+
+  const FileHeader &getHeader() const { return *mHeader; }
+
+  const Record *begin() const { return mRecords; }
+  const Record *end() const { return mRecords + mHeader->numOfRecords; }
+  size_t size() const { return mHeader->numOfRecords; }
+
+  /**
+   * @brief
+   * The symbols of the file in the order of their index, with the price
+   * scale of the records and the default static data otherwise
+   */
+  std::vector<SymbolConfig> getSymbols() const;
+
+private:
+  void *mData = nullptr;
+  size_t mSize = 0;
+  const FileHeader *mHeader = nullptr;
+  const Record *mRecords = nullptr;
+  const SymbolEntry *mSymbols = nullptr;
+};
+
+// the TraderIds of the trader indexes of a file: T0, T1, ...
+std::vector<TraderId> makeTraderIds(std::uint32_t numOfTraders);
+
+} // namespace Replay
+
+#endif
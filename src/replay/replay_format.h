@@ -0,0 +1,81 @@
+#ifndef REPLAY_FORMAT
+#define REPLAY_FORMAT
+#include <cstdint>
+#include <types.h>
+
+using namespace Common;
+
+/**
+ * @brief
+ * The replay format: a stream of fixed-width events of historical order
+ * flow, made to be memory-mapped and read in place. The file is a header,
+ * the records from kRecordsOffset, then the table of the symbols the records
+ * refer to by index. The table is at the end so that a converter can intern
+ * the symbols as it streams its input. The integers are little-endian.
+ */
+namespace Replay {
+
+constexpr char kMagic[8] = {'O', 'M', 'S', 'R', 'P', 'L', 'A', 'Y'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint64_t kRecordsOffset = 64;
+
+enum class EventType : std::uint8_t {
+  // a new order, orderRef names it in the later events
+  NEW_ORDER = 1,
+  // the order is cancelled
+  CANCEL = 2,
+  // quantity is taken off the order, the order is cancelled if none is left
+  REDUCE = 3,
+  // the order is amended to the price and the quantity
+  AMEND = 4,
+};
+
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t recordSize;
+  std::uint64_t numOfRecords;
+  std::uint64_t symbolsOffset;
+  std::uint32_t numOfSymbols;
+  // the traders are named by index, see makeTraderIds()
+  std::uint32_t numOfTraders;
+  char reserved[24];
+};
+static_assert(sizeof(FileHeader) == kRecordsOffset);
+
+/**
+ * @brief
+ * timestamp: the time of the event in the unit of the source, the replay is
+ * paced on it
+ * orderRef: the id of the order in the source
+ * price: the price in units of the price scale of the symbol
+ * quantity: the quantity of the order, or the quantity taken off by REDUCE
+ * traderIndex, symbolIndex: the indexes in the trader and symbol tables
+ * type: the EventType
+ * side, style: the Side and the OrderStyle of a NEW_ORDER
+ */
+struct Record {
+  Timestamp timestamp;
+  std::uint64_t orderRef;
+  std::int64_t price;
+  std::uint64_t quantity;
+  std::uint32_t traderIndex;
+  std::uint32_t symbolIndex;
+  EventType type;
+  std::uint8_t side;
+  std::uint8_t style;
+  std::uint8_t reserved[5];
+};
+static_assert(sizeof(Record) == 48);
+
+// a symbol of the table, the name is padded with zeros
+struct SymbolEntry {
+  char name[24];
+  std::uint32_t priceScale;
+  std::uint32_t reserved;
+};
+static_assert(sizeof(SymbolEntry) == 32);
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,76 @@
+#include "replay_writer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Replay {
+
+ReplayWriter::~ReplayWriter() {
+  if (mFile) {
+    close();
+  }
+}
+
+bool ReplayWriter::open(const std::string &path) {
+  mFile = std::fopen(path.c_str(), "wb");
+  if (!mFile) {
+    return false;
+  }
+
+  // the header is written again by close()
+  FileHeader header{};
+  mHasFailed = std::fwrite(&header, sizeof(header), 1, mFile) != 1;
+  return !mHasFailed;
+}
+
+std::uint32_t ReplayWriter::internSymbol(std::string_view name,
+                                         unsigned priceScale) {
+  auto [it, isAdded] = mSymbolIndexes.try_emplace(
+      std::string(name), static_cast<std::uint32_t>(mSymbols.size()));
+  if (isAdded) {
+    SymbolEntry entry{};
+    std::memcpy(entry.name, name.data(),
+                std::min(name.size(), sizeof(entry.name) - 1));
+    entry.priceScale = priceScale;
+    mSymbols.push_back(entry);
+  }
+  return it->second;
+}
+
+void ReplayWriter::write() {
+  if (mSize &&
+      std::fwrite(mBuffer.data(), sizeof(Record), mSize, mFile) != mSize) {
+    mHasFailed = true;
+  }
+  mSize = 0;
+}
+
+bool ReplayWriter::close() {
+  if (!mFile) {
+    return false;
+  }
+  write();
+
+  FileHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.recordSize = sizeof(Record);
+  header.numOfRecords = mNumOfRecords;
+  header.symbolsOffset = kRecordsOffset + mNumOfRecords * sizeof(Record);
+  header.numOfSymbols = static_cast<std::uint32_t>(mSymbols.size());
+  header.numOfTraders = mNumOfTraders;
+
+  if (!mSymbols.empty() &&
+      std::fwrite(mSymbols.data(), sizeof(SymbolEntry), mSymbols.size(),
+                  mFile) != mSymbols.size()) {
+    mHasFailed = true;
+  }
+  if (std::fseek(mFile, 0, SEEK_SET) != 0 ||
+      std::fwrite(&header, sizeof(header), 1, mFile) != 1) {
+    mHasFailed = true;
+  }
+  mHasFailed = std::fclose(mFile) != 0 || mHasFailed;
+  mFile = nullptr;
+  return !mHasFailed;
+}
+
+} // namespace Replay
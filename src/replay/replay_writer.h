@@ -0,0 +1,84 @@
+#ifndef REPLAY_WRITER
+#define REPLAY_WRITER
+#include "replay_format.h"
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Replay {
+
+/**
+ * @brief
+ * Writes a replay file as a stream: the records are buffered and written in
+ * order, the symbols are interned as they come and their table and the
+ * header are written by close(). Only the symbol table is held in memory.
+ */
+class ReplayWriter {
+public:
+  ReplayWriter() = default;
+  ~ReplayWriter();
+
+  ReplayWriter(const ReplayWriter &other) = delete;
+  ReplayWriter &operator=(const ReplayWriter &) = delete;
+  ReplayWriter(ReplayWriter &&other) = delete;
+  ReplayWriter &operator=(ReplayWriter &&other) = delete;
+
+  /**
+   * @brief
+   * Create or truncate the file
+   * return false if the file cannot be opened
+   */
+  bool open(const std::string &path);
+
+  /**
+   * @brief
+   * The index of the symbol in the file, the symbol is added with the price
+   * scale on its first call
+   * precondition: the name is shorter than the name of a SymbolEntry
+   */
+  std::uint32_t internSymbol(std::string_view name, unsigned priceScale);
+
+  // the number of traders of the file, the trader indexes are below it
+  void setNumOfTraders(std::uint32_t numOfTraders) {
+    mNumOfTraders = numOfTraders;
+  }
+  std::uint32_t getNumOfTraders() const { return mNumOfTraders; }
+
+  // append the record, a failed write is reported by close()
+  void append(const Record &record) {
+    if (mSize == kBufferSize) {
+      write();
+    }
+    mBuffer[mSize++] = record;
+    mNumOfRecords++;
+  }
+
+  std::uint64_t getNumOfRecords() const { return mNumOfRecords; }
+
+  /**
+   * @brief
+   * Write the records left, the symbol table and the header
+   * return false if a write failed
+   */
+  bool close();
+
+private:
+  static constexpr size_t kBufferSize = 4096;
+
+  void write();
+
+  std::FILE *mFile = nullptr;
+  std::vector<Record> mBuffer = std::vector<Record>(kBufferSize);
+  size_t mSize = 0;
+  std::uint64_t mNumOfRecords = 0;
+  std::uint32_t mNumOfTraders = 0;
+  std::unordered_map<std::string, std::uint32_t> mSymbolIndexes;
+  std::vector<SymbolEntry> mSymbols;
+  bool mHasFailed = false;
+};
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef REPLAYER
+#define REPLAYER
+#include "replay_format.h"
+#include <algorithm>
+#include <core/execution_context/execution_context.h>
+#include <cstdint>
+#include <iterator>
+#include <types.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+namespace Replay {
+
+/**
+ * @brief
+ * Applies the records of a replay file to a matching engine. The order refs
+ * of the source are mapped to the order ids of the engine while the orders
+ * rest, the events of an order that is no longer in the book are dropped.
+ * The refs of the orders filled in the book are swept out whenever the map
+ * has doubled since the last sweep, so it is bounded by the resting orders.
+ */
+template <typename Engine> class Replayer {
+public:
+  /**
+   * @brief
+   * symbolIds: the SymbolId in the engine of each symbol index of the file
+   */
+  Replayer(Engine &engine, ExecutionContext &context,
+           const std::vector<TraderId> &traderIds,
+           const std::vector<SymbolId> &symbolIds)
+      : mEngine(engine), mContext(context), mTraderIds(traderIds),
+        mSymbolIds(symbolIds) {}
+
+  // precondition: the trader and the symbol indexes are in their tables
+  void apply(const Record &record) {
+    switch (record.type) {
+    case EventType::NEW_ORDER:
+      if (record.side == static_cast<std::uint8_t>(Side::BUY)) {
+        insert<Side::BUY>(record);
+      } else if (record.side == static_cast<std::uint8_t>(Side::SELL)) {
+        insert<Side::SELL>(record);
+      }
+      break;
+    case EventType::CANCEL:
+      cancel(record);
+      break;
+    case EventType::REDUCE:
+      reduce(record);
+      break;
+    case EventType::AMEND:
+      amend(record);
+      break;
+    }
+  }
+
+  // the refs of the orders that may rest in the books
+  size_t getNumOfRefs() const { return mOrders.size(); }
+
+private:
+  struct RestingOrder {
+    OrderId mOrderId;
+    SymbolId mSymbolId;
+    Side mSide;
+    std::uint32_t mTraderIndex;
+  };
+
+  template <Side side> void insert(const Record &record) {
+    const auto &traderId = mTraderIds[record.traderIndex];
+    auto symbolId = mSymbolIds[record.symbolIndex];
+    Price price(record.price);
+    OrderId orderId = 0;
+
+    switch (static_cast<OrderStyle>(record.style)) {
+    case OrderStyle::MKT_ORDER:
+      mEngine.template insert<side, OrderStyle::MKT_ORDER>(
+          mContext, traderId, symbolId, record.quantity);
+      return;
+    case OrderStyle::LIMIT_ORDER:
+      orderId = mEngine.template insert<side, OrderStyle::LIMIT_ORDER>(
+          mContext, traderId, symbolId, price, record.quantity);
+      break;
+    case OrderStyle::IOC_ORDER:
+      mEngine.template insert<side, OrderStyle::IOC_ORDER>(
+          mContext, traderId, symbolId, price, record.quantity);
+      return;
+    case OrderStyle::FOK_ORDER:
+      mEngine.template insert<side, OrderStyle::FOK_ORDER>(
+          mContext, traderId, symbolId, price, record.quantity);
+      return;
+    default:
+      return;
+    }
+
+    auto book = mEngine.getOrderBook(symbolId);
+    if (book && book->template contains<side>(orderId)) {
+      mOrders[record.orderRef] =
+          RestingOrder{orderId, symbolId, side, record.traderIndex};
+      if (mOrders.size() >= 2 * mSweepSize) {
+        sweep();
+      }
+    }
+  }
+
+  void cancel(const Record &record) {
+    auto it = mOrders.find(record.orderRef);
+    if (it == mOrders.end()) {
+      return;
+    }
+    const auto &order = it->second;
+    mEngine.cancel(mContext, mTraderIds[order.mTraderIndex], order.mSymbolId,
+                   order.mOrderId);
+    mOrders.erase(it);
+  }
+
+  void reduce(const Record &record) {
+    auto it = mOrders.find(record.orderRef);
+    if (it == mOrders.end()) {
+      return;
+    }
+
+    const auto &order = it->second;
+    auto book = mEngine.getOrderBook(order.mSymbolId);
+    Price price = 0;
+    Quantity quantity = 0;
+    if (order.mSide == Side::BUY) {
+      auto resting = book->template find<Side::BUY>(order.mOrderId);
+      if (resting) {
+        price = resting->getPrice();
+        quantity = resting->getTotalQuantity();
+      }
+    } else {
+      auto resting = book->template find<Side::SELL>(order.mOrderId);
+      if (resting) {
+        price = resting->getPrice();
+        quantity = resting->getTotalQuantity();
+      }
+    }
+
+    if (quantity > record.quantity) {
+      mEngine.amend(mContext, mTraderIds[order.mTraderIndex], order.mSymbolId,
+                    order.mOrderId, price, quantity - record.quantity);
+    } else {
+      cancel(record);
+    }
+  }
+
+  void amend(const Record &record) {
+    auto it = mOrders.find(record.orderRef);
+    if (it == mOrders.end()) {
+      return;
+    }
+    const auto &order = it->second;
+    mEngine.amend(mContext, mTraderIds[order.mTraderIndex], order.mSymbolId,
+                  order.mOrderId, record.price, record.quantity);
+  }
+
+  // drop the refs of the orders no longer in the books
+  void sweep() {
+    for (auto it = mOrders.begin(); it != mOrders.end();) {
+      const auto &order = it->second;
+      auto book = mEngine.getOrderBook(order.mSymbolId);
+      bool isResting = order.mSide == Side::BUY
+                           ? book->template contains<Side::BUY>(order.mOrderId)
+                           : book->template contains<Side::SELL>(
+                                 order.mOrderId);
+      it = isResting ? std::next(it) : mOrders.erase(it);
+    }
+    mSweepSize = std::max(mOrders.size(), kMinSweepSize);
+  }
+
+  static constexpr size_t kMinSweepSize = 1024;
+
+  Engine &mEngine;
+  ExecutionContext &mContext;
+  std::vector<TraderId> mTraderIds;
+  std::vector<SymbolId> mSymbolIds;
+  std::unordered_map<std::uint64_t, RestingOrder> mOrders;
+  size_t mSweepSize = kMinSweepSize;
+};
+
+} // namespace Replay
+
+#endif
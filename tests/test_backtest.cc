@@ -0,0 +1,239 @@
+#include "gtest/gtest.h"
+#include <backtest/backtester.h>
+#include <backtest/parameter_sweep.h>
+#include <backtest/queue_maker.h>
+#include <backtest/strategy.h>
+#include <matching_engine/matching_engine.h>
+#include <random>
+#include <replay/replay_file.h>
+#include <replay/replay_writer.h>
+#include <string>
+#include <types.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+namespace {
+
+Replay::Record makeRecord(Replay::EventType type, Timestamp timestamp,
+                          std::uint64_t orderRef, std::uint32_t traderIndex,
+                          Side side, Price price, Quantity quantity) {
+  Replay::Record record{};
+  record.timestamp = timestamp;
+  record.orderRef = orderRef;
+  record.price = price.units();
+  record.quantity = quantity;
+  record.traderIndex = traderIndex;
+  record.type = type;
+  record.side = static_cast<std::uint8_t>(side);
+  record.style = static_cast<std::uint8_t>(OrderStyle::LIMIT_ORDER);
+  return record;
+}
+
+// joins the best bid once and records what it sees
+class RecordingStrategy : public Backtest::Strategy {
+public:
+  template <typename Driver> void onStart(Driver &backtest) {
+    backtest.scheduleTimer(2500, 7);
+  }
+
+  template <typename Driver>
+  void onBook(Driver &backtest, SymbolId symbolId) {
+    if (mOrderId) {
+      mQueuePositions.push_back(*backtest.getQueuePosition(mOrderId));
+      return;
+    }
+
+    auto top = backtest.getTopOfBook(symbolId);
+    if (top.mBidQuantity) {
+      mOrderId =
+          backtest.template insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+              symbolId, top.mBidPrice, 50);
+    }
+  }
+
+  template <typename Driver>
+  void onOpen(Driver &backtest, const Backtest::OrderReport &report) {
+    mOpenTimes.push_back(backtest.now());
+    EXPECT_EQ(report.mOrderId, mOrderId);
+  }
+
+  template <typename Driver>
+  void onFill(Driver &, const Backtest::OrderReport &report) {
+    mFills.push_back(report.mQuantity);
+    EXPECT_EQ(report.mPrice, 1000);
+  }
+
+  template <typename Driver>
+  void onTimer(Driver &backtest, std::uint64_t timerId) {
+    mTimers.emplace_back(timerId, backtest.now());
+    if (backtest.now() + mTimerPeriod < mTimerEnd) {
+      backtest.scheduleTimer(backtest.now() + mTimerPeriod, timerId);
+    }
+  }
+
+  // the timer reschedules itself by the period while it is before the end
+  Timestamp mTimerPeriod = 0;
+  Timestamp mTimerEnd = 0;
+  OrderId mOrderId = 0;
+  std::vector<Timestamp> mOpenTimes;
+  std::vector<Quantity> mQueuePositions;
+  std::vector<Quantity> mFills;
+  std::vector<std::pair<std::uint64_t, Timestamp>> mTimers;
+};
+
+} // namespace
+
+/**
+ * @brief
+ * Trader 0 bids 100 at 10.00 and the strategy joins behind it with 50, the
+ * 100 ahead are its queue position. Trader 1 sells 60 at 10.00, which fills
+ * trader 0 first, then trader 0 cancels the rest and the strategy is at the
+ * front. The next sale of 30 fills the strategy. The timer of the strategy
+ * fires at 2500, between the records at 2000 and 3000.
+ */
+TEST(BacktestTest, BacktesterTest1) {
+  using Replay::EventType;
+  auto path = ::testing::TempDir() + "backtest_test.bin";
+  {
+    Replay::ReplayWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    writer.setNumOfTraders(2);
+    writer.internSymbol("ABC", 2);
+    for (const auto &record :
+         {makeRecord(EventType::NEW_ORDER, 1000, 1, 0, Side::BUY, 1000, 100),
+          makeRecord(EventType::NEW_ORDER, 2000, 2, 1, Side::SELL, 1010, 100),
+          makeRecord(EventType::NEW_ORDER, 3000, 3, 1, Side::SELL, 1000, 60),
+          makeRecord(EventType::CANCEL, 4000, 1, 0, Side::BUY, 0, 0),
+          makeRecord(EventType::NEW_ORDER, 5000, 4, 1, Side::SELL, 1000,
+                     30)}) {
+      writer.append(record);
+    }
+    ASSERT_TRUE(writer.close());
+  }
+
+  Replay::ReplayFile file;
+  ASSERT_TRUE(file.open(path));
+  RecordingStrategy strategy;
+  Backtest::Backtester<MatchingEngine, RecordingStrategy> backtest(file,
+                                                                   strategy);
+  backtest.run();
+  ::unlink(path.c_str());
+
+  EXPECT_EQ(backtest.getNumOfRecords(), 5);
+  EXPECT_EQ(strategy.mOpenTimes, std::vector<Timestamp>{1000});
+  EXPECT_EQ(strategy.mQueuePositions,
+            (std::vector<Quantity>{100, 40, 0, 0}));
+  EXPECT_EQ(strategy.mFills, std::vector<Quantity>{30});
+  EXPECT_EQ(strategy.mTimers,
+            (std::vector<std::pair<std::uint64_t, Timestamp>>{{7, 2500}}));
+
+  auto symbolId = backtest.getSymbolIds()[0];
+  EXPECT_EQ(backtest.getPosition(symbolId).getNetQuantity(), 30);
+  EXPECT_EQ(backtest.getQueuePosition(strategy.mOrderId), 0);
+  EXPECT_EQ(backtest.getTopOfBook(symbolId).mBidQuantity, 20);
+}
+
+/**
+ * @brief
+ * The timer of the strategy fires at 2500 and reschedules itself every 200
+ * until 3000. Each time fires in turn between the records at 1000 and 3000,
+ * before the record at 3000 is applied.
+ */
+TEST(BacktestTest, BacktesterTest2) {
+  using Replay::EventType;
+  auto path = ::testing::TempDir() + "backtest_test2.bin";
+  {
+    Replay::ReplayWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    writer.setNumOfTraders(2);
+    writer.internSymbol("ABC", 2);
+    writer.append(
+        makeRecord(EventType::NEW_ORDER, 1000, 1, 0, Side::BUY, 1000, 100));
+    writer.append(
+        makeRecord(EventType::NEW_ORDER, 3000, 2, 1, Side::SELL, 1010, 100));
+    ASSERT_TRUE(writer.close());
+  }
+
+  Replay::ReplayFile file;
+  ASSERT_TRUE(file.open(path));
+  RecordingStrategy strategy;
+  strategy.mTimerPeriod = 200;
+  strategy.mTimerEnd = 3000;
+  Backtest::Backtester<MatchingEngine, RecordingStrategy> backtest(file,
+                                                                   strategy);
+  backtest.run();
+  ::unlink(path.c_str());
+
+  EXPECT_EQ(strategy.mTimers,
+            (std::vector<std::pair<std::uint64_t, Timestamp>>{
+                {7, 2500}, {7, 2700}, {7, 2900}}));
+}
+
+/**
+ * @brief
+ * Sweep the queue maker over a random flow with 3 workers and compare each
+ * result with the backtest of the same parameters in this process
+ */
+TEST(BacktestTest, ParameterSweepTest1) {
+  using Replay::EventType;
+  auto path = ::testing::TempDir() + "parameter_sweep_test.bin";
+  {
+    Replay::ReplayWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    writer.setNumOfTraders(4);
+    writer.internSymbol("ABC", 2);
+    std::mt19937 random(7);
+    for (std::uint64_t ref = 1; ref <= 3000; ref++) {
+      auto side = random() % 2 ? Side::BUY : Side::SELL;
+      Price price =
+          side == Side::BUY ? 990 + random() % 16 : 995 + random() % 16;
+      if (ref > 10 && random() % 4 == 0) {
+        writer.append(makeRecord(EventType::CANCEL, ref * 100,
+                                 ref - 1 - random() % 10, 0, side, 0, 0));
+      }
+      writer.append(makeRecord(EventType::NEW_ORDER, ref * 100, ref,
+                               random() % 4, side, price,
+                               10 + random() % 90));
+    }
+    ASSERT_TRUE(writer.close());
+  }
+
+  Replay::ReplayFile file;
+  ASSERT_TRUE(file.open(path));
+  std::vector<Backtest::QueueMakerConfig> configs;
+  for (Quantity quantity : {20, 50}) {
+    for (std::int64_t maxPosition : {100, 1000}) {
+      configs.push_back({0, quantity, maxPosition, 2});
+    }
+  }
+  Backtest::ParameterSweep<MatchingEngine, Backtest::QueueMaker,
+                           Backtest::QueueMakerConfig>
+      sweep(file, configs);
+  EXPECT_TRUE(sweep.run(3));
+
+  std::uint64_t numOfFills = 0;
+  ASSERT_EQ(sweep.getResults().size(), configs.size());
+  for (size_t i = 0; i < configs.size(); i++) {
+    const auto &result = sweep.getResults()[i];
+    Backtest::QueueMaker strategy(configs[i]);
+    Backtest::Backtester<MatchingEngine, Backtest::QueueMaker> backtest(
+        file, strategy);
+    backtest.run();
+
+    EXPECT_TRUE(result.mIsCompleted);
+    EXPECT_LT(result.mWorker, 3);
+    EXPECT_EQ(result.mNumOfRecords, backtest.getNumOfRecords());
+    EXPECT_EQ(result.mNumOfOrders, backtest.getNumOfOrders());
+    EXPECT_EQ(result.mNumOfFills, backtest.getNumOfFills());
+    EXPECT_EQ(result.mVolume, strategy.getVolume());
+    EXPECT_EQ(result.mPosition, strategy.getPosition());
+    EXPECT_EQ(result.mPnl, strategy.getPnl());
+    numOfFills += result.mNumOfFills;
+  }
+  ::unlink(path.c_str());
+  EXPECT_GT(numOfFills, 0);
+}
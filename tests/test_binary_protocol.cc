@@ -0,0 +1,232 @@
+#include "gtest/gtest.h"
+#include <core/execution_context/execution_context.h>
+#include <gateway/binary_order_entry.h>
+#include <gateway/binary_protocol.h>
+#include <matching_engine/matching_engine.h>
+#include <types.h>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+namespace {
+
+struct RecordingHandler {
+  void onNewOrder(const BinaryProtocol::NewOrderView &message) {
+    newOrders.push_back(message.quantity());
+  }
+  void onCancel(const BinaryProtocol::CancelView &message) {
+    cancels.push_back(message.orderId());
+  }
+  void onAmend(const BinaryProtocol::AmendView &message) {
+    amends.push_back(message.orderId());
+  }
+  void onMassCancel(const BinaryProtocol::MassCancelView &message) {
+    massCancels.push_back(message.symbolId());
+  }
+  void onExecutionReport(const BinaryProtocol::ExecutionReportView &message) {
+    reports.push_back(message.seqNum());
+  }
+
+  std::vector<Quantity> newOrders;
+  std::vector<OrderId> cancels;
+  std::vector<OrderId> amends;
+  std::vector<SymbolId> massCancels;
+  std::vector<std::uint64_t> reports;
+};
+
+} // namespace
+
+class BinaryProtocolTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    mMatchingEngine.addStocks(mSymbols);
+    mExecutionContext.addTraders(mTraderIds);
+    for (const auto &traderId : mTraderIds) {
+      mOrderEntry.addTrader(traderId);
+    }
+  }
+
+  std::vector<Symbol> mSymbols = {"ABC", "S"};
+  std::vector<TraderId> mTraderIds = {"TraderA", "TraderB"};
+  MatchingEngine mMatchingEngine;
+  ExecutionContext mExecutionContext;
+  BinaryOrderEntry<MatchingEngine> mOrderEntry{mMatchingEngine,
+                                               mExecutionContext};
+  char mBuffer[512];
+};
+
+/**
+ * @brief
+ * A new order, a cancel, an amend and a mass cancel are written back to back
+ * followed by half of another new order. The views read the fields in place,
+ * the incomplete message is not consumed.
+ */
+TEST_F(BinaryProtocolTest, DecodeTest1) {
+  size_t size = 0;
+  size += BinaryProtocol::encodeNewOrder(mBuffer + size, 1, 0, Side::SELL,
+                                         OrderStyle::LIMIT_ORDER, -1250, 0, 7);
+  size += BinaryProtocol::encodeCancel(mBuffer + size, 0, 1, 42);
+  size += BinaryProtocol::encodeAmend(mBuffer + size, 0, 1, 43, 10, 5);
+  size += BinaryProtocol::encodeMassCancel(mBuffer + size, 0,
+                                           BinaryProtocol::kAllSymbols,
+                                           BinaryProtocol::kBothSides);
+  auto complete = size;
+  size += BinaryProtocol::encodeNewOrder(mBuffer + size, 1, 0, Side::SELL,
+                                         OrderStyle::LIMIT_ORDER, 10, 0, 8);
+
+  BinaryProtocol::NewOrderView newOrder(mBuffer +
+                                        BinaryProtocol::MessageHeader::kSize);
+  EXPECT_EQ(newOrder.traderIndex(), 1);
+  EXPECT_EQ(newOrder.symbolId(), 0);
+  EXPECT_EQ(newOrder.price(), -1250);
+  EXPECT_EQ(newOrder.side(), static_cast<std::uint8_t>(Side::SELL));
+  EXPECT_EQ(newOrder.style(),
+            static_cast<std::uint8_t>(OrderStyle::LIMIT_ORDER));
+
+  RecordingHandler handler;
+  EXPECT_EQ(BinaryProtocol::decode(mBuffer, size - 1, handler), complete);
+  EXPECT_EQ(handler.newOrders, std::vector<Quantity>{7});
+  EXPECT_EQ(handler.cancels, std::vector<OrderId>{42});
+  EXPECT_EQ(handler.amends, std::vector<OrderId>{43});
+  EXPECT_EQ(handler.massCancels,
+            std::vector<SymbolId>{BinaryProtocol::kAllSymbols});
+
+  EXPECT_EQ(BinaryProtocol::decode(mBuffer + complete, size - complete,
+                                   handler),
+            size - complete);
+  EXPECT_EQ(handler.newOrders, (std::vector<Quantity>{7, 8}));
+}
+
+/**
+ * @brief
+ * A message of an unknown template is skipped by its block length and a
+ * message with a block too short for its template is dropped, the messages
+ * after them are decoded.
+ */
+TEST_F(BinaryProtocolTest, DecodeTest2) {
+  size_t size = BinaryProtocol::encodeCancel(mBuffer, 0, 1, 42);
+  BinaryProtocol::store<std::uint16_t>(mBuffer + 2, 99);
+  size += BinaryProtocol::encodeCancel(mBuffer + size, 0, 1, 43);
+  BinaryProtocol::store<std::uint16_t>(mBuffer + size, 8);
+  size += BinaryProtocol::MessageHeader::kSize + 8;
+  size += BinaryProtocol::encodeCancel(mBuffer + size, 0, 1, 44);
+
+  RecordingHandler handler;
+  EXPECT_EQ(BinaryProtocol::decode(mBuffer, size, handler), size);
+  EXPECT_EQ(handler.cancels, (std::vector<OrderId>{43, 44}));
+}
+
+/**
+ * @brief
+ * Two execution reports are framed back to back followed by half of a third
+ * frame, only the complete frames are consumed. A frame of another encoding
+ * type breaks the stream.
+ */
+TEST_F(BinaryProtocolTest, FrameTest1) {
+  size_t size = 0;
+  for (std::uint64_t seqNum = 1; seqNum <= 3; seqNum++) {
+    auto messageSize = BinaryProtocol::encodeExecutionReport(
+        mBuffer + size + BinaryProtocol::FrameHeader::kSize, 42, 7, seqNum,
+        -1250, 100, 1, 0, BinaryProtocol::ExecType::CANCEL, Side::SELL,
+        static_cast<std::uint8_t>(OrderCancelReason::CANCEL_REQUEST));
+    size += BinaryProtocol::encodeFrame(mBuffer + size, messageSize);
+  }
+  auto frameSize = size / 3;
+  EXPECT_EQ(frameSize, BinaryProtocol::kMaxFrameSize);
+
+  BinaryProtocol::FrameHeader frame(mBuffer);
+  EXPECT_EQ(frame.messageLength(), frameSize);
+  EXPECT_EQ(frame.encodingType(), BinaryProtocol::FrameHeader::kSbeEncoding);
+  BinaryProtocol::ExecutionReportView report(
+      mBuffer + BinaryProtocol::FrameHeader::kSize +
+      BinaryProtocol::MessageHeader::kSize);
+  EXPECT_EQ(report.orderId(), 42);
+  EXPECT_EQ(report.requestSeqNum(), 7);
+  EXPECT_EQ(report.price(), -1250);
+  EXPECT_EQ(report.quantity(), 100);
+  EXPECT_EQ(report.traderIndex(), 1);
+  EXPECT_EQ(report.execType(), BinaryProtocol::ExecType::CANCEL);
+
+  RecordingHandler handler;
+  EXPECT_EQ(BinaryProtocol::decodeFrames(mBuffer, size - frameSize / 2,
+                                         handler),
+            2 * frameSize);
+  EXPECT_EQ(handler.reports, (std::vector<std::uint64_t>{1, 2}));
+
+  BinaryProtocol::store<std::uint16_t>(mBuffer + frameSize + 4, 0);
+  EXPECT_EQ(BinaryProtocol::decodeFrames(mBuffer, size, handler),
+            std::nullopt);
+}
+
+/**
+ * @brief
+ * Trader A buys 100 at 10 on ABC and Trader B sells 60 at 10 through the
+ * binary order entry, the orders match by symbol id. Trader A amends the
+ * remaining 40 down to 30 and then cancels it. A message of an unknown trader
+ * index is dropped.
+ */
+TEST_F(BinaryProtocolTest, OrderEntryTest1) {
+  auto book = mMatchingEngine.getOrderBook("ABC");
+  auto symbolId = *mMatchingEngine.getSymbolId("ABC");
+
+  size_t size = BinaryProtocol::encodeNewOrder(
+      mBuffer, 0, symbolId, Side::BUY, OrderStyle::LIMIT_ORDER, 10, 0, 100);
+  size += BinaryProtocol::encodeNewOrder(mBuffer + size, 1, symbolId,
+                                         Side::SELL, OrderStyle::LIMIT_ORDER,
+                                         10, 0, 60);
+  size += BinaryProtocol::encodeNewOrder(mBuffer + size, 5, symbolId,
+                                         Side::SELL, OrderStyle::LIMIT_ORDER,
+                                         10, 0, 60);
+  EXPECT_EQ(mOrderEntry.onData(mBuffer, size), size);
+  ASSERT_EQ(book->getNumOfOrders<Side::BUY>(), 1);
+  EXPECT_EQ(book->getNumOfOrders<Side::SELL>(), 0);
+
+  auto orderId = book->begin<Side::BUY>()->second.front().getOrderId();
+  EXPECT_EQ(book->find<Side::BUY>(orderId)->getQuantity(), 40);
+
+  size = BinaryProtocol::encodeAmend(mBuffer, 0, symbolId, orderId, 10, 30);
+  mOrderEntry.onData(mBuffer, size);
+  EXPECT_EQ(book->find<Side::BUY>(orderId)->getQuantity(), 30);
+
+  size = BinaryProtocol::encodeCancel(mBuffer, 1, symbolId, orderId);
+  mOrderEntry.onData(mBuffer, size);
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 1);
+
+  size = BinaryProtocol::encodeCancel(mBuffer, 0, symbolId, orderId);
+  mOrderEntry.onData(mBuffer, size);
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 0);
+}
+
+/**
+ * @brief
+ * Trader A rests orders on both symbols, the mass cancel of the SELL side of
+ * S leaves the BUY order, the mass cancel of every symbol takes the rest.
+ */
+TEST_F(BinaryProtocolTest, OrderEntryTest2) {
+  auto bookABC = mMatchingEngine.getOrderBook("ABC");
+  auto bookS = mMatchingEngine.getOrderBook("S");
+  auto symbolS = *mMatchingEngine.getSymbolId("S");
+
+  size_t size = BinaryProtocol::encodeNewOrder(
+      mBuffer, 0, 0, Side::BUY, OrderStyle::LIMIT_ORDER, 10, 0, 100);
+  size += BinaryProtocol::encodeNewOrder(mBuffer + size, 0, symbolS,
+                                         Side::BUY, OrderStyle::LIMIT_ORDER,
+                                         10, 0, 100);
+  size += BinaryProtocol::encodeNewOrder(mBuffer + size, 0, symbolS,
+                                         Side::SELL, OrderStyle::LIMIT_ORDER,
+                                         12, 0, 100);
+  size += BinaryProtocol::encodeMassCancel(
+      mBuffer + size, 0, symbolS, static_cast<std::uint8_t>(Side::SELL));
+  mOrderEntry.onData(mBuffer, size);
+  EXPECT_EQ(bookS->getNumOfOrders<Side::BUY>(), 1);
+  EXPECT_EQ(bookS->getNumOfOrders<Side::SELL>(), 0);
+  EXPECT_EQ(bookABC->getNumOfOrders<Side::BUY>(), 1);
+
+  size = BinaryProtocol::encodeMassCancel(mBuffer, 0,
+                                          BinaryProtocol::kAllSymbols,
+                                          BinaryProtocol::kBothSides);
+  mOrderEntry.onData(mBuffer, size);
+  EXPECT_EQ(bookS->getNumOfOrders<Side::BUY>(), 0);
+  EXPECT_EQ(bookABC->getNumOfOrders<Side::BUY>(), 0);
+}
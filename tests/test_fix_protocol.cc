@@ -0,0 +1,299 @@
+#include "gtest/gtest.h"
+#include <core/execution_context/execution_context.h>
+#include <cstdio>
+#include <gateway/fix_protocol.h>
+#include <gateway/fix_session.h>
+#include <matching_engine/matching_engine.h>
+#include <string>
+#include <string_view>
+#include <types.h>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+namespace {
+
+// the messages of the output, split on the BeginString
+std::vector<Fix::FixMessage> parseAll(const std::string &output) {
+  std::vector<Fix::FixMessage> messages;
+  size_t offset = 0;
+  while (offset < output.size()) {
+    Fix::FixMessage message;
+    size_t consumed = 0;
+    auto status = Fix::parse(output.data() + offset, output.size() - offset,
+                             message, consumed);
+    EXPECT_EQ(status, Fix::ParseStatus::OK);
+    if (status != Fix::ParseStatus::OK) {
+      break;
+    }
+    messages.push_back(message);
+    offset += consumed;
+  }
+  return messages;
+}
+
+// a message of the body, the body is not checked
+std::string rawMessage(const std::string &body) {
+  auto text = "8=FIX.4.4\x01" "9=" + std::to_string(body.size()) + "\x01" +
+              body;
+  unsigned sum = 0;
+  for (char c : text) {
+    sum += static_cast<unsigned char>(c);
+  }
+  char trailer[8];
+  std::snprintf(trailer, sizeof(trailer), "10=%03u\x01", sum % 256);
+  return text + trailer;
+}
+
+} // namespace
+
+class FixProtocolTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    SymbolConfig config;
+    config.symbol = "ABC";
+    config.priceScale = 2;
+    config.tickSize = 5;
+    mMatchingEngine.addStocks({config});
+    mExecutionContext.addTraders(mTraderIds);
+    for (const auto &traderId : mTraderIds) {
+      mSession.addTrader(traderId);
+    }
+  }
+
+  std::string newOrderSingle(std::string_view clOrdId, std::string_view account,
+                             char side, Quantity quantity,
+                             std::string_view price) {
+    mClient.begin('D', ++mSeqNum);
+    mClient.add(Fix::Tag::kClOrdId, clOrdId);
+    mClient.add(Fix::Tag::kAccount, account);
+    mClient.add(Fix::Tag::kSymbol, std::string_view("ABC"));
+    mClient.add(Fix::Tag::kSide, side);
+    mClient.add(Fix::Tag::kOrderQty, quantity);
+    mClient.add(Fix::Tag::kOrdType, '2');
+    mClient.add(Fix::Tag::kPrice, price);
+    return std::string(mClient.finish());
+  }
+
+  std::vector<TraderId> mTraderIds = {"TraderA", "TraderB"};
+  MatchingEngine mMatchingEngine;
+  ExecutionContext mExecutionContext;
+  FixSession<MatchingEngine> mSession{mMatchingEngine, mExecutionContext,
+                                      "ENGINE", "CLIENT"};
+  Fix::FixWriter mClient{"CLIENT", "ENGINE"};
+  std::uint64_t mSeqNum = 0;
+};
+
+/**
+ * @brief
+ * A written message is parsed back field by field. Any prefix of it is
+ * incomplete, and a message with a wrong checksum is malformed but consumed
+ * whole so that the next message can be parsed.
+ */
+TEST_F(FixProtocolTest, ParseTest1) {
+  auto text = newOrderSingle("a1", "TraderA", '1', 100, "10.25");
+
+  Fix::FixMessage message;
+  size_t consumed = 0;
+  EXPECT_EQ(Fix::parse(text.data(), text.size(), message, consumed),
+            Fix::ParseStatus::OK);
+  EXPECT_EQ(consumed, text.size());
+  EXPECT_EQ(message.getMsgType(), "D");
+  EXPECT_EQ(message.get(Fix::Tag::kSenderCompId), "CLIENT");
+  EXPECT_EQ(message.get(Fix::Tag::kMsgSeqNum), "1");
+  EXPECT_EQ(message.get(Fix::Tag::kClOrdId), "a1");
+  EXPECT_EQ(message.get(Fix::Tag::kPrice), "10.25");
+  EXPECT_EQ(message.get(Fix::Tag::kText), "");
+
+  for (size_t size = 0; size < text.size(); size++) {
+    EXPECT_EQ(Fix::parse(text.data(), size, message, consumed),
+              Fix::ParseStatus::INCOMPLETE);
+  }
+
+  auto corrupted = text;
+  corrupted[corrupted.size() - 2]++;
+  corrupted += text;
+  EXPECT_EQ(Fix::parse(corrupted.data(), corrupted.size(), message, consumed),
+            Fix::ParseStatus::MALFORMED);
+  EXPECT_EQ(consumed, text.size());
+  EXPECT_EQ(Fix::parse(corrupted.data() + consumed,
+                       corrupted.size() - consumed, message, consumed),
+            Fix::ParseStatus::OK);
+
+  std::string garbage = "garbage\x01" + text;
+  EXPECT_EQ(Fix::parse(garbage.data(), garbage.size(), message, consumed),
+            Fix::ParseStatus::MALFORMED);
+  EXPECT_EQ(consumed, garbage.size() - text.size());
+}
+
+/**
+ * @brief
+ * Trader A buys 100 ABC at 10.25 and Trader B sells 60 at 10.20, both get a
+ * fill of 60 at 10.25, the price of the resting order. Trader A replaces the
+ * order down to 90 in total, then cancels it. The cancel of an unknown ClOrdID
+ * is rejected.
+ */
+TEST_F(FixProtocolTest, SessionTest1) {
+  auto input = newOrderSingle("a1", "TraderA", '1', 100, "10.25") +
+               newOrderSingle("b1", "TraderB", '2', 60, "10.20");
+  EXPECT_EQ(mSession.onData(input.data(), input.size()), input.size());
+
+  auto reports = parseAll(mSession.getOutput());
+  ASSERT_EQ(reports.size(), 3);
+  EXPECT_EQ(reports[0].get(Fix::Tag::kExecType), "0");
+  EXPECT_EQ(reports[0].get(Fix::Tag::kClOrdId), "a1");
+  EXPECT_EQ(reports[0].get(Fix::Tag::kPrice), "10.25");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kClOrdId), "a1");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kExecType), "F");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kOrdStatus), "1");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kLastPx), "10.25");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kLeavesQty), "40");
+  EXPECT_EQ(reports[2].get(Fix::Tag::kClOrdId), "b1");
+  EXPECT_EQ(reports[2].get(Fix::Tag::kOrdStatus), "2");
+  EXPECT_EQ(reports[2].get(Fix::Tag::kCumQty), "60");
+  EXPECT_EQ(reports[2].get(Fix::Tag::kMsgSeqNum), "3");
+  mSession.clearOutput();
+
+  mClient.begin('G', ++mSeqNum);
+  mClient.add(Fix::Tag::kClOrdId, std::string_view("a2"));
+  mClient.add(Fix::Tag::kOrigClOrdId, std::string_view("a1"));
+  mClient.add(Fix::Tag::kAccount, std::string_view("TraderA"));
+  mClient.add(Fix::Tag::kOrderQty, Quantity(90));
+  mClient.add(Fix::Tag::kPrice, std::string_view("10.25"));
+  input = std::string(mClient.finish());
+  mClient.begin('F', ++mSeqNum);
+  mClient.add(Fix::Tag::kClOrdId, std::string_view("a3"));
+  mClient.add(Fix::Tag::kOrigClOrdId, std::string_view("a2"));
+  mClient.add(Fix::Tag::kAccount, std::string_view("TraderA"));
+  input += mClient.finish();
+  mClient.begin('F', ++mSeqNum);
+  mClient.add(Fix::Tag::kClOrdId, std::string_view("a4"));
+  mClient.add(Fix::Tag::kOrigClOrdId, std::string_view("a1"));
+  mClient.add(Fix::Tag::kAccount, std::string_view("TraderA"));
+  input += mClient.finish();
+  mSession.onData(input.data(), input.size());
+
+  reports = parseAll(mSession.getOutput());
+  ASSERT_EQ(reports.size(), 3);
+  EXPECT_EQ(reports[0].get(Fix::Tag::kExecType), "5");
+  EXPECT_EQ(reports[0].get(Fix::Tag::kOrigClOrdId), "a1");
+  EXPECT_EQ(reports[0].get(Fix::Tag::kLeavesQty), "30");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kExecType), "4");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kClOrdId), "a3");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kOrigClOrdId), "a2");
+  EXPECT_EQ(reports[2].getMsgType(), "9");
+  EXPECT_EQ(reports[2].get(Fix::Tag::kOrderId), "NONE");
+  EXPECT_EQ(reports[2].get(Fix::Tag::kCxlRejResponseTo), "1");
+
+  auto book = mMatchingEngine.getOrderBook("ABC");
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 0);
+}
+
+/**
+ * @brief
+ * A NewOrderSingle of an unknown account, a price off the scale of the symbol
+ * or off its tick is rejected, the first two before reaching the engine.
+ */
+TEST_F(FixProtocolTest, SessionTest2) {
+  auto input = newOrderSingle("a1", "TraderZ", '1', 100, "10.25") +
+               newOrderSingle("a2", "TraderA", '1', 100, "10.255") +
+               newOrderSingle("a3", "TraderA", '1', 100, "10.26");
+  mSession.onData(input.data(), input.size());
+
+  auto reports = parseAll(mSession.getOutput());
+  ASSERT_EQ(reports.size(), 3);
+  EXPECT_EQ(reports[0].get(Fix::Tag::kText), "UNKNOWN ACCOUNT");
+  EXPECT_EQ(reports[0].get(Fix::Tag::kOrderId), "NONE");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kText), "INVALID PRICE");
+  EXPECT_EQ(reports[2].get(Fix::Tag::kOrdStatus), "8");
+  EXPECT_EQ(reports[2].get(Fix::Tag::kText),
+            orderRejectReason2Str(OrderRejectReason::TICK_OR_LOT_SIZE));
+  EXPECT_NE(reports[2].get(Fix::Tag::kOrderId), "NONE");
+}
+
+/**
+ * @brief
+ * A NewOrderSingle reusing the ClOrdID of a live order is rejected before
+ * reaching the engine, a replace to the ClOrdID of another live order is
+ * rejected and leaves the order as it was.
+ */
+TEST_F(FixProtocolTest, SessionTest3) {
+  auto input = newOrderSingle("a1", "TraderA", '1', 100, "10.25") +
+               newOrderSingle("a1", "TraderA", '1', 50, "10.20") +
+               newOrderSingle("a2", "TraderA", '1', 50, "10.20");
+  mClient.begin('G', ++mSeqNum);
+  mClient.add(Fix::Tag::kClOrdId, std::string_view("a1"));
+  mClient.add(Fix::Tag::kOrigClOrdId, std::string_view("a2"));
+  mClient.add(Fix::Tag::kAccount, std::string_view("TraderA"));
+  mClient.add(Fix::Tag::kOrderQty, Quantity(80));
+  mClient.add(Fix::Tag::kPrice, std::string_view("10.20"));
+  input += mClient.finish();
+  mSession.onData(input.data(), input.size());
+
+  auto reports = parseAll(mSession.getOutput());
+  ASSERT_EQ(reports.size(), 4);
+  EXPECT_EQ(reports[0].get(Fix::Tag::kExecType), "0");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kText), "DUPLICATE CLORDID");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kOrderId), "NONE");
+  EXPECT_EQ(reports[2].get(Fix::Tag::kExecType), "0");
+  EXPECT_EQ(reports[3].getMsgType(), "9");
+  EXPECT_EQ(reports[3].get(Fix::Tag::kOrderId),
+            reports[2].get(Fix::Tag::kOrderId));
+  EXPECT_EQ(reports[3].get(Fix::Tag::kOrigClOrdId), "a2");
+  EXPECT_EQ(reports[3].get(Fix::Tag::kCxlRejResponseTo), "2");
+  EXPECT_EQ(reports[3].get(Fix::Tag::kOrdStatus), "0");
+
+  auto book = mMatchingEngine.getOrderBook("ABC");
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 2);
+}
+
+/**
+ * @brief
+ * A field too long for the buffer of the writer is left out whole and the
+ * message is marked as overflowed, the message still parses. The next message
+ * starts clean.
+ */
+TEST_F(FixProtocolTest, WriterTest1) {
+  std::string longValue(Fix::FixWriter::kMaxMessageSize, 'x');
+  mClient.begin('D', ++mSeqNum);
+  mClient.add(Fix::Tag::kClOrdId, std::string_view("a1"));
+  mClient.add(Fix::Tag::kSymbol, std::string_view(longValue));
+  mClient.add(Fix::Tag::kSide, '1');
+  EXPECT_TRUE(mClient.hasOverflowed());
+  auto messages = parseAll(std::string(mClient.finish()));
+  ASSERT_EQ(messages.size(), 1);
+  EXPECT_EQ(messages[0].get(Fix::Tag::kClOrdId), "a1");
+  EXPECT_EQ(messages[0].get(Fix::Tag::kSymbol), "");
+  EXPECT_EQ(messages[0].get(Fix::Tag::kSide), "1");
+
+  newOrderSingle("a2", "TraderA", '1', 100, "10.25");
+  EXPECT_FALSE(mClient.hasOverflowed());
+}
+
+/**
+ * @brief
+ * A NewOrderSingle with a ClOrdID and a Symbol longer than the buffer of the
+ * session is rejected without echoing them, the reject parses and the next
+ * report takes the following MsgSeqNum.
+ */
+TEST_F(FixProtocolTest, SessionTest4) {
+  std::string longValue(Fix::FixWriter::kMaxMessageSize, 'x');
+  auto input = rawMessage("35=D\x01" "49=CLIENT\x01" "56=ENGINE\x01"
+                          "34=1\x01" "11=" + longValue + "\x01"
+                          "1=TraderA\x01" "55=" + longValue + "\x01"
+                          "54=1\x01" "38=100\x01" "40=2\x01"
+                          "44=10.25\x01");
+  mSeqNum++;
+  input += newOrderSingle("a2", "TraderA", '1', 100, "10.25");
+  EXPECT_EQ(mSession.onData(input.data(), input.size()), input.size());
+
+  auto reports = parseAll(mSession.getOutput());
+  ASSERT_EQ(reports.size(), 2);
+  EXPECT_EQ(reports[0].get(Fix::Tag::kText), "INVALID CLORDID");
+  EXPECT_EQ(reports[0].get(Fix::Tag::kClOrdId), "");
+  EXPECT_EQ(reports[0].get(Fix::Tag::kSymbol), "");
+  EXPECT_EQ(reports[0].get(Fix::Tag::kMsgSeqNum), "1");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kClOrdId), "a2");
+  EXPECT_EQ(reports[1].get(Fix::Tag::kMsgSeqNum), "2");
+}
@@ -0,0 +1,229 @@
+#include "gtest/gtest.h"
+#include <arpa/inet.h>
+#include <core/execution_context/execution_context.h>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <gateway/binary_protocol.h>
+#include <matching_engine/matching_engine.h>
+#include <netinet/in.h>
+#include <order_entry_server/io_backend.h>
+#include <order_entry_server/journal.h>
+#include <order_entry_server/order_entry_server.h>
+#include <order_entry_server/output_queue.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <types.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+namespace {
+
+// the backends the kernel supports
+std::vector<std::unique_ptr<IoBackend>> makeBackends() {
+  std::vector<std::unique_ptr<IoBackend>> backends;
+  for (auto type : {IoBackendType::WRITE, IoBackendType::IO_URING}) {
+    if (auto backend = makeIoBackend(type)) {
+      backends.push_back(std::move(backend));
+    }
+  }
+  return backends;
+}
+
+std::string readFile(const std::string &path) {
+  std::string content;
+  int fd = ::open(path.c_str(), O_RDONLY);
+  char buffer[4096];
+  for (ssize_t size; (size = ::read(fd, buffer, sizeof(buffer))) > 0;) {
+    content.append(buffer, size);
+  }
+  ::close(fd);
+  return content;
+}
+
+std::string newOrderFrame(std::uint32_t traderIndex, Side side, Price price,
+                          Quantity quantity) {
+  char frame[BinaryProtocol::kMaxFrameSize];
+  auto size = BinaryProtocol::encodeNewOrder(
+      frame + BinaryProtocol::FrameHeader::kSize, traderIndex, 0, side,
+      OrderStyle::LIMIT_ORDER, price, 0, quantity);
+  return std::string(frame, BinaryProtocol::encodeFrame(frame, size));
+}
+
+// a blocking connection to the server on the loopback
+int connectTo(std::uint16_t port) {
+  sockaddr_in socketAddress{};
+  socketAddress.sin_family = AF_INET;
+  socketAddress.sin_port = htons(port);
+  ::inet_pton(AF_INET, "127.0.0.1", &socketAddress.sin_addr);
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  timeval timeout{5, 0};
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  EXPECT_EQ(::connect(fd, reinterpret_cast<sockaddr *>(&socketAddress),
+                      sizeof(socketAddress)),
+            0);
+  return fd;
+}
+
+/**
+ * @brief
+ * Run an order entry server of TraderA and TraderB journaling to the path
+ * while the clients are connected to its port
+ * return the journal once the server is stopped
+ */
+std::string runServer(IoBackend &backend, const std::string &path,
+                      const std::function<void(std::uint16_t)> &clients) {
+  std::vector<TraderId> traderIds = {"TraderA", "TraderB"};
+  MatchingEngine matchingEngine;
+  matchingEngine.addStocks(std::vector<Symbol>{"ABC"});
+  ExecutionContext executionContext;
+  executionContext.setTraderLog(nullptr);
+  executionContext.addTraders(traderIds);
+  {
+    Journal journal(backend);
+    EXPECT_TRUE(journal.open(path));
+    OrderEntryServer server(matchingEngine, executionContext, traderIds,
+                            backend, &journal);
+    EXPECT_TRUE(server.listen("127.0.0.1", 0));
+    std::thread thread([&server] { server.run(); });
+    clients(server.getPort());
+    server.stop();
+    thread.join();
+  }
+  auto content = readFile(path);
+  ::unlink(path.c_str());
+  return content;
+}
+
+} // namespace
+
+/**
+ * @brief
+ * Records of every length up to 1000 bytes are appended to the journal, more
+ * than both of its buffers hold, with a flush and a submit after every tenth
+ * record as a server does per batch. The file holds them in order.
+ */
+TEST(IoBackendTest, JournalTest1) {
+  auto path = ::testing::TempDir() + "journal_test1.bin";
+  for (auto &backend : makeBackends()) {
+    std::string expected;
+    {
+      Journal journal(*backend);
+      ASSERT_TRUE(journal.open(path));
+      for (size_t i = 0; expected.size() < 3 * Journal::kBufferSize; i++) {
+        std::string record(i % 1000, static_cast<char>('a' + i % 26));
+        EXPECT_TRUE(journal.append(record.data(), record.size()));
+        expected += record;
+        if (i % 10 == 0) {
+          journal.flush();
+          EXPECT_TRUE(backend->submit());
+        }
+      }
+      EXPECT_EQ(journal.size(), static_cast<off_t>(expected.size()));
+    }
+    EXPECT_EQ(readFile(path), expected);
+  }
+  ::unlink(path.c_str());
+}
+
+/**
+ * @brief
+ * A connection sends a frame followed by a corrupted one. The first frame is
+ * executed and journaled before the connection is closed, the corrupted one
+ * is not journaled.
+ */
+TEST(IoBackendTest, JournalTest2) {
+  auto path = ::testing::TempDir() + "journal_test2.bin";
+  for (auto &backend : makeBackends()) {
+    auto frame = newOrderFrame(0, Side::BUY, 100, 10);
+    auto journal = runServer(*backend, path, [&](std::uint16_t port) {
+      int fd = connectTo(port);
+      auto input = frame + std::string(BinaryProtocol::FrameHeader::kSize,
+                                       '\xff');
+      EXPECT_EQ(::send(fd, input.data(), input.size(), MSG_NOSIGNAL),
+                static_cast<ssize_t>(input.size()));
+      char buffer[4096];
+      while (::recv(fd, buffer, sizeof(buffer), 0) > 0) {
+      }
+      ::close(fd);
+    });
+    EXPECT_EQ(journal, frame);
+  }
+}
+
+/**
+ * @brief
+ * TraderA is bound to its connection. The frame for TraderA sent by another
+ * connection is dropped and not journaled, the frames executed are.
+ */
+TEST(IoBackendTest, JournalTest3) {
+  auto path = ::testing::TempDir() + "journal_test3.bin";
+  for (auto &backend : makeBackends()) {
+    auto frameA = newOrderFrame(0, Side::BUY, 100, 10);
+    auto dropped = newOrderFrame(0, Side::BUY, 90, 10);
+    auto frameB = newOrderFrame(1, Side::SELL, 200, 10);
+    auto journal = runServer(*backend, path, [&](std::uint16_t port) {
+      char buffer[4096];
+      int fdA = connectTo(port);
+      ::send(fdA, frameA.data(), frameA.size(), MSG_NOSIGNAL);
+      EXPECT_GT(::recv(fdA, buffer, sizeof(buffer), 0), 0);
+      int fdB = connectTo(port);
+      auto input = dropped + frameB;
+      ::send(fdB, input.data(), input.size(), MSG_NOSIGNAL);
+      EXPECT_GT(::recv(fdB, buffer, sizeof(buffer), 0), 0);
+      ::close(fdA);
+      ::close(fdB);
+    });
+    EXPECT_EQ(journal, frameA + frameB);
+  }
+}
+
+/**
+ * @brief
+ * A queue is sent to a socket that takes part of it, the rest stays queued
+ * until the peer reads and the socket takes it. A send to a closed peer marks
+ * the queue failed.
+ */
+TEST(IoBackendTest, SendTest1) {
+  for (auto &backend : makeBackends()) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+    int size = 64 * 1024;
+    ::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+    OutputQueue queue;
+    std::string expected;
+    for (size_t i = 0; expected.size() < 4 * 1024 * 1024; i++) {
+      std::string message(100, static_cast<char>('a' + i % 26));
+      std::memcpy(queue.reserve(message.size()), message.data(),
+                  message.size());
+      queue.commit(message.size());
+      expected += message;
+    }
+
+    std::string received;
+    char buffer[64 * 1024];
+    while (!queue.empty()) {
+      backend->queueSend(fds[0], queue);
+      EXPECT_TRUE(backend->submit());
+      ASSERT_FALSE(queue.hasFailed());
+      for (ssize_t read; (read = ::read(fds[1], buffer, sizeof(buffer))) > 0;) {
+        received.append(buffer, read);
+      }
+    }
+    EXPECT_EQ(received, expected);
+
+    ::close(fds[1]);
+    std::memcpy(queue.reserve(1), "x", 1);
+    queue.commit(1);
+    backend->queueSend(fds[0], queue);
+    backend->submit();
+    EXPECT_TRUE(queue.hasFailed());
+    ::close(fds[0]);
+  }
+}
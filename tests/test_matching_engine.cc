@@ -1,10 +1,15 @@
 #include "gtest/gtest.h"
 #include <core/execution_context/execution_context.h>
+#include <core/execution_context/execution_listener.h>
 #include <core/order_book/order_book.h>
+#include <cstdio>
+#include <fstream>
 #include <matching_engine/matching_engine.h>
 #include <memory>
+#include <sstream>
 #include <types.h>
 #include <utility>
+#include <vector>
 
 using namespace Common;
 using namespace Core;
@@ -50,8 +55,7 @@ TEST_F(MatchingEngineTest, BasicInsertion) {
       mExecutionContext, "TraderC", sym, 18, 10);
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
       mExecutionContext, "TraderD", sym, 17, 10);
-  auto mp = mMatchingEngine.getOrderBookMap();
-  auto &book = mp[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
 
   EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 4);
   EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 4);
@@ -66,7 +70,7 @@ TEST_F(MatchingEngineTest, BasicInsertion) {
  */
 TEST_F(MatchingEngineTest, MatchingTest1) {
   auto sym = mSymbols[1];
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
   mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
       mExecutionContext, "TraderA", sym, 10, 200);
@@ -103,7 +107,7 @@ TEST_F(MatchingEngineTest, MatchingTest1) {
  */
 TEST_F(MatchingEngineTest, MatchingTest2) {
   auto sym = "G";
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -150,7 +154,7 @@ TEST_F(MatchingEngineTest, MatchingTest2) {
 
 TEST_F(MatchingEngineTest, MatchingTest3) {
   auto sym = "H";
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -218,7 +222,7 @@ TEST_F(MatchingEngineTest, MatchingTest3) {
 
 TEST_F(MatchingEngineTest, MatchingTest4) {
   auto sym = "H";
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -291,7 +295,7 @@ TEST_F(MatchingEngineTest, MatchingTest4) {
 
 TEST_F(MatchingEngineTest, MatchingTest5) {
   auto sym = "H";
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
@@ -359,7 +363,7 @@ TEST_F(MatchingEngineTest, MatchingTest5) {
 
 TEST_F(MatchingEngineTest, MatchingTest6) {
   auto sym = "H";
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
@@ -391,7 +395,7 @@ TEST_F(MatchingEngineTest, MatchingTest6) {
     EXPECT_EQ(filledBuyOrders.size(), 1);
     EXPECT_EQ(filledSellOrders.size(), 0);
 
-    EXPECT_EQ(filledBuyOrders[0].getPrice(), 5);
+    EXPECT_EQ(filledBuyOrders[0].getPrice(), 10);
     EXPECT_EQ(filledBuyOrders[0].getQuantity(), 200);
   }
 
@@ -401,7 +405,7 @@ TEST_F(MatchingEngineTest, MatchingTest6) {
     EXPECT_EQ(filledBuyOrders.size(), 1);
     EXPECT_EQ(filledSellOrders.size(), 0);
 
-    EXPECT_EQ(filledBuyOrders[0].getPrice(), 5);
+    EXPECT_EQ(filledBuyOrders[0].getPrice(), 20);
     EXPECT_EQ(filledBuyOrders[0].getQuantity(), 200);
   }
 
@@ -411,7 +415,7 @@ TEST_F(MatchingEngineTest, MatchingTest6) {
     EXPECT_EQ(filledBuyOrders.size(), 1);
     EXPECT_EQ(filledSellOrders.size(), 0);
 
-    EXPECT_EQ(filledBuyOrders[0].getPrice(), 5);
+    EXPECT_EQ(filledBuyOrders[0].getPrice(), 30);
     EXPECT_EQ(filledBuyOrders[0].getQuantity(), 200);
   }
 
@@ -421,13 +425,13 @@ TEST_F(MatchingEngineTest, MatchingTest6) {
     EXPECT_EQ(filledBuyOrders.size(), 0);
     EXPECT_EQ(filledSellOrders.size(), 3);
 
-    EXPECT_EQ(filledSellOrders[0].getPrice(), 5);
+    EXPECT_EQ(filledSellOrders[0].getPrice(), 30);
     EXPECT_EQ(filledSellOrders[0].getQuantity(), 200);
 
-    EXPECT_EQ(filledSellOrders[1].getPrice(), 5);
+    EXPECT_EQ(filledSellOrders[1].getPrice(), 20);
     EXPECT_EQ(filledSellOrders[1].getQuantity(), 200);
 
-    EXPECT_EQ(filledSellOrders[2].getPrice(), 5);
+    EXPECT_EQ(filledSellOrders[2].getPrice(), 10);
     EXPECT_EQ(filledSellOrders[2].getQuantity(), 200);
   }
 }
@@ -441,7 +445,7 @@ TEST_F(MatchingEngineTest, MatchingTest6) {
 
 TEST_F(MatchingEngineTest, MatchingTest7) {
   auto sym = "H";
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
@@ -482,7 +486,7 @@ TEST_F(MatchingEngineTest, MatchingTest7) {
     EXPECT_EQ(filledBuyOrders.size(), 1);
     EXPECT_EQ(filledSellOrders.size(), 0);
 
-    EXPECT_EQ(filledBuyOrders[0].getPrice(), 15);
+    EXPECT_EQ(filledBuyOrders[0].getPrice(), 20);
     EXPECT_EQ(filledBuyOrders[0].getQuantity(), 200);
   }
 
@@ -492,7 +496,7 @@ TEST_F(MatchingEngineTest, MatchingTest7) {
     EXPECT_EQ(filledBuyOrders.size(), 1);
     EXPECT_EQ(filledSellOrders.size(), 0);
 
-    EXPECT_EQ(filledBuyOrders[0].getPrice(), 15);
+    EXPECT_EQ(filledBuyOrders[0].getPrice(), 30);
     EXPECT_EQ(filledBuyOrders[0].getQuantity(), 200);
   }
 
@@ -502,10 +506,10 @@ TEST_F(MatchingEngineTest, MatchingTest7) {
     EXPECT_EQ(filledBuyOrders.size(), 0);
     EXPECT_EQ(filledSellOrders.size(), 2);
 
-    EXPECT_EQ(filledSellOrders[0].getPrice(), 15);
+    EXPECT_EQ(filledSellOrders[0].getPrice(), 30);
     EXPECT_EQ(filledSellOrders[0].getQuantity(), 200);
 
-    EXPECT_EQ(filledSellOrders[1].getPrice(), 15);
+    EXPECT_EQ(filledSellOrders[1].getPrice(), 20);
     EXPECT_EQ(filledSellOrders[1].getQuantity(), 200);
   }
 }
@@ -518,7 +522,7 @@ TEST_F(MatchingEngineTest, MatchingTest7) {
  */
 TEST_F(MatchingEngineTest, MatchingTest8) {
   auto sym = "H";
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -595,7 +599,7 @@ TEST_F(MatchingEngineTest, MatchingTest8) {
  */
 TEST_F(MatchingEngineTest, MatchingTest9) {
   auto sym = "H";
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -676,7 +680,7 @@ TEST_F(MatchingEngineTest, MatchingTest9) {
  */
 TEST_F(MatchingEngineTest, MatchingTest10) {
   auto sym = "H";
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
@@ -757,7 +761,7 @@ TEST_F(MatchingEngineTest, MatchingTest11) {
   mConfig->selfTradPreventionConfig->policy =
       SelfTradePreventionPolicy::CANCEL_ACTIVE;
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
@@ -787,7 +791,7 @@ TEST_F(MatchingEngineTest, MatchingTest12) {
   mConfig->selfTradPreventionConfig->policy =
       SelfTradePreventionPolicy::CANCEL_ACTIVE;
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -817,7 +821,7 @@ TEST_F(MatchingEngineTest, MatchingTest13) {
   mConfig->selfTradPreventionConfig->policy =
       SelfTradePreventionPolicy::CANCEL_BOTH;
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -847,7 +851,7 @@ TEST_F(MatchingEngineTest, MatchingTest14) {
   mConfig->selfTradPreventionConfig->policy =
       SelfTradePreventionPolicy::CANCEL_PASSIVE;
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -883,7 +887,7 @@ TEST_F(MatchingEngineTest, MatchingTest15) {
   mConfig->selfTradPreventionConfig->policy =
       SelfTradePreventionPolicy::CANCEL_PASSIVE;
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -911,7 +915,7 @@ TEST_F(MatchingEngineTest, MatchingTest16) {
   mConfig->selfTradPreventionConfig->policy =
       SelfTradePreventionPolicy::CANCEL_PASSIVE;
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::BUY, OrderStyle::MKT_ORDER>(mExecutionContext,
@@ -933,7 +937,7 @@ TEST_F(MatchingEngineTest, MatchingTest17) {
   mConfig->selfTradPreventionConfig->policy =
       SelfTradePreventionPolicy::CANCEL_PASSIVE;
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::MKT_ORDER>(
@@ -956,7 +960,7 @@ TEST_F(MatchingEngineTest, MatchingTest18) {
   mConfig->selfTradPreventionConfig->policy =
       SelfTradePreventionPolicy::CANCEL_ACTIVE;
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -986,7 +990,7 @@ TEST_F(MatchingEngineTest, MatchingTest19) {
   mConfig->selfTradPreventionConfig->policy =
       SelfTradePreventionPolicy::CANCEL_BOTH;
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -1016,7 +1020,7 @@ TEST_F(MatchingEngineTest, MatchingTest20) {
   mConfig->selfTradPreventionConfig->policy =
       SelfTradePreventionPolicy::CANCEL_PASSIVE;
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -1042,7 +1046,7 @@ TEST_F(MatchingEngineTest, MatchingTest20) {
 TEST_F(MatchingEngineTest, MatchingTest21) {
   auto sym = "H";
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   auto id = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -1076,7 +1080,7 @@ TEST_F(MatchingEngineTest, MatchingTest21) {
 TEST_F(MatchingEngineTest, MatchingTest22) {
   auto sym = "H";
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   auto id = mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
@@ -1111,7 +1115,7 @@ TEST_F(MatchingEngineTest, MatchingTest22) {
 TEST_F(MatchingEngineTest, MatchingTest23) {
   auto sym = "H";
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   auto id = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -1148,7 +1152,7 @@ TEST_F(MatchingEngineTest, MatchingTest23) {
 TEST_F(MatchingEngineTest, MatchingTest24) {
   auto sym = "H";
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   auto id = mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
@@ -1185,7 +1189,7 @@ TEST_F(MatchingEngineTest, MatchingTest24) {
 TEST_F(MatchingEngineTest, MatchingTest25) {
   auto sym = "H";
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   auto id = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
@@ -1222,7 +1226,7 @@ TEST_F(MatchingEngineTest, MatchingTest25) {
 TEST_F(MatchingEngineTest, MatchingTest26) {
   auto sym = "H";
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   auto id = mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
@@ -1258,7 +1262,7 @@ TEST_F(MatchingEngineTest, MatchingTest26) {
 TEST_F(MatchingEngineTest, MatchingTest27) {
   auto sym = "H";
 
-  auto book = mMatchingEngine.getOrderBookMap()[sym];
+  auto book = mMatchingEngine.getOrderBook(sym);
   auto traderMap = mExecutionContext.getTraderMap();
 
   OrderCancelRequest req;
@@ -1270,3 +1274,1287 @@ TEST_F(MatchingEngineTest, MatchingTest27) {
   EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
   EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 0);
 }
+
+/**
+ * @brief
+ * Trader W places a BUY order of 200 on stock H at 10, Trader X sells 200 at
+ * 10, Trader W sells 100 at 15 to Trader Y.
+ * W should be long 100 at an average cost of 10 with a realized P&L of 500,
+ * X should be short 200, Y should have an open BUY exposure of 100 at 15.
+ */
+TEST_F(MatchingEngineTest, PositionTest1) {
+  auto sym = "H";
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 200);
+  {
+    auto position = mExecutionContext.getPosition("TraderW", sym);
+    EXPECT_EQ(position.getNetQuantity(), 0);
+    EXPECT_EQ(position.getOpenBuyQuantity(), 200);
+    EXPECT_EQ(position.getOpenBuyNotional(), 2000);
+  }
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 10, 200);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 15, 200);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 15, 100);
+
+  {
+    auto position = mExecutionContext.getPosition("TraderW", sym);
+    EXPECT_EQ(position.getNetQuantity(), 100);
+    EXPECT_DOUBLE_EQ(position.getAverageCost(), 10);
+    EXPECT_DOUBLE_EQ(position.getRealizedPnl(), 500);
+    EXPECT_EQ(position.getOpenBuyQuantity(), 0);
+    EXPECT_EQ(position.getOpenSellQuantity(), 0);
+  }
+
+  {
+    auto position = mExecutionContext.getPosition("TraderX", sym);
+    EXPECT_EQ(position.getNetQuantity(), -200);
+    EXPECT_DOUBLE_EQ(position.getAverageCost(), 10);
+    EXPECT_DOUBLE_EQ(position.getUnrealizedPnl(15), -1000);
+  }
+
+  {
+    auto position = mExecutionContext.getPosition("TraderY", sym);
+    EXPECT_EQ(position.getNetQuantity(), 100);
+    EXPECT_EQ(position.getOpenBuyQuantity(), 100);
+    EXPECT_EQ(position.getOpenBuyNotional(), 1500);
+  }
+}
+
+/**
+ * @brief
+ * Trader W places SELL orders of 200 on stock H at 10 and 20, cancels the one
+ * at 20, then buys 300 with a market order from Trader X's SELL at 30.
+ * The open exposure is released by the cancel, the position flips from short
+ * to long at the fill price of the last fill.
+ */
+TEST_F(MatchingEngineTest, PositionTest2) {
+  auto sym = "H";
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 200);
+  auto id = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 20, 200);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getOpenSellQuantity(),
+            400);
+
+  OrderCancelRequest req;
+  req.mOrderId = id;
+  req.mSymbol = sym;
+  req.mTraderId = "TraderW";
+  mMatchingEngine.cancel(mExecutionContext, req);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getOpenSellQuantity(),
+            200);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getOpenSellNotional(),
+            2000);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 10, 200);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getNetQuantity(),
+            -200);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 30, 300);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::MKT_ORDER>(mExecutionContext,
+                                                           "TraderW", sym, 300);
+
+  auto position = mExecutionContext.getPosition("TraderW", sym);
+  EXPECT_EQ(position.getNetQuantity(), 100);
+  EXPECT_DOUBLE_EQ(position.getAverageCost(), 30);
+  EXPECT_DOUBLE_EQ(position.getRealizedPnl(), -4000);
+  EXPECT_EQ(position.getOpenSellQuantity(), 0);
+  EXPECT_EQ(mExecutionContext.getPositions("TraderW").size(), 1);
+}
+
+/**
+ * @brief
+ * Given the risk check is enabled with max order quantity 500, max notional
+ * 4000 and price collar 5,
+ * Trader W's BUY orders of 600 at 10, 300 at 20 and 0 at 10 are rejected,
+ * Trader X's SELL order of 200 at 10 rests, Trader W's BUY order of 200 at 16
+ * is rejected by the collar, the one at 15 is filled
+ */
+TEST_F(MatchingEngineTest, RiskCheckTest1) {
+  auto sym = "H";
+  mConfig->riskConfig = RiskConfig();
+  mConfig->riskConfig->enable = true;
+  mConfig->riskConfig->maxOrderQuantity = 500;
+  mConfig->riskConfig->maxNotional = 4000;
+  mConfig->riskConfig->priceCollar = 5;
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+  auto traderMap = mExecutionContext.getTraderMap();
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 600);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 20, 300);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 0);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 10, 200);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 1);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 16, 200);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 1);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 15, 200);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 0);
+  EXPECT_EQ(traderMap["TraderW"]->getFilledBuyOrders().size(), 1);
+}
+
+/**
+ * @brief
+ * Given the risk check is enabled with max open orders 2 and max net
+ * position 300,
+ * Trader W's third resting order is rejected, after Trader X fills W's BUY
+ * order of 200 at 10, W's BUY order of 200 at 9 is rejected because W could
+ * be long 400, and W's market BUY order of 100 is filled by Trader Y's SELL
+ * order at 15
+ */
+TEST_F(MatchingEngineTest, RiskCheckTest2) {
+  auto sym = "H";
+  mConfig->riskConfig = RiskConfig();
+  mConfig->riskConfig->enable = true;
+  mConfig->riskConfig->maxOpenOrders = 2;
+  mConfig->riskConfig->maxNetPosition = 300;
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 200);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 20, 200);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 30, 200);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 1);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 1);
+  EXPECT_EQ(mExecutionContext.findAccount("TraderW")->getOpenOrderCount(), 2);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 10, 200);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(mExecutionContext.findAccount("TraderW")->getOpenOrderCount(), 1);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 9, 200);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 15, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::MKT_ORDER>(mExecutionContext,
+                                                           "TraderW", sym, 100);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getNetQuantity(),
+            300);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 1);
+  EXPECT_EQ(book->begin<Side::SELL>()->first, 20);
+}
+
+/**
+ * @brief
+ * Given the risk check is enabled with max open orders 1 and max net
+ * position 300,
+ * Trader W's BUY order of 100 at 10 rests, its amend up to 400 is rejected
+ * because W could be long 400, its amend up to 300 at 11 is accepted as it
+ * does not add an open order
+ */
+TEST_F(MatchingEngineTest, RiskCheckTest3) {
+  auto sym = "H";
+  mConfig->riskConfig = RiskConfig();
+  mConfig->riskConfig->enable = true;
+  mConfig->riskConfig->maxOpenOrders = 1;
+  mConfig->riskConfig->maxNetPosition = 300;
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  auto id = mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 100);
+  mMatchingEngine.amend(mExecutionContext, "TraderW", sym, id, 10, 400);
+  EXPECT_EQ(book->find<Side::BUY>(id)->getQuantity(), 100);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getOpenBuyQuantity(),
+            100);
+
+  mMatchingEngine.amend(mExecutionContext, "TraderW", sym, id, 11, 300);
+  EXPECT_EQ(book->find<Side::BUY>(id)->getQuantity(), 300);
+  EXPECT_EQ(book->begin<Side::BUY>()->first, 11);
+  EXPECT_EQ(mExecutionContext.findAccount("TraderW")->getOpenOrderCount(), 1);
+}
+
+/**
+ * @brief
+ * Trader W, Y place SELL order of 200 on stock H at 10,
+ * Trader W amends the order down to 100, W keeps its time priority,
+ * Trader W amends the order up to 300, W loses its time priority
+ */
+TEST_F(MatchingEngineTest, AmendTest1) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  auto id = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 200);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 10, 200);
+
+  OrderAmendRequest req;
+  req.mOrderId = id;
+  req.mSymbol = sym;
+  req.mTraderId = "TraderW";
+  req.mPrice = 10;
+  req.mQuantity = 100;
+
+  mMatchingEngine.amend(mExecutionContext, req);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 1);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.numOfOrders(), 2);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.totalQuantity(), 300);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.front().getTraderId(), "TraderW");
+  EXPECT_EQ(book->begin<Side::SELL>()->second.front().getQuantity(), 100);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getOpenSellQuantity(),
+            100);
+
+  req.mQuantity = 300;
+  mMatchingEngine.amend(mExecutionContext, req);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.numOfOrders(), 2);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.totalQuantity(), 500);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.front().getTraderId(), "TraderY");
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getOpenSellQuantity(),
+            300);
+}
+
+/**
+ * @brief
+ * Trader W places BUY order of 200 on stock H at 10,
+ * Trader X places SELL order of 100 on stock H at 12,
+ * Trader W amends the order to 12, 100 is filled and 100 rests at 12
+ */
+TEST_F(MatchingEngineTest, AmendTest2) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+  auto traderMap = mExecutionContext.getTraderMap();
+
+  auto id = mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 200);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 12, 100);
+
+  OrderAmendRequest req;
+  req.mOrderId = id;
+  req.mSymbol = sym;
+  req.mTraderId = "TraderW";
+  req.mPrice = 12;
+  req.mQuantity = 200;
+
+  mMatchingEngine.amend(mExecutionContext, req);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 0);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 1);
+  EXPECT_EQ(book->begin<Side::BUY>()->first, 12);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.front().getOrderId(), id);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.front().getQuantity(), 100);
+
+  auto &filledBuyOrders = traderMap["TraderW"]->getFilledBuyOrders();
+  EXPECT_EQ(filledBuyOrders.size(), 1);
+  EXPECT_EQ(filledBuyOrders[0].getPrice(), 12);
+
+  auto position = mExecutionContext.getPosition("TraderW", sym);
+  EXPECT_EQ(position.getNetQuantity(), 100);
+  EXPECT_EQ(position.getOpenBuyQuantity(), 100);
+  EXPECT_EQ(position.getOpenBuyNotional(), 1200);
+}
+
+/**
+ * @brief
+ * Amending an unknown order, the order of another trader or to a quantity of
+ * 0 is rejected and leaves the book untouched
+ */
+TEST_F(MatchingEngineTest, AmendTest3) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  auto id = mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 200);
+
+  OrderAmendRequest req;
+  req.mOrderId = id + 1;
+  req.mSymbol = sym;
+  req.mTraderId = "TraderW";
+  req.mPrice = 11;
+  req.mQuantity = 100;
+  mMatchingEngine.amend(mExecutionContext, req);
+
+  req.mOrderId = id;
+  req.mTraderId = "TraderX";
+  mMatchingEngine.amend(mExecutionContext, req);
+
+  req.mTraderId = "TraderW";
+  req.mQuantity = 0;
+  mMatchingEngine.amend(mExecutionContext, req);
+
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 1);
+  EXPECT_EQ(book->begin<Side::BUY>()->first, 10);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.front().getQuantity(), 200);
+}
+
+/**
+ * @brief
+ * Trader W places two BUY orders of 200 on stock H at 10, Trader Y places one
+ * in between, Trader W cancels its first order,
+ * Trader Z places a SELL order of 300 at 10, Y is filled first then W's
+ * second order is partially filled
+ */
+TEST_F(MatchingEngineTest, MultipleOrdersPerTraderTest) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+  auto traderMap = mExecutionContext.getTraderMap();
+
+  auto id1 = mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 200);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 10, 200);
+  auto id2 = mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 200);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.numOfOrders(), 3);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.totalQuantity(), 600);
+
+  OrderCancelRequest req;
+  req.mOrderId = id1;
+  req.mSymbol = sym;
+  req.mTraderId = "TraderW";
+  mMatchingEngine.cancel(mExecutionContext, req);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.numOfOrders(), 2);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.front().getTraderId(), "TraderY");
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderZ", sym, 10, 300);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.numOfOrders(), 1);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.front().getOrderId(), id2);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.front().getQuantity(), 100);
+  EXPECT_EQ(traderMap["TraderY"]->getFilledBuyOrders().size(), 1);
+  EXPECT_EQ(traderMap["TraderW"]->getFilledBuyOrders().size(), 1);
+  EXPECT_EQ(mExecutionContext.findAccount("TraderW")->getOpenOrderCount(), 1);
+}
+
+/**
+ * @brief
+ * Trader W, X place SELL order of 200 on stock H at 10, 20 respectively.
+ * Trader Z places an IOC BUY order of 600 at 15, 200 is filled at 10 and the
+ * rest is cancelled, nothing rests on the BUY side
+ */
+TEST_F(MatchingEngineTest, IOCTest1) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+  auto traderMap = mExecutionContext.getTraderMap();
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 200);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 20, 200);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::IOC_ORDER>(
+      mExecutionContext, "TraderZ", sym, 15, 600);
+
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 1);
+  EXPECT_EQ(book->begin<Side::SELL>()->first, 20);
+
+  auto &filledBuyOrders = traderMap["TraderZ"]->getFilledBuyOrders();
+  EXPECT_EQ(filledBuyOrders.size(), 1);
+  EXPECT_EQ(filledBuyOrders[0].getPrice(), 10);
+  EXPECT_EQ(filledBuyOrders[0].getQuantity(), 200);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderZ", sym).getOpenBuyQuantity(),
+            0);
+}
+
+/**
+ * @brief
+ * Trader W, X, Y place BUY order of 200 on stock H at 30, 20, 10 respectively.
+ * Trader Z's FOK SELL order of 500 at 20 is cancelled without touching the
+ * book, Trader Z's FOK SELL order of 300 at 20 is fully filled
+ */
+TEST_F(MatchingEngineTest, FOKTest1) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+  auto traderMap = mExecutionContext.getTraderMap();
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 30, 200);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 20, 200);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 10, 200);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::FOK_ORDER>(
+      mExecutionContext, "TraderZ", sym, 20, 500);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 3);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.totalQuantity(), 200);
+  EXPECT_EQ(traderMap["TraderZ"]->getFilledSellOrders().size(), 0);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::FOK_ORDER>(
+      mExecutionContext, "TraderZ", sym, 20, 300);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 2);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 0);
+  EXPECT_EQ(book->begin<Side::BUY>()->first, 20);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.totalQuantity(), 100);
+  EXPECT_EQ(traderMap["TraderZ"]->getFilledSellOrders().size(), 2);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderZ", sym).getNetQuantity(),
+            -300);
+}
+
+/**
+ * @brief
+ * Trader W places SELL order of 100 on stock H at 20, then Trader X places
+ * SELL order of 100 at 20. Given the self-trade prevention is enabled,
+ * policy: CANCEL_PASSIVE, Trader W's own order is left out of the quantity
+ * of its FOK BUY order: the FOK BUY of 150 at 20 is cancelled without
+ * touching the book, the FOK BUY of 100 at 20 cancels Trader W's SELL order
+ * and is fully filled by Trader X
+ */
+TEST_F(MatchingEngineTest, FOKSelfTradePreventionTest1) {
+  auto sym = "H";
+  mConfig->selfTradPreventionConfig->enable = true;
+  mConfig->selfTradPreventionConfig->policy =
+      SelfTradePreventionPolicy::CANCEL_PASSIVE;
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+  auto traderMap = mExecutionContext.getTraderMap();
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 20, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 20, 100);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::FOK_ORDER>(
+      mExecutionContext, "TraderW", sym, 20, 150);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 1);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.numOfOrders(), 2);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.totalQuantity(), 200);
+  EXPECT_EQ(traderMap["TraderW"]->getFilledBuyOrders().size(), 0);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::FOK_ORDER>(
+      mExecutionContext, "TraderW", sym, 20, 100);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 0);
+  EXPECT_EQ(traderMap["TraderW"]->getFilledBuyOrders().size(), 1);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getNetQuantity(),
+            100);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderX", sym).getNetQuantity(),
+            -100);
+}
+
+/**
+ * @brief
+ * Trader W places SELL order of 100 on stock H at 20, then Trader X places
+ * SELL order of 100 at 21. Given the self-trade prevention is enabled,
+ * policy: CANCEL_ACTIVE, Trader W's FOK BUY of 100 at 21 would be stopped at
+ * its own order, so it is cancelled without touching the book
+ */
+TEST_F(MatchingEngineTest, FOKSelfTradePreventionTest2) {
+  auto sym = "H";
+  mConfig->selfTradPreventionConfig->enable = true;
+  mConfig->selfTradPreventionConfig->policy =
+      SelfTradePreventionPolicy::CANCEL_ACTIVE;
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+  auto traderMap = mExecutionContext.getTraderMap();
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 20, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 21, 100);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::FOK_ORDER>(
+      mExecutionContext, "TraderW", sym, 21, 100);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 2);
+  EXPECT_EQ(book->getNumOfOrders<Side::SELL>(), 2);
+  EXPECT_EQ(traderMap["TraderW"]->getFilledBuyOrders().size(), 0);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getNetQuantity(), 0);
+}
+
+/**
+ * @brief
+ * Trader W, X, Y place SELL order of 100 on stock H at 10, 11, 12
+ * respectively. Trader Z's BUY order of 150 at 11 sweeps the first level,
+ * partially fills the second one and stops before the third one
+ */
+TEST_F(MatchingEngineTest, SweepTest1) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+  auto traderMap = mExecutionContext.getTraderMap();
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 11, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 12, 100);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderZ", sym, 11, 150);
+
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 2);
+  EXPECT_EQ(book->begin<Side::SELL>()->first, 11);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.totalQuantity(), 50);
+
+  auto &filledBuyOrders = traderMap["TraderZ"]->getFilledBuyOrders();
+  EXPECT_EQ(filledBuyOrders.size(), 2);
+  EXPECT_EQ(filledBuyOrders[0].getPrice(), 10);
+  EXPECT_EQ(filledBuyOrders[0].getQuantity(), 100);
+  EXPECT_EQ(filledBuyOrders[1].getPrice(), 11);
+  EXPECT_EQ(filledBuyOrders[1].getQuantity(), 50);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderX", sym).getNetQuantity(),
+            -50);
+}
+
+/**
+ * @brief
+ * The engine is built with CANCEL_PASSIVE self-trade prevention, the config
+ * does not enable it. Trader A's BUY order of 100 on stock S at 10 cancels
+ * Trader A's SELL order at 10 and trades with Trader B's SELL order at 10
+ */
+TEST(BasicMatchingEngineTest, CompileTimeSelfTradePreventionTest1) {
+  BasicMatchingEngine<
+      SelfTradePrevention<SelfTradePreventionPolicy::CANCEL_PASSIVE>>
+      engine(std::make_shared<MatchingEngineConfig>(), {"S"});
+  ExecutionContext context({"TraderA", "TraderB"});
+
+  engine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(context, "TraderA", "S",
+                                                     10, 100);
+  engine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(context, "TraderB", "S",
+                                                     10, 100);
+  engine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(context, "TraderA", "S", 10,
+                                                    100);
+
+  auto book = engine.getOrderBook("S");
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 0);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(context.getPosition("TraderA", "S").getNetQuantity(), 100);
+  EXPECT_EQ(context.getPosition("TraderB", "S").getNetQuantity(), -100);
+  EXPECT_EQ(context.getPosition("TraderA", "S").getOpenSellQuantity(), 0);
+}
+
+/**
+ * @brief
+ * The engine is built without self-trade prevention, enabling it in the
+ * config has no effect. Trader A's BUY order trades with its own SELL order
+ */
+TEST(BasicMatchingEngineTest, CompileTimeSelfTradePreventionTest2) {
+  auto config = std::make_shared<MatchingEngineConfig>();
+  config->selfTradPreventionConfig = SelfTradePreventionConfig{
+      true, SelfTradePreventionPolicy::CANCEL_BOTH, {}};
+  BasicMatchingEngine<NoSelfTradePrevention> engine(config, {"S"});
+  ExecutionContext context({"TraderA"});
+
+  engine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(context, "TraderA", "S",
+                                                     10, 100);
+  engine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(context, "TraderA", "S", 10,
+                                                    40);
+
+  auto book = engine.getOrderBook("S");
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 1);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.totalQuantity(), 60);
+  EXPECT_EQ(context.getPosition("TraderA", "S").getNetQuantity(), 0);
+}
+
+/**
+ * @brief
+ * Trader W places SELL order of 30 on stock H at 10, Trader X places SELL
+ * order of 50 on stock H at 10. Given the self-trade prevention is enabled,
+ * policy: DECREMENT_AND_CANCEL, Trader W's BUY order of 50 at 10 cancels its
+ * own SELL order, is decremented to 20 and trades 20 with Trader X. Once
+ * Trader X is filled, the rest of Trader W's BUY order of 30 at 12 is
+ * cancelled against its SELL order of 40 at 11, which is decremented to 30
+ */
+TEST_F(MatchingEngineTest, DecrementAndCancelTest1) {
+  auto sym = "H";
+  mConfig->selfTradPreventionConfig->enable = true;
+  mConfig->selfTradPreventionConfig->policy =
+      SelfTradePreventionPolicy::DECREMENT_AND_CANCEL;
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 30);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 10, 50);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 50);
+
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(book->getNumOfOrders<Side::SELL>(), 1);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.totalQuantity(), 30);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getNetQuantity(), 20);
+  EXPECT_EQ(
+      mExecutionContext.getPosition("TraderW", sym).getOpenSellQuantity(), 0);
+
+  auto sellOrderId =
+      mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+          mExecutionContext, "TraderW", sym, 11, 40);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 12, 10);
+
+  // the BUY order is matched against Trader X first
+  EXPECT_EQ(book->getNumOfOrders<Side::SELL>(), 2);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.totalQuantity(), 20);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 12, 30);
+
+  // 20 is traded with Trader X, the remaining 10 decrements the SELL order
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(book->getNumOfOrders<Side::SELL>(), 1);
+  EXPECT_EQ(book->find<Side::SELL>(sellOrderId)->getQuantity(), 30);
+  EXPECT_EQ(
+      mExecutionContext.getPosition("TraderW", sym).getOpenSellQuantity(), 30);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getNetQuantity(), 50);
+}
+
+/**
+ * @brief
+ * Trader W and X are in the same STP group. Given the self-trade prevention
+ * is enabled, policy: CANCEL_PASSIVE, Trader W's BUY order of 100 on stock H
+ * at 10 cancels Trader X's SELL order at 10 and rests in the order book
+ */
+TEST_F(MatchingEngineTest, SelfTradePreventionGroupTest1) {
+  auto sym = "H";
+  mConfig->selfTradPreventionConfig->enable = true;
+  mConfig->selfTradPreventionConfig->policy =
+      SelfTradePreventionPolicy::CANCEL_PASSIVE;
+  mConfig->selfTradPreventionConfig->groups = {{"TraderW", 7},
+                                               {"TraderX", 7}};
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 10, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 11, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 100);
+
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 1);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 1);
+  EXPECT_EQ(book->begin<Side::SELL>()->first, 11);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderX", sym).getNetQuantity(), 0);
+
+  // Trader Y is not in the group
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 11, 100);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 0);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderX", sym).getNetQuantity(),
+            100);
+}
+
+/**
+ * @brief
+ * Trader X, Y place SELL order of 100 on stock H at 10, 12 respectively.
+ * Trader Z places a STOP BUY order of 50 triggered at 10, it waits until
+ * Trader W's BUY order of 100 at 10 trades, then it is released as a market
+ * order and is filled at 12
+ */
+TEST_F(MatchingEngineTest, StopOrderTest1) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 10, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 12, 100);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::STOP_ORDER>(
+      mExecutionContext, "TraderZ", sym, 10, 50);
+  EXPECT_EQ(book->getNumOfStops<Side::BUY>(), 1);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(
+      mExecutionContext.getPosition("TraderZ", sym).getOpenBuyQuantity(), 0);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 10, 100);
+
+  EXPECT_EQ(book->getNumOfStops<Side::BUY>(), 0);
+  EXPECT_EQ(book->getLastTradePrice(), 12);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 1);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.totalQuantity(), 50);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderZ", sym).getNetQuantity(), 50);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderY", sym).getNetQuantity(),
+            -50);
+}
+
+/**
+ * @brief
+ * Trader X, Y place BUY order of 100 on stock H at 9, 8 respectively.
+ * Trader Z places a STOP LIMIT SELL order of 150 triggered at 9 with limit 8,
+ * Trader W places a STOP SELL order of 10 triggered at 9 and cancels it.
+ * Trader A's SELL order of 50 at 9 trades and releases Trader Z's order,
+ * which sweeps both BUY levels
+ */
+TEST_F(MatchingEngineTest, StopOrderTest2) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", sym, 9, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 8, 100);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::STOP_LIMIT_ORDER>(
+      mExecutionContext, "TraderZ", sym, 9, 8, 150);
+  auto stopOrderId =
+      mMatchingEngine.insert<Side::SELL, OrderStyle::STOP_ORDER>(
+          mExecutionContext, "TraderW", sym, 9, 10);
+  EXPECT_EQ(book->getNumOfStops<Side::SELL>(), 2);
+
+  mMatchingEngine.cancel(mExecutionContext,
+                         OrderCancelRequest{stopOrderId, sym, "TraderW"});
+  EXPECT_EQ(book->getNumOfStops<Side::SELL>(), 1);
+
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", sym, 9, 50);
+
+  EXPECT_EQ(book->getNumOfStops<Side::SELL>(), 0);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 0);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderZ", sym).getNetQuantity(),
+            -150);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getNetQuantity(), 0);
+}
+
+/**
+ * @brief
+ * Trader X places an iceberg SELL order of 100 showing 20 on stock H at 10,
+ * Trader Y places SELL order of 50 at 10. Trader Z's BUY order of 30 at 10
+ * fills the displayed 20 of Trader X, the next slice of Trader X goes behind
+ * Trader Y, and the last 10 is filled by Trader Y
+ */
+TEST_F(MatchingEngineTest, IcebergTest1) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+  auto traderMap = mExecutionContext.getTraderMap();
+
+  auto icebergId = mMatchingEngine.insertIceberg<Side::SELL>(
+      mExecutionContext, "TraderX", sym, 10, 100, 20);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", sym, 10, 50);
+
+  auto &level = book->begin<Side::SELL>()->second;
+  EXPECT_EQ(level.totalQuantity(), 70);
+  EXPECT_EQ(level.hiddenQuantity(), 80);
+  EXPECT_EQ(
+      mExecutionContext.getPosition("TraderX", sym).getOpenSellQuantity(), 100);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderZ", sym, 10, 30);
+
+  auto &filledBuyOrders = traderMap["TraderZ"]->getFilledBuyOrders();
+  EXPECT_EQ(filledBuyOrders.size(), 2);
+  EXPECT_EQ(filledBuyOrders[0].getQuantity(), 20);
+  EXPECT_EQ(filledBuyOrders[1].getQuantity(), 10);
+  EXPECT_EQ(level.totalQuantity(), 60);
+  EXPECT_EQ(level.hiddenQuantity(), 60);
+  EXPECT_EQ(level.front().getTraderId(), "TraderY");
+  EXPECT_EQ(book->find<Side::SELL>(icebergId)->getQuantity(), 20);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderX", sym).getNetQuantity(),
+            -20);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderZ", sym, 10, 200);
+
+  EXPECT_EQ(book->getNumOfLevels<Side::SELL>(), 0);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.totalQuantity(), 80);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderX", sym).getNetQuantity(),
+            -100);
+  EXPECT_EQ(
+      mExecutionContext.getPosition("TraderX", sym).getOpenSellQuantity(), 0);
+}
+
+/**
+ * @brief
+ * Trader X, Y place good-till-time BUY order of 100 on stock H at 10, 9
+ * expiring at 1000, 2000 respectively, Trader Z sells 30 at 10. At 1500
+ * the rest of Trader X's order expires, at 2000 Trader Y's order expires
+ */
+TEST_F(MatchingEngineTest, GoodTillTimeTest1) {
+  auto sym = "H";
+
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  mMatchingEngine.insertGoodTillTime<Side::BUY>(mExecutionContext, "TraderX",
+                                                sym, 10, 100, 1000);
+  mMatchingEngine.insertGoodTillTime<Side::BUY>(mExecutionContext, "TraderY",
+                                                sym, 9, 100, 2000);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderZ", sym, 10, 30);
+
+  mMatchingEngine.advanceTime(mExecutionContext, 999);
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 2);
+
+  mMatchingEngine.advanceTime(mExecutionContext, 1500);
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 1);
+  EXPECT_EQ(book->begin<Side::BUY>()->first, 9);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderX", sym).getNetQuantity(), 30);
+  EXPECT_EQ(
+      mExecutionContext.getPosition("TraderX", sym).getOpenBuyQuantity(), 0);
+  EXPECT_EQ(mExecutionContext.findAccount("TraderX")->getOpenOrderCount(), 0);
+
+  mMatchingEngine.advanceTime(mExecutionContext, 2000);
+  EXPECT_EQ(book->getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(
+      mExecutionContext.getPosition("TraderY", sym).getOpenBuyQuantity(), 0);
+}
+
+/**
+ * @brief
+ * Trader X places BUY orders on stock H and G and a SELL order on stock H,
+ * Trader Y places a BUY order on stock H. The mass cancel of Trader X's BUY
+ * orders on stock H, then of all Trader X's orders, leaves Trader Y's order
+ */
+TEST_F(MatchingEngineTest, MassCancelTest1) {
+  auto bookH = mMatchingEngine.getOrderBook("H");
+  auto bookG = mMatchingEngine.getOrderBook("G");
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", "H", 10, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", "H", 9, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", "H", 12, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", "G", 10, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", "H", 10, 100);
+
+  EXPECT_EQ(mMatchingEngine.massCancel(mExecutionContext, "TraderX", "H",
+                                       Side::BUY),
+            2);
+  EXPECT_EQ(bookH->getNumOfOrders<Side::BUY>(), 1);
+  EXPECT_EQ(bookH->getNumOfOrders<Side::SELL>(), 1);
+  EXPECT_EQ(bookG->getNumOfOrders<Side::BUY>(), 1);
+
+  EXPECT_EQ(mMatchingEngine.massCancel(mExecutionContext, "TraderX"), 2);
+  EXPECT_EQ(bookH->getNumOfOrders<Side::SELL>(), 0);
+  EXPECT_EQ(bookG->getNumOfOrders<Side::BUY>(), 0);
+  EXPECT_EQ(bookH->begin<Side::BUY>()->second.front().getTraderId(),
+            "TraderY");
+  EXPECT_EQ(mExecutionContext.findAccount("TraderX")->getOpenOrderCount(), 0);
+  EXPECT_EQ(mMatchingEngine.massCancel(mExecutionContext, "TraderX"), 0);
+}
+
+namespace {
+
+// counts the cancel batches and the cancels passed on by the default batch
+class CancelCounter : public ExecutionListener {
+public:
+  void onCancel(const TraderId &, OrderId orderId, const Symbol &, Side,
+                OrderStyle, Price, Quantity, OrderCancelReason) override {
+    mOrderIds.push_back(orderId);
+  }
+
+  void onCancelled(const std::vector<CancelledOrder> &cancelledOrders,
+                   OrderCancelReason rsn) override {
+    mNumOfBatches++;
+    ExecutionListener::onCancelled(cancelledOrders, rsn);
+  }
+
+  size_t mNumOfBatches = 0;
+  std::vector<OrderId> mOrderIds;
+};
+
+} // namespace
+
+/**
+ * @brief
+ * Trader X places 3 BUY orders on stock H. Their mass cancel reaches the
+ * listener as one batch, which the default onCancelled() passes on to
+ * onCancel() in the order of the ids, and leaves Trader X with no open order
+ */
+TEST_F(MatchingEngineTest, MassCancelTest2) {
+  CancelCounter counter;
+  mExecutionContext.setListener(&counter);
+  std::vector<OrderId> orderIds;
+  for (Price price : {10, 9, 8}) {
+    orderIds.push_back(
+        mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+            mExecutionContext, "TraderX", "H", price, 100));
+  }
+
+  EXPECT_EQ(mMatchingEngine.massCancel(mExecutionContext, "TraderX"), 3);
+  mExecutionContext.setListener(nullptr);
+  EXPECT_EQ(counter.mNumOfBatches, 1);
+  EXPECT_EQ(counter.mOrderIds, orderIds);
+  EXPECT_EQ(mExecutionContext.findAccount("TraderX")->getOpenOrderCount(), 0);
+}
+
+/**
+ * @brief
+ * Stock H is in the call phase, the crossing BUY orders at 102, 101 and 100
+ * and SELL orders at 99, 100 and 101 rest without matching and the market
+ * order is rejected. The uncross executes 300 at 101, the price with the most
+ * executable volume, and leaves Trader W's SELL order partially filled.
+ */
+TEST_F(MatchingEngineTest, AuctionTest1) {
+  auto sym = "H";
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  mMatchingEngine.setTradingPhase(sym, TradingPhase::CALL);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", sym, 102, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderB", sym, 101, 200);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderC", sym, 100, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderD", sym, 99, 150);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderE", sym, 100, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderW", sym, 101, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::MKT_ORDER>(mExecutionContext,
+                                                           "TraderX", sym, 50);
+
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 3);
+  EXPECT_EQ(book->getNumOfOrders<Side::SELL>(), 3);
+  EXPECT_EQ(book->getLastTradePrice(), 0);
+
+  auto result = mMatchingEngine.uncross(mExecutionContext, sym);
+  EXPECT_EQ(result.mPrice, 101);
+  EXPECT_EQ(result.mVolume, 300);
+  EXPECT_EQ(result.mImbalance, -50);
+  EXPECT_EQ(mMatchingEngine.getTradingPhase(sym), TradingPhase::CONTINUOUS);
+  EXPECT_EQ(book->getLastTradePrice(), 101);
+
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 1);
+  EXPECT_EQ(book->getBest<Side::BUY>(), 100);
+  EXPECT_EQ(book->getNumOfOrders<Side::SELL>(), 1);
+  EXPECT_EQ(book->getBest<Side::SELL>(), 101);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.totalQuantity(), 50);
+
+  EXPECT_EQ(mExecutionContext.getPosition("TraderA", sym).getNetQuantity(),
+            100);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderB", sym).getNetQuantity(),
+            200);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderD", sym).getNetQuantity(),
+            -150);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderW", sym).getNetQuantity(),
+            -50);
+  EXPECT_DOUBLE_EQ(
+      mExecutionContext.getPosition("TraderD", sym).getAverageCost(), 101);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderX", sym).getNetQuantity(),
+            0);
+}
+
+/**
+ * @brief
+ * The orders of stock G trade 100 with a surplus of 50 at 9, 10 and 11, the
+ * buyers are in excess at 9 and 10 and the sellers at 11, so the uncross
+ * picks 10, the nearest price to the last trade price. A book which does not
+ * cross is left untouched.
+ */
+TEST_F(MatchingEngineTest, AuctionTest2) {
+  auto sym = "G";
+  auto book = mMatchingEngine.getOrderBook(sym);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", sym, 10, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderB", sym, 10, 100);
+  EXPECT_EQ(book->getLastTradePrice(), 10);
+
+  mMatchingEngine.setTradingPhase(sym, TradingPhase::CALL);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", sym, 11, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderC", sym, 10, 50);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderB", sym, 9, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderD", sym, 11, 50);
+
+  auto result = mMatchingEngine.uncross(mExecutionContext, sym);
+  EXPECT_EQ(result.mPrice, 10);
+  EXPECT_EQ(result.mVolume, 100);
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 1);
+  EXPECT_EQ(book->getNumOfOrders<Side::SELL>(), 1);
+
+  mMatchingEngine.setTradingPhase(sym, TradingPhase::CALL);
+  result = mMatchingEngine.uncross(mExecutionContext, sym);
+  EXPECT_EQ(result.mVolume, 0);
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 1);
+  EXPECT_EQ(book->getLastTradePrice(), 10);
+}
+
+/**
+ * @brief
+ * Stock P allocates pro-rata with a minimum allocation of 20. Trader X's BUY
+ * order of 105 is shared among the SELL orders of 100, 300 and 600 as 10, 31
+ * and 63, Trader A's allocation of 10 is dropped and the residual of 11 goes
+ * in time priority, i.e. to Trader A.
+ */
+TEST_F(MatchingEngineTest, AllocationTest1) {
+  AllocationConfig allocation;
+  allocation.policy = AllocationPolicy::PRO_RATA;
+  allocation.minAllocation = 20;
+  mMatchingEngine.addStocks({"P"}, allocation);
+  auto book = mMatchingEngine.getOrderBook("P");
+
+  auto idA = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "P", 10, 100);
+  auto idB = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderB", "P", 10, 300);
+  auto idC = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderC", "P", 10, 600);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderX", "P", 10, 105);
+
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 0);
+  EXPECT_EQ(book->find<Side::SELL>(idA)->getQuantity(), 89);
+  EXPECT_EQ(book->find<Side::SELL>(idB)->getQuantity(), 269);
+  EXPECT_EQ(book->find<Side::SELL>(idC)->getQuantity(), 537);
+  EXPECT_EQ(book->begin<Side::SELL>()->second.totalQuantity(), 895);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderX", "P").getNetQuantity(),
+            105);
+
+  // the order consuming the whole level fills every order
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderY", "P", 11, 1000);
+  EXPECT_EQ(book->getNumOfOrders<Side::SELL>(), 0);
+  EXPECT_EQ(book->begin<Side::BUY>()->second.totalQuantity(), 105);
+}
+
+/**
+ * @brief
+ * Stock L gives 40% of the incoming quantity to the lead market maker Trader C.
+ * Trader X's BUY order of 150 fills 60 of Trader C's SELL order and the other
+ * 90 go in time priority to Trader A.
+ */
+TEST_F(MatchingEngineTest, AllocationTest2) {
+  AllocationConfig allocation;
+  allocation.policy = AllocationPolicy::LEAD_MARKET_MAKER;
+  allocation.leadMarketMaker = "TraderC";
+  allocation.leadMarketMakerShare = 40;
+  mMatchingEngine.addStocks({"L"}, allocation);
+  auto book = mMatchingEngine.getOrderBook("L");
+
+  auto idA = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "L", 10, 100);
+  auto idB = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderB", "L", 10, 100);
+  auto idC = mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderC", "L", 10, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::MKT_ORDER>(mExecutionContext,
+                                                           "TraderX", "L", 150);
+
+  EXPECT_EQ(book->find<Side::SELL>(idA)->getQuantity(), 10);
+  EXPECT_EQ(book->find<Side::SELL>(idB)->getQuantity(), 100);
+  EXPECT_EQ(book->find<Side::SELL>(idC)->getQuantity(), 40);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderC", "L").getNetQuantity(),
+            -60);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderX", "L").getNetQuantity(),
+            150);
+}
+
+/**
+ * @brief
+ * AllocationTest2 on the engine without self-trade prevention, which interns
+ * the trader ids on stock L only to find the lead market maker Trader C
+ */
+TEST(BasicMatchingEngineTest, LeadMarketMakerTest1) {
+  AllocationConfig allocation;
+  allocation.policy = AllocationPolicy::LEAD_MARKET_MAKER;
+  allocation.leadMarketMaker = "TraderC";
+  allocation.leadMarketMakerShare = 40;
+  BasicMatchingEngine<NoSelfTradePrevention> engine;
+  engine.addStocks({"L"}, allocation);
+  ExecutionContext context({"TraderA", "TraderB", "TraderC", "TraderX"});
+  auto book = engine.getOrderBook("L");
+
+  auto idA = engine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      context, "TraderA", "L", 10, 100);
+  auto idC = engine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      context, "TraderC", "L", 10, 100);
+  engine.insert<Side::BUY, OrderStyle::MKT_ORDER>(context, "TraderX", "L",
+                                                  150);
+
+  EXPECT_EQ(book->find<Side::SELL>(idA)->getQuantity(), 10);
+  EXPECT_EQ(book->find<Side::SELL>(idC)->getQuantity(), 40);
+  EXPECT_EQ(context.getPosition("TraderC", "L").getNetQuantity(), -60);
+}
+
+/**
+ * @brief
+ * Stock T trades in ticks of 5 and lots of 10 between 100 and 200. The orders
+ * off the tick or the lot and outside the band are rejected, the amend to a
+ * price off the tick is rejected too.
+ */
+TEST_F(MatchingEngineTest, SymbolConfigTest1) {
+  SymbolConfig config;
+  config.symbol = "T";
+  config.tickSize = 5;
+  config.lotSize = 10;
+  config.minPrice = 100;
+  config.maxPrice = 200;
+  mMatchingEngine.addStocks({config});
+  auto book = mMatchingEngine.getOrderBook("T");
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "T", 102, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "T", 105, 15);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "T", 95, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "T", 205, 100);
+  EXPECT_EQ(book->getNumOfOrders<Side::BUY>(), 0);
+  EXPECT_EQ(book->getNumOfOrders<Side::SELL>(), 0);
+
+  auto orderId = mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "T", 100, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::MKT_ORDER>(mExecutionContext,
+                                                            "TraderB", "T", 5);
+  EXPECT_EQ(book->find<Side::BUY>(orderId)->getQuantity(), 100);
+
+  OrderAmendRequest req;
+  req.mOrderId = orderId;
+  req.mSymbol = "T";
+  req.mTraderId = "TraderA";
+  req.mPrice = 101;
+  req.mQuantity = 100;
+  mMatchingEngine.amend(mExecutionContext, req);
+  EXPECT_EQ(book->find<Side::BUY>(orderId)->getPrice(), 100);
+
+  req.mPrice = 110;
+  req.mQuantity = 50;
+  mMatchingEngine.amend(mExecutionContext, req);
+  EXPECT_EQ(book->find<Side::BUY>(orderId)->getPrice(), 110);
+}
+
+/**
+ * @brief
+ * The static data of the stocks is read from a file, the static data of a
+ * stock already added is replaced. A malformed file, or one asking for a book
+ * backend that does not exist, adds nothing.
+ */
+TEST_F(MatchingEngineTest, SymbolConfigTest2) {
+  auto path = ::testing::TempDir() + "symbols.txt";
+  {
+    std::ofstream file(path);
+    file << "# symbol scale tick lot min max backend\n"
+         << "\n"
+         << "U 2 0.1 1 0.10 10 MAP\n"
+         << "H 0 2 1 2 100\n";
+  }
+  EXPECT_TRUE(mMatchingEngine.loadStocks(path));
+
+  auto bookU = mMatchingEngine.getOrderBook("U");
+  ASSERT_NE(bookU, nullptr);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "U", 15, 10);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "U", 20, 10);
+  EXPECT_EQ(bookU->getNumOfOrders<Side::BUY>(), 1);
+
+  auto bookH = mMatchingEngine.getOrderBook("H");
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "H", 101, 10);
+  EXPECT_EQ(bookH->getNumOfOrders<Side::SELL>(), 0);
+
+  {
+    std::ofstream file(path);
+    file << "V 0 1 1 1 100\n"
+         << "W 1 0.05 1 1 100\n";
+  }
+  EXPECT_FALSE(mMatchingEngine.loadStocks(path));
+  EXPECT_EQ(mMatchingEngine.getOrderBook("V"), nullptr);
+
+  {
+    std::ofstream file(path);
+    file << "V 0 1 1 1 100 ARRAY_LADDER\n";
+  }
+  EXPECT_FALSE(mMatchingEngine.loadStocks(path));
+  EXPECT_EQ(mMatchingEngine.getOrderBook("V"), nullptr);
+  std::remove(path.c_str());
+}
+
+/**
+ * @brief
+ * The orders on an unknown symbol are rejected and no order book is created
+ * for it. An order inserted by symbol id lands in the book of the symbol.
+ */
+TEST_F(MatchingEngineTest, SymbolIdTest1) {
+  auto orderId = mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", "NONE", 10, 100);
+  EXPECT_EQ(mMatchingEngine.getOrderBook("NONE"), nullptr);
+  EXPECT_FALSE(mMatchingEngine.getSymbolId("NONE"));
+
+  OrderCancelRequest req;
+  req.mOrderId = orderId;
+  req.mSymbol = "NONE";
+  req.mTraderId = "TraderA";
+  mMatchingEngine.cancel(mExecutionContext, req);
+  EXPECT_EQ(mMatchingEngine.getOrderBook("NONE"), nullptr);
+
+  auto symbolId = mMatchingEngine.getSymbolId("G");
+  ASSERT_TRUE(symbolId);
+  EXPECT_EQ(mMatchingEngine.getOrderBook(*symbolId),
+            mMatchingEngine.getOrderBook("G"));
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", *symbolId, 10, 100);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::MKT_ORDER>(
+      mExecutionContext, "TraderB", *symbolId, 40);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderB", "G").getNetQuantity(), 40);
+  EXPECT_EQ(mMatchingEngine.getOrderBook("G")
+                ->begin<Side::SELL>()
+                ->second.totalQuantity(),
+            60);
+
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", SymbolId(100), 10, 100);
+  EXPECT_EQ(mMatchingEngine.getOrderBook(SymbolId(100)), nullptr);
+}
+
+/**
+ * @brief
+ * The traders log to the stream of the context, the traders added before and
+ * after it is set, and not at all once it is nullptr
+ */
+TEST_F(MatchingEngineTest, TraderLogTest) {
+  std::ostringstream log;
+  mExecutionContext.setTraderLog(&log);
+  mExecutionContext.addTraders({"TraderF"});
+  auto sym = mSymbols[0];
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", sym, 10, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderF", sym, 10, 100);
+  EXPECT_NE(log.str().find("Order Open! TraderA BUY 100 ABC"),
+            std::string::npos);
+  EXPECT_NE(log.str().find("Fill! TraderF ORDER_TYPE: LIMIT ORDER SELL 100"),
+            std::string::npos);
+
+  auto size = log.str().size();
+  mExecutionContext.setTraderLog(nullptr);
+  mMatchingEngine.insert<Side::BUY, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderA", sym, 10, 100);
+  mMatchingEngine.insert<Side::SELL, OrderStyle::LIMIT_ORDER>(
+      mExecutionContext, "TraderF", sym, 10, 100);
+  EXPECT_EQ(log.str().size(), size);
+  EXPECT_EQ(mExecutionContext.getPosition("TraderF", "ABC").getNetQuantity(),
+            -200);
+}
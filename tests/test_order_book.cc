@@ -2,6 +2,7 @@
 #include <core/order/order.h>
 #include <core/order_book/order_book.h>
 #include <types.h>
+#include <utility>
 
 using namespace Common;
 using namespace Core;
@@ -56,9 +57,9 @@ TEST_F(OrderBookTest, TestSameTraderBidOrderInsertionSamePriceLevel) {
 
   Order<Side::BUY> buyOrder1(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC", 100,
                              10);
-  Order<Side::BUY> buyOrder2(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC", 100,
+  Order<Side::BUY> buyOrder2(OrderStyle::LIMIT_ORDER, mTrader1Id, 1, "ABC", 100,
                              5);
-  Order<Side::BUY> buyOrder3(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC", 100,
+  Order<Side::BUY> buyOrder3(OrderStyle::LIMIT_ORDER, mTrader1Id, 2, "ABC", 100,
                              2);
 
   mOrderbook.insert<Side::BUY>(buyOrder1);
@@ -71,6 +72,17 @@ TEST_F(OrderBookTest, TestSameTraderBidOrderInsertionSamePriceLevel) {
 
   auto best_bid_iter = mOrderbook.begin<Side::BUY>();
   EXPECT_EQ(best_bid_iter->first, 100);
+  EXPECT_EQ(best_bid_iter->second.numOfOrders(), 3);
+  EXPECT_EQ(best_bid_iter->second.totalQuantity(), 17);
+  EXPECT_EQ(best_bid_iter->second.front(), buyOrder1);
+
+  bool success = mOrderbook.removeOrder(1, mTrader1Id);
+  EXPECT_EQ(success, true);
+  EXPECT_EQ(best_bid_iter->second.numOfOrders(), 2);
+  EXPECT_EQ(best_bid_iter->second.totalQuantity(), 12);
+
+  best_bid_iter->second.pop();
+
   EXPECT_EQ(best_bid_iter->second.numOfOrders(), 1);
   EXPECT_EQ(best_bid_iter->second.front(), buyOrder3);
 }
@@ -146,9 +158,9 @@ TEST_F(OrderBookTest, TestAskOrderInsertionMultiplePriceLevel) {
 TEST_F(OrderBookTest, TestSameTraderAskOrderInsertionSamePriceLevel) {
   Order<Side::SELL> sellOrder1(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC",
                                100, 10);
-  Order<Side::SELL> sellOrder2(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC",
+  Order<Side::SELL> sellOrder2(OrderStyle::LIMIT_ORDER, mTrader1Id, 1, "ABC",
                                100, 5);
-  Order<Side::SELL> sellOrder3(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC",
+  Order<Side::SELL> sellOrder3(OrderStyle::LIMIT_ORDER, mTrader1Id, 2, "ABC",
                                100, 1);
 
   mOrderbook.insert<Side::SELL>(sellOrder1);
@@ -161,8 +173,14 @@ TEST_F(OrderBookTest, TestSameTraderAskOrderInsertionSamePriceLevel) {
 
   auto best_ask_iter = mOrderbook.begin<Side::SELL>();
   EXPECT_EQ(best_ask_iter->first, 100);
-  EXPECT_EQ(best_ask_iter->second.numOfOrders(), 1);
-  EXPECT_EQ(best_ask_iter->second.front(), sellOrder3);
+  EXPECT_EQ(best_ask_iter->second.numOfOrders(), 3);
+  EXPECT_EQ(best_ask_iter->second.totalQuantity(), 16);
+  EXPECT_EQ(best_ask_iter->second.front(), sellOrder1);
+
+  bool success = mOrderbook.removeOrder(0, mTrader1Id);
+  EXPECT_EQ(success, true);
+  EXPECT_EQ(best_ask_iter->second.numOfOrders(), 2);
+  EXPECT_EQ(best_ask_iter->second.front(), sellOrder2);
 }
 
 TEST_F(OrderBookTest, TestDifferentTraderAskOrderInsertionSamePriceLevel) {
@@ -353,3 +371,194 @@ TEST_F(OrderBookTest, TestAskOrderSearch) {
     EXPECT_EQ(bookLevel, mOrderbook.begin<Side::SELL>());
   }
 }
+
+TEST_F(OrderBookTest, TestBidOrderReduce) {
+  Order<Side::BUY> buyOrder1(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC", 100,
+                             10);
+  Order<Side::BUY> buyOrder2(OrderStyle::LIMIT_ORDER, mTrader2Id, 1, "ABC", 100,
+                             50);
+
+  mOrderbook.insert<Side::BUY>(buyOrder1);
+  mOrderbook.insert<Side::BUY>(buyOrder2);
+  EXPECT_EQ(mOrderbook.getNumOfOrders<Side::BUY>(), 2);
+
+  bool success = mOrderbook.reduce<Side::BUY>(0, 4);
+  EXPECT_EQ(success, true);
+
+  auto best_bid_iter = mOrderbook.begin<Side::BUY>();
+  EXPECT_EQ(best_bid_iter->second.front().getOrderId(), 0);
+  EXPECT_EQ(best_bid_iter->second.front().getQuantity(), 4);
+  EXPECT_EQ(best_bid_iter->second.totalQuantity(), 54);
+  EXPECT_EQ(mOrderbook.find<Side::BUY>(1)->getQuantity(), 50);
+
+  EXPECT_EQ(mOrderbook.reduce<Side::BUY>(2, 4), false);
+  EXPECT_EQ(mOrderbook.find<Side::BUY>(2), nullptr);
+}
+
+TEST_F(OrderBookTest, TestAskOrderRemovalByIndex) {
+  Order<Side::SELL> sellOrder1(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC",
+                               100, 10);
+  Order<Side::SELL> sellOrder2(OrderStyle::LIMIT_ORDER, mTrader2Id, 1, "ABC",
+                               101, 50);
+
+  mOrderbook.insert<Side::SELL>(sellOrder1);
+  mOrderbook.insert<Side::SELL>(sellOrder2);
+
+  EXPECT_EQ(mOrderbook.removeOrder(1, mTrader1Id), false);
+  EXPECT_EQ(mOrderbook.removeOrder(1, mTrader2Id), true);
+  EXPECT_EQ(mOrderbook.removeOrder(1, mTrader2Id), false);
+  EXPECT_EQ(mOrderbook.getNumOfLevels<Side::SELL>(), 1);
+  EXPECT_EQ(mOrderbook.getNumOfOrders<Side::SELL>(), 1);
+
+  mOrderbook.begin<Side::SELL>()->second.pop();
+  EXPECT_EQ(mOrderbook.getNumOfOrders<Side::SELL>(), 0);
+  EXPECT_EQ(mOrderbook.contains<Side::SELL>(0), false);
+}
+
+TEST_F(OrderBookTest, TestCanFill) {
+  Order<Side::SELL> sellOrder1(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC",
+                               100, 10);
+  Order<Side::SELL> sellOrder2(OrderStyle::LIMIT_ORDER, mTrader2Id, 1, "ABC",
+                               101, 50);
+  Order<Side::SELL> sellOrder3(OrderStyle::LIMIT_ORDER, mTrader3Id, 2, "ABC",
+                               102, 60);
+
+  mOrderbook.insert<Side::SELL>(sellOrder1);
+  mOrderbook.insert<Side::SELL>(sellOrder2);
+  mOrderbook.insert<Side::SELL>(sellOrder3);
+
+  EXPECT_EQ(mOrderbook.canFill<Side::SELL>(99, 1), false);
+  EXPECT_EQ(mOrderbook.canFill<Side::SELL>(100, 10), true);
+  EXPECT_EQ(mOrderbook.canFill<Side::SELL>(100, 11), false);
+  EXPECT_EQ(mOrderbook.canFill<Side::SELL>(101, 60), true);
+  EXPECT_EQ(mOrderbook.canFill<Side::SELL>(200, 120), true);
+  EXPECT_EQ(mOrderbook.canFill<Side::SELL>(200, 121), false);
+  EXPECT_EQ(mOrderbook.canFill<Side::BUY>(200, 1), false);
+}
+
+TEST_F(OrderBookTest, TestStopTriggerOrder) {
+  Order<Side::BUY> stopOrder1(OrderStyle::STOP_ORDER, mTrader1Id, 0, "ABC",
+                              105, 10);
+  Order<Side::BUY> stopOrder2(OrderStyle::STOP_ORDER, mTrader2Id, 1, "ABC",
+                              103, 10);
+  Order<Side::BUY> stopOrder3(OrderStyle::STOP_ORDER, mTrader3Id, 2, "ABC",
+                              105, 10);
+
+  mOrderbook.insertStop<Side::BUY>(105, stopOrder1);
+  mOrderbook.insertStop<Side::BUY>(103, stopOrder2);
+  mOrderbook.insertStop<Side::BUY>(105, stopOrder3);
+
+  std::vector<Order<Side::BUY>> triggered;
+  mOrderbook.popTriggeredStops<Side::BUY>(triggered);
+  EXPECT_EQ(triggered.size(), 0);
+
+  mOrderbook.setLastTradePrice(104);
+  mOrderbook.popTriggeredStops<Side::BUY>(triggered);
+  EXPECT_EQ(triggered.size(), 1);
+  EXPECT_EQ(triggered[0], stopOrder2);
+
+  mOrderbook.setLastTradePrice(106);
+  mOrderbook.popTriggeredStops<Side::BUY>(triggered);
+  EXPECT_EQ(triggered.size(), 3);
+  EXPECT_EQ(triggered[1], stopOrder1);
+  EXPECT_EQ(triggered[2], stopOrder3);
+  EXPECT_EQ(mOrderbook.getNumOfStops<Side::BUY>(), 0);
+}
+
+TEST_F(OrderBookTest, TestIcebergOrderReplenish) {
+  Order<Side::BUY> buyOrder1(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC",
+                             100, 50);
+  buyOrder1.setDisplayQuantity(20);
+  Order<Side::BUY> buyOrder2(OrderStyle::LIMIT_ORDER, mTrader2Id, 1, "ABC",
+                             100, 10);
+
+  mOrderbook.insert<Side::BUY>(buyOrder1);
+  mOrderbook.insert<Side::BUY>(buyOrder2);
+
+  auto &level = mOrderbook.begin<Side::BUY>()->second;
+  EXPECT_EQ(level.totalQuantity(), 30);
+  EXPECT_EQ(level.hiddenQuantity(), 30);
+
+  level.setQuantity(level.begin(), 0);
+  level.replenish(level.begin());
+  EXPECT_EQ(level.front().getOrderId(), 1);
+  EXPECT_EQ(level.totalQuantity(), 30);
+  EXPECT_EQ(level.hiddenQuantity(), 10);
+
+  mOrderbook.reduce<Side::BUY>(0, 5);
+  EXPECT_EQ(mOrderbook.find<Side::BUY>(0)->getQuantity(), 5);
+  EXPECT_EQ(level.totalQuantity(), 15);
+  EXPECT_EQ(level.hiddenQuantity(), 0);
+
+  EXPECT_EQ(mOrderbook.removeOrder<Side::BUY>(0, mTrader1Id), true);
+  EXPECT_EQ(level.totalQuantity(), 10);
+}
+
+TEST_F(OrderBookTest, TestTraderOrderIndex) {
+  Order<Side::SELL> sellOrder1(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC",
+                               100, 10);
+  Order<Side::SELL> sellOrder2(OrderStyle::LIMIT_ORDER, mTrader1Id, 1, "ABC",
+                               101, 10);
+  Order<Side::SELL> sellOrder3(OrderStyle::LIMIT_ORDER, mTrader2Id, 2, "ABC",
+                               101, 10);
+
+  mOrderbook.insert<Side::SELL>(sellOrder1);
+  mOrderbook.insert<Side::SELL>(sellOrder2);
+  mOrderbook.insert<Side::SELL>(sellOrder3);
+
+  EXPECT_EQ(mOrderbook.findTraderOrders<Side::SELL>(mTrader1Id)->size(), 2);
+  EXPECT_EQ(mOrderbook.findTraderOrders<Side::BUY>(mTrader1Id), nullptr);
+
+  mOrderbook.removeOrder<Side::SELL>(1, mTrader1Id);
+  EXPECT_EQ(mOrderbook.findTraderOrders<Side::SELL>(mTrader1Id)->count(0), 1);
+
+  mOrderbook.erase(mOrderbook.begin<Side::SELL>());
+  EXPECT_EQ(mOrderbook.findTraderOrders<Side::SELL>(mTrader1Id), nullptr);
+  EXPECT_EQ(mOrderbook.findTraderOrders<Side::SELL>(mTrader2Id)->size(), 1);
+}
+
+TEST_F(OrderBookTest, TestMoveOrderBook) {
+  Order<Side::BUY> buyOrder1(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC", 100,
+                             10);
+  Order<Side::BUY> buyOrder2(OrderStyle::LIMIT_ORDER, mTrader2Id, 1, "ABC", 100,
+                             10);
+  mOrderbook.insert<Side::BUY>(buyOrder1);
+  mOrderbook.insert<Side::BUY>(buyOrder2);
+
+  OrderBook book(std::move(mOrderbook));
+  EXPECT_EQ(book.getNumOfOrders<Side::BUY>(), 2);
+
+  // the levels update the indexes of the book they have moved to
+  book.begin<Side::BUY>()->second.pop();
+  EXPECT_FALSE(book.contains<Side::BUY>(0));
+  EXPECT_EQ(book.findTraderOrders<Side::BUY>(mTrader1Id), nullptr);
+
+  EXPECT_TRUE(book.removeOrder<Side::BUY>(1, mTrader2Id));
+  EXPECT_EQ(book.getNumOfLevels<Side::BUY>(), 0);
+  EXPECT_EQ(book.getNumOfOrders<Side::BUY>(), 0);
+}
+
+TEST_F(OrderBookTest, TestQueuePosition) {
+  Order<Side::BUY> buyOrder1(OrderStyle::LIMIT_ORDER, mTrader1Id, 0, "ABC", 100,
+                             10);
+  Order<Side::BUY> buyOrder2(OrderStyle::LIMIT_ORDER, mTrader2Id, 1, "ABC", 100,
+                             20);
+  Order<Side::BUY> buyOrder3(OrderStyle::LIMIT_ORDER, mTrader1Id, 2, "ABC", 100,
+                             30);
+  Order<Side::BUY> buyOrder4(OrderStyle::LIMIT_ORDER, mTrader2Id, 3, "ABC", 101,
+                             40);
+  mOrderbook.insert<Side::BUY>(buyOrder1);
+  mOrderbook.insert<Side::BUY>(buyOrder2);
+  mOrderbook.insert<Side::BUY>(buyOrder3);
+  mOrderbook.insert<Side::BUY>(buyOrder4);
+
+  // only the orders of the same level ahead in time count
+  EXPECT_EQ(mOrderbook.getQueuePosition<Side::BUY>(0), 0);
+  EXPECT_EQ(mOrderbook.getQueuePosition<Side::BUY>(2), 30);
+  EXPECT_EQ(mOrderbook.getQueuePosition<Side::BUY>(3), 0);
+  EXPECT_EQ(mOrderbook.getQueuePosition<Side::SELL>(2), std::nullopt);
+
+  mOrderbook.reduce<Side::BUY>(0, 5);
+  mOrderbook.removeOrder<Side::BUY>(1, mTrader2Id);
+  EXPECT_EQ(mOrderbook.getQueuePosition<Side::BUY>(2), 5);
+}
@@ -0,0 +1,303 @@
+#include "gtest/gtest.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <core/execution_context/execution_context.h>
+#include <cstring>
+#include <gateway/binary_protocol.h>
+#include <matching_engine/matching_engine.h>
+#include <netinet/in.h>
+#include <optional>
+#include <order_entry_server/io_backend.h>
+#include <order_entry_server/order_entry_server.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <types.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+namespace {
+
+struct Report {
+  OrderId mOrderId;
+  std::uint64_t mRequestSeqNum;
+  std::uint32_t mTraderIndex;
+  BinaryProtocol::ExecType mExecType;
+};
+
+/**
+ * @brief
+ * A blocking client of the server on the loopback, it keeps every report it
+ * has read
+ */
+class Client {
+public:
+  // a receive buffer size of 0 keeps the default of the kernel
+  explicit Client(std::uint16_t port, int receiveBufferSize = 0) {
+    sockaddr_in socketAddress{};
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = htons(port);
+    ::inet_pton(AF_INET, "127.0.0.1", &socketAddress.sin_addr);
+    mFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    timeval timeout{5, 0};
+    ::setsockopt(mFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(mFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    if (receiveBufferSize > 0) {
+      ::setsockopt(mFd, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize,
+                   sizeof(receiveBufferSize));
+    }
+    mIsConnected =
+        ::connect(mFd, reinterpret_cast<sockaddr *>(&socketAddress),
+                  sizeof(socketAddress)) == 0;
+  }
+  ~Client() { ::close(mFd); }
+
+  Client(const Client &other) = delete;
+  Client &operator=(const Client &) = delete;
+
+  bool isConnected() const { return mIsConnected; }
+
+  bool sendNewOrder(std::uint32_t traderIndex, Side side, Price price,
+                    Quantity quantity) {
+    char frame[BinaryProtocol::kMaxFrameSize];
+    auto size = BinaryProtocol::encodeNewOrder(
+        frame + BinaryProtocol::FrameHeader::kSize, traderIndex, 0, side,
+        OrderStyle::LIMIT_ORDER, price, 0, quantity);
+    return send(frame, BinaryProtocol::encodeFrame(frame, size));
+  }
+
+  bool sendCancel(std::uint32_t traderIndex, OrderId orderId) {
+    char frame[BinaryProtocol::kMaxFrameSize];
+    auto size = BinaryProtocol::encodeCancel(
+        frame + BinaryProtocol::FrameHeader::kSize, traderIndex, 0, orderId);
+    return send(frame, BinaryProtocol::encodeFrame(frame, size));
+  }
+
+  bool send(const char *data, size_t size) {
+    while (size > 0) {
+      auto written = ::send(mFd, data, size, MSG_NOSIGNAL);
+      if (written <= 0) {
+        return false;
+      }
+      data += written;
+      size -= written;
+    }
+    return true;
+  }
+
+  /**
+   * @brief
+   * Read the reports until one of the exec type has come
+   * return the first one, nullopt if the connection is closed or nothing
+   * comes in time
+   */
+  std::optional<Report> waitFor(BinaryProtocol::ExecType execType) {
+    size_t numOfReports = 0;
+    while (true) {
+      for (; numOfReports < mReports.size(); numOfReports++) {
+        if (mReports[numOfReports].mExecType == execType) {
+          return mReports[numOfReports];
+        }
+      }
+      if (!read()) {
+        return std::nullopt;
+      }
+    }
+  }
+
+  // read until the server closes the connection, false on a timeout
+  bool waitForClose() {
+    char buffer[4096];
+    while (true) {
+      auto numOfBytes = ::recv(mFd, buffer, sizeof(buffer), 0);
+      if (numOfBytes == 0) {
+        return true;
+      }
+      if (numOfBytes < 0) {
+        return errno != EAGAIN && errno != EWOULDBLOCK;
+      }
+    }
+  }
+
+  const std::vector<Report> &getReports() const { return mReports; }
+
+  void onNewOrder(const BinaryProtocol::NewOrderView &) {}
+  void onCancel(const BinaryProtocol::CancelView &) {}
+  void onAmend(const BinaryProtocol::AmendView &) {}
+  void onMassCancel(const BinaryProtocol::MassCancelView &) {}
+  void onExecutionReport(const BinaryProtocol::ExecutionReportView &message) {
+    mReports.push_back(Report{message.orderId(), message.requestSeqNum(),
+                              message.traderIndex(), message.execType()});
+  }
+
+private:
+  bool read() {
+    char buffer[4096];
+    auto numOfBytes = ::recv(mFd, buffer, sizeof(buffer), 0);
+    if (numOfBytes <= 0) {
+      return false;
+    }
+    mInput.insert(mInput.end(), buffer, buffer + numOfBytes);
+    auto consumed =
+        BinaryProtocol::decodeFrames(mInput.data(), mInput.size(), *this);
+    if (!consumed) {
+      return false;
+    }
+    mInput.erase(mInput.begin(), mInput.begin() + *consumed);
+    return true;
+  }
+
+  int mFd = -1;
+  bool mIsConnected = false;
+  std::vector<char> mInput;
+  std::vector<Report> mReports;
+};
+
+} // namespace
+
+class OrderEntryServerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    mMatchingEngine.addStocks(mSymbols);
+    mExecutionContext.setTraderLog(nullptr);
+    mExecutionContext.addTraders(mTraderIds);
+    ASSERT_TRUE(mServer.listen("127.0.0.1", 0));
+  }
+
+  void TearDown() override {
+    mServer.stop();
+    if (mThread.joinable()) {
+      mThread.join();
+    }
+  }
+
+  void start() {
+    mThread = std::thread([this] { mServer.run(); });
+  }
+
+  std::vector<Symbol> mSymbols = {"ABC"};
+  std::vector<TraderId> mTraderIds = {"TraderA", "TraderB"};
+  MatchingEngine mMatchingEngine;
+  ExecutionContext mExecutionContext;
+  std::unique_ptr<IoBackend> mBackend = makeIoBackend(IoBackendType::WRITE);
+  OrderEntryServer mServer{mMatchingEngine, mExecutionContext, mTraderIds,
+                           *mBackend};
+  std::thread mThread;
+};
+
+/**
+ * @brief
+ * TraderA and TraderB send from their own connection. The order of TraderA
+ * rests, the order of TraderB trades with it. Each connection gets only the
+ * reports of its trader, the answers carry the number of the message and the
+ * fill of the resting order carries none.
+ */
+TEST_F(OrderEntryServerTest, RoutingTest1) {
+  start();
+  Client clientA(mServer.getPort());
+  Client clientB(mServer.getPort());
+  ASSERT_TRUE(clientA.isConnected());
+  ASSERT_TRUE(clientB.isConnected());
+
+  ASSERT_TRUE(clientA.sendNewOrder(0, Side::BUY, 100, 10));
+  auto open = clientA.waitFor(BinaryProtocol::ExecType::NEW);
+  ASSERT_TRUE(open);
+  EXPECT_EQ(open->mRequestSeqNum, 1u);
+
+  ASSERT_TRUE(clientB.sendNewOrder(1, Side::SELL, 100, 4));
+  auto fillB = clientB.waitFor(BinaryProtocol::ExecType::FILL);
+  ASSERT_TRUE(fillB);
+  EXPECT_EQ(fillB->mRequestSeqNum, 1u);
+  auto fillA = clientA.waitFor(BinaryProtocol::ExecType::FILL);
+  ASSERT_TRUE(fillA);
+  EXPECT_EQ(fillA->mOrderId, open->mOrderId);
+  EXPECT_EQ(fillA->mRequestSeqNum, 0u);
+
+  for (const auto &report : clientA.getReports()) {
+    EXPECT_EQ(report.mTraderIndex, 0u);
+  }
+  for (const auto &report : clientB.getReports()) {
+    EXPECT_EQ(report.mTraderIndex, 1u);
+  }
+}
+
+/**
+ * @brief
+ * TraderA is bound to its connection. The cancel of its order sent by the
+ * connection of TraderB is dropped without a number, TraderA can still
+ * cancel the order itself and its reports stay on its connection.
+ */
+TEST_F(OrderEntryServerTest, RoutingTest2) {
+  start();
+  Client clientA(mServer.getPort());
+  Client clientB(mServer.getPort());
+  ASSERT_TRUE(clientA.isConnected());
+  ASSERT_TRUE(clientB.isConnected());
+
+  ASSERT_TRUE(clientA.sendNewOrder(0, Side::BUY, 100, 10));
+  auto open = clientA.waitFor(BinaryProtocol::ExecType::NEW);
+  ASSERT_TRUE(open);
+
+  ASSERT_TRUE(clientB.sendCancel(0, open->mOrderId));
+  ASSERT_TRUE(clientB.sendNewOrder(1, Side::SELL, 200, 10));
+  auto openB = clientB.waitFor(BinaryProtocol::ExecType::NEW);
+  ASSERT_TRUE(openB);
+  EXPECT_EQ(openB->mRequestSeqNum, 1u);
+
+  ASSERT_TRUE(clientA.sendCancel(0, open->mOrderId));
+  auto cancel = clientA.waitFor(BinaryProtocol::ExecType::CANCEL);
+  ASSERT_TRUE(cancel);
+  EXPECT_EQ(cancel->mOrderId, open->mOrderId);
+  EXPECT_EQ(cancel->mRequestSeqNum, 2u);
+  EXPECT_EQ(clientA.getReports().size(), 2u);
+  for (const auto &report : clientB.getReports()) {
+    EXPECT_EQ(report.mTraderIndex, 1u);
+  }
+}
+
+/**
+ * @brief
+ * The connection of TraderB sends orders without reading its reports and is
+ * dropped once its pending output passes the limit. TraderB is then free for
+ * a new connection, the connection of TraderA is not affected.
+ */
+TEST_F(OrderEntryServerTest, CloseTest1) {
+  mServer.setMaxPendingOutput(64 * 1024);
+  start();
+  Client clientA(mServer.getPort());
+  ASSERT_TRUE(clientA.isConnected());
+  ASSERT_TRUE(clientA.sendNewOrder(0, Side::BUY, 100, 10));
+  ASSERT_TRUE(clientA.waitFor(BinaryProtocol::ExecType::NEW));
+
+  {
+    Client clientB(mServer.getPort(), 4096);
+    ASSERT_TRUE(clientB.isConnected());
+    std::vector<char> frames;
+    char frame[BinaryProtocol::kMaxFrameSize];
+    for (int i = 0; i < 1000; i++) {
+      auto frameSize = BinaryProtocol::encodeFrame(
+          frame, BinaryProtocol::encodeNewOrder(
+                     frame + BinaryProtocol::FrameHeader::kSize, 1, 0,
+                     Side::SELL, OrderStyle::LIMIT_ORDER, 200, 0, 1));
+      frames.insert(frames.end(), frame, frame + frameSize);
+    }
+    // far more reports than the socket buffers hold, the sends may fail
+    // once the connection is dropped
+    for (int i = 0; i < 200 && clientB.send(frames.data(), frames.size());
+         i++) {
+    }
+    EXPECT_TRUE(clientB.waitForClose());
+  }
+
+  Client clientC(mServer.getPort());
+  ASSERT_TRUE(clientC.isConnected());
+  ASSERT_TRUE(clientC.sendNewOrder(1, Side::SELL, 100, 4));
+  auto fill = clientC.waitFor(BinaryProtocol::ExecType::FILL);
+  ASSERT_TRUE(fill);
+  EXPECT_EQ(fill->mTraderIndex, 1u);
+  EXPECT_EQ(fill->mRequestSeqNum, 1u);
+  ASSERT_TRUE(clientA.waitFor(BinaryProtocol::ExecType::FILL));
+}
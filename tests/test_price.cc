@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <limits>
+#include <price.h>
+#include <string>
+#include <type_traits>
+#include <types.h>
+
+using namespace Common;
+
+namespace {
+std::string format(Price price, unsigned scale) {
+  char buffer[Price::kMaxFormattedSize];
+  return std::string(buffer, price.format(buffer, scale));
+}
+} // namespace
+
+TEST(PriceTest, TestParse) {
+  Price price;
+  EXPECT_TRUE(Price::parse("12.345", 3, price));
+  EXPECT_EQ(price, 12345);
+  EXPECT_TRUE(Price::parse("12.3", 3, price));
+  EXPECT_EQ(price, 12300);
+  EXPECT_TRUE(Price::parse("-0.05", 2, price));
+  EXPECT_EQ(price, -5);
+  EXPECT_TRUE(Price::parse("42", 0, price));
+  EXPECT_EQ(price, 42);
+  EXPECT_TRUE(Price::parse("9223372036854775807", 0, price));
+  EXPECT_EQ(price, Price::max());
+
+  EXPECT_FALSE(Price::parse("12.345", 2, price));
+  EXPECT_FALSE(Price::parse("1.2.3", 2, price));
+  EXPECT_FALSE(Price::parse("12a", 2, price));
+  EXPECT_FALSE(Price::parse("-", 2, price));
+  EXPECT_FALSE(Price::parse("", 2, price));
+  EXPECT_FALSE(Price::parse("9223372036854775808", 0, price));
+  EXPECT_FALSE(Price::parse("92233720368547758.08", 3, price));
+}
+
+TEST(PriceTest, TestFormat) {
+  EXPECT_EQ(format(12345, 3), "12.345");
+  EXPECT_EQ(format(5, 2), "0.05");
+  EXPECT_EQ(format(-5, 2), "-0.05");
+  EXPECT_EQ(format(0, 0), "0");
+  EXPECT_EQ(format(120, 0), "120");
+  EXPECT_EQ(format(Price::max(), 18), "9.223372036854775807");
+  EXPECT_EQ(format(Price(std::numeric_limits<std::int64_t>::min()), 0),
+            "-9223372036854775808");
+}
+
+TEST(PriceTest, TestArithmetic) {
+  constexpr Price tick = 5;
+  static_assert(Price(15) % tick == 0);
+  static_assert(Price(10) + tick == 15 && Price(10) - tick == tick);
+  static_assert(Price(101) > Price(100) && !Price(0));
+  static_assert(Price(250).notional(4) == 1000);
+  static_assert(std::is_convertible_v<std::int64_t, Price>);
+  static_assert(!std::is_constructible_v<Price, double> &&
+                !std::is_convertible_v<double, Price> &&
+                !std::is_convertible_v<float, Price>);
+}
@@ -0,0 +1,324 @@
+#include "gtest/gtest.h"
+#include <core/execution_context/execution_context.h>
+#include <fstream>
+#include <matching_engine/matching_engine.h>
+#include <replay/book_checksum.h>
+#include <replay/csv_converter.h>
+#include <replay/itch_converter.h>
+#include <replay/latency_histogram.h>
+#include <replay/replay_file.h>
+#include <replay/replay_writer.h>
+#include <replay/replayer.h>
+#include <string>
+#include <types.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+namespace {
+
+Replay::Record makeRecord(Replay::EventType type, std::uint64_t orderRef,
+                          std::uint32_t traderIndex, Side side, Price price,
+                          Quantity quantity) {
+  Replay::Record record{};
+  record.timestamp = orderRef * 1000;
+  record.orderRef = orderRef;
+  record.price = price.units();
+  record.quantity = quantity;
+  record.traderIndex = traderIndex;
+  record.type = type;
+  record.side = static_cast<std::uint8_t>(side);
+  record.style = static_cast<std::uint8_t>(OrderStyle::LIMIT_ORDER);
+  return record;
+}
+
+// an ITCH message of the type, the fields are stored by storeBigEndian()
+std::string makeItchMessage(char type, size_t length, std::uint64_t orderRef) {
+  std::string message(length, '\0');
+  message[0] = type;
+  for (size_t i = 0; i < 8; i++) {
+    message[11 + i] = static_cast<char>(orderRef >> (56 - 8 * i));
+  }
+  return message;
+}
+
+void storeBigEndian(std::string &message, size_t offset, std::uint64_t value,
+                    size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    message[offset + i] = static_cast<char>(value >> (8 * (size - 1 - i)));
+  }
+}
+
+std::string makeItchAdd(std::uint64_t orderRef, char side,
+                        std::uint32_t shares, std::uint32_t price) {
+  auto message = makeItchMessage('A', 36, orderRef);
+  message[19] = side;
+  storeBigEndian(message, 20, shares, 4);
+  message.replace(24, 8, "ABC     ");
+  storeBigEndian(message, 32, price, 4);
+  return message;
+}
+
+} // namespace
+
+class ReplayTest : public ::testing::Test {
+protected:
+  void TearDown() override { ::unlink(mPath.c_str()); }
+
+  // write the records on symbol ABC of two traders
+  void write(const std::vector<Replay::Record> &records) {
+    Replay::ReplayWriter writer;
+    ASSERT_TRUE(writer.open(mPath));
+    writer.setNumOfTraders(2);
+    EXPECT_EQ(writer.internSymbol("ABC", 2), 0);
+    for (const auto &record : records) {
+      writer.append(record);
+    }
+    EXPECT_TRUE(writer.close());
+  }
+
+  // replay the file on a new engine and return the checksum of ABC
+  std::uint64_t replay() {
+    Replay::ReplayFile file;
+    EXPECT_TRUE(file.open(mPath));
+    auto symbols = file.getSymbols();
+    MatchingEngine engine;
+    engine.addStocks(symbols);
+    auto traderIds = Replay::makeTraderIds(file.getHeader().numOfTraders);
+    ExecutionContext context(traderIds);
+    Replay::Replayer<MatchingEngine> replayer(engine, context, traderIds,
+                                              {*engine.getSymbolId("ABC")});
+    for (const auto &record : file) {
+      replayer.apply(record);
+    }
+
+    auto book = engine.getOrderBook("ABC");
+    mNetQuantity =
+        context.getPosition(traderIds.back(), "ABC").getNetQuantity();
+    mNumOfBuyOrders = book->getNumOfOrders<Side::BUY>();
+    mNumOfSellOrders = book->getNumOfOrders<Side::SELL>();
+    if (mNumOfBuyOrders) {
+      mBestBid = *book->find<Side::BUY>(
+          book->begin<Side::BUY>()->second.front().getOrderId());
+    }
+    return Replay::checksum(*book);
+  }
+
+  std::string mPath = ::testing::TempDir() + "replay_test.bin";
+  // the position of the last trader
+  std::int64_t mNetQuantity = 0;
+  size_t mNumOfBuyOrders = 0;
+  size_t mNumOfSellOrders = 0;
+  Order<Side::BUY> mBestBid;
+};
+
+/**
+ * @brief
+ * The records and the interned symbols written are mapped back in place, a
+ * symbol interned twice keeps its index. A file that is not a replay file is
+ * not opened.
+ */
+TEST_F(ReplayTest, FileTest1) {
+  {
+    Replay::ReplayWriter writer;
+    ASSERT_TRUE(writer.open(mPath));
+    writer.setNumOfTraders(3);
+    EXPECT_EQ(writer.internSymbol("ABC", 2), 0);
+    EXPECT_EQ(writer.internSymbol("S", 4), 1);
+    EXPECT_EQ(writer.internSymbol("ABC", 2), 0);
+    for (std::uint64_t i = 1; i <= 10000; i++) {
+      writer.append(makeRecord(Replay::EventType::NEW_ORDER, i, i % 3,
+                               Side::BUY, static_cast<std::int64_t>(i), i));
+    }
+    EXPECT_TRUE(writer.close());
+  }
+
+  Replay::ReplayFile file;
+  ASSERT_TRUE(file.open(mPath));
+  EXPECT_EQ(file.size(), 10000);
+  EXPECT_EQ(file.getHeader().numOfTraders, 3);
+  auto symbols = file.getSymbols();
+  ASSERT_EQ(symbols.size(), 2);
+  EXPECT_EQ(symbols[0].symbol, "ABC");
+  EXPECT_EQ(symbols[1].symbol, "S");
+  EXPECT_EQ(symbols[1].priceScale, 4);
+
+  std::uint64_t orderRef = 0;
+  for (const auto &record : file) {
+    EXPECT_EQ(record.orderRef, ++orderRef);
+    EXPECT_EQ(record.price, static_cast<std::int64_t>(orderRef));
+  }
+  EXPECT_EQ(orderRef, 10000);
+
+  std::ofstream(mPath) << "not a replay file, not a replay file, not a replay "
+                          "file, not a replay file";
+  Replay::ReplayFile other;
+  EXPECT_FALSE(other.open(mPath));
+}
+
+/**
+ * @brief
+ * Trader 0 buys 100 at 10.00 and trader 1 sells 30 into it. Trader 0 then
+ * takes 20 off the order, amends it to 40 at 10.05 and buys 10 more at 9.95
+ * which is cancelled. One BUY order of 40 at 10.05 is left, and the same
+ * records replayed again end with the same checksum.
+ */
+TEST_F(ReplayTest, ReplayerTest1) {
+  using Replay::EventType;
+  write({makeRecord(EventType::NEW_ORDER, 1, 0, Side::BUY, 1000, 100),
+         makeRecord(EventType::NEW_ORDER, 2, 1, Side::SELL, 1000, 30),
+         makeRecord(EventType::REDUCE, 1, 0, Side::BUY, 0, 20),
+         makeRecord(EventType::AMEND, 1, 0, Side::BUY, 1005, 40),
+         makeRecord(EventType::NEW_ORDER, 3, 0, Side::BUY, 995, 10),
+         makeRecord(EventType::CANCEL, 3, 0, Side::BUY, 0, 0),
+         makeRecord(EventType::CANCEL, 2, 1, Side::SELL, 0, 0)});
+
+  auto checksum = replay();
+  EXPECT_EQ(mNumOfBuyOrders, 1);
+  EXPECT_EQ(mNumOfSellOrders, 0);
+  EXPECT_EQ(mBestBid.getPrice(), 1005);
+  EXPECT_EQ(mBestBid.getQuantity(), 40);
+  EXPECT_EQ(replay(), checksum);
+
+  write({makeRecord(EventType::NEW_ORDER, 1, 0, Side::BUY, 1005, 41)});
+  EXPECT_NE(replay(), checksum);
+}
+
+/**
+ * @brief
+ * A CSV with a header, a comment, a CRLF line end and two malformed lines is
+ * converted in blocks of 128 bytes by 3 threads. The records keep the order
+ * of the lines, the prices are normalized to the scale of their symbol and
+ * the file has the traders up to the largest index.
+ */
+TEST_F(ReplayTest, CsvConverterTest1) {
+  auto csvPath = mPath + ".csv";
+  std::ofstream(csvPath)
+      << "timestamp,event,orderRef,trader,symbol,side,style,price,quantity\n"
+         "1,NEW,1,0,ABC,B,LIMIT,10.00,100\n"
+         "2,NEW,2,1,ABC,S,,10,30\r\n"
+         "# a comment\n"
+         "3,REDUCE,1,0,ABC,,,,20\n"
+         "4,AMEND,1,0,ABC,,,10.05,40\n"
+         "5,NEW,3,0,ABC,B,IOC,10.001,10\n"
+         "6,NEW,4,2,XYZ,S,MKT,,5\n"
+         "7,FILL,5,0,ABC,B,LIMIT,1,1\n"
+         "8,CANCEL,2,1,ABC,,,,\n";
+
+  Replay::ReplayWriter writer;
+  ASSERT_TRUE(writer.open(mPath));
+  Replay::CsvConverter converter(writer, 3, 2, 128);
+  converter.setPriceScale("XYZ", 1);
+  EXPECT_TRUE(converter.convert(csvPath));
+  EXPECT_EQ(converter.getNumOfRecords(), 6);
+  EXPECT_EQ(converter.getNumOfSkippedLines(), 2);
+  EXPECT_TRUE(writer.close());
+  ::unlink(csvPath.c_str());
+
+  Replay::ReplayFile file;
+  ASSERT_TRUE(file.open(mPath));
+  EXPECT_EQ(file.getHeader().numOfTraders, 3);
+  auto symbols = file.getSymbols();
+  ASSERT_EQ(symbols.size(), 2);
+  EXPECT_EQ(symbols[1].symbol, "XYZ");
+  EXPECT_EQ(symbols[1].priceScale, 1);
+
+  std::vector<Timestamp> timestamps;
+  for (const auto &record : file) {
+    timestamps.push_back(record.timestamp);
+  }
+  EXPECT_EQ(timestamps, (std::vector<Timestamp>{1, 2, 3, 4, 6, 8}));
+  auto records = file.begin();
+  EXPECT_EQ(records[0].price, 1000);
+  EXPECT_EQ(records[1].side, static_cast<std::uint8_t>(Side::SELL));
+  EXPECT_EQ(records[2].type, Replay::EventType::REDUCE);
+  EXPECT_EQ(records[3].price, 1005);
+  EXPECT_EQ(records[4].symbolIndex, 1);
+  EXPECT_EQ(records[4].style, static_cast<std::uint8_t>(OrderStyle::MKT_ORDER));
+  EXPECT_EQ(records[5].type, Replay::EventType::CANCEL);
+}
+
+/**
+ * @brief
+ * An ITCH capture adds a BUY order of 100 at 10.0000 and a SELL order of 50,
+ * executes 30 of the BUY order and cancels 20 more, replaces the SELL order
+ * and deletes the replacement. The capture is fed a byte at a time, the
+ * delete of an unknown order is skipped and a system event is ignored. The
+ * execution is an IOC SELL order of trader 1 at 10.0000 which trades with the
+ * BUY order. One BUY order of 50 at 10.0000 is left on the book.
+ */
+TEST_F(ReplayTest, ItchConverterTest1) {
+  auto executed = makeItchMessage('E', 31, 1);
+  storeBigEndian(executed, 19, 30, 4);
+  auto cancelled = makeItchMessage('X', 23, 1);
+  storeBigEndian(cancelled, 19, 20, 4);
+  auto replaced = makeItchMessage('U', 35, 2);
+  storeBigEndian(replaced, 19, 3, 8);
+  storeBigEndian(replaced, 27, 40, 4);
+  storeBigEndian(replaced, 31, 100500, 4);
+
+  std::string capture;
+  for (const auto &message :
+       {makeItchAdd(1, 'B', 100, 100000), makeItchAdd(2, 'S', 50, 101000),
+        std::string(12, 'S'), executed, cancelled, replaced,
+        makeItchMessage('D', 19, 9), makeItchMessage('D', 19, 3)}) {
+    capture += static_cast<char>(message.size() >> 8);
+    capture += static_cast<char>(message.size());
+    capture += message;
+  }
+
+  Replay::ReplayWriter writer;
+  ASSERT_TRUE(writer.open(mPath));
+  Replay::ItchConverter converter(writer);
+  size_t consumed = 0;
+  for (size_t size = 1; size <= capture.size(); size++) {
+    consumed += converter.onData(capture.data() + consumed, size - consumed);
+  }
+  EXPECT_EQ(consumed, capture.size());
+  EXPECT_EQ(converter.getNumOfRecords(), 7);
+  EXPECT_EQ(converter.getNumOfSkippedMessages(), 1);
+  EXPECT_EQ(converter.getNumOfRestingOrders(), 1);
+  EXPECT_TRUE(writer.close());
+
+  Replay::ReplayFile file;
+  ASSERT_TRUE(file.open(mPath));
+  EXPECT_EQ(file.getHeader().numOfTraders, 2);
+  ASSERT_EQ(file.getHeader().numOfRecords, 7);
+  auto records = file.begin();
+  EXPECT_EQ(records[2].type, Replay::EventType::NEW_ORDER);
+  EXPECT_EQ(records[2].traderIndex, 1);
+  EXPECT_EQ(records[2].side, static_cast<std::uint8_t>(Side::SELL));
+  EXPECT_EQ(records[2].style, static_cast<std::uint8_t>(OrderStyle::IOC_ORDER));
+  EXPECT_EQ(records[2].price, 100000);
+  EXPECT_EQ(records[2].quantity, 30);
+  EXPECT_EQ(records[3].type, Replay::EventType::REDUCE);
+  EXPECT_EQ(records[3].traderIndex, 0);
+
+  replay();
+  EXPECT_EQ(mNetQuantity, -30);
+  EXPECT_EQ(mNumOfBuyOrders, 1);
+  EXPECT_EQ(mNumOfSellOrders, 0);
+  EXPECT_EQ(mBestBid.getPrice(), 100000);
+  EXPECT_EQ(mBestBid.getQuantity(), 50);
+}
+
+/**
+ * @brief
+ * The latencies 1 to 1000 are recorded, the percentiles are within 1/16 of
+ * the true values and the small values are exact.
+ */
+TEST(LatencyHistogramTest, PercentileTest1) {
+  Replay::LatencyHistogram latencies;
+  for (std::uint64_t latency = 1; latency <= 1000; latency++) {
+    latencies.record(latency);
+  }
+
+  EXPECT_EQ(latencies.getCount(), 1000);
+  EXPECT_EQ(latencies.getMax(), 1000);
+  EXPECT_EQ(latencies.percentile(0.005), 6);
+  EXPECT_NEAR(latencies.percentile(0.5), 500, 500 / 16);
+  EXPECT_NEAR(latencies.percentile(0.99), 990, 990 / 16);
+  EXPECT_EQ(latencies.percentile(1), 1000);
+}
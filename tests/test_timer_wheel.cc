@@ -0,0 +1,69 @@
+#include "gtest/gtest.h"
+#include <core/timer_wheel/timer_wheel.h>
+#include <types.h>
+#include <vector>
+
+using namespace Common;
+using namespace Core;
+
+class TimerWheelTest : public ::testing::Test {
+protected:
+  void SetUp() override { mExpired.clear(); }
+
+  void TearDown() override {}
+
+  TimerWheel mTimerWheel;
+  std::vector<TimerWheel::Timer> mExpired;
+};
+
+TEST_F(TimerWheelTest, TestExpiryOrder) {
+  std::vector<Timestamp> expiries = {5000, 1,  64,         63, 1ull << 20,
+                                     4096, 65, 1ull << 40, 0,  4095};
+  for (size_t i = 0; i < expiries.size(); i++) {
+    mTimerWheel.schedule(expiries[i], i);
+  }
+  EXPECT_EQ(mTimerWheel.size(), expiries.size());
+
+  mTimerWheel.advance(64, mExpired);
+  EXPECT_EQ(mExpired.size(), 4);
+  EXPECT_EQ(mExpired[0].mId, 8);
+  EXPECT_EQ(mExpired[1].mId, 1);
+  EXPECT_EQ(mExpired[2].mId, 3);
+  EXPECT_EQ(mExpired[3].mId, 2);
+
+  mTimerWheel.advance(1ull << 20, mExpired);
+  EXPECT_EQ(mExpired.size(), 9);
+  EXPECT_EQ(mExpired[4].mId, 6);
+  EXPECT_EQ(mExpired[5].mId, 9);
+  EXPECT_EQ(mExpired[6].mId, 5);
+  EXPECT_EQ(mExpired[7].mId, 0);
+  EXPECT_EQ(mExpired[8].mId, 4);
+  EXPECT_EQ(mTimerWheel.size(), 1);
+
+  mTimerWheel.advance((1ull << 40) - 1, mExpired);
+  EXPECT_EQ(mExpired.size(), 9);
+
+  mTimerWheel.advance(1ull << 40, mExpired);
+  EXPECT_EQ(mExpired.size(), 10);
+  EXPECT_EQ(mExpired[9].mExpiry, 1ull << 40);
+  EXPECT_EQ(mTimerWheel.empty(), true);
+}
+
+TEST_F(TimerWheelTest, TestScheduleAfterAdvance) {
+  mTimerWheel.advance(1000, mExpired);
+  EXPECT_EQ(mTimerWheel.getTime(), 1001);
+
+  // already due, it expires on the next advance
+  mTimerWheel.schedule(10, 0);
+  mTimerWheel.schedule(1100, 1);
+  mTimerWheel.schedule(1024, 2);
+
+  mTimerWheel.advance(1023, mExpired);
+  EXPECT_EQ(mExpired.size(), 1);
+  EXPECT_EQ(mExpired[0].mId, 0);
+
+  mTimerWheel.advance(2000, mExpired);
+  EXPECT_EQ(mExpired.size(), 3);
+  EXPECT_EQ(mExpired[1].mId, 2);
+  EXPECT_EQ(mExpired[2].mId, 1);
+}